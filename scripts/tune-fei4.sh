@@ -4,15 +4,26 @@ if [ "$#" -lt 5 ]; then
     exit 1
 fi
 
-bin/scanConsole -s digitalscan -r $4 -c ${@:5} -p -m 1
-bin/scanConsole -s analogscan -r $4 -c ${@:5} -p
-bin/scanConsole -s tune_globalthreshold -t $1 -r $4 -c ${@:5} -p
-bin/scanConsole -s tune_globalpreamp -t $3 $2 -r $4 -c ${@:5} -p
-bin/scanConsole -s tune_globalthreshold -t $1 -r $4 -c ${@:5} -p
-bin/scanConsole -s tune_pixelthreshold -t $1 -r $4 -c ${@:5} -p
-bin/scanConsole -s tune_globalpreamp -t $3 $2 -r $4 -c ${@:5} -p
-bin/scanConsole -s tune_pixelpreamp -t $3 $2 -r $4 -c ${@:5} -p
-bin/scanConsole -s tune_pixelthreshold -t $1 -r $4 -c ${@:5} -p
-bin/scanConsole -s noisescan -r $4 -c ${@:5} -p
-bin/scanConsole -s totscan -t $3 $2 -r $4 -c ${@:5} -p
-bin/scanConsole -s thresholdscan -r $4 -c ${@:5} -p
+# All scans run in one scanConsole, the hardware and the chips are set up once
+sequence=$(mktemp --suffix=.json)
+trap "rm -f $sequence" EXIT
+cat > $sequence << EOF
+{
+  "scans": [
+    {"scan": "configs/scans/fei4/std_digitalscan.json", "mask": 1},
+    "configs/scans/fei4/std_analogscan.json",
+    {"scan": "configs/scans/fei4/std_tune_globalthreshold.json", "target_charge": $1},
+    {"scan": "configs/scans/fei4/std_tune_globalpreamp.json", "target_charge": $3, "target_tot": $2},
+    {"scan": "configs/scans/fei4/std_tune_globalthreshold.json", "target_charge": $1},
+    {"scan": "configs/scans/fei4/std_tune_pixelthreshold.json", "target_charge": $1},
+    {"scan": "configs/scans/fei4/std_tune_globalpreamp.json", "target_charge": $3, "target_tot": $2},
+    {"scan": "configs/scans/fei4/std_tune_pixelpreamp.json", "target_charge": $3, "target_tot": $2},
+    {"scan": "configs/scans/fei4/std_tune_pixelthreshold.json", "target_charge": $1},
+    "configs/scans/fei4/std_noisescan.json",
+    {"scan": "configs/scans/fei4/std_totscan.json", "target_charge": $3, "target_tot": $2},
+    "configs/scans/fei4/std_thresholdscan.json"
+  ]
+}
+EOF
+
+bin/scanConsole -S $sequence -r $4 -c ${@:5} -p
@@ -5,35 +5,40 @@ if [ "$#" -lt 6 ]; then
     exit 1
 fi
 
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/std_digitalscan.json -p -m 1
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/std_analogscan.json -p
-#./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/std_thresholdscan.json -p -m
-#./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/std_totscan.json -p -m 0 -t $3
-
-# Tune diff FE
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/diff_tune_globalthreshold.json -t $2 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/diff_tune_pixelthreshold.json -t $2 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/diff_tune_globalpreamp.json -t $3 $4 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/diff_tune_pixelthreshold.json -t $2 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/diff_tune_finepixelthreshold.json -t $2 -p
-
-# Tune lin FE
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/lin_tune_globalthreshold.json -t $1 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/lin_tune_pixelthreshold.json -t $1 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/lin_retune_globalthreshold.json -t $2 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/lin_retune_pixelthreshold.json -t $2 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/lin_tune_globalpreamp.json -t $3 $4 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/lin_retune_pixelthreshold.json -t $2 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/lin_tune_finepixelthreshold.json -t $2 -p
-
-# Tune sync FE
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/syn_tune_globalthreshold.json -t $2 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/syn_tune_globalpreamp.json -t $3 $4 -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/syn_tune_globalthreshold.json -t $2 -p
-
-# Finals threshold & tot scans
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/std_thresholdscan.json -p
-./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/std_totscan.json -p -t $3
+# All scans run in one scanConsole, the hardware and the chips are set up once
+sequence=$(mktemp --suffix=.json)
+trap "rm -f $sequence" EXIT
+cat > $sequence << EOF
+{
+  "scans": [
+    {"scan": "configs/scans/rd53a/std_digitalscan.json", "mask": 1},
+    "configs/scans/rd53a/std_analogscan.json",
+
+    {"scan": "configs/scans/rd53a/diff_tune_globalthreshold.json", "target_charge": $2},
+    {"scan": "configs/scans/rd53a/diff_tune_pixelthreshold.json", "target_charge": $2},
+    {"scan": "configs/scans/rd53a/diff_tune_globalpreamp.json", "target_charge": $3, "target_tot": $4},
+    {"scan": "configs/scans/rd53a/diff_tune_pixelthreshold.json", "target_charge": $2},
+    {"scan": "configs/scans/rd53a/diff_tune_finepixelthreshold.json", "target_charge": $2},
+
+    {"scan": "configs/scans/rd53a/lin_tune_globalthreshold.json", "target_charge": $1},
+    {"scan": "configs/scans/rd53a/lin_tune_pixelthreshold.json", "target_charge": $1},
+    {"scan": "configs/scans/rd53a/lin_retune_globalthreshold.json", "target_charge": $2},
+    {"scan": "configs/scans/rd53a/lin_retune_pixelthreshold.json", "target_charge": $2},
+    {"scan": "configs/scans/rd53a/lin_tune_globalpreamp.json", "target_charge": $3, "target_tot": $4},
+    {"scan": "configs/scans/rd53a/lin_retune_pixelthreshold.json", "target_charge": $2},
+    {"scan": "configs/scans/rd53a/lin_tune_finepixelthreshold.json", "target_charge": $2},
+
+    {"scan": "configs/scans/rd53a/syn_tune_globalthreshold.json", "target_charge": $2},
+    {"scan": "configs/scans/rd53a/syn_tune_globalpreamp.json", "target_charge": $3, "target_tot": $4},
+    {"scan": "configs/scans/rd53a/syn_tune_globalthreshold.json", "target_charge": $2},
+
+    "configs/scans/rd53a/std_thresholdscan.json",
+    {"scan": "configs/scans/rd53a/std_totscan.json", "target_charge": $3}
+  ]
+}
+EOF
+
+./bin/scanConsole -r $5 -c ${@:6} -S $sequence -p
 
 # Create final mask for operation
 #./bin/scanConsole -r $5 -c ${@:6} -s configs/scans/rd53a/std_digitalscan.json -p -m 1
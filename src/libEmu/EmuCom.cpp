@@ -1,4 +1,20 @@
 #include "EmuCom.h"
 
+#include <thread>
+
 EmuCom::EmuCom() {}
 EmuCom::~EmuCom() {}
+
+void EmuCom::writeBlock32(const uint32_t *buf, uint32_t length) {
+    for (uint32_t i=0; i<length; i++)
+        this->write32(buf[i]);
+}
+
+bool EmuCom::waitForData(std::chrono::microseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (this->isEmpty()) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return true;
+}
@@ -4,6 +4,7 @@
 #include "logging.h"
 
 #include "Fei4Emu.h"
+#include "Gauss.h"
 #include "Rd53aEmu.h"
 
 namespace {
@@ -13,7 +14,8 @@ namespace {
 template<class FE, class ChipEmu>
 std::unique_ptr<HwController> makeEmu() {
   // nikola's hack to use RingBuffer
-  std::unique_ptr<RingBuffer> rx(new RingBuffer(128));
+  // Room for a burst of hit data without stalling the emulator
+  std::unique_ptr<RingBuffer> rx(new RingBuffer(1 << 14));
   std::unique_ptr<RingBuffer> tx(new RingBuffer(128));
 
   std::unique_ptr<HwController> ctrl(new EmuController<FE, ChipEmu>(std::move(rx), std::move(tx)));
@@ -29,35 +31,75 @@ bool emu_registered_Rd53a =
   StdDict::registerHwController("emu_Rd53a",
                                 makeEmu<Rd53a, Rd53aEmu>);
 
+template<>
+void EmuController<Fei4, Fei4Emu>::addChip(uint32_t channel) {
+  Chip &chip = chips[channel];
+  if (!chip.tx_com) {
+    chip.rx_com.reset(new RingBuffer(chips[0].rx_com->getCapacity()));
+    chip.tx_com.reset(new RingBuffer(chips[0].tx_com->getCapacity()));
+    EmuTxCore<Fei4>::setCom(channel, chip.tx_com.get());
+    EmuRxCore<Fei4>::setCom(channel, chip.rx_com.get());
+  }
+
+  std::string emuCfgFile = emuCfg["feCfg"];
+  logger->info("Starting FEI4 Emulator on channel {}", channel);
+  chip.emu.reset(new Fei4Emu(emuCfgFile, emuCfgFile, chip.rx_com.get(), chip.tx_com.get(), channel));
+  if (emuCfg.find("physicsHits") != emuCfg.end()) {
+    double physicsHits = emuCfg["physicsHits"];
+    chip.emu->setPhysicsHits(physicsHits);
+  }
+  chip.thread = std::thread(&Fei4Emu::executeLoop, chip.emu.get());
+}
+
 template<>
 void EmuController<Fei4, Fei4Emu>::loadConfig(json &j) {
 //    EmuTxCore::setCom(new EmuShm(j["tx"]["id"], j["tx"]["size"], true));
 //    EmuRxCore::setCom(new EmuShm(j["rx"]["id"], j["rx"]["size"], true));
 
-  auto tx = EmuTxCore<Fei4>::getCom();
-  auto rx = EmuRxCore<Fei4>::getCom();
-
   //TODO make nice
-  logger->info("Starting FEI4 Emulator");
-  std::string emuCfgFile = j["feCfg"];
-  logger->info(" read {}", emuCfgFile);
-  emu.reset(new Fei4Emu(emuCfgFile, emuCfgFile, rx, tx));
-  emuThreads.push_back(std::thread(&Fei4Emu::executeLoop, emu.get()));
+  emuCfg = j;
+  logger->info(" read {}", std::string(j["feCfg"]));
+  if (j.find("seed") != j.end()) {
+    uint64_t seed = j["seed"];
+    logger->info(" random seed {}", seed);
+    Gauss::setSeed(seed);
+  }
+  if (j.find("physicsHits") != j.end()) {
+    double physicsHits = j["physicsHits"];
+    logger->info(" physics hits per trigger {}", physicsHits);
+  }
+  this->addChip(0);
 }
 
 
+template<>
+void EmuController<Rd53a, Rd53aEmu>::addChip(uint32_t channel) {
+  Chip &chip = chips[channel];
+  if (!chip.tx_com) {
+    chip.rx_com.reset(new RingBuffer(chips[0].rx_com->getCapacity()));
+    chip.tx_com.reset(new RingBuffer(chips[0].tx_com->getCapacity()));
+    EmuTxCore<Rd53a>::setCom(channel, chip.tx_com.get());
+    EmuRxCore<Rd53a>::setCom(channel, chip.rx_com.get());
+  }
+
+  std::string emuCfgFile = emuCfg["feCfg"];
+  logger->info("Starting RD53a Emulator on channel {}", channel);
+  chip.emu.reset(new Rd53aEmu( chip.rx_com.get(), chip.tx_com.get(), emuCfgFile, channel ));
+  chip.thread = std::thread(&Rd53aEmu::executeLoop, chip.emu.get());
+}
+
 template<>
 void EmuController<Rd53a, Rd53aEmu>::loadConfig(json &j) {
 //    EmuTxCore::setCom(new EmuShm(j["tx"]["id"], j["tx"]["size"], true));
 //    EmuRxCore::setCom(new EmuShm(j["rx"]["id"], j["rx"]["size"], true));
 
-  auto tx = EmuTxCore<Rd53a>::getCom();
-  auto rx = EmuRxCore<Rd53a>::getCom();
-
   //TODO make nice
-  logger->info("Starting RD53a Emulator");
-  std::string emuCfgFile = j["feCfg"];
-  logger->info(" read {}", emuCfgFile);
-  emu.reset(new Rd53aEmu( rx_com.get(), tx_com.get(), emuCfgFile ));
-  emuThreads.push_back(std::thread(&Rd53aEmu::executeLoop, emu.get()));
+  emuCfg = j;
+  logger->info(" read {}", std::string(j["feCfg"]));
+  if (j.find("seed") != j.end()) {
+    uint64_t seed = j["seed"];
+    logger->info(" random seed {}", seed);
+    Gauss::setSeed(seed);
+  }
+  this->addChip(0);
 }
@@ -1,45 +1,60 @@
-#if 0
-
 // #################################
 // # Author: Timon Heim
 // # Email: timon.heim at cern.ch
 // # Project: Yarr
 // # Description: Emulator Receiver
-// # Comment:
+// # Comment: Channel encodings of the merged data
 // # Date: Jan 2017
 // ################################
 
 #include "EmuRxCore.h"
-#include <iostream>
-#include <unistd.h>
-#include <iterator>
-#include <iomanip>
-#include <algorithm>
-#include <chrono>
-#include <thread>
 
-#define HEXF(x,y) std::hex << "0x" << std::hex << std::setw(x) << std::setfill('0') << static_cast<int>(y) << std::dec
+#include "Fei4.h"
+#include "Rd53a.h"
+
+// FE-I4 records are 24 bit, the firmware puts the channel into the top 6 bits
+template<>
+RawData* EmuRxCore<Fei4>::readData() {
+    auto &data = this->drain();
+    uint32_t words = 0;
+    for (auto &d : data) words += d.size();
+    if (words == 0) return NULL;
 
-EmuRxCore::EmuRxCore(EmuCom *com) {
-    m_com = com;
+    uint32_t *buf = new uint32_t[words];
+    uint32_t *out = buf;
+    for (unsigned i=0; i<data.size(); i++) {
+        uint32_t channel = (m_enabled[i] & 0x3F) << 26;
+        for (uint32_t word : data[i]) {
+            *out++ = channel | (word & 0x03FFFFFF);
+        }
+    }
+    return new RawData(0x0, buf, words);
 }
 
-EmuRxCore::~EmuRxCore() {}
+// RD53A frames are 64 bit, the firmware sends one frame per enabled channel in
+// turn and fills the slots of channels without data with 0xFFFFFFFF
+template<>
+RawData* EmuRxCore<Rd53a>::readData() {
+    auto &data = this->drain();
+    size_t frames = 0;
+    for (auto &d : data) frames = std::max(frames, (d.size()+1)/2);
+    if (frames == 0) return NULL;
 
-RawData* EmuRxCore::readData() {
-    //std::this_thread::sleep_for(std::chrono::microseconds(1));
-    uint32_t words = this->getCurCount()/sizeof(uint32_t);
-    if (words > 0) {
-        uint32_t *buf = new uint32_t[words];
-        //for(unsigned i=0; i<words; i++)
-        //    buf[i] = m_com->read32();
-        if (m_com->readBlock32(buf, words)) {
-            return new RawData(0x0, buf, words);
-        } else {
-            delete[] buf;
+    // A single channel needs no slots
+    if (data.size() == 1) {
+        uint32_t *buf = new uint32_t[data[0].size()];
+        std::copy(data[0].begin(), data[0].end(), buf);
+        return new RawData(0x0, buf, data[0].size());
+    }
+
+    uint32_t words = frames*2*data.size();
+    uint32_t *buf = new uint32_t[words];
+    std::fill(buf, buf+words, 0xFFFFFFFF);
+    for (unsigned i=0; i<data.size(); i++) {
+        uint32_t *out = buf + 2*i;
+        for (size_t w=0; w<data[i].size(); w++) {
+            out[(w/2)*2*data.size() + (w%2)] = data[i][w];
         }
     }
-    return NULL;
+    return new RawData(0x0, buf, words);
 }
-
-#endif
@@ -16,23 +16,28 @@
 template<>
 void EmuTxCore<Fei4>::doTrigger() {
     for(unsigned i=0; i<m_trigCnt; i++) {
-        m_com->write32(0x1D000000 + i);
+        this->writeFifo(0x1D000000 + i);
     }
-    m_com->write32(0x0);
-    while(!m_com->isEmpty());
+    this->writeFifo(0x0);
+    while(!this->isCmdEmpty());
     trigProcRunning = false;
 }
 
 
 template<>
 void EmuTxCore<Rd53a>::doTrigger() {
+    // One block, so the emulator decodes the triggers in batches instead of
+    // being woken up for every word
+    std::vector<uint32_t> words;
+    words.reserve(m_trigCnt*trigLength + 1);
     for(unsigned i=0; i<m_trigCnt; i++) {
         for( uint32_t j =0; j<trigLength; j++) {
-            m_com->write32( trigWord[trigLength-j-1] );
+            words.push_back( trigWord[trigLength-j-1] );
         }
     }
-    m_com->write32(0x0);
-    while(!m_com->isEmpty());
+    words.push_back(0x0);
+    this->writeFifoBlock(words.data(), words.size());
+    while(!this->isCmdEmpty());
     trigProcRunning = false;
     //std::cout << __PRETTY_FUNCTION__ << ": doTrigger() is done." << std::endl;
 }
@@ -41,11 +46,11 @@ template<>
 void EmuTxCore<StarChips>::doTrigger() {
     for(unsigned i=0; i<m_trigCnt; i++) {
         for( uint32_t j =0; j<trigLength; j++) {
-            m_com->write32( trigWord[trigLength-j-1] );
+            this->writeFifo( trigWord[trigLength-j-1] );
         }
     }
 
-    while(!m_com->isEmpty());
+    while(!this->isCmdEmpty());
     trigProcRunning = false;
     //std::cout << __PRETTY_FUNCTION__ << ": doTrigger() is done." << std::endl;
 }
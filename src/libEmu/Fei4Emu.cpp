@@ -7,6 +7,8 @@
 
 #include "Fei4Emu.h"
 #include <algorithm>
+#include <chrono>
+#include <thread>
 
 #include "logging.h"
 
@@ -16,12 +18,15 @@ using namespace Gauss;
 
 namespace {
     auto flog = logging::make_log("emu_fei4");
+
+    // Threshold is the smeared Vthin lowered by 30 per TDAC step, ToT code 0 is no hit
+    const PixelArray::Response fei4Response { 0, 1, 0, -30, 1, 9.0/16000.0, 16, 0 };
 }
 
 Fei4Emu::Fei4Emu(std::string output_model_cfg, std::string input_model_cfg,
-                 EmuCom * rx, EmuCom * tx) {
-    srand(time(NULL));
-
+                 EmuCom * rx, EmuCom * tx, uint32_t channel)
+    : m_pixels(80, 336), m_injectablesValid(false), m_physicsHits(0),
+      m_gen(streamSeed(channel)) {
     m_feId = 0x00;
     m_l1IdCnt = 0x00;
     m_bcIdCnt = 0x00;
@@ -39,11 +44,6 @@ Fei4Emu::Fei4Emu(std::string output_model_cfg, std::string input_model_cfg,
 }
 
 Fei4Emu::~Fei4Emu() {
-    for (unsigned col = 1; col <= m_feCfg->n_Col; col++) {
-        for (unsigned row = 1; row <= m_feCfg->n_Row; row++) {
-            delete(m_pixelModelObjects[col - 1][row - 1]);
-        }
-    }
 }
 
 void Fei4Emu::initializePixelModelsFromFile(std::string json_file_path) {
@@ -53,17 +53,9 @@ void Fei4Emu::initializePixelModelsFromFile(std::string json_file_path) {
 
     for (unsigned col = 1; col <= m_feCfg->n_Col; col++) {
         for (unsigned row = 1; row <= m_feCfg->n_Row; row++) {
+            // only the smeared values enter the response
             size_t index = (col - 1) * m_feCfg->n_Row + (row - 1);
-            m_pixelModelObjects[col - 1][row - 1] = new PixelModel
-              (j["Vthin_mean_vector"][index],
-               j["Vthin_sigma_vector"][index],
-               j["Vthin_gauss_vector"][index],
-               j["TDACVbp_mean_vector"][index],
-               j["TDACVbp_sigma_vector"][index],
-               j["TDACVbp_gauss_vector"][index],
-               j["noise_sigma_mean_vector"][index],
-               j["noise_sigma_sigma_vector"][index],
-               j["noise_sigma_gauss_vector"][index]);
+            m_pixels.setPixel(col - 1, row - 1, j["Vthin_gauss_vector"][index], j["noise_sigma_gauss_vector"][index]);
         }
     }
 
@@ -72,6 +64,10 @@ void Fei4Emu::initializePixelModelsFromFile(std::string json_file_path) {
 
 void Fei4Emu::executeLoop() {
     flog->info("Starting emulator loop");
+
+    // Only bounds how late a stop request is seen
+    static const auto WAIT_TIME = std::chrono::milliseconds(10);
+
     while (run)
     {
         uint32_t command;
@@ -136,12 +132,20 @@ void Fei4Emu::executeLoop() {
                     fprintf(stderr, "ERROR - unknown type recieved, %x\n", type);
                     break;
             }
+
+            this->flushOutput();
+        } else {
+            // leave the core to the other emulated chips
+            m_txRingBuffer->waitForData(WAIT_TIME);
         }
     }
 }
 
 // functions for handling the recieved commands
 void Fei4Emu::handleGlobalPulse(uint32_t chipid) {
+    // pixel registers may be latched
+    m_injectablesValid = false;
+
     // ignore if we get a ReadErrorReq
     if (m_feCfg->getValue(&Fei4Cfg::ReadErrorReq) == 1) {
     }
@@ -269,6 +273,7 @@ void Fei4Emu::handleRunMode(uint32_t chipid, int command) {
 void Fei4Emu::handleWrRegister(uint32_t chipid, uint32_t address, uint32_t value) {
     // write value to address in the Global Register (of FE chipid - ignoring this part for now)
     m_feCfg->cfg[address] = value;
+    m_injectablesValid = false;
 }
 
 void Fei4Emu::handleWrFrontEnd(uint32_t chipid, uint32_t bitstream[21]) {
@@ -301,8 +306,8 @@ void Fei4Emu::handleWrFrontEnd(uint32_t chipid, uint32_t bitstream[21]) {
     }
 }
 
-void Fei4Emu::handleTrigger() {
-    this->addDataHeader(false);    // no error flags
+void Fei4Emu::updateInjectables() {
+    m_injectables.clear();
 
     // use Fei4Cfg::Colpr_Mode to determine which dc to loop over
     unsigned dc_step = 40;
@@ -321,50 +326,71 @@ void Fei4Emu::handleTrigger() {
             break;
     }
 
+    float vthin = m_feCfg->getValue(&Fei4Cfg::Vthin_Fine) + 128.0*m_feCfg->getValue(&Fei4Cfg::Vthin_Coarse);
+
     // loop through the 40 double columns
     for (unsigned i = 0; i < 40 / dc_step; i++) {
         unsigned dc = m_feCfg->getValue(&Fei4Cfg::Colpr_Addr) + dc_step * i % 40;
 
         for (unsigned row = 1; row <= m_feCfg->n_Row; row++) {
             for (int c = 0; c <= 1; c++) {
-                if (m_feCfg->getEn(dc * 2 + 1 + c, row)) {
+                unsigned col = dc * 2 + 1 + c;
+                if (m_feCfg->getEn(col, row)) {
                     // the injection charge is well defined
-                    float injection_charge = m_feCfg->toCharge(m_feCfg->getValue(&Fei4Cfg::PlsrDAC), m_feCfg->getSCap(dc * 2 + 1 + c, row), m_feCfg->getLCap(dc * 2 + 1 + c, row));
-                    // the threshold charge requires quite some modeling
-                    float threshold_charge = m_pixelModelObjects[dc * 2 + 1 + c - 1][row - 1]->calculateThreshold(m_feCfg->getValue(&Fei4Cfg::Vthin_Fine), m_feCfg->getValue(&Fei4Cfg::Vthin_Coarse), m_feCfg->getTDAC(dc * 2 + 1 + c, row));
-                    // the noise charge requires simple modeling
-                    float noise_charge = m_pixelModelObjects[dc * 2 + 1 + c - 1][row - 1]->calculateNoise();
+                    float injection_charge = m_feCfg->toCharge(m_feCfg->getValue(&Fei4Cfg::PlsrDAC), m_feCfg->getSCap(col, row), m_feCfg->getLCap(col, row));
+                    m_pixels.select(m_injectables, fei4Response, col - 1, row - 1, vthin, m_feCfg->getTDAC(col, row), injection_charge);
+                }
+            }
+        }
+    }
+}
 
-                    uint32_t digital_tot = 0;
-                    uint32_t analog_tot = 0;
+void Fei4Emu::handleTrigger() {
+    this->addDataHeader(false);    // no error flags
 
-                    if (m_feCfg->getValue(&Fei4Cfg::DigHitIn_Sel)) {               // check if we are doing a digital hit
-                        digital_tot = 10;
-                    }
-                    else if (injection_charge + noise_charge > threshold_charge) {       // check if we are doing an analog hit
-                        analog_tot = m_pixelModelObjects[dc * 2 + 1 + c - 1][row - 1]->calculateToT(injection_charge + noise_charge - threshold_charge);
-                    }
+    // the enabled pixels only change with the configuration
+    if (!m_injectablesValid) {
+        this->updateInjectables();
+        m_injectablesValid = true;
+    }
 
-                    if (digital_tot && analog_tot) {
-                        fprintf(stderr, "ERROR - doing both a digital and an analog hit, this should not happen!\n");
-                    }
+    m_tots.resize(m_injectables.size());
+    if (m_feCfg->getValue(&Fei4Cfg::DigHitIn_Sel)) {               // check if we are doing a digital hit
+        std::fill(m_tots.begin(), m_tots.end(), 10);
+    } else {
+        PixelArray::respond(fei4Response, m_injectables, m_tots.data(), m_gen);
+    }
 
-                    if (digital_tot >= analog_tot) {
-                        this->addHit(dc * 2 + 1 + c, row, digital_tot, 0);
-                    }
-                    if (analog_tot > digital_tot) {
-                        this->addHit(dc * 2 + 1 + c, row, analog_tot, 0);
-                    }
-                }
-            }
-        }
+    // same records as addHit, with the ToT codes looked up once per trigger
+    uint8_t totCode[17];
+    for (uint8_t tot = 0; tot <= 16; tot++) {
+        totCode[tot] = this->getToTCode(tot);
+    }
+    uint32_t noTot2 = totCode[0] & 0xF;
+
+    size_t first = m_outBuffer.size();
+    m_outBuffer.resize(first + m_injectables.size());
+    uint32_t *out = &m_outBuffer[first];
+    for (unsigned i = 0; i < m_injectables.size(); i++) {
+        uint32_t pixel = m_injectables.pixels[i];
+        uint32_t col = m_pixels.col(pixel) + 1;
+        uint32_t row = m_pixels.row(pixel) + 1;
+        uint8_t tot = std::min<uint8_t>(m_tots[i], 16);
+        out[i] = (m_feId << 24) | ((col&0x7F) << 17) | ((row&0x1FF) << 8) | ((totCode[tot]&0xF) << 4) | noTot2;
     }
+
+    this->addPhysicsHits();
 }
 
 void Fei4Emu::pushOutput(uint32_t value) {
-    if (m_rxRingBuffer) {
-        m_rxRingBuffer->write32(value);
+    m_outBuffer.push_back(value);
+}
+
+void Fei4Emu::flushOutput() {
+    if (m_rxRingBuffer && !m_outBuffer.empty()) {
+        m_rxRingBuffer->writeBlock32(m_outBuffer.data(), m_outBuffer.size());
     }
+    m_outBuffer.clear();
 }
 
 // Assuming that first command byte is 0x01 (e.g. triger command is 0x1d0)
@@ -407,13 +433,23 @@ void Fei4Emu::addRandomHits(uint32_t nHits) {
   addDataHeader(false);
   addServiceRecord(true); // True because we can insert SRs [14-16] here
   while(nHits-- > 0) {
-    addDataRecord( rand() % m_feGeo.nCol, rand() % m_feGeo.nRow, rand() % 0xF, rand() % 0xF);
+    addDataRecord( m_gen.next() % m_feGeo.nCol, m_gen.next() % m_feGeo.nRow, m_gen.next() % 0xF, m_gen.next() % 0xF);
   }
   addServiceRecord(false);
   endFrame();
 }
 
 void Fei4Emu::addPhysicsHits() {
+  if (m_physicsHits <= 0) return;
+
+  unsigned nHits = m_gen.poisson(m_physicsHits);
+  while(nHits-- > 0) {
+    unsigned col = 1 + m_gen.next() % m_feGeo.nCol;
+    unsigned row = 1 + m_gen.next() % m_feGeo.nRow;
+    // masked pixels do not send hits
+    if (!m_feCfg->getEn(col, row)) continue;
+    addHit(col, row, 1 + m_gen.next() % 14, 0);
+  }
 }
 
 void Fei4Emu::addHit(uint16_t col, uint16_t row, uint8_t tot1, uint8_t tot2) {
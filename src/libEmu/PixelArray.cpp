@@ -0,0 +1,60 @@
+#include "PixelArray.h"
+
+#include <algorithm>
+
+namespace {
+    // Noise of one batch stays in L1
+    const unsigned batchSize = 256;
+}
+
+void PixelArray::Selection::clear() {
+    pixels.clear();
+    threshold.clear();
+    noise.clear();
+    charge.clear();
+}
+
+PixelArray::PixelArray(unsigned nCol, unsigned nRow)
+    : m_nRow(nRow), m_vthGain(nCol*nRow, 0), m_noiseSigma(nCol*nRow, 0) {
+}
+
+void PixelArray::setPixel(unsigned col, unsigned row, float vthGain, float noiseSigma) {
+    m_vthGain[this->index(col, row)] = vthGain;
+    m_noiseSigma[this->index(col, row)] = noiseSigma;
+}
+
+float PixelArray::threshold(const Response &resp, unsigned col, unsigned row, float vth, int tdac) const {
+    float smeared = m_vthGain[this->index(col, row)]*vth + resp.tdacStep*(tdac - resp.tdacCenter);
+    if (smeared < 0) smeared = 0;
+    return resp.thrOffset + resp.thrSlope*smeared;
+}
+
+void PixelArray::select(Selection &sel, const Response &resp, unsigned col, unsigned row,
+                        float vth, int tdac, float charge) const {
+    sel.pixels.push_back(this->index(col, row));
+    sel.threshold.push_back(this->threshold(resp, col, row, vth, tdac));
+    sel.noise.push_back(m_noiseSigma[this->index(col, row)]);
+    sel.charge.push_back(charge);
+}
+
+void PixelArray::respond(const Response &resp, const Selection &sel, uint8_t *tot,
+                         Gauss::Generator &gen) {
+    float normal[batchSize];
+
+    const float totMax = resp.totMax;
+    for (unsigned first = 0; first < sel.size(); first += batchSize) {
+        unsigned n = std::min(batchSize, sel.size() - first);
+        gen.fillNormal(normal, n, 0.f, 1.f);
+
+        const float *threshold = &sel.threshold[first];
+        const float *noise = &sel.noise[first];
+        const float *charge = &sel.charge[first];
+        uint8_t *out = tot + first;
+        for (unsigned i=0; i<n; i++) {
+            float signal = charge[i] + noise[i]*normal[i] - threshold[i];
+            float t = std::min(resp.totOffset + resp.totGain*signal, totMax);
+            int32_t code = t;
+            out[i] = (signal > 0) ? code : resp.noHit;
+        }
+    }
+}
@@ -6,147 +6,196 @@
 
 #include "RingBuffer.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <thread>
+
+namespace {
+    // Spin briefly for the other side, then give up the time slice
+    void backoff(unsigned &spins) {
+        if (++spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
 
 RingBuffer::RingBuffer(uint32_t size)
 {
-    ringbuffer_size = size;
-    element_size = sizeof(uint32_t);
+    capacity = 1;
+    while (capacity < size)
+    {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
 
-    buffer = (uint32_t *) malloc(ringbuffer_size * element_size);
+    buffer.reset(new uint32_t[capacity]);
 
-    read_index = 0;
     write_index = 0;
-
-//    sem_init(&read_sem, 0, 0);
-//    sem_init(&write_sem, 0, ringbuffer_size / element_size - 2);
+    read_index = 0;
+    cached_read_index = 0;
+    cached_write_index = 0;
+    consumer_waiting = false;
 }
 
 RingBuffer::~RingBuffer()
 {
-    free(buffer);
 }
 
-void RingBuffer::write32(uint32_t word)
+// Producer side, only looks at the consumer's index if the last view is short
+uint32_t RingBuffer::freeWords(uint32_t wanted)
 {
-    // wait if the write index would catch up to the read index
-    std::unique_lock<std::mutex> lk(mtx);
-    cv.wait(lk, [&] { return ((write_index + element_size >= ringbuffer_size) ? 0 : write_index + element_size) != read_index; });
+    uint64_t w = write_index.load(std::memory_order_relaxed);
+    if (capacity - (w - cached_read_index) < wanted)
+    {
+        cached_read_index = read_index.load(std::memory_order_acquire);
+    }
+    return capacity - (w - cached_read_index);
+}
 
-//    sem_wait(&write_sem);
+// Consumer side, same for the producer's index
+uint32_t RingBuffer::usedWords(uint32_t wanted)
+{
+    uint64_t r = read_index.load(std::memory_order_relaxed);
+    if (cached_write_index - r < wanted)
+    {
+        cached_write_index = write_index.load(std::memory_order_acquire);
+    }
+    return cached_write_index - r;
+}
 
-    // do the write
-    memcpy(&buffer[write_index], &word, element_size);
+void RingBuffer::copyIn(uint64_t pos, const uint32_t *buf, uint32_t length)
+{
+    uint32_t start = pos & mask;
+    uint32_t first = std::min(length, capacity - start);
+    memcpy(&buffer[start], buf, first * sizeof(uint32_t));
+    memcpy(&buffer[0], buf + first, (length - first) * sizeof(uint32_t));
+}
 
-    // update the write pointer
-    write_index += element_size;
+void RingBuffer::copyOut(uint64_t pos, uint32_t *buf, uint32_t length)
+{
+    uint32_t start = pos & mask;
+    uint32_t first = std::min(length, capacity - start);
+    memcpy(buf, &buffer[start], first * sizeof(uint32_t));
+    memcpy(buf + first, &buffer[0], (length - first) * sizeof(uint32_t));
+}
 
-    // check if the write_index must wrap
-    if (write_index >= ringbuffer_size)
+uint32_t RingBuffer::tryWriteBlock32(const uint32_t *buf, uint32_t length)
+{
+    uint32_t n = std::min(length, this->freeWords(length));
+    if (n == 0)
     {
-        write_index = 0;
+        return 0;
+    }
+    uint64_t w = write_index.load(std::memory_order_relaxed);
+    this->copyIn(w, buf, n);
+    write_index.store(w + n, std::memory_order_release);
+    // Pairs with the fence in waitForData, either the consumer sees the new
+    // index or it is seen waiting here
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumer_waiting.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex);
+        data_cv.notify_one();
     }
+    return n;
+}
 
-    // notify the cv that a read/write has occured
-    cv.notify_all();
+uint32_t RingBuffer::tryReadBlock32(uint32_t *buf, uint32_t length)
+{
+    uint32_t n = std::min(length, this->usedWords(length));
+    if (n == 0)
+    {
+        return 0;
+    }
+    uint64_t r = read_index.load(std::memory_order_relaxed);
+    this->copyOut(r, buf, n);
+    read_index.store(r + n, std::memory_order_release);
+    return n;
+}
 
-//    sem_post(&read_sem);
+void RingBuffer::write32(uint32_t word)
+{
+    this->writeBlock32(&word, 1);
+}
+
+void RingBuffer::writeBlock32(const uint32_t *buf, uint32_t length)
+{
+    unsigned spins = 0;
+    while (length > 0)
+    {
+        uint32_t n = this->tryWriteBlock32(buf, length);
+        if (n == 0)
+        {
+            backoff(spins);
+            continue;
+        }
+        spins = 0;
+        buf += n;
+        length -= n;
+    }
 }
 
 uint32_t RingBuffer::read32()
 {
     uint32_t word;
-
-    // wait if the read pointer has caught up to the write pointer
-    std::unique_lock<std::mutex> lk(mtx);
-    cv.wait(lk, [&] { return read_index != write_index; });
-
-//    sem_wait(&read_sem);
-
-    // do the read
-    memcpy(&word, &buffer[read_index], element_size);
-
-    // update the read pointer
-    read_index += element_size;
-
-    // check if the read_index must wrap
-    if (read_index >= ringbuffer_size)
+    unsigned spins = 0;
+    while (this->tryReadBlock32(&word, 1) == 0)
     {
-        read_index = 0;
+        backoff(spins);
     }
-
-    // notify the cv that a read/write has occured
-    cv.notify_all();
-
-//    sem_post(&write_sem);
-
     return word;
 }
 
 uint32_t RingBuffer::readBlock32(uint32_t* buf, uint32_t length)
 {
-    if ((length * element_size) > this->getCurSize()) {
+    uint32_t available = this->usedWords(length);
+    if (length > available)
+    {
         std::cerr << __PRETTY_FUNCTION__
-            << " -> ERROR : not enough data in buffer! This should not be possible! Requested: "
-            << length * element_size << ", actual: " << this->getCurSize() << std::endl;
+            << " -> ERROR : not enough data in buffer! Requested: "
+            << length << " words, actual: " << available << std::endl;
         return 0;
     }
-
-for (uint32_t i = 0; i < length; i++) buf[i] = this->read32();
-
-return 1;
-
-    //
-    // 0 1 2 3 4 5 6 7
-    //     w     r | |
-    if (read_index + (length * element_size) >= ringbuffer_size) {
-        //split transfer
-        // length of first part
-
-        uint32_t length_p1 = ringbuffer_size - read_index;
-        uint32_t length_p2 = length * element_size - length_p1;
-        memcpy(&buf[0], &buffer[read_index], length_p1);
-        memcpy(&buf[(length_p1) / element_size], &buffer[0], length_p2);
-    } else {
-        //one transfer
-        memcpy(&buf[0], &buffer[read_index], element_size * length);
-    }
-    // update the read pointer
-
-    read_index += element_size * length;
-
-    // check if the read_index must wrap
-    if (read_index >= ringbuffer_size)
-    {
-        read_index = read_index - (ringbuffer_size - element_size) - element_size;
-    }
-
-//    for (uint32_t i = 0; i < length; i++) { sem_post(&write_sem); }
-
-    // notify the cv that a read/write has occured
-    cv.notify_all();
-
+    this->tryReadBlock32(buf, length);
     return 1;
 }
 
-bool RingBuffer::isEmpty()
+bool RingBuffer::waitForData(std::chrono::microseconds timeout)
 {
-    if (write_index == read_index)
+    if (!this->isEmpty())
     {
         return true;
     }
-    return false;
+    std::unique_lock<std::mutex> lock(wait_mutex);
+    consumer_waiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool ready = data_cv.wait_for(lock, timeout, [this] { return !this->isEmpty(); });
+    consumer_waiting.store(false, std::memory_order_relaxed);
+    return ready;
 }
 
-uint32_t RingBuffer::getCurSize() {
-    return ((write_index - read_index) + (ringbuffer_size)) % (ringbuffer_size);
+// Either side
+bool RingBuffer::isEmpty()
+{
+    return write_index.load(std::memory_order_acquire) == read_index.load(std::memory_order_acquire);
+}
+
+uint32_t RingBuffer::getCurSize()
+{
+    uint64_t r = read_index.load(std::memory_order_acquire);
+    uint64_t w = write_index.load(std::memory_order_acquire);
+    return (w - r) * sizeof(uint32_t);
 }
 
 void RingBuffer::dump()
 {
-    for (uint32_t i = 0; i < ringbuffer_size / element_size; i++)
+    for (uint32_t i = 0; i < capacity; i++)
     {
-        std::cout << "[" << i << "]\t\t0x" << std::hex << (uint32_t) *((uint32_t*) &buffer[i * element_size]) << std::dec << std::endl;
+        std::cout << "[" << i << "]\t\t0x" << std::hex << buffer[i] << std::dec << std::endl;
     }
 }
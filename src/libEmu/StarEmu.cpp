@@ -3,11 +3,14 @@
 #include <chrono>
 #include <iomanip>
 #include <fstream>
+#include <map>
+#include <stdexcept>
 #include <thread>
 
 #include "AllHwControllers.h"
 #include "EmuCom.h"
 #include "EmuRxCore.h"
+#include "Gauss.h"
 #include "LCBUtils.h"
 #include "RingBuffer.h"
 
@@ -35,15 +38,102 @@ std::ostream &operator <<(std::ostream &os, print_hex_type<T> v) {
 }
 
 auto logger = logging::make_log("StarEmu");
+
+/// What an LCB frame carries
+enum class LCBKind : uint8_t { Other, L0A, RegData, K2, Fast };
+
+/// Kind of a frame with its decoded 12-bit data (6-bit after a kcode)
+struct LCBEntry {
+  LCBKind kind;
+  uint16_t data;
+};
+
+/// Decoding of all 16-bit frames, built on first use
+const std::vector<LCBEntry> &lcbTable() {
+  static const std::vector<LCBEntry> table = [] {
+    std::vector<LCBEntry> t(0x10000, LCBEntry{LCBKind::Other, 0});
+    for (unsigned frame = 0; frame < t.size(); ++frame) {
+      uint8_t code0 = (frame >> 8) & 0xff;
+      uint8_t code1 = frame & 0xff;
+
+      if (not (SixEight::is_kcode(code0) or SixEight::is_kcode(code1))) {
+        // Neither of the 8-bit symbol is a kcode
+        uint16_t data12 = (SixEight::decode(code0) << 6) | SixEight::decode(code1);
+        t[frame] = {((data12 >> 7) & 0x1f) ? LCBKind::L0A : LCBKind::RegData, data12};
+      } else if (code0 == LCB::K3) {
+        t[frame] = {LCBKind::Fast, SixEight::decode(code1)};
+      } else if (code0 == LCB::K2) {
+        t[frame] = {LCBKind::K2, SixEight::decode(code1)};
+      }
+    }
+    return t;
+  }();
+  return table;
+}
+
+/// Even bits of a 32-bit word packed into 16 bits
+inline uint32_t evenBits(uint32_t x) {
+  x &= 0x55555555;
+  x = (x | (x >> 1)) & 0x33333333;
+  x = (x | (x >> 2)) & 0x0f0f0f0f;
+  x = (x | (x >> 4)) & 0x00ff00ff;
+  x = (x | (x >> 8)) & 0x0000ffff;
+  return x;
+}
+
+/// Lower bit pair of each nibble of a 32-bit word packed into 16 bits
+inline uint32_t lowPairs(uint32_t x) {
+  x &= 0x33333333;
+  x = (x | (x >> 2)) & 0x0f0f0f0f;
+  x = (x | (x >> 4)) & 0x00ff00ff;
+  x = (x | (x >> 8)) & 0x0000ffff;
+  return x;
+}
+
+/// Strips of one ABCStar from four 64-bit words, strip 0 in the lowest bit
+template<size_t N>
+std::bitset<N> fromWords(const uint64_t (&w)[4]) {
+  return (std::bitset<N>(w[3]) << 192) | (std::bitset<N>(w[2]) << 128) |
+         (std::bitset<N>(w[1]) << 64) | std::bitset<N>(w[0]);
+}
+
+/// 64-bit word i of the strips
+template<size_t N>
+uint64_t toWord(const std::bitset<N> &bits, unsigned i) {
+  static const std::bitset<N> selector(0xffffffffffffffffULL);
+  return ((bits >> (64*i)) & selector).to_ullong();
+}
+
+/// One row of 128 strips
+__extension__ typedef unsigned __int128 StripRow;
+
+/// Strip pattern of the three strips after a hit, first one in the top bit
+constexpr uint8_t nextThreeStrips[8] = {0, 4, 2, 6, 1, 5, 3, 7};
+
+/// Cluster of the lowest strip hit in a row that has hits, which are then
+/// removed from the row together with the next three strips
+inline uint16_t takeCluster(StripRow &row, bool isSecondRow) {
+  uint64_t low = (uint64_t)row;
+  unsigned hit_addr = low ? __builtin_ctzll(low)
+                          : 64 + __builtin_ctzll((uint64_t)(row >> 64));
+
+  uint8_t hitpat_next3 = hit_addr < 127 ? nextThreeStrips[(unsigned)(row >> (hit_addr+1)) & 7] : 0;
+  row &= ~((StripRow)0xf << hit_addr);
+
+  hit_addr += isSecondRow<<7;
+  // the lowest bit of any valid cluster is 0
+  return hit_addr << 3 | hitpat_next3;
+}
 }
 
 StarEmu::StarEmu(ClipBoard<RawData> &rx, EmuCom * tx, std::string json_file_path,
-    unsigned hpr_period)
+    unsigned hpr_period, unsigned hccID, const std::vector<unsigned> &abcIDs)
     : m_txRingBuffer ( tx )
     , m_rxQueue ( rx )
     , m_bccnt( 0 )
     , m_starCfg( new StarCfg )
     , HPRPERIOD( hpr_period )
+    , m_gen( Gauss::streamSeed( hccID ) )
 {
     run = true;
 
@@ -68,16 +158,10 @@ StarEmu::StarEmu(ClipBoard<RawData> &rx, EmuCom * tx, std::string json_file_path
     m_bc_sel = 0;
     
     // HCCStar and ABCStar configurations
-    // TODO: should get these from chip config json file
-    // m_starCfg->fromFileJson(j_starCfg);
-    // for now
-    m_starCfg->setHCCChipId(15);
-    m_starCfg->addABCchipID(15);
-    /*
-    for (size_t id_abc = 1; id_abc < 9; id_abc++) {
-        m_starCfg->addABCchipID(id_abc);
+    m_starCfg->setHCCChipId(hccID);
+    for (unsigned abcID : abcIDs) {
+        m_starCfg->addABCchipID(abcID);
     }
-    */
 
     hpr_clkcnt = HPRPERIOD/2; // 20000 BCs or 500 us
     hpr_sent.resize(m_starCfg->numABCs() + 1); // 1 HCCStar + nABCs ABCStar chips
@@ -224,43 +308,27 @@ void StarEmu::DecodeLCB(LCB::Frame frame) {
     // HPR
     doHPR(frame);
 
-    // {code0, code1}
-    uint8_t code0 = (frame >> 8) & 0xff;
-    uint8_t code1 = frame & 0xff;
-
-    bool iskcode0 = SixEight::is_kcode(code0);
-    bool iskcode1 = SixEight::is_kcode(code1);
-
-    if (not (iskcode0 or iskcode1) ) {
-        // Neither of the 8-bit symbol is a kcode
-        // Decode the 16-bit frame to the 12-bit data
-        uint16_t data12 = (SixEight::decode(code0) << 6) | SixEight::decode(code1);
-        
-        if ( (data12 >> 7) & 0x1f ) {
-            // Top 5 bits are not zeros: has a BCR and/or triggers
-            doL0A(data12);
-        }
-        else {
-            // Top 5 bits are all zeros: part of a command sequence
-            doRegReadWrite(frame);
-        }
+    const LCBEntry &entry = lcbTable()[frame];
+    switch (entry.kind) {
+    case LCBKind::L0A:
+        // Top 5 bits are not zeros: has a BCR and/or triggers
+        doL0A(entry.data);
+        break;
+    case LCBKind::RegData:
+        // Top 5 bits are all zeros: part of a command sequence
+        doRegData(entry.data);
+        break;
+    case LCBKind::K2:
+        // Start or end of a command sequence
+        doRegStartEnd(entry.data);
+        break;
+    case LCBKind::Fast:
+        doFastCommand(entry.data);
+        break;
+    case LCBKind::Other:
+        // Idle or other kcodes, do nothing
+        break;
     }
-    else {
-        // Kcode detected
-        if (code0 == LCB::K3) { // Fast command
-            // decode the second symbol
-            uint8_t k3cmd = SixEight::decode(code1);
-            doFastCommand(k3cmd);
-        }
-        else if (code0 == LCB::K2) { // Start or end of a command sequence
-
-            doRegReadWrite(frame);
-        }
-        else if (frame == LCB::IDLE) { // Idle
-            SPDLOG_LOGGER_TRACE(logger, "Receive an IDLE");
-            // do nothing
-        }
-    } // if (not (iskcode0 or iskcode1) )
 
     // Increment BC counter
     m_bccnt += 4;
@@ -269,60 +337,54 @@ void StarEmu::DecodeLCB(LCB::Frame frame) {
 //
 // Register commands
 //
-void StarEmu::doRegReadWrite(LCB::Frame frame) {
-    uint8_t code0 = (frame >> 8) & 0xff;
-    uint8_t code1 = frame & 0xff;
+void StarEmu::doRegStartEnd(uint8_t data6) {
+    SPDLOG_LOGGER_TRACE(logger, "Receive a K2 frame -> data = 0x{:x}", data6);
 
-    SPDLOG_LOGGER_TRACE(logger, "Receive a register command -> symbol1 = 0x{:x}, symbol2 = 0x{:x}", code0, code1);
+    bool isK2Start = (data6 >> 4) & 1; // Otherwise it is a K2 End
+    unsigned cmd_hccID = data6 & 0xf; // Bottom 4 bits for HCC ID
+    // Ignore the command sequence unless the HCC ID matches the ID on chip
+    // or it is a broadcast command (0b1111)
+    m_ignoreCmd = not ( cmd_hccID == (m_starCfg->getHCCchipID() & 0xf) or cmd_hccID == 0xf);
 
-    if (code0 == LCB::K2) { // This frame is a K2 Start or K2 End
+    if (m_ignoreCmd) return;
 
-        // Decode the second symbol
-        uint8_t data6 = SixEight::decode(code1);
-        bool isK2Start = (data6 >> 4) & 1; // Otherwise it is a K2 End
-        unsigned cmd_hccID = data6 & 0xf; // Bottom 4 bits for HCC ID
-        // Ignore the command sequence unless the HCC ID matches the ID on chip
-        // or it is a broadcast command (0b1111)
-        m_ignoreCmd = not ( cmd_hccID == (m_starCfg->getHCCchipID() & 0xf) or cmd_hccID == 0xf);
+    if (isK2Start) {
+        m_isForABC = (data6 >> 5) & 1; // Otherwise it is a HCC command
 
-        if (m_ignoreCmd) return;
-        
-        if (isK2Start) {
-            m_isForABC = (data6 >> 5) & 1; // Otherwise it is a HCC command
-
-            // Clear the command buffer if it is not empty
-            // (in case a second K2 Start is received before a K2 End)
-            if (not m_reg_cmd_buffer.empty()) {
-                std::queue<uint8_t> empty_buffer;
-                std::swap(m_reg_cmd_buffer, empty_buffer);
-            }
+        // Clear the command buffer if it is not empty
+        // (in case a second K2 Start is received before a K2 End)
+        if (not m_reg_cmd_buffer.empty()) {
+            std::queue<uint8_t> empty_buffer;
+            std::swap(m_reg_cmd_buffer, empty_buffer);
         }
-        else { // K2 End
-            size_t bufsize = m_reg_cmd_buffer.size();
-            if ( not (bufsize==2 or bufsize==7) ) {
-                // If K2 End occurs at the wrong stage, no action is taken.
-                logger->warn("K2 End received at the wrong position! Current command sequence size (excluding K2 frames): {}", m_reg_cmd_buffer.size());
-                return;
-            }
-
-            execute_command_sequence();
-        } // if (isK2Start)
-    } else { // not K2 Start or End
-        if (m_ignoreCmd) return;
-        
-        // Decode the frame
-        uint16_t data12 = (SixEight::decode(code0) << 6) | (SixEight::decode(code1));
-        // Top 5 bits should be zeros
-        assert(not (data12>>7));
-        // Store the lowest 7 bits into the buffer.
-        m_reg_cmd_buffer.push(data12 & 0x7f);
     }
+    else { // K2 End
+        size_t bufsize = m_reg_cmd_buffer.size();
+        if ( not (bufsize==2 or bufsize==7) ) {
+            // If K2 End occurs at the wrong stage, no action is taken.
+            logger->warn("K2 End received at the wrong position! Current command sequence size (excluding K2 frames): {}", m_reg_cmd_buffer.size());
+            return;
+        }
+
+        execute_command_sequence();
+    } // if (isK2Start)
+}
+
+void StarEmu::doRegData(uint16_t data12) {
+    if (m_ignoreCmd) return;
+
+    // Top 5 bits are zeros, store the lowest 7 bits into the buffer.
+    m_reg_cmd_buffer.push(data12 & 0x7f);
 }
 
 void StarEmu::writeRegister(const uint32_t data, const uint8_t address,
                             bool isABC, const unsigned ABCID)
 {
     if (isABC) {
+        if (m_starCfg->hccChannelForABCchipID(ABCID) >= m_starCfg->numABCs()) {
+            logger->warn("Cannot find an ABCStar chip with ID = {}", ABCID);
+            return;
+        }
         m_starCfg->setABCRegister(address, data, ABCID);
     }
     else {
@@ -496,16 +558,16 @@ void StarEmu::logicReset()
     m_bccnt = 0;
     hpr_clkcnt = HPRPERIOD/2;
     std::fill(hpr_sent.begin(), hpr_sent.end(), false);
-    m_starCfg->setSubRegisterValue(0, "TESTHPR", 0);
-    m_starCfg->setSubRegisterValue(0, "STOPHPR", 0);
-    m_starCfg->setSubRegisterValue(0, "MASKHPR", 0);
+    m_starCfg->setSubRegisterValue(HCCStarSubRegister::TESTHPR, 0);
+    m_starCfg->setSubRegisterValue(HCCStarSubRegister::STOPHPR, 0);
+    m_starCfg->setSubRegisterValue(HCCStarSubRegister::MASKHPR, 0);
     
     for (unsigned ichip = 1; ichip <= m_starCfg->numABCs(); ++ichip) {
         clearFEData(ichip);
 
-        m_starCfg->setSubRegisterValue(ichip, "TESTHPR", 0);
-        m_starCfg->setSubRegisterValue(ichip, "STOPHPR", 0);
-        m_starCfg->setSubRegisterValue(ichip, "MASKHPR", 0);
+        m_starCfg->setSubRegisterValue(ichip, ABCStarSubRegister::TESTHPR, 0);
+        m_starCfg->setSubRegisterValue(ichip, ABCStarSubRegister::STOPHPR, 0);
+        m_starCfg->setSubRegisterValue(ichip, ABCStarSubRegister::MASKHPR, 0);
     }
 }
 
@@ -663,9 +725,9 @@ void StarEmu::doHPR_HCC(LCB::Frame frame)
     setHCCStarHPR(frame);
 
     //// HPR control logic
-    bool testHPR = m_starCfg->getSubRegisterValue(0, "TESTHPR");
-    bool stopHPR = m_starCfg->getSubRegisterValue(0, "STOPHPR");
-    bool maskHPR = m_starCfg->getSubRegisterValue(0, "MASKHPR");
+    bool testHPR = m_starCfg->getSubRegisterValue(HCCStarSubRegister::TESTHPR);
+    bool stopHPR = m_starCfg->getSubRegisterValue(HCCStarSubRegister::STOPHPR);
+    bool maskHPR = m_starCfg->getSubRegisterValue(HCCStarSubRegister::MASKHPR);
 
     // Assume for now in the software emulation LCB is always locked and only
     // testHPR bit can trigger the one-time pulse to send an HPR packet
@@ -697,11 +759,11 @@ void StarEmu::doHPR_HCC(LCB::Frame frame)
     // Reset stopHPR to zero (i.e. resume the periodic HPR packet transmission)
     // if lcb_lock_changed
     if (stopHPR and lcb_lock_changed)
-        m_starCfg->setSubRegisterValue(0, "STOPHPR", 0);
+        m_starCfg->setSubRegisterValue(HCCStarSubRegister::STOPHPR, 0);
 
     // Reset testHPR bit to zero if it is one
     if (testHPR)
-        m_starCfg->setSubRegisterValue(0, "TESTHPR", 0);
+        m_starCfg->setSubRegisterValue(HCCStarSubRegister::TESTHPR, 0);
 }
 
 void StarEmu::doHPR_ABC(LCB::Frame frame, unsigned ichip)
@@ -712,9 +774,9 @@ void StarEmu::doHPR_ABC(LCB::Frame frame, unsigned ichip)
     setABCStarHPR(frame, abcID);
 
     //// HPR control logic
-    bool testHPR = m_starCfg->getSubRegisterValue(ichip, "TESTHPR");
-    bool stopHPR = m_starCfg->getSubRegisterValue(ichip, "STOPHPR");
-    bool maskHPR = m_starCfg->getSubRegisterValue(ichip, "MASKHPR");
+    bool testHPR = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::TESTHPR);
+    bool stopHPR = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::STOPHPR);
+    bool maskHPR = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::MASKHPR);
 
     bool lcb_lock_changed = testHPR & (~maskHPR);
     bool hpr_periodic = not (hpr_clkcnt%HPRPERIOD) and not stopHPR;
@@ -734,9 +796,9 @@ void StarEmu::doHPR_ABC(LCB::Frame frame, unsigned ichip)
 
     //// Update HPR control bits
     if (stopHPR and lcb_lock_changed)
-        m_starCfg->setSubRegisterValue(ichip, "STOPHPR", 0);
+        m_starCfg->setSubRegisterValue(ichip, ABCStarSubRegister::STOPHPR, 0);
     if (testHPR)
-        m_starCfg->setSubRegisterValue(ichip, "TESTHPR", 0);
+        m_starCfg->setSubRegisterValue(ichip, ABCStarSubRegister::TESTHPR, 0);
 }
 
 void StarEmu::setHCCStarHPR(LCB::Frame frame)
@@ -856,7 +918,7 @@ void StarEmu::countHits(unsigned iABC, uint8_t cmdBC)
 
     unsigned ichip = iABC+1;
     int abcID = m_starCfg->getABCchipID(ichip);
-    bool EnCount = m_starCfg->getSubRegisterValue(ichip, "ENCOUNT");
+    bool EnCount = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::ENCOUNT);
     if (not EnCount) return;
 
     auto feBC = getL0BufferAddr(iABC, cmdBC);
@@ -932,49 +994,17 @@ StarEmu::StripData StarEmu::getMasks(unsigned ichip)
     */
     /**/
     // To make the masks consistent with what is observed on actual chips
-    StripData masks;
-    for (size_t j = 0; j < 16; ++j) {
-        // maskinput0
-        // even bit
-        if ( (maskinput0 >> 2*j) & 1 ) masks.set(j);
-        // odd bit
-        if ( (maskinput0 >> (2*j+1)) & 1 ) masks.set(128+j);
-        // maskinput1
-        // even bit
-        if ( (maskinput1 >> 2*j) & 1 ) masks.set(j+16*1);
-        // odd bit
-        if ( (maskinput1 >> (2*j+1)) & 1 ) masks.set(128+j+16*1);
-        // maskinput2
-        // even bit
-        if ( (maskinput2 >> 2*j) & 1 ) masks.set(j+16*2);
-        // odd bit
-        if ( (maskinput2 >> (2*j+1)) & 1 ) masks.set(128+j+16*2);
-        // maskinput3
-        // even bit
-        if ( (maskinput3 >> 2*j) & 1 ) masks.set(j+16*3);
-        // odd bit
-        if ( (maskinput3 >> (2*j+1)) & 1 ) masks.set(128+j+16*3);
-        // maskinput4
-        // even bit
-        if ( (maskinput4 >> 2*j) & 1 ) masks.set(j+16*4);
-        // odd bit
-        if ( (maskinput4 >> (2*j+1)) & 1 ) masks.set(128+j+16*4);
-        // maskinput5
-        // even bit
-        if ( (maskinput5 >> 2*j) & 1 ) masks.set(j+16*5);
-        // odd bit
-        if ( (maskinput5 >> (2*j+1)) & 1 ) masks.set(128+j+16*5);
-        // maskinput6
-        // even bit
-        if ( (maskinput6 >> 2*j) & 1 ) masks.set(j+16*6);
-        // odd bit
-        if ( (maskinput6 >> (2*j+1)) & 1 ) masks.set(128+j+16*6);
-        // maskinput7
-        // even bit
-        if ( (maskinput7 >> 2*j) & 1 ) masks.set(j+16*7);
-        // odd bit
-        if ( (maskinput7 >> (2*j+1)) & 1 ) masks.set(128+j+16*7);
+    // Even bits of MaskInput<k> are strips 16k to 16k+15, odd bits the same
+    // strips of the second row
+    const uint32_t maskinputs[8] = {maskinput0, maskinput1, maskinput2, maskinput3,
+                                    maskinput4, maskinput5, maskinput6, maskinput7};
+    uint64_t words[4] = {0, 0, 0, 0};
+    for (size_t k = 0; k < 8; ++k) {
+        unsigned shift = 16*(k%4);
+        words[k/4] |= (uint64_t)evenBits(maskinputs[k]) << shift;
+        words[2+k/4] |= (uint64_t)evenBits(maskinputs[k] >> 1) << shift;
     }
+    StripData masks = fromWords<NStrips+NBitsBC>(words);
     /**/
 
     return masks;
@@ -984,7 +1014,7 @@ void StarEmu::applyMasks(unsigned ichip) {
 
     unsigned iABC = ichip - 1;
 
-    uint8_t TM = m_starCfg->getSubRegisterValue(ichip, "TM");
+    uint8_t TM = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::TM);
     if (TM != 0) // do nothing if not normal data taking mode
         return;
 
@@ -999,7 +1029,7 @@ void StarEmu::generateFEData_StaticTest(unsigned ichip)
     // ABC index starts from 1. Zero is reserved for HCC.
     unsigned iABC = ichip - 1;
 
-    uint8_t TM = m_starCfg->getSubRegisterValue(ichip, "TM");
+    uint8_t TM = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::TM);
     if (TM != 1) // do nothing if not static test mode
         return;
 
@@ -1021,25 +1051,25 @@ void StarEmu::generateFEData_TestPulse(unsigned ichip, uint8_t cmdBC)
     // ABC index starts from 1. Zero is reserved for HCC.
     unsigned iABC = ichip - 1;
 
-    uint8_t TM = m_starCfg->getSubRegisterValue(ichip, "TM");
+    uint8_t TM = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::TM);
     if (TM != 2) // do nothing if not test pulse mode
         return;
     
     // enable
-    bool TestPulseEnable = m_starCfg->getSubRegisterValue(ichip, "TEST_PULSE_ENABLE");
+    bool TestPulseEnable = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::TEST_PULSE_ENABLE);
     if (not TestPulseEnable)
         return;
 
     StripData masks = getMasks(ichip);
 
     // Two test pulse options: determined by bit 18 of ABC register CREG0
-    bool testPattEnable = m_starCfg->getSubRegisterValue(ichip, "TESTPATT_ENABLE");
+    bool testPattEnable = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::TESTPATT_ENABLE);
     
     if (testPattEnable) { // Use test pattern for four consecutive BC
         // Test patterns
         // testPatt1 if mask bit is 0, otherwise testPatt2
-        uint8_t testPatt1 = m_starCfg->getSubRegisterValue(ichip, "TESTPATT1");
-        uint8_t testPatt2 = m_starCfg->getSubRegisterValue(ichip, "TESTPATT2");
+        uint8_t testPatt1 = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::TESTPATT1);
+        uint8_t testPatt2 = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::TESTPATT2);
 
         for (int ibit = 0; ibit < 4; ++ibit) {
             StripData patt1_ibit(0); // 0's
@@ -1089,24 +1119,24 @@ void StarEmu::generateFEData_CaliPulse(unsigned ichip, uint8_t bc)
     // ABC index starts from 1. Zero is reserved for HCC.
     unsigned iABC = ichip - 1;
 
-    uint8_t TM = m_starCfg->getSubRegisterValue(ichip, "TM");
+    uint8_t TM = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::TM);
     if (TM != 0) // do nothing if not normal data taking mode
         return;
     
-    bool CalPulseEnable = m_starCfg->getSubRegisterValue(ichip, "CALPULSE_ENABLE");
+    bool CalPulseEnable = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::CALPULSE_ENABLE);
     if (not CalPulseEnable)
         return;
     
     // Injected charge DAC
     // 9 bits, 0 - 170 mV
-    uint16_t BCAL = m_starCfg->getSubRegisterValue(ichip, "BCAL");
+    uint16_t BCAL = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::BCAL);
 
     // Threshold DAC
     // BVT: 8 bits, 0 - -550 mV
-    uint8_t BVT = m_starCfg->getSubRegisterValue(ichip, "BVT");
+    uint8_t BVT = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::BVT);
     // Trim Range
     // BTRANGE: 5 bits, 50 mV - 230 mV
-    uint8_t BTRANGE = m_starCfg->getSubRegisterValue(ichip, "BTRANGE");
+    uint8_t BTRANGE = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::BTRANGE);
 
     // Loop over 256 strips
     for (int istrip = 0; istrip < 256; ++istrip) {
@@ -1115,7 +1145,7 @@ void StarEmu::generateFEData_CaliPulse(unsigned ichip, uint8_t bc)
         unsigned row = istrip/128 + 2*ichip - 1;
         uint8_t TrimDAC = m_starCfg->getTrimDAC(col, row);
 
-        bool aHit = m_stripArray[istrip].calculateHit(BCAL, BVT, TrimDAC, BTRANGE);
+        bool aHit = m_stripArray[istrip].calculateHit(BCAL, BVT, TrimDAC, BTRANGE, m_gen);
         
         if (aHit) { // has a hit
             m_l0buffers_lite[iABC][bc].set(istrip);
@@ -1159,49 +1189,17 @@ StarEmu::StripData StarEmu::getCalEnables(unsigned ichip)
     /**/
     // To make the masks consistent with what is observed on actual chips
     // Note: the following channel mapping for CalREGs is not the same as that for mask registers in StarEmu::getMasks either.
-    StripData enables;
-    for (size_t j = 0; j < 8; ++j) { // deal with 4 bits at a time
-        // calenable0
-        if ( (calenable0 >> 4*j) & 1 ) enables.set(2*j);
-        if ( (calenable0 >> (4*j+1)) & 1 ) enables.set(2*j+1);
-        if ( (calenable0 >> (4*j+2)) & 1 ) enables.set(128+2*j);
-        if ( (calenable0 >> (4*j+3)) & 1 ) enables.set(128+2*j+1);
-        // calenable1
-        if ( (calenable1 >> 4*j) & 1 ) enables.set(2*j+16*1);
-        if ( (calenable1 >> (4*j+1)) & 1 ) enables.set(2*j+1+16*1);
-        if ( (calenable1 >> (4*j+2)) & 1 ) enables.set(128+2*j+16*1);
-        if ( (calenable1 >> (4*j+3)) & 1 ) enables.set(128+2*j+1+16*1);
-        // calenable2
-        if ( (calenable2 >> 4*j) & 1 ) enables.set(2*j+16*2);
-        if ( (calenable2 >> (4*j+1)) & 1 ) enables.set(2*j+1+16*2);
-        if ( (calenable2 >> (4*j+2)) & 1 ) enables.set(128+2*j+16*2);
-        if ( (calenable2 >> (4*j+3)) & 1 ) enables.set(128+2*j+1+16*2);
-        // calenable3
-        if ( (calenable3 >> 4*j) & 1 ) enables.set(2*j+16*3);
-        if ( (calenable3 >> (4*j+1)) & 1 ) enables.set(2*j+1+16*3);
-        if ( (calenable3 >> (4*j+2)) & 1 ) enables.set(128+2*j+16*3);
-        if ( (calenable3 >> (4*j+3)) & 1 ) enables.set(128+2*j+1+16*3);
-        // calenable4
-        if ( (calenable4 >> 4*j) & 1 ) enables.set(2*j+16*4);
-        if ( (calenable4 >> (4*j+1)) & 1 ) enables.set(2*j+1+16*4);
-        if ( (calenable4 >> (4*j+2)) & 1 ) enables.set(128+2*j+16*4);
-        if ( (calenable4 >> (4*j+3)) & 1 ) enables.set(128+2*j+1+16*4);
-        // calenable5
-        if ( (calenable5 >> 4*j) & 1 ) enables.set(2*j+16*5);
-        if ( (calenable5 >> (4*j+1)) & 1 ) enables.set(2*j+1+16*5);
-        if ( (calenable5 >> (4*j+2)) & 1 ) enables.set(128+2*j+16*5);
-        if ( (calenable5 >> (4*j+3)) & 1 ) enables.set(128+2*j+1+16*5);
-        // calenable6
-        if ( (calenable6 >> 4*j) & 1 ) enables.set(2*j+16*6);
-        if ( (calenable6 >> (4*j+1)) & 1 ) enables.set(2*j+1+16*6);
-        if ( (calenable6 >> (4*j+2)) & 1 ) enables.set(128+2*j+16*6);
-        if ( (calenable6 >> (4*j+3)) & 1 ) enables.set(128+2*j+1+16*6);
-        // calenable7
-        if ( (calenable7 >> 4*j) & 1 ) enables.set(2*j+16*7);
-        if ( (calenable7 >> (4*j+1)) & 1 ) enables.set(2*j+1+16*7);
-        if ( (calenable7 >> (4*j+2)) & 1 ) enables.set(128+2*j+16*7);
-        if ( (calenable7 >> (4*j+3)) & 1 ) enables.set(128+2*j+1+16*7);
+    // Bits 0 and 1 of each nibble of CalREG<k> are two strips out of 16k to
+    // 16k+15, bits 2 and 3 the same strips of the second row
+    const uint32_t calenables[8] = {calenable0, calenable1, calenable2, calenable3,
+                                    calenable4, calenable5, calenable6, calenable7};
+    uint64_t words[4] = {0, 0, 0, 0};
+    for (size_t k = 0; k < 8; ++k) {
+        unsigned shift = 16*(k%4);
+        words[k/4] |= (uint64_t)lowPairs(calenables[k]) << shift;
+        words[2+k/4] |= (uint64_t)lowPairs(calenables[k] >> 2) << shift;
     }
+    StripData enables = fromWords<NStrips+NBitsBC>(words);
     /**/
     return enables;
 }
@@ -1212,7 +1210,7 @@ void StarEmu::prepareFEData(unsigned ichip)
     assert(ichip);
 
     // Check mode of operation
-    uint8_t TM = m_starCfg->getSubRegisterValue(ichip, "TM");
+    uint8_t TM = m_starCfg->getSubRegisterValue(ichip, ABCStarSubRegister::TM);
     
     if (TM == 0) { // Normal data taking
         this->applyMasks(ichip);
@@ -1230,27 +1228,21 @@ std::vector<uint16_t> StarEmu::clusterFinder(
     std::vector<uint16_t> clusters;
 
     // The 256 strips are divided into two rows to form clusters
-    // Split input data into uint64_t
-    StripData selector(0xffffffffffffffffULL); // 64 ones
-    // Row 1
-    uint64_t d0l = (inputData & selector).to_ullong(); // 0 ~ 63
-    uint64_t d0h = ((inputData >> 64) & selector).to_ullong(); // 64 ~ 127
-    // Row 2
-    uint64_t d1l = ((inputData >> 128) & selector).to_ullong(); // 128 ~ 191
-    uint64_t d1h = ((inputData >> 192) & selector).to_ullong(); // 192 ~ 155
-
-    while (d0l or d0h or d1l or d1h) {
+    // Row 1: strips 0 ~ 127
+    StripRow row0 = (StripRow)toWord(inputData, 1) << 64 | toWord(inputData, 0);
+    // Row 2: strips 128 ~ 255
+    StripRow row1 = (StripRow)toWord(inputData, 3) << 64 | toWord(inputData, 2);
+
+    while (row0 or row1) {
         if (clusters.size() > maxCluster) break;
 
-        uint16_t cluster1 = clusterFinder_sub(d1h, d1l, true);
-        if (cluster1 != 0x3ff) // if not an empty cluster
-            clusters.push_back(cluster1);
+        if (row1)
+            clusters.push_back(takeCluster(row1, true));
 
         if (clusters.size() > maxCluster)  break;
 
-        uint16_t cluster0 = clusterFinder_sub(d0h, d0l, false);
-        if (cluster0 != 0x3ff) // if not an empty cluster
-            clusters.push_back(cluster0);
+        if (row0)
+            clusters.push_back(takeCluster(row0, false));
     }
 
     if (clusters.empty()) {
@@ -1264,60 +1256,6 @@ std::vector<uint16_t> StarEmu::clusterFinder(
     return clusters;
 }
 
-uint16_t StarEmu::clusterFinder_sub(uint64_t& hits_high64, uint64_t& hits_low64,
-                                    bool isSecondRow)
-{
-    uint8_t hit_addr = 128;
-    uint8_t hitpat_next3 = 0;
-
-    // Count trailing zeros to get address of the hit
-    if (hits_low64) {   
-        hit_addr = __builtin_ctzll(hits_low64);
-    }
-    else if (hits_high64) {
-        hit_addr = __builtin_ctzll(hits_high64) + 64;
-    }
-    
-    // Get the value of the next three strips: [hit_addr+3: hit_addr+1]
-    hitpat_next3 = getBit_128b(hit_addr+1, hits_high64, hits_low64) << 2
-        | getBit_128b(hit_addr+2, hits_high64, hits_low64) << 1
-        | getBit_128b(hit_addr+3, hits_high64, hits_low64);
-
-    // Mask the bits that have already been considered
-    // i.e. set bits [hit_addr+3 : hit_addr] to zero
-    for (int i=0; i<4; ++i)
-        setBit_128b(hit_addr+i, 0, hits_high64, hits_low64);
-
-    if (hit_addr == 128) { // no cluster found
-        return 0x3ff;
-    }
-    else {
-        hit_addr += isSecondRow<<7;
-        // set the lowest bit of any valid cluster to 0
-        return hit_addr << 3 | hitpat_next3;
-    }
-}
-
-inline bool StarEmu::getBit_128b(uint8_t bit_addr, uint64_t data_high64,
-                                 uint64_t data_low64)
-{
-    if (bit_addr > 127) return false;
-
-    return bit_addr<64 ? data_low64>>bit_addr & 1 : data_high64>>(bit_addr-64) & 1;
-}
-
-inline void StarEmu::setBit_128b(uint8_t bit_addr, bool value,
-                                 uint64_t& data_high64, uint64_t& data_low64)
-{
-    if (bit_addr < 64) {
-        data_low64 = (data_low64 & ~(1ULL << bit_addr)) | ((uint64_t)value << bit_addr);
-    }
-    else if (bit_addr < 128) {
-        data_high64 =
-            (data_high64 & ~(1ULL << (bit_addr-64))) | ((uint64_t)value << (bit_addr-64));
-    }
-}
-
 void StarEmu::addClusters(std::vector<std::vector<uint16_t>>& allclusters,
                           unsigned iABC, uint8_t cmdBC)
 {
@@ -1326,8 +1264,8 @@ void StarEmu::addClusters(std::vector<std::vector<uint16_t>>& allclusters,
     auto feBC = getL0BufferAddr(iABC, cmdBC);
 
     // max clusters
-    bool maxcluster_en = m_starCfg->getSubRegisterValue(iABC+1, "MAX_CLUSTER_ENABLE");
-    uint8_t maxcluster = maxcluster_en ? m_starCfg->getSubRegisterValue(iABC+1, "MAX_CLUSTER") : 63;
+    bool maxcluster_en = m_starCfg->getSubRegisterValue(iABC+1, ABCStarSubRegister::MAX_CLUSTER_ENABLE);
+    uint8_t maxcluster = maxcluster_en ? m_starCfg->getSubRegisterValue(iABC+1, ABCStarSubRegister::MAX_CLUSTER) : 63;
     
     // Get front-end data and find clusters
     std::vector<uint16_t> abc_clusters = clusterFinder(
@@ -1342,7 +1280,7 @@ unsigned StarEmu::getL0BufferAddr(unsigned iABC, uint8_t cmdBC)
     
     // get L0A latency from the ABCStar config register CREG2
     // 9 bits, in unit of BC (25 ns)
-    unsigned l0a_latency = m_starCfg->getSubRegisterValue(iABC+1, "LATENCY");
+    unsigned l0a_latency = m_starCfg->getSubRegisterValue(iABC+1, ABCStarSubRegister::LATENCY);
 
     // return address of the FE data in m_l0buffers_lite[iABC] that corresponds to cmdBC
     // m_l0buffers_lite[iABC] is of size 4 and is used as a ring buffer
@@ -1353,72 +1291,26 @@ unsigned StarEmu::getL0BufferAddr(unsigned iABC, uint8_t cmdBC)
 void StarEmu::executeLoop() {
     logger->info("Starting emulator loop");
 
-    static const auto SLEEP_TIME = std::chrono::milliseconds(1);
+    // Only bounds how late a stop request is seen
+    static const auto WAIT_TIME = std::chrono::milliseconds(10);
+
+    // Each word holds two LCB frames, the earlier one in the upper half
+    std::vector<uint32_t> words(1024);
 
     while (run) {
-        if ( m_txRingBuffer->isEmpty()) {
-            std::this_thread::sleep_for( SLEEP_TIME );
+        uint32_t available = m_txRingBuffer->getCurSize() / sizeof(uint32_t);
+        if (available == 0) {
+            m_txRingBuffer->waitForData(WAIT_TIME);
             continue;
         }
 
-        logger->debug("{}: -----------------------------------------------------------", __PRETTY_FUNCTION__);
+        uint32_t n = std::min<uint32_t>(available, words.size());
+        if (not m_txRingBuffer->readBlock32(words.data(), n)) continue;
 
-        uint32_t d = m_txRingBuffer->read32();
-
-        
-        uint16_t d0 = (d >> 16) & 0xffff;
-        uint16_t d1 = (d >> 0) & 0xffff;
-
-        DecodeLCB(d0);
-        DecodeLCB(d1);
-
-        /*
-        int trig_count = 0;
-        trig_count += countTriggers(d0);
-        trig_count += countTriggers(d1);
-
-        // This is an LP packet
-        alignas(32) uint8_t fixed_packet[] =
-            {0x20, 0x06,
-             // Channel 0...
-             0x07, 0x8f, 0x03, 0x8f, 0x07, 0xaf, 0x03, 0xaf,
-             // Channel 1...
-             0x0f, 0x8f, 0x0b, 0x8f, 0x0f, 0xaf, 0x0b, 0xaf,
-             // Channel 2
-             0x17, 0x8f, 0x13, 0x8f, 0x17, 0xaf, 0x13, 0xaf,
-             0x17, 0xcf, 0x13, 0xcf, 0x17, 0xee, 0x13, 0xee,
-             // Channel 0 continued
-             0x07, 0xcf, 0x03, 0xcf, 0x07, 0xee, 0x03, 0xee,
-             // Channel 1 continued
-             0x0f, 0xcf, 0x0b, 0xcf, 0x0f, 0xee, 0x0b, 0xee,
-             // Channel 3
-             0x1f, 0x8f, 0x1b, 0x8f, 0x1f, 0xaf, 0x1b, 0xaf,
-             0x1f, 0xcf, 0x1b, 0xcf, 0x1f, 0xee, 0x1b, 0xee,
-             // Channel 4
-             0x27, 0x8f, 0x23, 0x8f, 0x27, 0xaf, 0x23, 0xaf,
-             0x27, 0xcf, 0x23, 0xcf, 0x27, 0xee, 0x23, 0xee,
-             // Channel 5
-             0x2f, 0x8f, 0x2b, 0x8f, 0x2f, 0xaf, 0x2b, 0xaf,
-             0x2f, 0xcf, 0x2b, 0xcf, 0x2f, 0xee, 0x2b, 0xee,
-             // Channel 6
-             0x37, 0x8f, 0x33, 0x8f, 0x37, 0xaf, 0x33, 0xaf,
-             0x37, 0xcf, 0x33, 0xcf, 0x37, 0xee, 0x33, 0xee,
-             // Channel 7
-             0x3f, 0x8f, 0x3b, 0x8f, 0x3f, 0xaf, 0x3b, 0xaf,
-             0x3f, 0xcf, 0x3b, 0xcf, 0x3f, 0xee, 0x3b, 0xee,
-             // Channel 8
-             0x47, 0x8f, 0x43, 0x8f, 0x47, 0xaf, 0x43, 0xaf,
-             0x47, 0xcf, 0x43, 0xcf, 0x47, 0xee, 0x43, 0xee,
-             // Channel 9
-             0x4f, 0x8f, 0x4b, 0x8f, 0x4f, 0xaf, 0x4b, 0xaf,
-             0x4f, 0xcf, 0x4b, 0xcf, 0x4f, 0xee, 0x4b, 0xee,
-             0x6f, 0xed};
-
-        for(int i=0; i<trig_count; i++) {
-            sendPacket(fixed_packet);
+        for (uint32_t i = 0; i < n; ++i) {
+            DecodeLCB((words[i] >> 16) & 0xffff);
+            DecodeLCB(words[i] & 0xffff);
         }
-        */
-
     }
 }
 
@@ -1426,25 +1318,28 @@ void StarEmu::executeLoop() {
 
 template<>
 class EmuRxCore<StarChips> : virtual public RxCore {
-        ClipBoard<RawData> m_queue;
-        uint32_t m_channel = 0;
+        /// Packets of each emulated HCC by rx channel
+        std::map<uint32_t, ClipBoard<RawData>> m_queues;
+        std::vector<uint32_t> m_enabled;
+        /// Index into m_enabled of the channel read first, so no HCC starves the others
+        unsigned m_next = 0;
     public:
         EmuRxCore();
         ~EmuRxCore();
         
         void setCom(EmuCom *com) {} // Used by EmuController.h
-        ClipBoard<RawData> &getCom() {return m_queue;}
+        ClipBoard<RawData> &getCom(uint32_t channel) {return m_queues[channel];}
 
-        void setRxEnable(uint32_t val) override { m_channel = val; }
-        void setRxEnable(std::vector<uint32_t> channels) override { if (not channels.empty()) m_channel = channels[0];}
+        void setRxEnable(uint32_t val) override { m_enabled.assign(1, val); m_next = 0; }
+        void setRxEnable(std::vector<uint32_t> channels) override { m_enabled = channels; m_next = 0; }
         void maskRxEnable(uint32_t val, uint32_t mask) override {}
         void disableRx() override {}
 
         RawData* readData() override;
         
         uint32_t getDataRate() override {return 0;}
-        uint32_t getCurCount() override {return m_queue.empty()?0:1;}
-        bool isBridgeEmpty() override {return m_queue.empty();}
+        uint32_t getCurCount() override;
+        bool isBridgeEmpty() override {return getCurCount() == 0;}
 };
 
 
@@ -1461,18 +1356,47 @@ std::unique_ptr<HwController> makeEmu() {
   return ctrl;
 }
 
-EmuRxCore<StarChips>::EmuRxCore() {}
+EmuRxCore<StarChips>::EmuRxCore() : m_enabled(1, 0) {}
 EmuRxCore<StarChips>::~EmuRxCore() {}
 
 RawData* EmuRxCore<StarChips>::readData() {
-    // //std::this_thread::sleep_for(std::chrono::microseconds(1));
-    if(m_queue.empty()) return nullptr;
+    // A single HCC answers on the first enabled channel, whatever its own is
+    if (m_queues.size() == 1) {
+        std::unique_ptr<RawData> rd = m_queues.begin()->second.popData();
+        if (!rd) return nullptr;
+        rd->adr = m_enabled.empty() ? 0 : m_enabled[0];
+        return rd.release();
+    }
+
+    for (unsigned i = 0; i < m_enabled.size(); i++) {
+        unsigned index = (m_next + i) % m_enabled.size();
+        auto it = m_queues.find(m_enabled[index]);
+        if (it == m_queues.end()) continue;
 
-    std::unique_ptr<RawData> rd = m_queue.popData();
-    // set rx channel number
-    rd->adr = m_channel;
+        std::unique_ptr<RawData> rd = it->second.popData();
+        if (!rd) continue;
 
-    return rd.release();
+        m_next = (index + 1) % m_enabled.size();
+        rd->adr = it->first;
+        return rd.release();
+    }
+
+    // Nobody reads the disabled channels
+    for (auto &it : m_queues) {
+        if (std::find(m_enabled.begin(), m_enabled.end(), it.first) != m_enabled.end()) continue;
+        while (std::unique_ptr<RawData> rd = it.second.popData()) {
+            delete [] rd->buf;
+        }
+    }
+    return nullptr;
+}
+
+uint32_t EmuRxCore<StarChips>::getCurCount() {
+    uint32_t count = 0;
+    for (auto &it : m_queues) {
+        if (!it.second.empty()) count++;
+    }
+    return count;
 }
 
 bool emu_registered_Emu =
@@ -1480,15 +1404,28 @@ bool emu_registered_Emu =
                                 makeEmu<StarChips, StarEmu>);
 
 template<>
-void EmuController<StarChips, StarEmu>::loadConfig(json &j) {
-  auto tx = EmuTxCore<StarChips>::getCom();
-  auto &rx = EmuRxCore<StarChips>::getCom();
+void EmuController<StarChips, StarEmu>::addChip(uint32_t channel) {
+  // The HCCs share the command link, they listen on every channel
+  for (auto &it : chips) {
+    if (it.second.emu) EmuTxCore<StarChips>::addCom(channel, it.second.tx_com.get());
+  }
+}
 
+template<>
+void EmuController<StarChips, StarEmu>::loadConfig(json &j) {
   //TODO make nice
   logger->info("-> Starting Emulator");
+  emuCfg = j;
+
+  if (!j["seed"].empty()) {
+    uint64_t seed = j["seed"];
+    logger->info("Random seed {}", seed);
+    Gauss::setSeed(seed);
+  }
+
   std::string emuCfgFile;
-  if (!j["feCfg"].empty()) {
-    emuCfgFile = j["feCfg"];
+  if (!emuCfg["feCfg"].empty()) {
+    emuCfgFile = emuCfg["feCfg"];
     logger->info("Using config: {}", emuCfgFile);
   }
 
@@ -1496,11 +1433,51 @@ void EmuController<StarChips, StarEmu>::loadConfig(json &j) {
   // 40000 BC (i.e. 1 ms) by default.
   // Can be set to a smaller value for testing, but need to be a multiple of 4
   unsigned hprperiod = 40000;
-  if (!j["hprPeriod"].empty()) {
-    hprperiod = j["hprPeriod"];
+  if (!emuCfg["hprPeriod"].empty()) {
+    hprperiod = emuCfg["hprPeriod"];
     logger->debug("HPR packet transmission period is set to {} BC", hprperiod);
   }
 
-  emu.reset(new StarEmu( rx, tx_com.get(), emuCfgFile, hprperiod ));
-  emuThreads.push_back(std::thread(&StarEmu::executeLoop, emu.get()));
+  // Without a list of HCCs a single one with ID 15 and one ABC with ID 15
+  // Each HCC gets its own thread and sends on its own rx channel
+  bool hasList = j.find("hccs") != j.end();
+  unsigned nHccs = hasList ? j["hccs"].size() : 1;
+  uint32_t txSize = chips[0].tx_com->getCapacity();
+  EmuCom *firstCom = nullptr;
+
+  for (unsigned i = 0; i < nHccs; i++) {
+    uint32_t rx = i;
+    unsigned hccID = 15;
+    std::vector<unsigned> abcIDs = {15};
+    if (hasList) {
+      auto &hcc = j["hccs"][i];
+      if (!hcc["rx"].empty()) rx = hcc["rx"];
+      if (!hcc["hccId"].empty()) hccID = hcc["hccId"];
+      if (!hcc["abcIds"].empty()) {
+        abcIDs.clear();
+        for (unsigned a = 0; a < hcc["abcIds"].size(); a++) abcIDs.push_back(hcc["abcIds"][a]);
+      }
+    }
+    if (abcIDs.size() > 11) {
+      throw std::runtime_error("HCC " + std::to_string(hccID) + " has more than 11 ABCs");
+    }
+
+    Chip &chip = chips[rx];
+    if (chip.emu) {
+      throw std::runtime_error("More than one HCC on rx channel " + std::to_string(rx));
+    }
+    if (!chip.tx_com) chip.tx_com.reset(new RingBuffer(txSize));
+
+    if (firstCom) {
+      EmuTxCore<StarChips>::addCom(0, chip.tx_com.get());
+    } else {
+      firstCom = chip.tx_com.get();
+      EmuTxCore<StarChips>::setCom(0, firstCom);
+    }
+
+    logger->info("Emulating HCC {} with {} ABCs on rx channel {}", hccID, abcIDs.size(), rx);
+    chip.emu.reset(new StarEmu(EmuRxCore<StarChips>::getCom(rx), chip.tx_com.get(),
+                               emuCfgFile, hprperiod, hccID, abcIDs));
+    chip.thread = std::thread(&StarEmu::executeLoop, chip.emu.get());
+  }
 }
@@ -1,5 +1,4 @@
 #include "StripModel.h"
-#include "Gauss.h"
 
 StripModel::StripModel()
     : vthreshold_mean(1)
@@ -20,13 +19,13 @@ void StripModel::setValue(float vth_mean, float vth_sigma, float noise_mean,
 }
 
 /// Threshold
-inline float StripModel::calculateBVT(uint8_t BVT)
+inline float StripModel::calculateBVT(uint8_t BVT, Gauss::Generator &gen)
 {
     // 8-bit DAC for global threshold
     // Range: 0 - -550 mV
     float vth = BVT / 255. * 550.; // -mv
     // Smear
-    return vth * Gauss::rand_normal(vthreshold_mean, vthreshold_sigma, true) / vthreshold_mean;
+    return vth * gen.normal(vthreshold_mean, vthreshold_sigma) / vthreshold_mean;
 }
 
 inline float StripModel::calculateTrimDAC(uint8_t TrimDAC, uint8_t Range)
@@ -39,9 +38,9 @@ inline float StripModel::calculateTrimDAC(uint8_t TrimDAC, uint8_t Range)
 }
 
 float StripModel::calculateThreshold(uint8_t BVT, uint8_t TrimDAC,
-                                     uint8_t TrimRange)
+                                     uint8_t TrimRange, Gauss::Generator &gen)
 {
-    float vth_smear = this->calculateBVT(BVT);
+    float vth_smear = this->calculateBVT(BVT, gen);
     float vtrim = this->calculateTrimDAC(TrimDAC, TrimRange);
     float threshold = vth_smear - vtrim;
     
@@ -52,9 +51,9 @@ float StripModel::calculateThreshold(uint8_t BVT, uint8_t TrimDAC,
 // Pre amp
 //
 /// Noise charge
-float StripModel::calculateNoise()
+float StripModel::calculateNoise(Gauss::Generator &gen)
 {
-    return Gauss::rand_normal(noise_occupancy_mean, noise_occupancy_sigma, true); // fC
+    return gen.normal(noise_occupancy_mean, noise_occupancy_sigma); // fC
 }
 
 /// Charge injection
@@ -75,16 +74,16 @@ float StripModel::gain_function(float charge)
 
 /// Determine if there is a hit
 bool StripModel::calculateHit(uint16_t BCAL, uint8_t BVT, uint8_t TrimDAC,
-                              uint8_t TrimRange)
+                              uint8_t TrimRange, Gauss::Generator &gen)
 {
     float injected_charge = calculateInjection(BCAL);
-    float noise_charge = calculateNoise();
+    float noise_charge = calculateNoise(gen);
 
     // After amplifier
     float voltage_inj = gain_function(injected_charge + noise_charge);
 
     // Threshold
-    float vthreshold = calculateThreshold(BVT, TrimDAC, TrimRange);
+    float vthreshold = calculateThreshold(BVT, TrimDAC, TrimRange, gen);
 
     // Compare
     return voltage_inj > vthreshold;
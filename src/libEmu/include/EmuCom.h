@@ -1,6 +1,7 @@
 #ifndef EMUCOM_H
 #define EMUCOM_H
 
+#include <chrono>
 #include <cstdint>
 
 class EmuCom {
@@ -10,6 +11,11 @@ class EmuCom {
         virtual uint32_t read32() = 0;
         virtual uint32_t readBlock32(uint32_t *buf, uint32_t length) = 0;
         virtual void write32(uint32_t) = 0;
+        /// Defaults to one write32() per word
+        virtual void writeBlock32(const uint32_t *buf, uint32_t length);
+        /// Block until there is data or the timeout passed, true if there is data
+        /// Defaults to polling isEmpty()
+        virtual bool waitForData(std::chrono::microseconds timeout);
 
         virtual ~EmuCom();
     protected:
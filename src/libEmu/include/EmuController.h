@@ -18,43 +18,79 @@
 
 #include "storage.hpp"
 
+#include <map>
+#include <memory>
+#include <thread>
+
 class Fei4;
 class Rd53a;
 
 template<class FE, class ChipEmu>
 class EmuController : public HwController, public EmuTxCore<FE>, public EmuRxCore<FE> {
-    std::unique_ptr<ChipEmu> emu;
-    std::vector<std::thread> emuThreads;
+    /// Emulated chip listening on tx channel n and sending on rx channel n,
+    /// for Star the HCCs by rx channel, they listen on all tx channels
+    struct Chip {
+        std::unique_ptr<RingBuffer> rx_com;
+        std::unique_ptr<RingBuffer> tx_com;
+        std::unique_ptr<ChipEmu> emu;
+        std::thread thread;
+    };
+    std::map<uint32_t, Chip> chips;
+
+    /// Kept to create the chips of channels enabled later on
+    json emuCfg;
 
-    std::unique_ptr<RingBuffer> rx_com;
-    std::unique_ptr<RingBuffer> tx_com;
-    
+    /// Creates the emulator of a channel, specialised per front-end
+    void addChip(uint32_t channel);
 
     public:
         EmuController(std::unique_ptr<RingBuffer> rx,
                       std::unique_ptr<RingBuffer> tx);
         ~EmuController();
         void loadConfig(json &j);
+
+        /// A chip is created for each channel commands are enabled on,
+        /// so the connectivity config decides how many are emulated
+        void setCmdEnable(uint32_t channel) override;
+        void setCmdEnable(std::vector<uint32_t> channels) override;
+
+        /// The emulated chips only live as long as the controller
+        bool hasPersistentChips() override {return false;}
 };
 
 template<class FE, class ChipEmu>
   EmuController<FE, ChipEmu>::EmuController(std::unique_ptr<RingBuffer> rx,
-                                            std::unique_ptr<RingBuffer> tx)
-  : emu(nullptr), rx_com(std::move(rx)), tx_com(std::move(tx)) {
+                                            std::unique_ptr<RingBuffer> tx) {
+    Chip &chip = chips[0];
+    chip.rx_com = std::move(rx);
+    chip.tx_com = std::move(tx);
     // Don't transfer ownership!
-    EmuTxCore<FE>::setCom(tx_com.get());
-    EmuRxCore<FE>::setCom(rx_com.get());
+    EmuTxCore<FE>::setCom(chip.tx_com.get());
+    EmuRxCore<FE>::setCom(chip.rx_com.get());
 }
 
 template<class FE, class ChipEmu>
 EmuController<FE, ChipEmu>::~EmuController() {
-  if(emu) {
-    emu->run = false;
+  for (auto &it : chips) {
+    if (it.second.emu) it.second.emu->run = false;
+  }
+  for (auto &it : chips) {
+    if (it.second.thread.joinable()) it.second.thread.join();
   }
-  emuThreads[0].join();
 }
 
+template<class FE, class ChipEmu>
+void EmuController<FE, ChipEmu>::setCmdEnable(uint32_t channel) {
+  this->setCmdEnable(std::vector<uint32_t>(1, channel));
+}
 
-
+template<class FE, class ChipEmu>
+void EmuController<FE, ChipEmu>::setCmdEnable(std::vector<uint32_t> channels) {
+  // Nothing listens on the channel yet
+  for (uint32_t channel : channels) {
+    if (!EmuTxCore<FE>::getCom(channel)) this->addChip(channel);
+  }
+  EmuTxCore<FE>::setCmdEnable(channels);
+}
 
 #endif
@@ -10,7 +10,10 @@
 // # Date: Jan 2017
 // ################################
 
+#include <algorithm>
 #include <iostream>
+#include <map>
+#include <vector>
 
 #include "RxCore.h"
 #include "EmuCom.h"
@@ -19,49 +22,136 @@ template<class FE>
 class EmuRxCore : virtual public RxCore {
     public:
         EmuRxCore(EmuCom *com);
-        EmuRxCore() {m_com = NULL;}
+        EmuRxCore() : m_enabled(1, 0) {}
         ~EmuRxCore();
         
-        void setCom(EmuCom *com) {m_com = com;}
-        EmuCom* getCom() {return m_com;}
+        /// Com of the chip on channel 0, the only one enabled by default
+        void setCom(EmuCom *com) {this->setCom(0, com);}
+        EmuCom* getCom() {return this->getCom(0);}
 
-        void setRxEnable(uint32_t val) {}
-        void setRxEnable(std::vector<uint32_t> channels) {}
-        void maskRxEnable(uint32_t val, uint32_t mask) {}
-        void disableRx() {}
+        /// Com of the chip sending on a data channel
+        void setCom(uint32_t channel, EmuCom *com) {m_coms[channel] = com;}
+        EmuCom* getCom(uint32_t channel);
 
+        void setRxEnable(uint32_t val) {this->setRxEnable(std::vector<uint32_t>(1, val));}
+        void setRxEnable(std::vector<uint32_t> channels);
+        void maskRxEnable(uint32_t val, uint32_t mask);
+        void disableRx() {this->setRxEnable(std::vector<uint32_t>());}
+
+        /// Data of all enabled channels merged into one block, encoded with
+        /// the channel the way the firmware does it for the front-end type.
+        /// Data of disabled channels is dropped.
         RawData* readData();
         
         uint32_t getDataRate() {return 0;}
-        uint32_t getCurCount() {return m_com->getCurSize();}
-        bool isBridgeEmpty() {return m_com->isEmpty();}
+        uint32_t getCurCount();
+        bool isBridgeEmpty();
 
     private:
-        EmuCom *m_com;
+        std::map<uint32_t, EmuCom*> m_coms;
+        /// Sorted like the channels of the data processors
+        std::vector<uint32_t> m_enabled;
+
+        /// Takes all words available on every channel, enabled ones are kept
+        /// in the order of m_enabled
+        std::vector<std::vector<uint32_t>> &drain();
+        std::vector<std::vector<uint32_t>> m_drained;
 };
 
 template<class FE>
-EmuRxCore<FE>::EmuRxCore(EmuCom *com) {
-    m_com = com;
+EmuRxCore<FE>::EmuRxCore(EmuCom *com) : m_enabled(1, 0) {
+    this->setCom(com);
 }
 
 template<class FE>
 EmuRxCore<FE>::~EmuRxCore() {}
 
 template<class FE>
-RawData* EmuRxCore<FE>::readData() {
-    //std::this_thread::sleep_for(std::chrono::microseconds(1));
-    uint32_t words = this->getCurCount()/sizeof(uint32_t);
-    if (words > 0) {
-        uint32_t *buf = new uint32_t[words];
-        //for(unsigned i=0; i<words; i++)
-        //    buf[i] = m_com->read32();
-        if (m_com->readBlock32(buf, words)) {
-            return new RawData(0x0, buf, words);
-        } else {
-            delete[] buf;
+EmuCom* EmuRxCore<FE>::getCom(uint32_t channel) {
+    auto it = m_coms.find(channel);
+    return (it == m_coms.end()) ? NULL : it->second;
+}
+
+template<class FE>
+void EmuRxCore<FE>::setRxEnable(std::vector<uint32_t> channels) {
+    std::sort(channels.begin(), channels.end());
+    channels.erase(std::unique(channels.begin(), channels.end()), channels.end());
+    m_enabled = channels;
+}
+
+template<class FE>
+void EmuRxCore<FE>::maskRxEnable(uint32_t val, uint32_t mask) {
+    std::vector<uint32_t> channels;
+    for (uint32_t channel : m_enabled) {
+        if (channel >= 32 || !((mask >> channel) & 0x1)) channels.push_back(channel);
+    }
+    for (uint32_t channel = 0; channel < 32; channel++) {
+        if ((mask >> channel) & (val >> channel) & 0x1) channels.push_back(channel);
+    }
+    this->setRxEnable(channels);
+}
+
+template<class FE>
+uint32_t EmuRxCore<FE>::getCurCount() {
+    uint32_t count = 0;
+    for (uint32_t channel : m_enabled) {
+        EmuCom *com = this->getCom(channel);
+        if (com) count += com->getCurSize();
+    }
+    return count;
+}
+
+template<class FE>
+bool EmuRxCore<FE>::isBridgeEmpty() {
+    for (auto &it : m_coms) {
+        if (!it.second->isEmpty()) return false;
+    }
+    return true;
+}
+
+template<class FE>
+std::vector<std::vector<uint32_t>> &EmuRxCore<FE>::drain() {
+    m_drained.resize(m_enabled.size());
+    for (unsigned i=0; i<m_enabled.size(); i++) {
+        m_drained[i].clear();
+        EmuCom *com = this->getCom(m_enabled[i]);
+        if (!com) continue;
+        uint32_t words = com->getCurSize()/sizeof(uint32_t);
+        m_drained[i].resize(words);
+        if (words > 0 && !com->readBlock32(m_drained[i].data(), words)) {
+            m_drained[i].clear();
         }
     }
-    return NULL;
+    // Nobody reads the disabled channels, the chips must not block on them
+    for (auto &it : m_coms) {
+        if (std::binary_search(m_enabled.begin(), m_enabled.end(), it.first)) continue;
+        uint32_t words = it.second->getCurSize()/sizeof(uint32_t);
+        if (words == 0) continue;
+        std::vector<uint32_t> dropped(words);
+        it.second->readBlock32(dropped.data(), words);
+    }
+    return m_drained;
 }
+
+template<class FE>
+RawData* EmuRxCore<FE>::readData() {
+    // Without a channel encoding only one channel can be told apart
+    auto &data = this->drain();
+    uint32_t words = 0;
+    for (auto &d : data) words += d.size();
+    if (words == 0) return NULL;
+
+    uint32_t *buf = new uint32_t[words];
+    uint32_t *out = buf;
+    for (auto &d : data) {
+        out = std::copy(d.begin(), d.end(), out);
+    }
+    return new RawData(m_enabled.empty() ? 0x0 : m_enabled[0], buf, words);
+}
+
+// Channel encodings of the firmware, in EmuRxCore.cpp
+class Fei4;
+class Rd53a;
+template<> RawData* EmuRxCore<Fei4>::readData();
+template<> RawData* EmuRxCore<Rd53a>::readData();
 #endif
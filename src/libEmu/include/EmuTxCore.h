@@ -10,10 +10,13 @@
 // # Date: Jan 2017
 // ################################
 
+#include <algorithm>
 #include <atomic>
 #include <iostream>
+#include <map>
 #include <thread>
 #include <mutex>
+#include <vector>
 
 #include "TxCore.h"
 #include "EmuCom.h"
@@ -25,20 +28,29 @@ class EmuTxCore : virtual public TxCore {
         EmuTxCore();
         ~EmuTxCore();
 
-        void setCom(EmuCom *com) {m_com = com;}
-        EmuCom* getCom() {return m_com;}
+        /// Com of the chip on channel 0, the only one enabled by default
+        void setCom(EmuCom *com) {this->setCom(0, com);}
+        EmuCom* getCom() {return this->getCom(0);}
 
+        /// Com of the chip listening on a command channel
+        void setCom(uint32_t channel, EmuCom *com);
+        EmuCom* getCom(uint32_t channel);
+        /// Another chip listening on the same command channel
+        void addCom(uint32_t channel, EmuCom *com);
+
+        /// Commands go to all enabled channels, like a broadcast on the firmware
         void writeFifo(uint32_t value);
+        void writeFifoBlock(const uint32_t *words, size_t count) override;
         void releaseFifo() {this->writeFifo(0x0);} // Add some padding
         
-        void setCmdEnable(uint32_t value) {}
-        void setCmdEnable(std::vector<uint32_t> channels) {}
-        void disableCmd() {}
-        uint32_t getCmdEnable() {return 0x0;}
-        void maskCmdEnable(uint32_t value, uint32_t mask) {}
+        void setCmdEnable(uint32_t value) {this->setCmdEnable(std::vector<uint32_t>(1, value));}
+        void setCmdEnable(std::vector<uint32_t> channels);
+        void disableCmd() {this->setCmdEnable(std::vector<uint32_t>());}
+        uint32_t getCmdEnable();
+        void maskCmdEnable(uint32_t value, uint32_t mask);
 
         void setTrigEnable(uint32_t value);
-        uint32_t getTrigEnable() {return triggerProc.joinable() || !m_com->isEmpty();}
+        uint32_t getTrigEnable() {return triggerProc.joinable() || !this->isCmdEmpty();}
         void maskTrigEnable(uint32_t value, uint32_t mask) {}
 
         void setTrigConfig(enum TRIG_CONF_VALUE cfg) {}
@@ -51,12 +63,9 @@ class EmuTxCore : virtual public TxCore {
 
         void toggleTrigAbort() {}
 
-        bool isCmdEmpty() {
-            bool rtn = m_com->isEmpty();
-            return rtn;
-        }
+        bool isCmdEmpty();
         bool isTrigDone() {
-            bool rtn = !trigProcRunning && m_com->isEmpty();
+            bool rtn = !trigProcRunning && this->isCmdEmpty();
             return rtn;
         }
 
@@ -67,7 +76,11 @@ class EmuTxCore : virtual public TxCore {
         void resetTriggerLogic() {}
 
     private:
-        EmuCom *m_com;
+        std::multimap<uint32_t, EmuCom*> m_coms;
+        std::vector<uint32_t> m_enabled;
+        /// Distinct coms of the enabled channels
+        std::vector<EmuCom*> m_enabledComs;
+        void updateEnabledComs();
 
         unsigned m_trigCnt;
         std::mutex accMutex;
@@ -79,15 +92,14 @@ class EmuTxCore : virtual public TxCore {
 };
 
 template<class FE>
-EmuTxCore<FE>::EmuTxCore(EmuCom *com) {
-    m_com = com;
+EmuTxCore<FE>::EmuTxCore(EmuCom *com) : m_enabled(1, 0) {
     m_trigCnt = 0;
     trigProcRunning = false;
+    this->setCom(com);
 }
 
 template<class FE>
-EmuTxCore<FE>::EmuTxCore() {
-    m_com = NULL;
+EmuTxCore<FE>::EmuTxCore() : m_enabled(1, 0) {
     m_trigCnt = 0;
     trigProcRunning = false;
 }
@@ -95,10 +107,90 @@ EmuTxCore<FE>::EmuTxCore() {
 template<class FE>
 EmuTxCore<FE>::~EmuTxCore() {}
 
+template<class FE>
+void EmuTxCore<FE>::setCom(uint32_t channel, EmuCom *com) {
+    m_coms.erase(channel);
+    m_coms.emplace(channel, com);
+    this->updateEnabledComs();
+}
+
+template<class FE>
+void EmuTxCore<FE>::addCom(uint32_t channel, EmuCom *com) {
+    auto range = m_coms.equal_range(channel);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == com) return;
+    }
+    m_coms.emplace(channel, com);
+    this->updateEnabledComs();
+}
+
+template<class FE>
+EmuCom* EmuTxCore<FE>::getCom(uint32_t channel) {
+    auto it = m_coms.lower_bound(channel);
+    return (it == m_coms.end() || it->first != channel) ? NULL : it->second;
+}
+
+template<class FE>
+void EmuTxCore<FE>::updateEnabledComs() {
+    m_enabledComs.clear();
+    for (uint32_t channel : m_enabled) {
+        auto range = m_coms.equal_range(channel);
+        for (auto it = range.first; it != range.second; ++it) {
+            EmuCom *com = it->second;
+            if (std::find(m_enabledComs.begin(), m_enabledComs.end(), com) == m_enabledComs.end()) {
+                m_enabledComs.push_back(com);
+            }
+        }
+    }
+}
+
+template<class FE>
+void EmuTxCore<FE>::setCmdEnable(std::vector<uint32_t> channels) {
+    m_enabled = channels;
+    this->updateEnabledComs();
+}
+
+template<class FE>
+uint32_t EmuTxCore<FE>::getCmdEnable() {
+    uint32_t mask = 0;
+    for (uint32_t channel : m_enabled) {
+        if (channel < 32) mask |= (1 << channel);
+    }
+    return mask;
+}
+
+template<class FE>
+void EmuTxCore<FE>::maskCmdEnable(uint32_t value, uint32_t mask) {
+    std::vector<uint32_t> channels;
+    for (uint32_t channel : m_enabled) {
+        if (channel >= 32 || !((mask >> channel) & 0x1)) channels.push_back(channel);
+    }
+    for (uint32_t channel = 0; channel < 32; channel++) {
+        if ((mask >> channel) & (value >> channel) & 0x1) channels.push_back(channel);
+    }
+    this->setCmdEnable(channels);
+}
+
 template<class FE>
 void EmuTxCore<FE>::writeFifo(uint32_t value) {
-    // TODO need to check channel
-    m_com->write32(value);
+    for (EmuCom *com : m_enabledComs) {
+        com->write32(value);
+    }
+}
+
+template<class FE>
+void EmuTxCore<FE>::writeFifoBlock(const uint32_t *words, size_t count) {
+    for (EmuCom *com : m_enabledComs) {
+        com->writeBlock32(words, count);
+    }
+}
+
+template<class FE>
+bool EmuTxCore<FE>::isCmdEmpty() {
+    for (EmuCom *com : m_enabledComs) {
+        if (!com->isEmpty()) return false;
+    }
+    return true;
 }
 
 template<class FE>
@@ -14,17 +14,19 @@
 #include "EmuShm.h"
 #include "EmuCom.h"
 #include "Gauss.h"
-#include "PixelModel.h"
+#include "PixelArray.h"
 #include "FrontEndGeometry.h"
 
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 class Fei4Emu {
     public:
+        /// Random numbers of a seeded run are derived from the seed and the channel
         Fei4Emu(std::string output_model_cfg, std::string input_model_cfg,
-                EmuCom * rx, EmuCom * tx);
+                EmuCom * rx, EmuCom * tx, uint32_t channel = 0);
         ~Fei4Emu();
 
         // the main loop which recieves commands from yarr
@@ -38,7 +40,9 @@ class Fei4Emu {
         void handleGlobalPulse(uint32_t chipid);
 
         // functions for dealing with sending data to yarr
+        // records are collected and written to the rx ring in one block
         void pushOutput(uint32_t value);
+        void flushOutput();
 
         // Call getFeStream() to see response from FE
         void decodeCommand(uint8_t* cmdStream, std::size_t size);
@@ -46,7 +50,9 @@ class Fei4Emu {
         // Only public function so far: to be moved to private once command decoder is fully implemented
         void addRandomHits(uint32_t nHits);
 
+        /// Poisson distributed hits on random enabled pixels, in every triggered event
         void addPhysicsHits();
+        void setPhysicsHits(double meanPerTrigger) { m_physicsHits = meanPerTrigger; }
 
         /// Adds hit to output
         /// @tot1, @tot2: expressed in "real" terms (connected to ToT code later)
@@ -83,9 +89,23 @@ class Fei4Emu {
         uint32_t m_l1IdCnt;
         uint32_t m_bcIdCnt;
 
-	PixelModel* m_pixelModelObjects[80][336];
+	PixelArray m_pixels;
 	void initializePixelModelsFromFile(std::string json_file_path);
 
+        // enabled pixels of the selected double columns, rebuilt after configuration
+        PixelArray::Selection m_injectables;
+        bool m_injectablesValid;
+        std::vector<uint8_t> m_tots;
+        void updateInjectables();
+
+        // mean number of physics hits per trigger, none if 0
+        double m_physicsHits;
+
+        // noise and random hits of this chip, independent of the thread drawing them
+        Gauss::Generator m_gen;
+
+        std::vector<uint32_t> m_outBuffer;
+
         // this is the file path to output the pixel model configuration
         std::string m_output_model_cfg;
 
@@ -0,0 +1,72 @@
+#ifndef PIXEL_ARRAY_H
+#define PIXEL_ARRAY_H
+
+// #################################
+// # Project: Yarr
+// # Description: Analog pixel response of the emulators
+// # Comment: Per pixel parameters are kept as one array each, pixels to be
+// #          injected are gathered into contiguous arrays once per configuration
+// ################################
+
+#include <cstdint>
+#include <vector>
+
+#include "Gauss.h"
+
+class PixelArray {
+    public:
+        /// Linear model of one front-end flavour, the same for all of its pixels
+        struct Response {
+            /// Threshold charge from the smeared global threshold DAC
+            float thrOffset;
+            float thrSlope;
+            /// Shift of the threshold DAC per TDAC step away from the centre
+            float tdacCenter;
+            float tdacStep;
+            /// ToT from the charge above threshold
+            float totOffset;
+            float totGain;
+            uint8_t totMax;
+            /// ToT code of an injected pixel which stays below threshold
+            uint8_t noHit;
+        };
+
+        /// Pixels to inject with the parameters gathered in selection order
+        struct Selection {
+            std::vector<uint32_t> pixels;
+            std::vector<float> threshold;
+            std::vector<float> noise;
+            std::vector<float> charge;
+
+            void clear();
+            unsigned size() const { return pixels.size(); }
+        };
+
+        PixelArray(unsigned nCol, unsigned nRow);
+
+        /// vthGain is the smeared gain of the global threshold DAC of the pixel
+        void setPixel(unsigned col, unsigned row, float vthGain, float noiseSigma);
+
+        unsigned index(unsigned col, unsigned row) const { return col*m_nRow + row; }
+        unsigned col(uint32_t index) const { return index/m_nRow; }
+        unsigned row(uint32_t index) const { return index%m_nRow; }
+
+        /// Threshold charge of a pixel for the global threshold DAC vth
+        float threshold(const Response &resp, unsigned col, unsigned row, float vth, int tdac) const;
+
+        /// Appends a pixel injected with charge to the selection
+        void select(Selection &sel, const Response &resp, unsigned col, unsigned row,
+                    float vth, int tdac, float charge) const;
+
+        /// ToT of all selected pixels for one injection. Noise is drawn from
+        /// gen in batches and the loop is written for the auto-vectorizer.
+        static void respond(const Response &resp, const Selection &sel, uint8_t *tot,
+                            Gauss::Generator &gen);
+
+    private:
+        unsigned m_nRow;
+        std::vector<float> m_vthGain;
+        std::vector<float> m_noiseSigma;
+};
+
+#endif
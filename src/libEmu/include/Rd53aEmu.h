@@ -2,19 +2,16 @@
 #define __RD53A_EMU_H__
 
 #include "Rd53aCfg.h"
-#include "AnyType.h"
-#include "ThreadPool.h"
+#include "TaskScheduler.h"
 #include "EmuShm.h"
 #include "EmuCom.h"
 #include "Gauss.h"
+#include "PixelArray.h"
 
-#include "Rd53aSyncPixelModel.h"
-#include "Rd53aLinPixelModel.h"
-#include "Rd53aDiffPixelModel.h"
-
-#include <unordered_map>
+#include <array>
+#include <deque>
 #include <memory>
-#include <future>
+#include <vector>
 #include <atomic>
 #include <chrono>
 #include <iomanip>
@@ -26,9 +23,6 @@
 //
 
 class RingBuffer;
-class Rd53aSyncPixelModel;
-class Rd53aLinPixelModel;
-class Rd53aDiffPixelModel;
 class Histo2d;
 
 class Rd53aEmu {
@@ -37,23 +31,24 @@ class Rd53aEmu {
      *
      * [[ Structure ]]
      *
-     * std::deque<uint16_t> Rd53aEmu::stream is used as the internal buffer of the command.
-     * Commands are digested in executeLoop(), and depending on the command, the corresponding
-     * strategy functions (commandFunc or triggerFunc) are called.
+     * std::deque<uint16_t> Rd53aEmu::commandStream is used as the internal buffer of the command.
+     * retrieve() moves all words available on the Tx ring buffer to it at once.
+     * Commands are digested in executeLoop(), the first byte of each word selects
+     * the command function or the trigger pattern from tables of 256 entries.
      * Used command words are popped from stream.
      *
-     * Partially these command functions can run asynchronously using std::async.
-     * 
-     * The image of the data flow is as the following diagram:
-     *
+     * Triggers are a pipeline: the hits of each triggered BC are generated on the
+     * shared task scheduler, one task per group of core columns, while further
+     * commands are decoded. The decoding thread generates the first group itself.
+     * The events are formatted and sent in trigger order by finishTrigger().
+     * Any command other than a trigger or a Noop first waits for the triggers in flight,
+     * as does an empty command stream.
      *
-     *                                                     +--> commandFunc (e.g. ECR) -->--+
-     *                                   [Rd53aEmu]        |                                |
-     * (Tx ring buffer) -->retrieve()--> (commandStream) --+--> commandFunc (e.g. Cal) -->--+--> (outWords) -->pushOutput()-->(Rx ring buffer)
-     *                                                     |                                |
-     *                                                     +--> commandFunc (e.g. Trg) -->--+
-     *                                                     |                                |
-     *                                                     +-->          ....          -->--+
+     *                                                                     +--> (pool: core columns) --+
+     *                                   [Rd53aEmu]                        |                           |
+     * (Tx ring buffer) -->retrieve()--> (commandStream) --> doTrigger() --+--> (pool: core columns) --+--> (outSlots) -->finishTrigger()-->(Rx ring buffer)
+     *                                          |                                                                          ^
+     *                                          +--> commandFunc (e.g. WrReg, RdReg) ------------------------------------>--+
      */
     
 public:
@@ -71,15 +66,15 @@ public:
         WrReg = 0x6666, RdReg = 0x6565, Noop = 0x6969, Sync = 0x817e, Zero = 0x0000
     };
 
-    /** These are ring buffers are owned by EmuController */
-    Rd53aEmu(EmuCom * rx, EmuCom * tx, std::string json_file_path);
+    /** These are ring buffers are owned by EmuController. Random numbers of a
+        seeded run are derived from the seed, the channel, the trigger and the
+        core column, whichever thread generates the hits. */
+    Rd53aEmu(EmuCom * rx, EmuCom * tx, std::string json_file_path, uint32_t channel = 0,
+             TaskScheduler& scheduler = TaskScheduler::shared());
     ~Rd53aEmu();
     
     // the main loop which recieves commands from yarr
     void executeLoop();
-    
-    /** another thread for writing out data */
-    void outputLoop();
 
     /** When set (by EmuController) shutdown executeLoop (i.e. the thread) */
     std::atomic<bool> run;
@@ -96,13 +91,8 @@ private:
 
     static constexpr unsigned n_corePixelCols = 8;
     static constexpr unsigned n_corePixelRows = 8;
-    
-    using PixelCore = std::array< std::array< anytype, n_corePixelRows>, n_corePixelCols> ;
-
-    template<unsigned CoreCols, unsigned CoreRows>
-    using PixelCoreArray = std::array< std::array< PixelCore, CoreRows>, CoreCols>;
 
-    /** PixelCoreArray is the 2-dim array of PixelCores */
+    /** The matrix is a 2-dim array of PixelCores */
 
     static constexpr unsigned n_coreCols = 50;
     static constexpr unsigned n_coreRows = 24;
@@ -181,7 +171,6 @@ private:
     
     /** Concrete implementations */
     using CommandFunc = void(*)( Rd53aEmu* );
-    using TriggerFunc = void(*)( Rd53aEmu*, const uint8_t, const uint8_t );
 
     inline static void doNoop        ( Rd53aEmu* );
     inline static void doECR         ( Rd53aEmu* );
@@ -197,19 +186,22 @@ private:
     inline static void doTrigger     ( Rd53aEmu*, const uint8_t /*pattern*/, const uint8_t /*tag*/ );
 
     
-    /** Container of the command and trigger (static) functions
-        as function tables.
+    /** Command functions and trigger patterns by the first byte of the command word.
+        A command also has to match in the second byte, the pattern is 0 for no trigger.
      */
-    static const std::unordered_map<enum Commands, CommandFunc> commandFuncs;
-    static const std::unordered_map<enum Triggers, uint8_t>     triggerPatterns;
+    struct CommandEntry {
+        uint16_t    word;
+        CommandFunc func;
+    };
+    static const std::array<CommandEntry, sizeOf8bit> commandFuncs;
+    static const std::array<uint8_t, sizeOf8bit>      triggerPatterns;
 
-    std::map<enum Triggers, unsigned> triggerCounters;
+    /** Counters by trigger pattern and by tag */
+    std::array<unsigned, 16>          triggerCounters;
     std::map<unsigned, unsigned>      triggerTagCounters;
 
-    /** This part of WrReg process will run asynchronously with threads
-        Concurrent running helps speed-up a little.
-     */
-    static void writeRegAsync( Rd53aEmu*, const uint16_t /*data*/, const uint32_t /*address*/);
+    /** Register write, the configuration is only changed with no triggers in flight */
+    static void writeReg( Rd53aEmu*, const uint16_t /*data*/, const uint32_t /*address*/);
     /** Function for assembling the register frame to be pushed to Rx
      */
     static std::pair<uint32_t, uint32_t> assembleRegFrame( Rd53aEmu*, const uint16_t /*address*/, const uint8_t /*zz*/, const uint8_t /*status*/ );
@@ -217,12 +209,6 @@ private:
      */
     static std::array<uint32_t, 3> readIDAddrData( Rd53aEmu*, Rd53aEmu::Commands /*command*/ );
     static void popCmd( Rd53aEmu* , const unsigned /*size*/ );
-    /** This part of trigger process will run asynchronously with threads
-        Concurrent running helps speed-up a little.
-     */
-    void triggerAsync0( const uint32_t /*tag*/);
-    void triggerAsync1( const uint32_t /*tag*/, const unsigned /*coreCol*/);
-    void triggerAsync2( const uint32_t /*tag*/, const unsigned /*coreCol*/, const unsigned /*coreRow*/);
 
 
     /** Parameters for analog FE */
@@ -250,7 +236,12 @@ private:
     // Pixel geometries
     //
 
-    PixelCoreArray<n_coreCols, n_coreRows> m_coreArray;
+    /** Analog FE parameters of all pixels, the flavour is given by the core column:
+        Core column [ 0:15]: Sync
+        Core column [16:32]: Linear
+        Core column [33:49]: Differential
+     */
+    PixelArray m_pixels;
 
 
     
@@ -272,24 +263,46 @@ private:
     std::deque<uint16_t> commandStream;
     
 
-    /**
-     * Temporary output word candidate storatege
+    /** Hits of one triggered BC, collected per core column as
+        ((position << 2 | pixel in region) << 32 | word) so that only actual hits
+        are sorted and emitted. A core column is only filled by the one task
+        generating it, so no locking is needed.
      */
+    struct HitSlot {
+        std::array< std::vector<uint64_t>, n_coreCols > coreColHits;
+    };
 
-    std::mutex queue_mutex;
-    std::condition_variable condition;
-    
-    // first = trigger tag, second = output words
-    std::map< uint32_t, std::array<uint32_t, 400*192/4> > outWords;
-    std::deque<uint32_t> outTags;
-    //std::vector<uint32_t> outWords;
+    /** Triggered BCs in flight, in order, each with its own slot */
+    static constexpr unsigned n_tagSlots = 32;
+    std::array<HitSlot, n_tagSlots> outSlots;
+
+    struct PendingTrigger {
+        PendingTrigger( TaskScheduler& scheduler, unsigned s, uint32_t h )
+            : slot( s ), header( h ), tasks( scheduler ) {}
+        unsigned  slot;
+        uint32_t  header;
+        TaskGroup tasks;
+    };
+    std::deque<PendingTrigger> pendingTriggers;
+    unsigned                   triggerSeq;
+
+    /** Queues the hit generation of one triggered BC */
+    void submitTrigger( const uint32_t /*tag*/ );
+    /** Waits for the oldest trigger in flight and sends its event */
+    void finishTrigger();
+    void finishTriggers() { while( !pendingTriggers.empty() ) finishTrigger(); }
+
+    /** Header and hit words of one trigger, written to Rx in one block */
+    std::vector<uint32_t> outBuffer;
     
 
     /** Emulator receives commands from the Ring buffer by 32bit words.
-        This function pushes back the command words as a format of
-        16bit data to the deque defined above.
+        This function pushes back all available command words as a format of
+        16bit data to the deque defined above, waiting for at least one.
+        Returns false if the emulator was stopped while waiting.
     */
-    void retrieve();
+    bool retrieve();
+    std::vector<uint32_t> retrieveBuffer;
 
     // functions for dealing with sending data to yarr
     void pushOutput(uint32_t value);
@@ -317,10 +330,15 @@ private:
     uint32_t l1id;
     uint32_t bcid;
 
-    /** container for async processing */
-    std::unique_ptr<ThreadPool>     m_pool;
-    std::unique_ptr<ThreadPool>     m_pool2;
-    std::vector<std::future<void> > m_async;
+    /** Pixels enabled for injection per core column, rebuilt after register writes
+        before the next trigger is submitted */
+    std::array<PixelArray::Selection, n_coreCols> injectables;
+    bool                                          injectablesValid;
+
+    /** Hit generation of the triggers, shared with the rest of the process */
+    TaskScheduler&                  m_scheduler;
+    unsigned                        m_colsPerTask;
+    uint32_t                        m_channel;
     
     
     /** Temporary used to keep records of hits, */
@@ -344,20 +362,20 @@ private:
     //
 
     /** Analog FE calculations */
-    
-    uint32_t calculateToT( Rd53aLinPixelModel&  /*analogFE*/, int /*TDAC*/  );
-    uint32_t calculateToT( Rd53aDiffPixelModel& /*analogFE*/, int /*TDAC*/  );
-    uint32_t calculateToT( Rd53aSyncPixelModel& /*analogFE*/, int /*TDAC*/  );
-    
 
-    template<class PIXEL>
-    void calculateSignal( anytype& pixel, const uint32_t coreCol, const uint32_t coreRow, const uint32_t subCol, const uint32_t subRow, uint32_t tag );
+    static const PixelArray::Response& response( const unsigned /*coreCol*/ );
+
+    /** Gathers the parameters of the pixels enabled for injection */
+    void updateInjectables();
+
+    /** Injects all selected pixels of a core column at once into an output slot */
+    void injectCoreColumn( const unsigned /*seq*/, const unsigned /*slot*/, const unsigned /*coreCol*/ );
 
     /**
      * This function creates the encoded hit words
      * and store it to the temporary output buffer
      */
-    void formatWords( const uint32_t /*coreCol*/, const uint32_t /*coreRow*/, const uint32_t /*subcol*/, const uint32_t /*subrow*/, uint32_t /*ToT*/, uint32_t /*tag*/ );
+    void formatWords( const uint32_t /*coreCol*/, const uint32_t /*coreRow*/, const uint32_t /*subcol*/, const uint32_t /*subrow*/, uint32_t /*ToT*/, unsigned /*slot*/ );
     
 };
 
@@ -2,51 +2,77 @@
  * Author: N. Whallon <alokin@uw.edu>
  * Date: 2017-VI
  * Description: a class to facilitate communication between programs using a typical buffer
+ *
+ * Lock-free for exactly one writing and one reading thread. Read and write
+ * positions count words and are only wrapped when indexing the buffer.
  */
 
 #ifndef RINGBUFFER
 #define RINGBUFFER
 
 #include <cstdint>
-#include <mutex>
 #include <atomic>
 #include <condition_variable>
-#include <semaphore.h>
+#include <memory>
+#include <mutex>
 
 #include "EmuCom.h"
 
 class RingBuffer : public EmuCom {
 	public:
+		// size is the capacity in words, rounded up to a power of two
 		RingBuffer(uint32_t size);
 		virtual ~RingBuffer();
 
-		uint32_t * buffer;
-
-		uint32_t ringbuffer_size;	// in bytes
-
-		// this is the size of the elements in the buffer/array
-		uint32_t element_size;
-
-		// these indicate the index in the ring buffer where the write and read "cursors" are
-		std::atomic<std::uint32_t> write_index;
-		std::atomic<std::uint32_t> read_index;
-
-		std::mutex mtx;
-		std::condition_variable cv;
-
-                sem_t read_sem;
-                sem_t write_sem;
-
 		// the main functionality of the class - write to and read from the ring buffer
+		// write32/writeBlock32 wait for free space, read32 waits for data
 		virtual void write32(uint32_t word);
+		virtual void writeBlock32(const uint32_t *buf, uint32_t length);
 		virtual uint32_t read32();
+		// Reads exactly length words, returns 0 without reading if fewer are available
 		virtual uint32_t readBlock32(uint32_t *buf, uint32_t length);
 
+		// Sleeps on a condition variable, the producer only notifies while
+		// the consumer is waiting
+		virtual bool waitForData(std::chrono::microseconds timeout);
+
+		// Non-blocking, transfer as many words as possible and return how many
+		uint32_t tryWriteBlock32(const uint32_t *buf, uint32_t length);
+		uint32_t tryReadBlock32(uint32_t *buf, uint32_t length);
+
 		// useful utility functions
 		virtual bool isEmpty();
+		// in bytes
 		virtual uint32_t getCurSize();
+		uint32_t getCapacity() const {return capacity;}
 		virtual void dump();
+
 	private:
+		static const unsigned cacheLine = 64;
+
+		std::unique_ptr<uint32_t[]> buffer;
+		uint32_t capacity;
+		uint32_t mask;
+
+		// Written by the producer only, with its last view of read_index
+		alignas(cacheLine) std::atomic<uint64_t> write_index;
+		uint64_t cached_read_index;
+
+		// Written by the consumer only, with its last view of write_index
+		alignas(cacheLine) std::atomic<uint64_t> read_index;
+		uint64_t cached_write_index;
+
+		char padding[cacheLine - sizeof(std::atomic<uint64_t>) - sizeof(uint64_t)];
+
+		// For waitForData, off the fast path
+		std::atomic<bool> consumer_waiting;
+		std::mutex wait_mutex;
+		std::condition_variable data_cv;
+
+		uint32_t freeWords(uint32_t wanted);
+		uint32_t usedWords(uint32_t wanted);
+		void copyIn(uint64_t pos, const uint32_t *buf, uint32_t length);
+		void copyOut(uint64_t pos, uint32_t *buf, uint32_t length);
 };
 
 #endif
@@ -13,6 +13,7 @@
 #include <iterator>
 #include <algorithm>
 #include <bitset>
+#include <vector>
 
 class EmuCom;
 
@@ -29,9 +30,14 @@ public:
         ABCFullTransRegRd = 11, ABCHPR = 13, HCCHPR = 14
     };
     
-    /** These are ring buffers are owned by EmuController */
+    /** These are ring buffers are owned by EmuController
+     *
+     * Emulates one HCCStar and the ABCStars on its inputs, in the order of
+     * the IDs given
+     */
     StarEmu(ClipBoard<RawData> &rx, EmuCom * tx, std::string json_file_path,
-            unsigned);
+            unsigned hpr_period, unsigned hccID=15,
+            const std::vector<unsigned> &abcIDs={15});
     ~StarEmu();
 
     // the main loop which recieves commands from yarr
@@ -68,8 +74,9 @@ private:
     /// Decode LCB command
     void DecodeLCB(LCB::Frame);
 
-    /// Register R/W commands
-    void doRegReadWrite(LCB::Frame);
+    /// Register R/W commands, K2 Start/End and the frames in between
+    void doRegStartEnd(uint8_t);
+    void doRegData(uint16_t);
     void execute_command_sequence();
     void writeRegister(const uint32_t, const uint8_t, bool isABC=false,
                        const unsigned ABCID=0);
@@ -102,7 +109,6 @@ private:
     uint8_t getEventBCID(uint8_t cmdBC);
     
     void addClusters(std::vector<std::vector<uint16_t>>&, unsigned, uint8_t);
-    uint16_t clusterFinder_sub(uint64_t&, uint64_t&, bool);
     std::vector<uint16_t> clusterFinder(const StripData&,
                                         const uint8_t maxCluster=63);
     void generateFEData_StaticTest(unsigned ichip);
@@ -116,8 +122,6 @@ private:
 
     /// Utilities
     bool getParity_8bits(uint8_t);
-    bool getBit_128b(uint8_t, uint64_t, uint64_t);
-    void setBit_128b(uint8_t, bool, uint64_t&, uint64_t&);
     
     ////////////////////////////////////////
     EmuCom * m_txRingBuffer;
@@ -158,6 +162,8 @@ private:
     ////////////////////////////////////////
     // Analog FE
     std::array<StripModel, NStrips> m_stripArray;
+    // Random numbers of this HCC, derived from the seed and the HCC ID
+    Gauss::Generator m_gen;
 };
 
 #endif //__STAR_EMU_H__
@@ -3,6 +3,8 @@
 
 #include <cstdint>
 
+#include "Gauss.h"
+
 class StripModel {
   public:
     StripModel();
@@ -10,14 +12,15 @@ class StripModel {
 
     void setValue(float, float, float, float);
     
-    float calculateThreshold(uint8_t BVT, uint8_t TrimDAC, uint8_t TrimRange);
-    float calculateBVT(uint8_t BVT);
+    // The smearing and the noise are drawn from gen
+    float calculateThreshold(uint8_t BVT, uint8_t TrimDAC, uint8_t TrimRange, Gauss::Generator &gen);
+    float calculateBVT(uint8_t BVT, Gauss::Generator &gen);
     float calculateTrimDAC(uint8_t TrimDAC, uint8_t TrimRange);
     
-    float calculateNoise();
+    float calculateNoise(Gauss::Generator &gen);
     static float calculateInjection(uint16_t BCAL);
 
-    bool calculateHit(uint16_t BCAL, uint8_t BVT, uint8_t TrimDAC, uint8_t TrimRange);
+    bool calculateHit(uint16_t BCAL, uint8_t BVT, uint8_t TrimDAC, uint8_t TrimRange, Gauss::Generator &gen);
 
     static float gain_function(float charge);
     
@@ -0,0 +1,142 @@
+// #################################
+// # Project: Yarr
+// # Description: Connected component clustering of pixel hits
+// # Comment:
+// ################################
+
+#include "ClusterFinder.h"
+
+#include <algorithm>
+#include <limits>
+
+ClusterFinder::ClusterFinder(unsigned colDist, unsigned rowDist, bool diagonal)
+    : gridCols(0), gridRows(0) {
+    for (int dc=0; dc<=(int)colDist; dc++) {
+        for (int dr=-(int)rowDist; dr<=(int)rowDist; dr++) {
+            if (dc == 0 && dr <= 0)
+                continue;
+            if (!diagonal && dc != 0 && dr != 0)
+                continue;
+            dCols.push_back(dc);
+            dRows.push_back(dr);
+        }
+    }
+}
+
+unsigned ClusterFinder::findRoot(unsigned i) {
+    // Path halving
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void ClusterFinder::merge(unsigned a, unsigned b) {
+    a = this->findRoot(a);
+    b = this->findRoot(b);
+    if (a == b)
+        return;
+    // Union by size
+    if (size[a] < size[b])
+        std::swap(a, b);
+    parent[b] = a;
+    size[a] += size[b];
+}
+
+void ClusterFinder::find(const Fei4Hit *hits, unsigned n) {
+    clusters.clear();
+    labels.resize(n);
+    if (n == 0)
+        return;
+
+    unsigned maxCol = 0;
+    unsigned maxRow = 0;
+    for (unsigned i=0; i<n; i++) {
+        maxCol = std::max(maxCol, (unsigned)hits[i].col);
+        maxRow = std::max(maxRow, (unsigned)hits[i].row);
+    }
+    // Only grows, the grid is all zero here so it can be reshaped freely
+    if (maxCol >= gridCols || maxRow >= gridRows) {
+        gridCols = std::max(gridCols, maxCol+1);
+        gridRows = std::max(gridRows, maxRow+1);
+        grid.assign(gridCols*gridRows, 0);
+    }
+
+    parent.resize(n);
+    size.assign(n, 1);
+    for (unsigned i=0; i<n; i++) {
+        parent[i] = i;
+    }
+
+    // Place hits, repeated hits on one pixel always belong together
+    for (unsigned i=0; i<n; i++) {
+        uint32_t &cell = grid[hits[i].col*gridRows + hits[i].row];
+        if (cell) {
+            this->merge(i, cell-1);
+        } else {
+            cell = i+1;
+        }
+    }
+
+    for (unsigned i=0; i<n; i++) {
+        for (unsigned k=0; k<dCols.size(); k++) {
+            int col = (int)hits[i].col + dCols[k];
+            int row = (int)hits[i].row + dRows[k];
+            if (col >= (int)gridCols || row < 0 || row >= (int)gridRows)
+                continue;
+            uint32_t cell = grid[col*gridRows + row];
+            if (cell)
+                this->merge(i, cell-1);
+        }
+    }
+
+    for (unsigned i=0; i<n; i++) {
+        grid[hits[i].col*gridRows + hits[i].row] = 0;
+    }
+
+    // Label and accumulate in one pass, size[] is reused as root -> label map
+    const unsigned none = std::numeric_limits<unsigned>::max();
+    for (unsigned i=0; i<n; i++) {
+        if (parent[i] == i)
+            size[i] = none;
+    }
+    for (unsigned i=0; i<n; i++) {
+        unsigned root = this->findRoot(i);
+        const Fei4Hit &hit = hits[i];
+        if (size[root] == none) {
+            size[root] = clusters.size();
+            clusters.push_back({0, 0, 0, 0, hit.col, hit.col, hit.row, hit.row});
+        }
+        unsigned label = size[root];
+        labels[i] = label;
+
+        Cluster &c = clusters[label];
+        c.nHits++;
+        c.sumTot += hit.tot;
+        c.col += (double)hit.col*hit.tot;
+        c.row += (double)hit.row*hit.tot;
+        c.minCol = std::min(c.minCol, hit.col);
+        c.maxCol = std::max(c.maxCol, hit.col);
+        c.minRow = std::min(c.minRow, hit.row);
+        c.maxRow = std::max(c.maxRow, hit.row);
+    }
+
+    for (Cluster &c : clusters) {
+        if (c.sumTot > 0) {
+            c.col /= c.sumTot;
+            c.row /= c.sumTot;
+        } else {
+            c.col = 0;
+            c.row = 0;
+        }
+    }
+    // Unweighted fallback needs a second look at the hits of ToT-less clusters
+    for (unsigned i=0; i<n; i++) {
+        Cluster &c = clusters[labels[i]];
+        if (c.sumTot == 0) {
+            c.col += (double)hits[i].col/c.nHits;
+            c.row += (double)hits[i].row/c.nHits;
+        }
+    }
+}
@@ -14,6 +14,14 @@
 
 namespace {
     auto alog = logging::make_log("Fei4Analysis");
+
+    // Name suffix of the outer loop indices, only built when a histogram is created
+    std::string loopSuffix(const LoopStatus &stat, const std::vector<unsigned> &loops) {
+        std::string suffix;
+        for (unsigned n=0; n<loops.size(); n++)
+            suffix += "-" + std::to_string(stat.get(loops[n]));
+        return suffix;
+    }
 }
 
 namespace {
@@ -55,6 +63,7 @@ namespace {
 }
 
 void OccupancyAnalysis::init(ScanBase *s) {
+    consume(typeid(OccupancyMap*));
     createMask=true;
     n_count = 1;
     injections = 0;
@@ -94,27 +103,19 @@ void OccupancyAnalysis::init(ScanBase *s) {
 }
 
 void OccupancyAnalysis::processHistogram(HistogramBase *h) {
-    // Check if right Histogram
-    if (h->getType() != typeid(OccupancyMap*))
-        return;
-
     // Select correct output container
     unsigned ident = 0;
     unsigned offset = 0;
 
     // Determine identifier
-    std::string name = "OccupancyMap";
-    std::string name2 = "EnMask";
     for (unsigned n=0; n<loops.size(); n++) {
         ident += h->getStat().get(loops[n])+offset;
         offset += loopMax[n];
-        name += "-" + std::to_string(h->getStat().get(loops[n]));
-        name2 += "-" + std::to_string(h->getStat().get(loops[n]));
     }
 
     // Check if Histogram exists
     if (occMaps[ident] == nullptr) {
-        std::unique_ptr<Histo2d> hh(new Histo2d(name, nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this)));
+        std::unique_ptr<Histo2d> hh(new Histo2d("OccupancyMap" + loopSuffix(h->getStat(), loops), nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this)));
         hh->setXaxisTitle("Column");
         hh->setYaxisTitle("Row");
         hh->setZaxisTitle("Hits");
@@ -127,7 +128,7 @@ void OccupancyAnalysis::processHistogram(HistogramBase *h) {
     innerCnt[ident]++;
     // Got all data, finish up Analysis
     if (innerCnt[ident] == n_count) {
-        std::unique_ptr<Histo2d> mask(new Histo2d(name2, nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this)));
+        std::unique_ptr<Histo2d> mask(new Histo2d("EnMask" + loopSuffix(h->getStat(), loops), nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this)));
         mask->setXaxisTitle("Column");
         mask->setYaxisTitle("Rows");
         mask->setZaxisTitle("Enable");
@@ -157,6 +158,10 @@ void OccupancyAnalysis::loadConfig(json &j){
 }
 
 void TotAnalysis::init(ScanBase *s) {
+    consume(typeid(OccupancyMap*));
+    consume(typeid(TotMap*));
+    consume(typeid(Tot2Map*));
+    concurrent = true;
     std::shared_ptr<LoopActionBase> tmpVcalLoop(new Fei4ParameterLoop(&Fei4::PlsrDAC));
     std::shared_ptr<LoopActionBase> tmpVcalLoop2(new Fe65p2ParameterLoop(&Fe65p2::PlsrDac));
     std::shared_ptr<LoopActionBase> tmpVcalLoop3(new Rd53aParameterLoop());
@@ -235,32 +240,27 @@ void TotAnalysis::processHistogram(HistogramBase *h) {
     unsigned ident = 0;
     unsigned offset = 0;
     // Determine identifier
-    std::string name = "OccMap";
-    std::string name2 = "TotMap";
-    std::string name3 = "Tot2Map";
     for (unsigned n=0; n<loops.size(); n++) {
         ident += h->getStat().get(loops[n])+offset;
         offset += loopMax[n];
-        name += "-" + std::to_string(h->getStat().get(loops[n]));
-        name2 += "-" + std::to_string(h->getStat().get(loops[n]));
-        name3 += "-" + std::to_string(h->getStat().get(loops[n]));
     }
 
     // Check if Histogram exists
     if (occMaps[ident] == NULL) {
-        Histo2d *hh = new Histo2d(name, nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
+        std::string suffix = loopSuffix(h->getStat(), loops);
+        Histo2d *hh = new Histo2d("OccMap" + suffix, nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
         hh->setXaxisTitle("Column");
         hh->setYaxisTitle("Row");
         hh->setZaxisTitle("Hits");
         occMaps[ident].reset(hh);
         occInnerCnt[ident] = 0;
-        hh = new Histo2d(name2, nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
+        hh = new Histo2d("TotMap" + suffix, nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
         hh->setXaxisTitle("Column");
         hh->setYaxisTitle("Row");
         hh->setZaxisTitle("{/Symbol S}(ToT)");
         totMaps[ident].reset(hh);
         totInnerCnt[ident] = 0;
-        hh = new Histo2d(name3, nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
+        hh = new Histo2d("Tot2Map" + suffix, nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
         hh->setXaxisTitle("Column");
         hh->setYaxisTitle("Row");
         hh->setZaxisTitle("{/Symbol S}(ToT^2)");
@@ -409,6 +409,8 @@ void TotAnalysis::end() {
 }
 
 void ScurveFitter::init(ScanBase *s) {
+    consume(typeid(OccupancyMap*));
+    concurrent = true;
     std::shared_ptr<LoopActionBase> tmpVcalLoop(new Fei4ParameterLoop(&Fei4::PlsrDAC));
     std::shared_ptr<LoopActionBase> tmpVcalLoop2(new Fe65p2ParameterLoop(&Fe65p2::PlsrDac));
     std::shared_ptr<LoopActionBase> tmpVcalLoop3(new Rd53aParameterLoop());
@@ -511,9 +513,6 @@ double scurveFct(double x, const double *par) {
 
 void ScurveFitter::processHistogram(HistogramBase *h) {
     cnt++;
-    // Check if right Histogram
-    if (h->getType() != typeid(OccupancyMap*))
-        return;
 
     Histo2d *hh = (Histo2d*) h;
 
@@ -537,18 +536,15 @@ void ScurveFitter::processHistogram(HistogramBase *h) {
                 unsigned ident = bin;
                 unsigned offset = nCol*nRow;
                 unsigned vcal = hh->getStat().get(vcalLoop);
-                // Determine identifier
-                std::string name = "Scurve";
-                name += "-" + std::to_string(col) + "-" + std::to_string(row);
-                // Check for other loops
+                // Determine identifier, check for other loops
                 for (unsigned n=0; n<loops.size(); n++) {
                     ident += hh->getStat().get(loops[n])+offset;
                     offset += loopMax[n];
-                    name += "-" + std::to_string(hh->getStat().get(loops[n]));
                 }
 
                 // Check if Histogram exists
                 if (histos[ident] == NULL) {
+                    std::string name = "Scurve-" + std::to_string(col) + "-" + std::to_string(row) + loopSuffix(hh->getStat(), loops);
                     Histo1d *hhh = new Histo1d(name, vcalBins+1, vcalMin-((double)vcalStep/2.0), vcalMax+((double)vcalStep/2.0), typeid(this));
                     hhh->setXaxisTitle("Vcal");
                     hhh->setYaxisTitle("Occupancy");
@@ -793,6 +789,8 @@ void ScurveFitter::end() {
 }
 
 void OccGlobalThresholdTune::init(ScanBase *s) {
+    consume(typeid(OccupancyMap*));
+    concurrent = true;
     std::shared_ptr<LoopActionBase> tmpVthinFb(new Fei4GlobalFeedback(&Fei4::Vthin_Fine));
     std::shared_ptr<LoopActionBase> tmpVthinFb2(new Fe65p2GlobalFeedback(&Fe65p2::Vthin1Dac));
     std::shared_ptr<LoopActionBase> tmpVthinFb3(new Rd53aGlobalFeedback());
@@ -844,26 +842,20 @@ void OccGlobalThresholdTune::init(ScanBase *s) {
 }
 
 void OccGlobalThresholdTune::processHistogram(HistogramBase *h) {
-    // Check if right Histogram
-    if (h->getType() != typeid(OccupancyMap*))
-        return;
-
     // Select correct output container
     unsigned ident = 0;
     unsigned offset = 0;
 
     // Determine identifier
-    std::string name = "OccupancyMap";
-    std::string name2 = "OccupancyDist";
     for (unsigned n=0; n<loops.size(); n++) {
         ident += h->getStat().get(loops[n])+offset;
         offset += loopMax[n];
-        name += "-" + std::to_string(h->getStat().get(loops[n]));
-        name2 += "-" + std::to_string(h->getStat().get(loops[n]));
     }
 
     // Check if Histogram exists
     if (occMaps[ident] == NULL) {
+        std::string name = "OccupancyMap" + loopSuffix(h->getStat(), loops);
+        std::string name2 = "OccupancyDist" + loopSuffix(h->getStat(), loops);
         Histo2d *hh = new Histo2d(name, nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
         hh->setXaxisTitle("Column");
         hh->setYaxisTitle("Row");
@@ -922,6 +914,8 @@ void OccGlobalThresholdTune::processHistogram(HistogramBase *h) {
 }
 
 void OccPixelThresholdTune::init(ScanBase *s) {
+    consume(typeid(OccupancyMap*));
+    concurrent = true;
     n_count = 1;
     for (unsigned n=0; n<s->size(); n++) {
         std::shared_ptr<LoopActionBase> l = s->getLoop(n);
@@ -973,27 +967,19 @@ void OccPixelThresholdTune::init(ScanBase *s) {
 }
 
 void OccPixelThresholdTune::processHistogram(HistogramBase *h) {
-    // Check if right Histogram
-    if (h->getType() != typeid(OccupancyMap*))
-        return;
-
     // Select correct output container
     unsigned ident = 0;
     unsigned offset = 0;
 
     // Determine identifier
-    std::string name = "OccupancyMap";
-    std::string name2 = "OccupancyDist";
     for (unsigned n=0; n<loops.size(); n++) {
         ident += h->getStat().get(loops[n])+offset;
         offset += loopMax[n];
-        name += "-" + std::to_string(h->getStat().get(loops[n]));
-        name2 += "-" + std::to_string(h->getStat().get(loops[n]));
     }
 
     // Check if Histogram exists
     if (occMaps[ident] == NULL) {
-        Histo2d *hh = new Histo2d(name, nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
+        Histo2d *hh = new Histo2d("OccupancyMap" + loopSuffix(h->getStat(), loops), nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
         hh->setXaxisTitle("Column");
         hh->setYaxisTitle("Row");
         hh->setZaxisTitle("Hits");
@@ -1008,7 +994,7 @@ void OccPixelThresholdTune::processHistogram(HistogramBase *h) {
     if (innerCnt[ident] == n_count) {
         double mean = 0;
         Histo2d *fbHisto = new Histo2d("feedback", nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
-        std::unique_ptr<Histo1d> occDist(new Histo1d(name2, injections-1, 0.5, injections-0.5, typeid(this)));
+        std::unique_ptr<Histo1d> occDist(new Histo1d("OccupancyDist" + loopSuffix(h->getStat(), loops), injections-1, 0.5, injections-0.5, typeid(this)));
         occDist->setXaxisTitle("Occupancy");
         occDist->setYaxisTitle("Number of Pixels");
         for (unsigned i=0; i<fbHisto->size(); i++) {
@@ -1038,6 +1024,8 @@ void OccPixelThresholdTune::processHistogram(HistogramBase *h) {
 
 // TODO exclude every loop
 void L1Analysis::init(ScanBase *s) {
+    consume(typeid(L1Dist*));
+    concurrent = true;
     n_count = 1;
     injections = 0;
     for (unsigned n=0; n<s->size(); n++) {
@@ -1083,16 +1071,14 @@ void L1Analysis::processHistogram(HistogramBase *h) {
     unsigned offset = 0;
 
     // Determine identifier
-    std::string name = "L1Dist";
     for (unsigned n=0; n<loops.size(); n++) {
         ident += h->getStat().get(loops[n])+offset;
         offset += loopMax[n];
-        name += "-" + std::to_string(h->getStat().get(loops[n]));
     }
 
     // Check if Histogram exists
     if (l1Histos[ident] == NULL) {
-        Histo1d *hh = new Histo1d(name, 16, -0.5, 15.5, typeid(this));
+        Histo1d *hh = new Histo1d("L1Dist" + loopSuffix(h->getStat(), loops), 16, -0.5, 15.5, typeid(this));
         hh->setXaxisTitle("L1Id");
         hh->setYaxisTitle("Hits");
         l1Histos[ident].reset(hh);
@@ -1100,12 +1086,8 @@ void L1Analysis::processHistogram(HistogramBase *h) {
     }
 
     // Add up Histograms
-    if (h->getType() == typeid(L1Dist*)) {
-        l1Histos[ident]->add(*(Histo1d*)h);
-        innerCnt[ident]++;
-    } else {
-        return;
-    }
+    l1Histos[ident]->add(*(Histo1d*)h);
+    innerCnt[ident]++;
 
     // Got all data, finish up Analysis
     if (innerCnt[ident] == n_count) {
@@ -1118,6 +1100,8 @@ void L1Analysis::end() {
 }
 
 void TotDistPlotter::init(ScanBase *s) {
+    consume(typeid(TotDist*));
+    concurrent = true;
     n_count = 1;
     injections = 0;
     std::shared_ptr<LoopActionBase> tmpVcalLoop(new Fei4ParameterLoop(&Fei4::PlsrDAC));
@@ -1156,25 +1140,19 @@ void TotDistPlotter::init(ScanBase *s) {
 }
 
 void TotDistPlotter::processHistogram(HistogramBase *h) {
-    // Check if right Histogram
-    if (h->getType() != typeid(TotDist*))
-        return;
-
     // Select correct output container
     unsigned ident = 0;
     unsigned offset = 0;
 
     // Determine identifier
-    std::string name = "TotDist";
     for (unsigned n=0; n<loops.size(); n++) {
         ident += h->getStat().get(loops[n])+offset;
         offset += loopMax[n];
-        name += "-" + std::to_string(h->getStat().get(loops[n]));
     }
 
     // Check if Histogram exists
     if (tot[ident] == NULL) {
-        Histo1d *hh = new Histo1d(name, 16, 0.5, 16.5, typeid(this));
+        Histo1d *hh = new Histo1d("TotDist" + loopSuffix(h->getStat(), loops), 16, 0.5, 16.5, typeid(this));
         hh->setXaxisTitle("ToT [bc]");
         hh->setYaxisTitle("Hits");
         tot[ident].reset(hh);
@@ -1192,6 +1170,8 @@ void TotDistPlotter::processHistogram(HistogramBase *h) {
 }
 
 void NoiseAnalysis::init(ScanBase *s) {
+    consume(typeid(OccupancyMap*));
+    consume(typeid(HitsPerEvent*));
     // We assume the nosie scan only has one trigger and data loop
     occ.reset(new Histo2d("Occupancy", nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this)));
     occ->setXaxisTitle("Col");
@@ -1226,8 +1206,7 @@ void NoiseAnalysis::end() {
     mask->setYaxisTitle("Row");
     mask->setZaxisTitle("Mask");
 
-    noiseOcc->add(&*occ);
-    noiseOcc->scale(1.0/(double)n_trigger);
+    noiseOcc->addScaled(*occ, 1.0/(double)n_trigger);
     alog->info("[{}] Received {} total trigger!", channel, n_trigger);
     double noiseThr = 1e-6; 
     for (unsigned i=0; i<noiseOcc->size(); i++) {
@@ -1247,6 +1226,8 @@ void NoiseAnalysis::end() {
 }
 
 void NoiseTuning::init(ScanBase *s) {
+    consume(typeid(OccupancyMap*));
+    concurrent = true;
     n_count = 1;
     pixelFb = NULL;
     globalFb = NULL;
@@ -1292,24 +1273,19 @@ void NoiseTuning::init(ScanBase *s) {
 }
 
 void NoiseTuning::processHistogram(HistogramBase *h) {
-    if (!(h->getType() == typeid(OccupancyMap*)))
-        return;
-
     // Select correct output container
     unsigned ident = 0;
     unsigned offset = 0;
 
     // Determine identifier
-    std::string name = "OccMap";
     for (unsigned n=0; n<loops.size(); n++) {
         ident += h->getStat().get(loops[n])+offset;
         offset += loopMax[n];
-        name += "-" + std::to_string(h->getStat().get(loops[n]));
     }
 
 
     if (occMaps[ident] == NULL) {
-        Histo2d *hh = new Histo2d(name, nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
+        Histo2d *hh = new Histo2d("OccMap" + loopSuffix(h->getStat(), loops), nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(this));
         hh->setXaxisTitle("Column");
         hh->setYaxisTitle("Row");
         hh->setZaxisTitle("Hits");
@@ -1318,7 +1294,7 @@ void NoiseTuning::processHistogram(HistogramBase *h) {
     }
 
     //Easy make it pretty
-    occMaps[ident]->add(&*(Histo2d*)h);
+    occMaps[ident]->add(*(Histo2d*)h);
     innerCnt[ident]++;
 
     if (innerCnt[ident] == n_count) {
@@ -1364,6 +1340,8 @@ void NoiseTuning::end() {
 }
 
 void DelayAnalysis::init(ScanBase *s) {
+    consume(typeid(L13d*));
+    concurrent = true;
     std::shared_ptr<LoopActionBase> tmpVcalLoop(new Rd53aParameterLoop());
     scan = s;
     n_count = nCol*nRow;
@@ -1415,10 +1393,6 @@ void DelayAnalysis::init(ScanBase *s) {
 }
 
 void DelayAnalysis::processHistogram(HistogramBase *h) {
-    // Check if right Histogram
-    if (h->getType() != typeid(L13d*))
-        return;
-
 
     Histo3d *hh = (Histo3d*) h;
     for(unsigned l1=0; l1<16; l1++) { //TODO hardcoded l1
@@ -1430,9 +1404,6 @@ void DelayAnalysis::processHistogram(HistogramBase *h) {
                     // Select correct output containe
                     unsigned ident = (row-1)+((col-1)*(nRow));
                     unsigned delay = hh->getStat().get(delayLoop);
-                    // Determine identifier
-                    std::string name = "Delay";
-                    name += "-" + std::to_string(col) + "-" + std::to_string(row);
                     // Check for other loops
                     /*
                        unsigned outerIdent = 0;
@@ -1448,6 +1419,7 @@ void DelayAnalysis::processHistogram(HistogramBase *h) {
 
                     // Check if Histogram exists
                     if (histos[ident] == NULL) {
+                        std::string name = "Delay-" + std::to_string(col) + "-" + std::to_string(row);
                         Histo1d *hhh = new Histo1d(name, 256, -0.5, 255.5, typeid(this)); // TODO hardcoded
                         hhh->setXaxisTitle("Delay");
                         hhh->setYaxisTitle("Occupancy");
@@ -1,19 +1,77 @@
 #include "Fei4EventData.h"
 
+#include "ClusterFinder.h"
+#include "Varint.h"
+
 #include <fstream>
 #include <iostream>
 #include <list>
 
+namespace {
+    template<typename T>
+    void put(std::vector<char> &buf, const T &value) {
+        const char *bytes = (const char*)&value;
+        buf.insert(buf.end(), bytes, bytes + sizeof(T));
+    }
+}
+
 void Fei4Event::toFileBinary(std::fstream &handle) const {
-    handle.write((char*)&tag, sizeof(uint32_t));
-    handle.write((char*)&l1id, sizeof(uint16_t));
-    handle.write((char*)&bcid, sizeof(uint16_t));
-    handle.write((char*)&nHits, sizeof(uint16_t));
-    for (auto hit : hits) {
-        handle.write((char*)&hit, sizeof(Fei4Hit));
+    static thread_local std::vector<char> buf;
+    buf.clear();
+    this->toBuffer(buf);
+    handle.write(buf.data(), buf.size());
+}
+
+void Fei4Event::toBuffer(std::vector<char> &buf) const {
+    put(buf, tag);
+    put(buf, l1id);
+    put(buf, bcid);
+    put(buf, nHits);
+    for (const Fei4Hit &hit : hits) {
+        put(buf, hit);
     }
 }
 
+void Fei4Event::toBufferCompact(std::vector<char> &buf) const {
+    Varint::put(buf, tag);
+    Varint::put(buf, l1id);
+    Varint::put(buf, bcid);
+    Varint::put(buf, nHits);
+    int32_t col = 0, row = 0;
+    for (const Fei4Hit &hit : hits) {
+        Varint::putSigned(buf, (int32_t)hit.col - col);
+        Varint::putSigned(buf, (int32_t)hit.row - row);
+        Varint::put(buf, hit.tot);
+        col = hit.col;
+        row = hit.row;
+    }
+}
+
+size_t Fei4Event::fromBufferCompact(const char *buf, size_t size) {
+    const char *pos = buf;
+    const char *end = buf + size;
+    uint32_t t_tag, t_l1id, t_bcid, t_hits;
+    if (!Varint::get(pos, end, t_tag) || !Varint::get(pos, end, t_l1id) ||
+        !Varint::get(pos, end, t_bcid) || !Varint::get(pos, end, t_hits)) {
+        return 0;
+    }
+    tag = t_tag;
+    l1id = t_l1id;
+    bcid = t_bcid;
+    int32_t col = 0, row = 0;
+    for (unsigned i=0; i<t_hits; i++) {
+        int32_t dcol, drow;
+        uint32_t tot;
+        if (!Varint::getSigned(pos, end, dcol) || !Varint::getSigned(pos, end, drow) || !Varint::get(pos, end, tot)) {
+            return 0;
+        }
+        col += dcol;
+        row += drow;
+        this->addHit(row, col, tot);
+    }
+    return pos - buf;
+}
+
 void Fei4Event::fromFileBinary(std::fstream &handle) {
     uint16_t t_hits = 0;
     handle.read((char*)&tag, sizeof(uint32_t));
@@ -31,44 +89,24 @@ void Fei4Event::doClustering() {
     // No hits = no cluster
     if (nHits == 0)
         return ;
-    // Create "copy" of hits
-    std::list<Fei4Hit*> unclustered;
+
+    // Hits up to one pixel gap apart belong to the same cluster
+    static thread_local ClusterFinder finder(2, 2);
+    static thread_local std::vector<Fei4Hit> contiguous;
+    static thread_local std::vector<Fei4Hit*> pointers;
+    contiguous.assign(hits.begin(), hits.end());
+    pointers.clear();
     for (auto &&hit : hits) {
-        unclustered.push_back(&hit);
+        pointers.push_back(&hit);
     }
-    
-    // Create first cluster and add first hit
-    clusters.push_back(Fei4Cluster());
-    clusters.back().addHit(unclustered.front());
-    unclustered.erase(unclustered.begin());
-
-    int gap = 1;
 
-    // Loop over vector of unclustered hits until empty
-    while (!unclustered.empty()) {
-        // Loop over hits in cluster, increases as we go
-        for (unsigned i=0; i<clusters.back().nHits; i++) {
-            Fei4Hit tHit = *clusters.back().hits[i];
-            // Loop over unclustered hits
-            for (auto j = unclustered.begin() ; j != unclustered.end(); ++j) {
-                if ((abs((int)(tHit.col) - (int)(*j)->col) <= (1+gap))
-                 && (abs((int)(tHit.row) - (int)(*j)->row) <= (1+gap))) {
-                    // If not more than 1 pixel gap, add to cluster
-                    clusters.back().addHit(*j);
-                    unclustered.erase(j--);
-                }
-            }
-        }
-        // Still hits to be clustered, create new cluster
-        if (!unclustered.empty()) {
-            clusters.push_back(Fei4Cluster());
-            clusters.back().addHit(unclustered.front());
-            unclustered.erase(unclustered.begin());
-        }
+    finder.find(contiguous);
+    clusters.clear();
+    clusters.resize(finder.getClusters().size());
+    const std::vector<unsigned> &labels = finder.getLabels();
+    for (unsigned i=0; i<pointers.size(); i++) {
+        clusters[labels[i]].addHit(pointers[i]);
     }
-    // All clustered
-        
-    
 }
 
 void Fei4Data::toFile(std::string filename) {
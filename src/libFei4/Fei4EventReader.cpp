@@ -0,0 +1,107 @@
+#include "Fei4EventReader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Varint.h"
+
+namespace {
+    const size_t plainHeaderSize = sizeof(uint32_t) + 3*sizeof(uint16_t);
+}
+
+Fei4EventReader::Fei4EventReader(const std::string &filename)
+    : m_data(NULL), m_size(0), m_begin(0), m_compact(false) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("could not open " + filename + ": " + strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("could not stat " + filename + ": " + strerror(errno));
+    }
+    m_size = st.st_size;
+    if (m_size > 0) {
+        void *ptr = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("could not map " + filename + ": " + strerror(errno));
+        }
+        m_data = (const char*)ptr;
+    }
+    // The mapping stays valid without the descriptor
+    ::close(fd);
+
+    const size_t magicSize = sizeof(Fei4EventFile::compactMagic);
+    if (m_size >= magicSize && memcmp(m_data, Fei4EventFile::compactMagic, magicSize) == 0) {
+        m_compact = true;
+        m_begin = magicSize;
+    }
+}
+
+Fei4EventReader::~Fei4EventReader() {
+    if (m_data) munmap((void*)m_data, m_size);
+}
+
+bool Fei4EventReader::header(size_t offset, Header &h) const {
+    if (!m_compact) {
+        if (offset + plainHeaderSize > m_size) return false;
+        const char *pos = m_data + offset;
+        memcpy(&h.tag, pos, sizeof(uint32_t));
+        memcpy(&h.l1id, pos + 4, sizeof(uint16_t));
+        memcpy(&h.bcid, pos + 6, sizeof(uint16_t));
+        memcpy(&h.nHits, pos + 8, sizeof(uint16_t));
+        h.hits = offset + plainHeaderSize;
+        h.next = h.hits + h.nHits*sizeof(Fei4Hit);
+        return h.next <= m_size;
+    }
+
+    const char *pos = m_data + offset;
+    const char *end = m_data + m_size;
+    uint32_t tag, l1id, bcid, nHits;
+    if (offset >= m_size || !Varint::get(pos, end, tag) || !Varint::get(pos, end, l1id) ||
+        !Varint::get(pos, end, bcid) || !Varint::get(pos, end, nHits)) {
+        return false;
+    }
+    h.tag = tag;
+    h.l1id = l1id;
+    h.bcid = bcid;
+    h.nHits = nHits;
+    h.hits = pos - m_data;
+    // Compact hits have no fixed size, skip over their bytes
+    unsigned ends = 3*nHits;
+    while (ends > 0 && pos < end) {
+        if (!(*pos++ & 0x80)) ends--;
+    }
+    h.next = pos - m_data;
+    return ends == 0;
+}
+
+void Fei4EventReader::hits(const Header &h, std::vector<Fei4Hit> &out) const {
+    if (!m_compact) {
+        size_t first = out.size();
+        out.resize(first + h.nHits);
+        memcpy(&out[first], m_data + h.hits, h.nHits*sizeof(Fei4Hit));
+        return;
+    }
+
+    const char *pos = m_data + h.hits;
+    const char *end = m_data + h.next;
+    int32_t col = 0, row = 0;
+    for (unsigned i=0; i<h.nHits; i++) {
+        int32_t dcol, drow;
+        uint32_t tot;
+        Varint::getSigned(pos, end, dcol);
+        Varint::getSigned(pos, end, drow);
+        Varint::get(pos, end, tot);
+        col += dcol;
+        row += drow;
+        out.push_back(Fei4Hit{(uint16_t)col, (uint16_t)row, (uint16_t)tot});
+    }
+}
@@ -55,12 +55,85 @@ namespace {
     bool hpe_registered =
       StdDict::registerHistogrammer("HitsPerEvent",
                                 []() { return std::unique_ptr<HistogramAlgorithm>(new HitsPerEvent());});
+
+    bool cs_registered =
+      StdDict::registerHistogrammer("ClusterSize",
+                                []() { return std::unique_ptr<HistogramAlgorithm>(new ClusterSize());});
+}
+
+namespace {
+    // Big enough to make each write cheap, small enough to be reused
+    const size_t archiveBlockSize = 1 << 20;
+}
+
+DataArchiver::DataArchiver(std::string filename, bool compact)
+    : HistogramAlgorithm(), m_compact(compact), m_done(false) {
+    r = NULL;
+    fileHandle.open(filename.c_str(), std::fstream::out | std::fstream::binary | std::fstream::trunc);
+    if (!fileHandle) {
+        alog->error("Could not open {} to archive data", filename);
+    }
+    m_block.reserve(archiveBlockSize);
+    if (m_compact) {
+        m_block.insert(m_block.end(), Fei4EventFile::compactMagic,
+                       Fei4EventFile::compactMagic + sizeof(Fei4EventFile::compactMagic));
+    }
+    m_thread = std::thread(&DataArchiver::writeLoop, this);
+}
+
+DataArchiver::~DataArchiver() {
+    this->queueBlock();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    fileHandle.close();
 }
 
 void DataArchiver::processEvent(Fei4Data *data) {
     for (const Fei4Event &curEvent: data->events) {
-        // Save Event to File
-        curEvent.toFileBinary(fileHandle);
+        if (m_compact) {
+            curEvent.toBufferCompact(m_block);
+        } else {
+            curEvent.toBuffer(m_block);
+        }
+        if (m_block.size() >= archiveBlockSize) {
+            this->queueBlock();
+        }
+    }
+}
+
+void DataArchiver::queueBlock() {
+    if (m_block.empty()) return;
+    std::vector<char> next;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_full.push_back(std::move(m_block));
+        if (!m_free.empty()) {
+            next = std::move(m_free.back());
+            m_free.pop_back();
+        }
+    }
+    m_cv.notify_one();
+    next.clear();
+    next.reserve(archiveBlockSize);
+    m_block = std::move(next);
+}
+
+void DataArchiver::writeLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [&] { return m_done || !m_full.empty(); });
+        if (m_full.empty()) break;
+        std::vector<char> block = std::move(m_full.front());
+        m_full.pop_front();
+
+        lock.unlock();
+        fileHandle.write(block.data(), block.size());
+        lock.lock();
+        m_free.push_back(std::move(block));
     }
 }
 
@@ -179,3 +252,19 @@ void HitsPerEvent::processEvent(Fei4Data *data) {
         h->fill(curEvent.nHits);
     }
 }
+
+void ClusterSize::processEvent(Fei4Data *data) {
+    for (const Fei4Event &curEvent: data->events) {
+        if (curEvent.nHits == 0)
+            continue;
+        eventHits.clear();
+        for (const Fei4Hit &curHit: curEvent.hits) {
+            if(curHit.tot > 0)
+                eventHits.push_back(curHit);
+        }
+        finder.find(eventHits);
+        for (const ClusterFinder::Cluster &cluster: finder.getClusters()) {
+            h->fill(cluster.nHits);
+        }
+    }
+}
@@ -8,6 +8,9 @@
 
 #include "Fei4PixelCfg.h"
 
+#include <algorithm>
+#include <vector>
+
 void DoubleColumnBit::set(const uint32_t *bitstream) {
     for(unsigned i=0; i<n_Words; i++)
         storage[i] = bitstream[i];
@@ -193,17 +196,26 @@ unsigned Fei4PixelCfg::getFDAC(unsigned col, unsigned row) {
 
 
 void Fei4PixelCfg::toFileJson(json &j) {
-    // Layout is one array per column
+    // Layout is one array per row, whole arrays are assigned at once
+    json &pixCfg = j["FE-I4B"]["PixelConfig"];
+    std::vector<unsigned> en(n_Col), hitbus(n_Col), tdac(n_Col), lcap(n_Col), scap(n_Col), fdac(n_Col);
     for (unsigned row=1; row<=n_Row; row++) {
         for (unsigned col=1; col<=n_Col; col++) {
-            j["FE-I4B"]["PixelConfig"][row-1]["Row"] = row;
-            j["FE-I4B"]["PixelConfig"][row-1]["Enable"][col-1] = getEn(col, row);
-            j["FE-I4B"]["PixelConfig"][row-1]["Hitbus"][col-1] = getHitbus(col, row);
-            j["FE-I4B"]["PixelConfig"][row-1]["TDAC"][col-1] = getTDAC(col, row);
-            j["FE-I4B"]["PixelConfig"][row-1]["LCap"][col-1] = getLCap(col, row);
-            j["FE-I4B"]["PixelConfig"][row-1]["SCap"][col-1] = getSCap(col, row);
-            j["FE-I4B"]["PixelConfig"][row-1]["FDAC"][col-1] = getFDAC(col, row);
+            en[col-1] = getEn(col, row);
+            hitbus[col-1] = getHitbus(col, row);
+            tdac[col-1] = getTDAC(col, row);
+            lcap[col-1] = getLCap(col, row);
+            scap[col-1] = getSCap(col, row);
+            fdac[col-1] = getFDAC(col, row);
         }
+        json &rowCfg = pixCfg[row-1];
+        rowCfg["Row"] = row;
+        rowCfg["Enable"] = en;
+        rowCfg["Hitbus"] = hitbus;
+        rowCfg["TDAC"] = tdac;
+        rowCfg["LCap"] = lcap;
+        rowCfg["SCap"] = scap;
+        rowCfg["FDAC"] = fdac;
     }
 
     /*
@@ -219,18 +231,47 @@ void Fei4PixelCfg::toFileJson(json &j) {
 }
 
 void Fei4PixelCfg::fromFileJson(json &j) {
-    // Layout is one array per column
+    // Layout is one array per row
     if (j["FE-I4B"]["PixelConfig"].empty())
         return;
+    json &pixCfg = j["FE-I4B"]["PixelConfig"];
     for (unsigned row=1; row<=n_Row; row++) {
+        json &rowCfg = pixCfg[row-1];
+        const json &en = rowCfg["Enable"];
+        const json &hitbus = rowCfg["Hitbus"];
+        const json &tdac = rowCfg["TDAC"];
+        const json &lcap = rowCfg["LCap"];
+        const json &scap = rowCfg["SCap"];
+        const json &fdac = rowCfg["FDAC"];
         for (unsigned col=1; col<=n_Col; col++) {
-            setEn(col, row, j["FE-I4B"]["PixelConfig"][row-1]["Enable"][col-1]);
-            setHitbus(col, row, j["FE-I4B"]["PixelConfig"][row-1]["Hitbus"][col-1]);
-            setTDAC(col, row, j["FE-I4B"]["PixelConfig"][row-1]["TDAC"][col-1]);
-            setLCap(col, row, j["FE-I4B"]["PixelConfig"][row-1]["LCap"][col-1]);
-            setSCap(col, row, j["FE-I4B"]["PixelConfig"][row-1]["SCap"][col-1]);
-            setFDAC(col, row, j["FE-I4B"]["PixelConfig"][row-1]["FDAC"][col-1]);
+            setEn(col, row, en[col-1]);
+            setHitbus(col, row, hitbus[col-1]);
+            setTDAC(col, row, tdac[col-1]);
+            setLCap(col, row, lcap[col-1]);
+            setSCap(col, row, scap[col-1]);
+            setFDAC(col, row, fdac[col-1]);
         }
     }
 
 }
+
+void Fei4PixelCfg::toBinary(std::ostream &handle) {
+    for (unsigned dc=0; dc<n_DC; dc++) {
+        for (unsigned bit=0; bit<n_Bits; bit++) {
+            handle.write((const char*)getCfg(bit, dc), n_Words*sizeof(uint32_t));
+        }
+    }
+}
+
+bool Fei4PixelCfg::fromBinary(std::istream &handle) {
+    std::vector<uint32_t> words(n_DC*n_Bits*n_Words);
+    if (!handle.read((char*)words.data(), words.size()*sizeof(uint32_t)))
+        return false;
+    for (unsigned dc=0; dc<n_DC; dc++) {
+        for (unsigned bit=0; bit<n_Bits; bit++) {
+            const uint32_t *stream = &words[(dc*n_Bits+bit)*n_Words];
+            std::copy(stream, stream+n_Words, getCfg(bit, dc));
+        }
+    }
+    return true;
+}
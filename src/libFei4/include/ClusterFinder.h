@@ -0,0 +1,62 @@
+#ifndef CLUSTERFINDER_H
+#define CLUSTERFINDER_H
+
+// #################################
+// # Project: Yarr
+// # Description: Connected component clustering of pixel hits
+// # Comment: Hits are placed on an occupancy grid and merged with union-find,
+// #          linear in the number of hits
+// ################################
+
+#include <cstdint>
+#include <vector>
+
+#include "Fei4EventData.h"
+
+class ClusterFinder {
+    public:
+        struct Cluster {
+            unsigned nHits;
+            unsigned sumTot;
+            // ToT weighted centroid, unweighted if all hits have ToT 0
+            double col;
+            double row;
+            uint16_t minCol, maxCol;
+            uint16_t minRow, maxRow;
+
+            unsigned getColLength() const {return maxCol-minCol+1;}
+            unsigned getRowWidth() const {return maxRow-minRow+1;}
+        };
+
+        /// Two hits are adjacent if they are at most colDist columns and rowDist
+        /// rows apart, without diagonal only if they share a column or row
+        ClusterFinder(unsigned colDist = 1, unsigned rowDist = 1, bool diagonal = true);
+
+        /// Cluster n hits, results stay valid until the next call
+        void find(const Fei4Hit *hits, unsigned n);
+        void find(const std::vector<Fei4Hit> &hits) {this->find(hits.data(), hits.size());}
+
+        const std::vector<Cluster>& getClusters() const {return clusters;}
+        /// Cluster index of every hit, clusters are ordered by their first hit
+        const std::vector<unsigned>& getLabels() const {return labels;}
+
+    private:
+        unsigned findRoot(unsigned i);
+        void merge(unsigned a, unsigned b);
+
+        // Forward half of the neighbourhood, the other half is covered by the neighbour
+        std::vector<int> dCols;
+        std::vector<int> dRows;
+
+        // Hit index+1 per pixel, all 0 between calls
+        std::vector<uint32_t> grid;
+        unsigned gridCols;
+        unsigned gridRows;
+
+        std::vector<unsigned> parent;
+        std::vector<unsigned> size;
+        std::vector<unsigned> labels;
+        std::vector<Cluster> clusters;
+};
+
+#endif
@@ -102,6 +102,7 @@ class ScurveFitter : public AnalysisAlgorithm {
         unsigned vcalBins;
         unsigned n_count;
         unsigned injections;
+        // Occupancy maps received, other histograms are not routed here
         unsigned cnt;
 	    unsigned n_failedfit;
         
@@ -62,6 +62,8 @@ class Fei4Cfg : public FrontEndCfg, public Fei4GlobalCfg, public Fei4PixelCfg {
 
         void toFileJson(json &j) override;
         void fromFileJson(json &j) override;
+        bool pixelsToBinary(std::ostream &handle) override {this->toBinary(handle); return true;}
+        bool pixelsFromBinary(std::istream &handle) override {return this->fromBinary(handle);}
 
     protected:
         unsigned chipId;
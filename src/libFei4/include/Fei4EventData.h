@@ -9,6 +9,7 @@
 // # Comment: Splits events by L1ID
 // ################################
 
+#include <algorithm>
 #include <deque>
 #include <list>
 #include <vector>
@@ -18,6 +19,11 @@
 #include "EventDataBase.h"
 #include "LoopStatus.h"
 
+namespace Fei4EventFile {
+    /// Start of a file of events in the compact layout, the plain layout has no header
+    const char compactMagic[8] = {'Y', 'A', 'R', 'R', 'E', 'V', 'C', '1'};
+}
+
 struct Fei4Hit {
     uint16_t col;
     uint16_t row;
@@ -28,40 +34,38 @@ class Fei4Cluster {
     public:
         Fei4Cluster() {
             nHits = 0;
+            minCol = maxCol = 0;
+            minRow = maxRow = 0;
         }
         ~Fei4Cluster() {}
 
         void addHit(Fei4Hit* hit) {
+            if (nHits == 0) {
+                minCol = maxCol = hit->col;
+                minRow = maxRow = hit->row;
+            } else {
+                minCol = std::min(minCol, hit->col);
+                maxCol = std::max(maxCol, hit->col);
+                minRow = std::min(minRow, hit->row);
+                maxRow = std::max(maxRow, hit->row);
+            }
             hits.push_back(hit);
             nHits++;
         }
 
-        unsigned getColLength() {
-            int min = 999999;
-            int max = -1;
-            for (unsigned i=0; i<hits.size(); i++) {
-                if ((int)hits[i]->col > max)
-                    max = hits[i]->col;
-                if ((int)hits[i]->col < min)
-                    min = hits[i]->col;
-            }
-            return max-min+1;
+        unsigned getColLength() const {
+            return maxCol-minCol+1;
         }
         
-        unsigned getRowWidth() {
-            int min = 999999;
-            int max = -1;
-            for (unsigned i=0; i<hits.size(); i++) {
-                if ((int)hits[i]->row > max)
-                    max = hits[i]->row;
-                if ((int)hits[i]->row < min)
-                    min = hits[i]->row;
-            }
-            return max-min+1;
+        unsigned getRowWidth() const {
+            return maxRow-minRow+1;
         }
 
         unsigned nHits;
         std::vector<Fei4Hit*> hits;
+    private:
+        uint16_t minCol, maxCol;
+        uint16_t minRow, maxRow;
 };
 
 class Fei4Event {
@@ -108,6 +112,15 @@ class Fei4Event {
         void toFileBinary(std::fstream &handle) const;
         void fromFileBinary(std::fstream &handle);
 
+        /// Appends the layout of toFileBinary
+        void toBuffer(std::vector<char> &buf) const;
+        /// Appends the compact layout: header fields as varints, each hit as
+        /// zigzag varint deltas of column and row to the previous hit and its ToT
+        void toBufferCompact(std::vector<char> &buf) const;
+        /// Reads one event of the compact layout, returns the bytes used or 0
+        /// if the buffer ends within the event
+        size_t fromBufferCompact(const char *buf, size_t size);
+
         uint16_t l1id;
         uint16_t bcid;
         uint32_t tag;
@@ -0,0 +1,55 @@
+#ifndef FEI4EVENTREADER_H
+#define FEI4EVENTREADER_H
+
+// #################################
+// # Project: Yarr
+// # Description: Memory mapped file of events written by the DataArchiver
+// # Comment: Plain and compact layout, events are decoded in place so several
+// #          threads can read different parts of the file at the same time
+// ################################
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Fei4EventData.h"
+
+class Fei4EventReader {
+    public:
+        struct Header {
+            uint32_t tag;
+            uint16_t l1id;
+            uint16_t bcid;
+            uint16_t nHits;
+            /// Offset of the first hit and of the next event
+            size_t hits;
+            size_t next;
+        };
+
+        /// Throws std::runtime_error if the file can not be mapped
+        Fei4EventReader(const std::string &filename);
+        ~Fei4EventReader();
+
+        Fei4EventReader(const Fei4EventReader&) = delete;
+        Fei4EventReader& operator=(const Fei4EventReader&) = delete;
+
+        bool isCompact() const {return m_compact;}
+        size_t size() const {return m_size;}
+        /// Offset of the first event
+        size_t begin() const {return m_begin;}
+
+        /// Header of the event at offset, false at the end of the file or if
+        /// the event is truncated
+        bool header(size_t offset, Header &h) const;
+
+        /// Appends the hits of an event
+        void hits(const Header &h, std::vector<Fei4Hit> &out) const;
+
+    private:
+        const char *m_data;
+        size_t m_size;
+        size_t m_begin;
+        bool m_compact;
+};
+
+#endif
@@ -9,13 +9,17 @@
 // # Comment: 
 // ################################
 
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <mutex>
 #include <vector>
 #include <typeinfo>
 #include <thread>
 
 #include "DataProcessor.h"
 #include "ClipBoard.h"
+#include "ClusterFinder.h"
 #include "Fei4EventData.h"
 #include "HistogramAlgorithm.h"
 #include "HistogramBase.h"
@@ -24,20 +28,31 @@
 #include "Histo3d.h"
 #include "LoopStatus.h"
 
+/// Writes all events to a file. Events are serialized into large blocks on
+/// the histogrammer thread, a writer thread of its own puts them on disk
 class DataArchiver : public HistogramAlgorithm {
     public:
-        DataArchiver(std::string filename) : HistogramAlgorithm() {
-            r = NULL;
-            fileHandle.open(filename.c_str(), std::fstream::out | std::fstream::binary | std::fstream::trunc);
-        }
-        ~DataArchiver() {
-            fileHandle.close();
-        }
+        /// The plain layout is read by Fei4Event::fromFileBinary, the compact
+        /// one starts with Fei4EventFile::compactMagic
+        DataArchiver(std::string filename, bool compact = false);
+        ~DataArchiver();
 
         void create(LoopStatus &stat) override {}
         void processEvent(Fei4Data *data) override;
     private:
+        void queueBlock();
+        void writeLoop();
+
         std::fstream fileHandle;
+        bool m_compact;
+
+        std::vector<char> m_block;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<std::vector<char>> m_full;
+        std::vector<std::vector<char>> m_free;
+        bool m_done;
+        std::thread m_thread;
 };
 
 class OccupancyMap : public HistogramAlgorithm {
@@ -222,4 +237,28 @@ class HitsPerEvent : public HistogramAlgorithm {
     private:
         Histo1d *h;
 };
+
+class ClusterSize : public HistogramAlgorithm {
+    public:
+        ClusterSize() : HistogramAlgorithm() {
+            h = nullptr;
+            r = nullptr;
+        }
+
+        ~ClusterSize() {
+        }
+
+        void create(LoopStatus &stat) override {
+            h = new Histo1d("ClusterSize", 16, 0.5, 16.5, typeid(this), stat);
+            h->setXaxisTitle("Cluster Size [hits]");
+            h->setYaxisTitle("# of Clusters");
+            r.reset(h);
+        }
+
+        void processEvent(Fei4Data *data) override;
+    private:
+        Histo1d *h;
+        ClusterFinder finder;
+        std::vector<Fei4Hit> eventHits;
+};
 #endif
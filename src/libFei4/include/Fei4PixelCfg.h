@@ -139,6 +139,10 @@ class Fei4PixelCfg {
         
         void toFileJson(json &j);
         void fromFileJson(json &j);
+
+        /// Raw pixel registers, for the binary sidecar of the config file
+        void toBinary(std::ostream &handle);
+        bool fromBinary(std::istream &handle);
 };
 
 #endif
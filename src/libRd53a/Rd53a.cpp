@@ -11,6 +11,10 @@
 #include "Rd53a.h"
 #include "RawData.h"
 
+#include <algorithm>
+#include <cstring>
+#include <typeinfo>
+
 #include "logging.h"
 
 namespace {
@@ -59,6 +63,12 @@ Rd53a::Rd53a(HwController *core, unsigned arg_txChannel, unsigned arg_rxChannel)
     core->setClkPeriod(6.25e-9);
 }
 
+Rd53a::~Rd53a() {
+    // Pixels written to the chip in this run, the next one starts from there
+    if (m_chipState && !m_chipPixRegs.empty())
+        m_chipState->store(m_chipPixRegs.data(), m_chipPixRegs.size()*sizeof(uint16_t));
+}
+
 void Rd53a::init(HwController *arg_core, unsigned arg_txChannel, unsigned arg_rxChannel) {
     this->setCore(arg_core);
     m_rxcore = arg_core;
@@ -94,8 +104,12 @@ void Rd53a::configure() {
     // Write globals
     this->configureGlobal();
     while(!core->isCmdEmpty()){;}
-    // Write pixels
-    this->configurePixels();
+    // Write pixels, the global pulse above does not reset them
+    if (this->knowsChipState()) {
+        this->configureChangedPixels();
+    } else {
+        this->configurePixels();
+    }
     while(!core->isCmdEmpty()){;}
     // Turn on clock to matrix
     this->writeRegister(&Rd53a::EnCoreColSync, tmp_enCoreColSync);
@@ -139,19 +153,82 @@ void Rd53a::configurePixels() {
 
     // Writing two columns and six rows at the same time
     for (unsigned col=0; col<n_Col; col+=2) {
-        this->writeRegister(&Rd53a::PixRegionCol, col/2);
-        this->writeRegister(&Rd53a::PixRegionRow, 0); 
-        for (unsigned row=0; row<n_Row; row+=1) {
-            //this->writeRegister(&Rd53a::PixRegionRow, row); 
-            //this->wrRegisterBlock(m_chipId, 0, &pixRegs[Rd53aPixelCfg::toIndex(col, row)]);
-            this->writeRegister(&Rd53a::PixPortal, pixRegs[Rd53aPixelCfg::toIndex(col, row)]);
-            //if (pixRegs[Rd53aPixelCfg::toIndex(col, row)] != 0x0)
-            //    std::cout << "[" << col << "][" << row << "] = 0x" << std::hex << pixRegs[Rd53aPixelCfg::toIndex(col, row)] << std::dec << std::endl;
-            //if (row % 24 == 0)
-            //    while(!core->isCmdEmpty()){;}
+        this->writeDoubleColumn(col/2);
+    }
+    m_chipPixRegs.assign(pixRegs.begin(), pixRegs.end());
+    if (m_chipState) m_chipState->fullWritten();
+}
+
+void Rd53a::writeDoubleColumn(unsigned dc) {
+    // Requires PixAutoRow, the row is incremented with each write
+    this->writeRegister(&Rd53a::PixRegionCol, dc);
+    this->writeRegister(&Rd53a::PixRegionRow, 0);
+    for (unsigned row=0; row<n_Row; row+=1) {
+        //this->writeRegister(&Rd53a::PixRegionRow, row); 
+        //this->wrRegisterBlock(m_chipId, 0, &pixRegs[Rd53aPixelCfg::toIndex(col, row)]);
+        this->writeRegister(&Rd53a::PixPortal, pixRegs[dc*n_Row+row]);
+        //if (row % 24 == 0)
+        //    while(!core->isCmdEmpty()){;}
+    }
+    while(!core->isCmdEmpty()){;}
+}
+
+void Rd53a::configureChangedPixels() {
+    if (m_chipPixRegs.size() != pixRegs.size()) {
+        this->configurePixels();
+        return;
+    }
+
+    // A region costs two writes on its own, so double columns with more than
+    // half of the rows changed are cheaper to write in full
+    std::vector<std::pair<unsigned, unsigned>> pixels;
+    std::vector<unsigned> dcs;
+    unsigned changed = 0;
+    for (unsigned dc=0; dc<n_DC; dc++) {
+        unsigned before = pixels.size();
+        for (unsigned row=0; row<n_Row; row++) {
+            if (pixRegs[dc*n_Row+row] != m_chipPixRegs[dc*n_Row+row])
+                pixels.emplace_back(dc*2, row);
+        }
+        changed += pixels.size() - before;
+        if (pixels.size() - before > n_Row/2) {
+            pixels.resize(before);
+            dcs.push_back(dc);
+        }
+    }
+
+    if (!dcs.empty()) {
+        this->writeRegister(&Rd53a::PixAutoCol, 0);
+        this->writeRegister(&Rd53a::PixAutoRow, 1);
+        for (unsigned dc : dcs) {
+            this->writeDoubleColumn(dc);
+            std::copy(&pixRegs[dc*n_Row], &pixRegs[dc*n_Row]+n_Row, &m_chipPixRegs[dc*n_Row]);
+        }
+    }
+    if (!pixels.empty()) {
+        this->configurePixels(pixels);
+    }
+    logger->info("{} of {} pixel registers changed since the last configuration, {} double columns rewritten",
+            changed, pixRegs.size(), dcs.size());
+}
+
+bool Rd53a::knowsChipState() {
+    auto hw = dynamic_cast<HwController*>(core);
+    // Broadcasts reach more than one chip
+    if (m_chipId == 8 || !hw || !hw->hasPersistentChips()) return false;
+
+    if (!m_chipState) {
+        std::string key = std::string("rd53a_") + typeid(*hw).name() + "_" + this->getName()
+            + "_" + std::to_string(m_chipId) + "_" + std::to_string(this->getTxChannel())
+            + "_" + std::to_string(this->getRxChannel());
+        m_chipState.reset(new ChipStateCache(key));
+        std::vector<char> state;
+        if (m_chipState->take(state) && state.size() == pixRegs.size()*sizeof(uint16_t)) {
+            m_chipPixRegs.resize(pixRegs.size());
+            memcpy(m_chipPixRegs.data(), state.data(), state.size());
         }
-        while(!core->isCmdEmpty()){;}
     }
+    return !m_chipPixRegs.empty() && !m_chipState->fullDue();
 }
 
 void Rd53a::configurePixels(std::vector<std::pair<unsigned, unsigned>> &pixels) {
@@ -167,7 +244,9 @@ void Rd53a::configurePixels(std::vector<std::pair<unsigned, unsigned>> &pixels)
             old_col = pixel.first/2;
         }
         this->writeRegister(&Rd53a::PixRegionRow, pixel.second); 
-        this->writeRegister(&Rd53a::PixPortal, pixRegs[Rd53aPixelCfg::toIndex(pixel.first, pixel.second)]);
+        unsigned index = Rd53aPixelCfg::toIndex(pixel.first, pixel.second);
+        this->writeRegister(&Rd53a::PixPortal, pixRegs[index]);
+        if (!m_chipPixRegs.empty()) m_chipPixRegs[index] = pixRegs[index];
         counter++;
         if (counter == 100 ) {
             while(!core->isCmdEmpty()){;}
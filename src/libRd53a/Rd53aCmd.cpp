@@ -88,21 +88,19 @@ void Rd53aCmd::cal(uint32_t chipId, uint32_t mode, uint32_t delay, uint32_t dura
 
 void Rd53aCmd::wrRegister(uint32_t chipId, uint32_t address, uint16_t value) {
     SPDLOG_LOGGER_TRACE(logger, "ID({}) ADR({}) VAL(0x{:x})", chipId, address, value);
-    // Header
-    core->writeFifo(0x69696666);
-    uint32_t tmp = 0x0;
+    // Header, the command goes out in one block
+    uint32_t words[3] = {0x69696666, 0x0, 0x0};
     // ID[3:0],0 | ADR[8:4]
-    tmp += (this->encode5to8((chipId & 0xF) << 1)) << 24;
-    tmp += (this->encode5to8((address >> 4) & 0x1F)) << 16;
+    words[1] += (this->encode5to8((chipId & 0xF) << 1)) << 24;
+    words[1] += (this->encode5to8((address >> 4) & 0x1F)) << 16;
     // ADR[3:0],VAL[15] | VAL[14:10]
-    tmp += (this->encode5to8(((address & 0xF) << 1) + ((value >> 15) & 0x1)) << 8);
-    tmp += (this->encode5to8((value >> 10) & 0x1F));
-    core->writeFifo(tmp);
+    words[1] += (this->encode5to8(((address & 0xF) << 1) + ((value >> 15) & 0x1)) << 8);
+    words[1] += (this->encode5to8((value >> 10) & 0x1F));
     // VAL[9:5] | VAL [4:0]
-    tmp = (this->encode5to8((value >> 5) & 0x1F) << 24);
-    tmp += (this->encode5to8(value & 0x1F)) << 16;
-    tmp += 0x6969;
-    core->writeFifo(tmp);
+    words[2] = (this->encode5to8((value >> 5) & 0x1F) << 24);
+    words[2] += (this->encode5to8(value & 0x1F)) << 16;
+    words[2] += 0x6969;
+    core->writeFifoBlock(words, 3);
     core->releaseFifo();
 }
 
@@ -106,8 +106,8 @@ void Rd53aMaskLoop::init() {
                 rd53a->setInjEn(col, row, 0);
             }
         }
-        // TODO make configrue for subset
-        rd53a->configurePixels();
+        // Only the pixels which were enabled are written
+        rd53a->configureChangedPixels();
         while(!g_tx->isCmdEmpty()) {}
     }
     // Reset CMD mask
@@ -8,6 +8,8 @@
 
 #include "Rd53aPixelCfg.h"
 
+#include <vector>
+
 struct pixelFields {
     unsigned en : 1;
     unsigned injen : 1;
@@ -130,27 +132,54 @@ int Rd53aPixelCfg::getTDAC(unsigned col, unsigned row) {
 }
 
 void Rd53aPixelCfg::toFileJson(json &j) {
+    // Whole columns are assigned at once, instead of a lookup per pixel
+    json &pixCfg = j["RD53A"]["PixelConfig"];
+    std::vector<int> en(n_Row), hitbus(n_Row), injEn(n_Row), tdac(n_Row);
     for (unsigned col=0; col<n_Col; col++) {
         for (unsigned row=0; row<n_Row; row++) {
-            j["RD53A"]["PixelConfig"][col]["Col"] = col;
-            j["RD53A"]["PixelConfig"][col]["Enable"][row] = this->getEn(col, row);
-            j["RD53A"]["PixelConfig"][col]["Hitbus"][row] = this->getHitbus(col, row);
-            j["RD53A"]["PixelConfig"][col]["InjEn"][row] = this->getInjEn(col, row);
-            j["RD53A"]["PixelConfig"][col]["TDAC"][row] = this->getTDAC(col, row);
+            en[row] = this->getEn(col, row);
+            hitbus[row] = this->getHitbus(col, row);
+            injEn[row] = this->getInjEn(col, row);
+            tdac[row] = this->getTDAC(col, row);
         }
+        json &column = pixCfg[col];
+        column["Col"] = col;
+        column["Enable"] = en;
+        column["Hitbus"] = hitbus;
+        column["InjEn"] = injEn;
+        column["TDAC"] = tdac;
     }
 }
 
 // TODO add failsaife
 void Rd53aPixelCfg::fromFileJson(json &j) {
+    // Not in the json if it was loaded from the binary sidecar
+    if (j["RD53A"]["PixelConfig"].empty())
+        return;
+    json &pixCfg = j["RD53A"]["PixelConfig"];
     for (unsigned col=0; col<n_Col; col++) {
+        json &column = pixCfg[col];
+        const json &en = column["Enable"];
+        const json &hitbus = column["Hitbus"];
+        const json &injEn = column["InjEn"];
+        const json &tdac = column["TDAC"];
         for (unsigned row=0; row<n_Row; row++) {
-            this->setEn(col, row, j["RD53A"]["PixelConfig"][col]["Enable"][row]);
-            this->setHitbus(col, row, j["RD53A"]["PixelConfig"][col]["Hitbus"][row]);
-            this->setInjEn(col, row, j["RD53A"]["PixelConfig"][col]["InjEn"][row]);
-            this->setTDAC(col, row, j["RD53A"]["PixelConfig"][col]["TDAC"][row]);
+            this->setEn(col, row, en[row]);
+            this->setHitbus(col, row, hitbus[row]);
+            this->setInjEn(col, row, injEn[row]);
+            this->setTDAC(col, row, tdac[row]);
         }
     }
 }
 
+void Rd53aPixelCfg::toBinary(std::ostream &handle) const {
+    handle.write((const char*)pixRegs.data(), pixRegs.size()*sizeof(uint16_t));
+}
 
+bool Rd53aPixelCfg::fromBinary(std::istream &handle) {
+    std::array<uint16_t, n_DC*n_Row> regs;
+    if (!handle.read((char*)regs.data(), regs.size()*sizeof(uint16_t)))
+        return false;
+    pixRegs = regs;
+    return true;
+}
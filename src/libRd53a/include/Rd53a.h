@@ -12,10 +12,12 @@
 
 #include <iostream>
 #include <chrono>
+#include <memory>
 #include <thread>
 #include <tuple>
 #include <vector>
 
+#include "ChipStateCache.h"
 #include "FrontEnd.h"
 #include "TxCore.h"
 #include "RxCore.h"
@@ -30,6 +32,7 @@ class Rd53a : public FrontEnd, public Rd53aCfg, public Rd53aCmd {
         Rd53a(HwController *arg_core);
         Rd53a(HwController *arg_core, unsigned arg_channel);
         Rd53a(HwController *arg_core, unsigned arg_txchannel, unsigned arg_rxchannel);
+        ~Rd53a();
     
         void init(HwController *arg_core, unsigned arg_txChannel, unsigned arg_rxChannel) override;
         void makeGlobal() override {
@@ -41,6 +44,8 @@ class Rd53a : public FrontEnd, public Rd53aCfg, public Rd53aCmd {
         void configureGlobal();
         void configurePixels();
         void configurePixels(std::vector<std::pair<unsigned, unsigned>> &pixels);
+        /// Only the pixel registers which differ from the ones last written to the chip
+        void configureChangedPixels();
 
         int checkCom() override;
 
@@ -65,7 +70,13 @@ class Rd53a : public FrontEnd, public Rd53aCfg, public Rd53aCmd {
 
     protected:
     private:
+        void writeDoubleColumn(unsigned dc);
+        /// True if the pixel registers on the chip are known and no full configuration is due
+        bool knowsChipState();
 
+        /// Pixel registers as written to the chip, empty if not known
+        std::vector<uint16_t> m_chipPixRegs;
+        std::unique_ptr<ChipStateCache> m_chipState;
 };
 
 #endif
@@ -46,6 +46,8 @@ class Rd53aCfg : public FrontEndCfg, public Rd53aGlobalCfg, public Rd53aPixelCfg
          */
         void toFileJson(json&);
         void fromFileJson(json&);
+        bool pixelsToBinary(std::ostream &handle) {this->toBinary(handle); return true;}
+        bool pixelsFromBinary(std::istream &handle) {return this->fromBinary(handle);}
         
         float ADCtoV (uint16_t ADC);
         float VtoTemp (float V, uint16_t Sensor, bool isRadSensor);
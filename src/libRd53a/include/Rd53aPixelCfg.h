@@ -46,6 +46,10 @@ class Rd53aPixelCfg {
         void toFileJson(json &j);
         void fromFileJson(json &j);
 
+        /// Raw pixel registers, for the binary sidecar of the config file
+        void toBinary(std::ostream &handle) const;
+        bool fromBinary(std::istream &handle);
+
 };
 
 #endif
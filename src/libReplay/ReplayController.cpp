@@ -0,0 +1,45 @@
+#include "ReplayController.h"
+
+#include "AllHwControllers.h"
+
+#include "logging.h"
+
+namespace {
+    auto rclog = logging::make_log("ReplayController");
+}
+
+bool replay_registered =
+  StdDict::registerHwController("replay",
+                                []() { return std::unique_ptr<HwController>(new ReplayController); });
+
+void ReplayController::loadConfig(json &j) {
+    if (j["file"].empty()) {
+        rclog->critical("No raw data file given to replay!");
+        throw std::runtime_error("ReplayController: no file");
+    }
+    std::string filename = j["file"];
+    rclog->info("Replaying raw data from {}", filename);
+    m_stream.reset(new ReplayStream(filename));
+
+    if (!j["rate"].empty()) {
+        m_stream->setRate(static_cast<double>(j["rate"]));
+    }
+    if (!j["repeat"].empty()) {
+        m_stream->setRepeat(static_cast<bool>(j["repeat"]));
+    }
+    // All data of a trigger is there once it is done, no need to wait for stragglers
+    unsigned waitTime = 0;
+    if (!j["waitTime"].empty()) {
+        waitTime = static_cast<unsigned>(j["waitTime"]);
+    }
+    this->setWaitTime(std::chrono::microseconds(waitTime));
+
+    if (m_stream->getRate() > 0) {
+        rclog->info("Playback rate {} words/s", m_stream->getRate());
+    } else {
+        rclog->info("Playback as fast as possible");
+    }
+
+    ReplayTxCore::setStream(m_stream.get());
+    ReplayRxCore::setStream(m_stream.get());
+}
@@ -0,0 +1,25 @@
+#include "ReplayRxCore.h"
+
+ReplayRxCore::ReplayRxCore() : m_stream(NULL), m_rxMask(0x1) {
+}
+
+ReplayRxCore::~ReplayRxCore() {}
+
+void ReplayRxCore::setRxEnable(uint32_t value) {
+    m_rxMask = (value < 32) ? (1 << value) : 0;
+}
+
+void ReplayRxCore::setRxEnable(std::vector<uint32_t> channels) {
+    m_rxMask = 0;
+    for (uint32_t channel : channels) {
+        if (channel < 32) m_rxMask |= (1 << channel);
+    }
+}
+
+void ReplayRxCore::maskRxEnable(uint32_t value, uint32_t mask) {
+    m_rxMask = (m_rxMask & ~mask) | (value & mask);
+}
+
+RawData* ReplayRxCore::readData() {
+    return m_stream ? m_stream->next() : NULL;
+}
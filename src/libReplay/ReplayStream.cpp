@@ -0,0 +1,61 @@
+#include "ReplayStream.h"
+
+#include "logging.h"
+
+namespace {
+    auto rslog = logging::make_log("ReplayStream");
+}
+
+ReplayStream::ReplayStream(const std::string &filename)
+    : m_reader(filename), m_rate(0), m_repeat(false), m_count(0),
+      m_block(0), m_remaining(0), m_sent(0) {
+}
+
+bool ReplayStream::arm() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_armed = m_reader.read();
+    if (!m_armed && m_repeat && m_count > 0) {
+        m_reader.rewind();
+        m_armed = m_reader.read();
+    }
+
+    m_block = 0;
+    m_remaining = 0;
+    m_sent = 0;
+    m_start = std::chrono::steady_clock::now();
+    if (!m_armed) {
+        rslog->warn("End of recorded data after {} triggers", m_count);
+        return false;
+    }
+    for (unsigned words : m_armed->words) m_remaining += words;
+    m_count++;
+    return true;
+}
+
+RawData* ReplayStream::next() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_armed || m_block == m_armed->size()) return NULL;
+
+    if (m_rate > 0) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_start;
+        if (m_sent > elapsed.count()*m_rate) return NULL;
+    }
+
+    // The caller takes over the buffer, the container must not free it
+    unsigned i = m_block++;
+    RawData *data = new RawData(m_armed->adr[i], m_armed->buf[i], m_armed->words[i]);
+    m_armed->buf[i] = NULL;
+    m_sent += data->words;
+    m_remaining -= data->words;
+    return data;
+}
+
+bool ReplayStream::done() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_armed || m_block == m_armed->size();
+}
+
+uint32_t ReplayStream::remaining() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_remaining;
+}
@@ -0,0 +1,28 @@
+#include "ReplayTxCore.h"
+
+ReplayTxCore::ReplayTxCore() : m_stream(NULL), m_cmdMask(0x1), m_trigEnable(0) {
+}
+
+ReplayTxCore::~ReplayTxCore() {}
+
+void ReplayTxCore::setCmdEnable(uint32_t value) {
+    m_cmdMask = (value < 32) ? (1 << value) : 0;
+}
+
+void ReplayTxCore::setCmdEnable(std::vector<uint32_t> channels) {
+    m_cmdMask = 0;
+    for (uint32_t channel : channels) {
+        if (channel < 32) m_cmdMask |= (1 << channel);
+    }
+}
+
+void ReplayTxCore::setTrigEnable(uint32_t value) {
+    m_trigEnable = value;
+    if (value != 0 && m_stream) {
+        m_stream->arm();
+    }
+}
+
+bool ReplayTxCore::isTrigDone() {
+    return !m_stream || m_stream->done();
+}
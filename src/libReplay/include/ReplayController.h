@@ -0,0 +1,34 @@
+#ifndef REPLAYCONTROLLER_H
+#define REPLAYCONTROLLER_H
+
+// #################################
+// # Project: Yarr
+// # Description: Replay Controller class
+// # Comment: Plays back a recorded raw data stream in place of the hardware
+// ################################
+
+#include <memory>
+
+#include "HwController.h"
+#include "ReplayTxCore.h"
+#include "ReplayRxCore.h"
+#include "ReplayStream.h"
+
+#include "storage.hpp"
+
+class ReplayController : public HwController, public ReplayTxCore, public ReplayRxCore {
+    public:
+        ReplayController() {}
+        ~ReplayController() {}
+
+        /// "file": recorded raw data, "rate": words/s (0 or missing for as
+        /// fast as possible), "repeat": loop over the file, "waitTime": us
+        void loadConfig(json &j);
+
+        bool hasFrontEnds() {return false;}
+
+    private:
+        std::unique_ptr<ReplayStream> m_stream;
+};
+
+#endif
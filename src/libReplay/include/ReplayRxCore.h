@@ -0,0 +1,42 @@
+#ifndef REPLAYRXCORE_H
+#define REPLAYRXCORE_H
+
+// #################################
+// # Project: Yarr
+// # Description: Replay Receiver
+// # Comment: The recorded data already carries the channel encoding of the
+// #          firmware, so the enabled channels are only kept for reference
+// ################################
+
+#include <cstdint>
+#include <vector>
+
+#include "RxCore.h"
+#include "ReplayStream.h"
+
+class ReplayRxCore : virtual public RxCore {
+    public:
+        ReplayRxCore();
+        ~ReplayRxCore();
+
+        void setStream(ReplayStream *stream) {m_stream = stream;}
+
+        void setRxEnable(uint32_t value);
+        void setRxEnable(std::vector<uint32_t> channels);
+        void maskRxEnable(uint32_t value, uint32_t mask);
+        void disableRx() {m_rxMask = 0;}
+
+        RawData* readData();
+
+        uint32_t getDataRate() {return m_stream ? m_stream->getRate() : 0;}
+        uint32_t getCurCount() {return m_stream ? m_stream->remaining() : 0;}
+        bool isBridgeEmpty() {return !m_stream || m_stream->done();}
+
+        void setWaitTime(std::chrono::microseconds waitTime) {m_waitTime = waitTime;}
+
+    private:
+        ReplayStream *m_stream;
+        uint32_t m_rxMask;
+};
+
+#endif
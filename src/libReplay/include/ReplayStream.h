@@ -0,0 +1,64 @@
+#ifndef REPLAYSTREAM_H
+#define REPLAYSTREAM_H
+
+// #################################
+// # Project: Yarr
+// # Description: Raw data stream played back from a file
+// # Comment: Each trigger releases the data of one recorded container, so
+// #          the data loop sees the same LoopStatus boundaries as when it was
+// #          recorded
+// ################################
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "RawData.h"
+#include "RawDataFile.h"
+
+class ReplayStream {
+    public:
+        /// Throws std::runtime_error if the file can not be read
+        ReplayStream(const std::string &filename);
+
+        /// Words per second, 0 plays back as fast as possible
+        void setRate(double rate) {m_rate = rate;}
+        double getRate() {return m_rate;}
+
+        /// Start again from the beginning when the file is exhausted
+        void setRepeat(bool repeat) {m_repeat = repeat;}
+
+        /// Load the next recorded container, false if there is none left
+        bool arm();
+
+        /// Next block of the armed container once the rate allows it, the
+        /// buffer is handed over to the caller
+        RawData* next();
+
+        /// All blocks of the armed container have been handed out
+        bool done();
+        /// Words of the armed container not handed out yet
+        uint32_t remaining();
+
+        /// Containers armed so far
+        unsigned count() {return m_count;}
+
+    private:
+        RawDataFileReader m_reader;
+        std::mutex m_mutex;
+
+        double m_rate;
+        bool m_repeat;
+        unsigned m_count;
+
+        std::unique_ptr<RawDataContainer> m_armed;
+        unsigned m_block;
+        uint32_t m_remaining;
+
+        std::chrono::steady_clock::time_point m_start;
+        uint64_t m_sent;
+};
+
+#endif
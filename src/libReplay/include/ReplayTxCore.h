@@ -0,0 +1,57 @@
+#ifndef REPLAYTXCORE_H
+#define REPLAYTXCORE_H
+
+// #################################
+// # Project: Yarr
+// # Description: Replay Transmitter
+// # Comment: Commands are discarded, enabling the trigger releases the next
+// #          recorded container and the trigger is done once it has been read
+// ################################
+
+#include <cstdint>
+#include <vector>
+
+#include "TxCore.h"
+#include "ReplayStream.h"
+
+class ReplayTxCore : virtual public TxCore {
+    public:
+        ReplayTxCore();
+        ~ReplayTxCore();
+
+        void setStream(ReplayStream *stream) {m_stream = stream;}
+
+        void writeFifo(uint32_t value) {}
+        void releaseFifo() {}
+
+        void setCmdEnable(uint32_t value);
+        void setCmdEnable(std::vector<uint32_t> channels);
+        void disableCmd() {m_cmdMask = 0;}
+        uint32_t getCmdEnable() {return m_cmdMask;}
+        bool isCmdEmpty() {return true;}
+
+        void setTrigEnable(uint32_t value);
+        uint32_t getTrigEnable() {return m_trigEnable;}
+        void maskTrigEnable(uint32_t value, uint32_t mask) {}
+        bool isTrigDone();
+
+        void setTrigConfig(enum TRIG_CONF_VALUE cfg) {}
+        void setTrigFreq(double freq) {}
+        void setTrigCnt(uint32_t count) {}
+        void setTrigTime(double time) {}
+        void setTrigWordLength(uint32_t length) {}
+        void setTrigWord(uint32_t *word, uint32_t length) {}
+        void toggleTrigAbort() {}
+
+        void setTriggerLogicMask(uint32_t mask) {}
+        void setTriggerLogicMode(enum TRIG_LOGIC_MODE_VALUE mode) {}
+        void resetTriggerLogic() {}
+        uint32_t getTrigInCount() {return 0x0;}
+
+    private:
+        ReplayStream *m_stream;
+        uint32_t m_cmdMask;
+        uint32_t m_trigEnable;
+};
+
+#endif
@@ -29,9 +29,10 @@ double StarCfg::toCharge(double vcal) {
 double StarCfg::toCharge(double vcal, bool sCap, bool lCap) { return toCharge(vcal); }
 
 int StarCfg::hccChannelForABCchipID(unsigned int chipID) {
-  auto itr = std::find_if(m_ABCchips.begin(), m_ABCchips.end(),
-                        [this, chipID](auto &it) { return it.getABCchipID() == chipID; });
-  return std::distance(m_ABCchips.begin(), itr);
+  if(chipID >= m_abcIndexByID.size() || m_abcIndexByID[chipID] < 0) {
+    return m_ABCchips.size();
+  }
+  return m_abcIndexByID[chipID];
 }
 
 //HCC register accessor functions
@@ -106,11 +107,8 @@ void StarCfg::toFileJson(json &j) {
 
     j["HCC"]["ID"] = getHCCchipID();
 
-    auto &hccRegs = HccStarRegInfo::instance()->hccregisterMap;
-
-    for(auto &reg: hccRegs) {
-        auto &info = reg.second;
-        int addr = info->addr();
+    for(HCCStarRegister hccReg: HCCStarRegister::_values()) {
+        int addr = hccReg;
         // Standard rw registers start from 32
         // Don't write status registers
         if(addr >= 32) {
@@ -123,8 +121,6 @@ void StarCfg::toFileJson(json &j) {
         }
     }
 
-    auto &abcRegs = AbcStarRegInfo::instance()->abcregisterMap;
-
     std::map<std::string, std::string> common;
     // Store until we know which are not common
     std::vector<std::map<std::string, std::string>> regs(numABCs());
@@ -133,9 +129,8 @@ void StarCfg::toFileJson(json &j) {
         auto &abc = abcFromIndex(iABC+1);
         j["ABCs"]["IDs"][iABC] = abc.getABCchipID();
 
-        for(auto &reg_i: abcRegs) {
-            auto &info = reg_i.second;
-            int addr = info->addr();
+        for(ABCStarRegister abcReg: ABCStarRegister::_values()) {
+            int addr = abcReg;
 
             // Skip non-writeable, trim and mask registers
             if(addr==ABCStarRegister::SCReg) {
@@ -404,8 +399,6 @@ void StarCfg::fromFileJson(json &j) {
             return;
         }
 
-        auto abcSubRegs = AbcStarRegInfo::instance()->abcSubRegisterMap_all;
-
         for (int iABC = 0; iABC < numABCs(); iABC++) {
             auto &chipSubRegs = subregArray[iABC];
 
@@ -104,27 +104,31 @@ void StarChips::reset(){
 
 	uint8_t delay = 0; //2 bits BC delay
 
-	//sendCmd(LCB::fast_command(LCB::LOGIC_RESET, delay) );
+	StarCmdStream stream;
+
+	//stream.add(LCB::fast_command(LCB::LOGIC_RESET, delay) );
 	logger->debug("Sending fast command #{} ABC_REG_RESET", LCB::ABC_REG_RESET);
-	sendCmd(LCB::fast_command(LCB::ABC_REG_RESET, delay) );
+	stream.add(LCB::fast_command(LCB::ABC_REG_RESET, delay) );
 
 	logger->debug("Sending fast command #{} ABC_SLOW_COMMAND_RESET", LCB::ABC_SLOW_COMMAND_RESET);
-	sendCmd(LCB::fast_command(LCB::ABC_SLOW_COMMAND_RESET, delay) );
+	stream.add(LCB::fast_command(LCB::ABC_SLOW_COMMAND_RESET, delay) );
 
 	logger->debug("Sending fast command #{} ABC_SEU_RESET", LCB::ABC_SEU_RESET);
-	sendCmd(LCB::fast_command(LCB::ABC_SEU_RESET, delay) );
+	stream.add(LCB::fast_command(LCB::ABC_SEU_RESET, delay) );
 
 	logger->debug("Sending fast command #{} ABC_HIT_COUNT_RESET", LCB::ABC_HIT_COUNT_RESET);
-	sendCmd(LCB::fast_command(LCB::ABC_HIT_COUNT_RESET, delay) );
+	stream.add(LCB::fast_command(LCB::ABC_HIT_COUNT_RESET, delay) );
 
 	logger->debug("Sending fast command #{} ABC_HIT_COUNT_START", LCB::ABC_HIT_COUNT_START);
-	sendCmd(LCB::fast_command(LCB::ABC_HIT_COUNT_START, delay) );
+	stream.add(LCB::fast_command(LCB::ABC_HIT_COUNT_START, delay) );
 
 	logger->debug("Sending fast command #{} HCC_START_PRLP", LCB::HCC_START_PRLP);
-	sendCmd(LCB::fast_command(LCB::HCC_START_PRLP, delay) );
+	stream.add(LCB::fast_command(LCB::HCC_START_PRLP, delay) );
 
 	logger->debug("Sending lonely_BCR");
-	sendCmd(LCB::lonely_bcr());
+	stream.add(LCB::lonely_bcr());
+
+	sendCmd(stream);
 }
 
 void StarChips::configure() {
@@ -142,39 +146,20 @@ void StarChips::configure() {
 }
 
 void StarChips::sendCmd(uint16_t cmd){
-	//	std::cout << std::hex <<cmd << std::dec<< "_"<<std::endl;
-
-	m_txcore->writeFifo((LCB::IDLE << 16) + LCB::IDLE);
-	m_txcore->writeFifo((cmd << 16) + LCB::IDLE);
-	m_txcore->writeFifo((LCB::IDLE << 16) + LCB::IDLE);
-	m_txcore->releaseFifo();
-
+	StarCmdStream stream;
+	stream.add(cmd);
+	sendCmd(stream);
 }
 
 void StarChips::sendCmd(std::array<uint16_t, 9> cmd){
-	//    std::cout << __PRETTY_FUNCTION__ << "  txChannel: " << getTxChannel() << " cmd:  " <<  cmd << std::endl;
-	//	for( auto a : cmd ) {
-	//		std::cout << std::hex <<a << std::dec<< "_";
-	//	}
-	//	std::cout <<  std::endl;
-
-	//	std::cout << std::hex <<((cmd[0] << 16) + cmd[1])<< std::dec<< "_";
-	//	std::cout << std::hex <<((cmd[2] << 16) + cmd[3]) << std::dec<< "_";
-	//	std::cout << std::hex <<((cmd[4] << 16) + cmd[5])<< std::dec<< "_";
-	//	std::cout << std::hex <<((cmd[6] << 16) + cmd[7])<< std::dec<< "_";
-	//	std::cout << std::hex <<((cmd[8] << 16) + 0)<< std::dec<< "_";
-	//	std::cout <<  std::endl;
-	m_txcore->writeFifo((LCB::IDLE << 16) + LCB::IDLE);
-	m_txcore->writeFifo((LCB::IDLE << 16) + LCB::IDLE);
-	m_txcore->writeFifo((cmd[0] << 16) + cmd[1]);
-	m_txcore->writeFifo((cmd[2] << 16) + cmd[3]);
-	m_txcore->writeFifo((cmd[4] << 16) + cmd[5]);
-	m_txcore->writeFifo((cmd[6] << 16) + cmd[7]);
-	m_txcore->writeFifo((cmd[8] << 16) + LCB::IDLE);
-	m_txcore->writeFifo((LCB::IDLE << 16) + LCB::IDLE);
-	m_txcore->writeFifo((LCB::IDLE << 16) + LCB::IDLE);
-	m_txcore->releaseFifo();
+	StarCmdStream stream;
+	stream.add(cmd);
+	sendCmd(stream);
+}
 
+void StarChips::sendCmd(const StarCmdStream &stream){
+	m_txcore->writeFifoBlock(stream.data(), stream.size());
+	m_txcore->releaseFifo();
 }
 
 
@@ -186,32 +171,37 @@ bool StarChips::writeRegisters(){
         // First write HCC
         int hccId = getHCCchipID();
 
-        const auto &hcc_regs = HccStarRegInfo::instance()->hccregisterMap;
+        const auto &hcc_regs = HCCStarRegister::_values();
 	logger->info("Starting on chip {} with {} registers", hccId, hcc_regs.size());
 
-        for(auto &map_iter: hcc_regs) {
-              auto addr = map_iter.first;
-              logger->trace("Writing HCC Register {} for chipID {}", addr, hccId);
-              writeHCCRegister(addr);
+        // All registers of all chips go in one burst per stage
+        StarCmdStream stream;
+        stream.reserve(hcc_regs.size());
+        for(HCCStarRegister addr: hcc_regs) {
+              logger->trace("Writing HCC Register {} for chipID {}", (int)addr, hccId);
+              queueHCCRegister(stream, addr);
         }
+        sendCmd(stream);
 
         // Send resets to ABC now HCC is configured
         this->reset();
 
         // Then each ABC
-        const auto &abc_regs = AbcStarRegInfo::instance()->abcregisterMap;
+        const auto &abc_regs = ABCStarRegister::_values();
+        stream.clear();
+        stream.reserve(num_abc * abc_regs.size());
 	eachAbc([&](auto &abc) {
                 int this_chipID = abc.getABCchipID();
 
                 logger->info("Starting on chip {} with {} registers", this_chipID, abc_regs.size());
-		for(auto &map_iter: abc_regs) {
-                        auto addr = map_iter.first;
-                        logger->debug("Writing Register {} for chipID {}", addr, this_chipID);
+		for(ABCStarRegister addr: abc_regs) {
+                        logger->debug("Writing Register {} for chipID {}", (int)addr, this_chipID);
 
-                        writeABCRegister(addr, abc);
+                        queueABCRegister(stream, addr, abc);
 		}
 		logger->info("Done with {}", this_chipID);
           });
+        sendCmd(stream);
 
 	return true;
 }
@@ -246,10 +236,7 @@ void StarChips::readRegisters(){
 	//Read all known registers, both for HCC & all ABCs
         logger->debug("Looping over all chips in readRegisters, where m_nABC is {}", numABCs());
 
-        auto &hcc_regs = HccStarRegInfo::instance()->hccregisterMap;
-
-        for(auto &map_iter: hcc_regs) {
-                auto addr = map_iter.first;
+        for(int addr: HCCStarRegister::_values()) {
                 // Skip HCCCommand reg
                 if(addr == 16) continue;
                 int this_chipID = getHCCchipID();
@@ -257,12 +244,9 @@ void StarChips::readRegisters(){
                 readHCCRegister(addr);
         }
 
-        auto &abc_regs = AbcStarRegInfo::instance()->abcregisterMap;
-
         eachAbc([&](const auto &abc) {
                 int this_chipID = abc.getABCchipID();
-                for(auto &map_iter: abc_regs) {
-                        auto addr = map_iter.first;
+                for(int addr: ABCStarRegister::_values()) {
 
                         logger->debug("Hcc id: {}", getHCCchipID());
                         logger->debug("Calling readRegister for chipID {} register {}", this_chipID, addr);
@@ -277,16 +261,36 @@ void StarChips::readRegisters(){
 }
 
 void StarChips::writeHCCRegister(int addr) {
-    uint32_t value = m_hcc.getRegisterValue(HCCStarRegister::_from_integral(addr));
-    logger->debug("Doing HCC write register with value 0x{:08x} from registerMap[addr={}]", value, addr);
-    sendCmd(write_hcc_register(addr, value, getHCCchipID()));
+    StarCmdStream stream;
+    queueHCCRegister(stream, HCCStarRegister::_from_integral(addr));
+    sendCmd(stream);
+}
+
+void StarChips::writeABCRegister(int addr) {
+    auto reg = ABCStarRegister(ABCStarRegs::_from_integral(addr));
+    StarCmdStream stream;
+    stream.reserve(numABCs());
+    eachAbc([&](auto &abc) { queueABCRegister(stream, reg, abc); });
+    sendCmd(stream);
 }
 
 void StarChips::writeABCRegister(int addr, AbcCfg &cfg) {
-    uint32_t value = cfg.getRegisterValue(ABCStarRegister::_from_integral(addr));
+    StarCmdStream stream;
+    queueABCRegister(stream, ABCStarRegister(ABCStarRegs::_from_integral(addr)), cfg);
+    sendCmd(stream);
+}
+
+void StarChips::queueHCCRegister(StarCmdStream &stream, HCCStarRegister addr) {
+    uint32_t value = m_hcc.getRegisterValue(addr);
+    logger->debug("Doing HCC write register with value 0x{:08x} from registerMap[addr={}]", value, (int)addr);
+    stream.add(write_hcc_register(addr, value, getHCCchipID()));
+}
+
+void StarChips::queueABCRegister(StarCmdStream &stream, ABCStarRegister addr, const AbcCfg &cfg) {
+    uint32_t value = cfg.getRegisterValue(addr);
     auto id = cfg.getABCchipID();
-    logger->debug("Doing ABC ID {} writeRegister {} with value 0x{:08x}", id, addr, value);
-    sendCmd(write_abc_register(addr, value, getHCCchipID(), id));
+    logger->debug("Doing ABC ID {} writeRegister {} with value 0x{:08x}", id, (int)addr, value);
+    stream.add(write_abc_register(addr, value, getHCCchipID(), id));
 }
 
 void StarChips::readHCCRegister(int addr) {
@@ -26,3 +26,20 @@ std::array<LCB::Frame, 9> StarCmd::command_sequence(int hccid, int abcid, int ad
 
   return result;
 }
+
+void StarCmdStream::add(const std::array<LCB::Frame, 9> &cmd) {
+  const uint32_t idle = (LCB::IDLE << 16) | LCB::IDLE;
+  m_words.insert(m_words.end(), {
+      idle, idle,
+      (uint32_t(cmd[0]) << 16) | cmd[1],
+      (uint32_t(cmd[2]) << 16) | cmd[3],
+      (uint32_t(cmd[4]) << 16) | cmd[5],
+      (uint32_t(cmd[6]) << 16) | cmd[7],
+      (uint32_t(cmd[8]) << 16) | LCB::IDLE,
+      idle, idle});
+}
+
+void StarCmdStream::add(LCB::Frame cmd) {
+  const uint32_t idle = (LCB::IDLE << 16) | LCB::IDLE;
+  m_words.insert(m_words.end(), {idle, (uint32_t(cmd) << 16) | LCB::IDLE, idle});
+}
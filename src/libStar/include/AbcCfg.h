@@ -7,9 +7,8 @@
 // # Comment: ABC Star configuration class
 // ################################
 
-#include <map>
-#include <memory>
-#include <vector>
+#include <array>
+#include <string>
 
 #include "enum.h"
 #include "StarRegister.h"
@@ -55,48 +54,35 @@ class ABCStarRegister : public ABCStarRegs {
     static  ABCStarRegister TrimHi(int i) { return ABCStarRegs::_from_integral((int)(ABCStarRegs::TrimDAC32) + i);}
 };
 
-/// Lookup information on ABC Star register map
-class AbcStarRegInfo {
-  public:
-  /// Fills the maps appropriately
-  AbcStarRegInfo();
-
-  //This is a map from each register address to the register info.  Thus abcregisterMap[addr]
-  std::map<unsigned, std::shared_ptr<RegisterInfo>> abcregisterMap;
+/// Lookup information on ABC Star register map, tables built at compile time
+namespace AbcStarRegInfo {
+  /// Registers are stored by address, not all addresses are used
+  constexpr unsigned numRegisters = ABCStarRegs::HitCountREG63 + 1;
 
-  //This is a 2D map of each subregister to the ABC subregister name.  For example abcSubRegisterMap_all[NAME]
-  std::map<ABCStarSubRegister, std::shared_ptr<SubRegisterInfo>> abcSubRegisterMap_all;
+  /// Position of a sub register
+  const SubRegisterInfo &subRegister(ABCStarSubRegister r);
 
-  //This is a 2D map of each trimDac_32b register to the chip index and trimDAC_4LSB register name.  For example trimDAC4LSB_RegisterMap_all[chip index][NAME]
-  std::map<int, std::shared_ptr<SubRegisterInfo>> trimDAC_4LSB_RegisterMap_all;
-
-  //This is a 2D map of each trimDac_32b register to the chip index and trimDAC_1MSB register name.  For example trimDAC1LSB_RegisterMap_all[chip index][NAME]
-  std::map<int, std::shared_ptr<SubRegisterInfo>> trimDAC_1MSB_RegisterMap_all;
+  /// Low 4 bits of the trim of a channel, 8 channels per register
+  constexpr SubRegisterInfo trimDAC4LSB(unsigned channel) {
+    return {ABCStarRegs::TrimDAC0 + channel/8, (channel%8)*4, 4};
+  }
 
-  static std::shared_ptr<AbcStarRegInfo> instance() {
-    if(!m_instance) m_instance.reset(new AbcStarRegInfo);
-    return m_instance;
+  /// High bit of the trim of a channel, 32 channels per register
+  constexpr SubRegisterInfo trimDAC1MSB(unsigned channel) {
+    return {ABCStarRegs::TrimDAC32 + channel/32, channel%32, 1};
   }
 
-  int getSubRegisterParentAddr(std::string subRegName) const {
-    auto info = abcSubRegisterMap_all.at(ABCStarSubRegister::_from_string(subRegName.c_str()));
-    return info->getRegAddress();
+  inline int getSubRegisterParentAddr(std::string subRegName) {
+    return subRegister(ABCStarSubRegister::_from_string(subRegName.c_str())).getRegAddress();
   }
- private:
-  static std::shared_ptr<AbcStarRegInfo> m_instance;
-};
+}
 
 /// Configuration for an individual ABCStar
 class AbcCfg {
         unsigned m_abcID;
 
-        //This is a map from address to register index (into register set)
-        std::map<unsigned, unsigned> m_registerMap;
-
-        // Store of registers in arbitrary order
-        std::vector< Register > m_registerSet;
-
-        std::shared_ptr< AbcStarRegInfo > m_info;
+        /// Register values indexed by address
+        std::array<uint32_t, AbcStarRegInfo::numRegisters> m_registers;
 
     public:
         AbcCfg();
@@ -114,29 +100,39 @@ class AbcCfg {
         }
 
         void setSubRegisterValue(std::string subRegName, uint32_t value) {
-            auto info = m_info->abcSubRegisterMap_all[ABCStarSubRegister::_from_string(subRegName.c_str())];
-            auto &reg = getRegister(info->m_regAddress);
-            reg.getSubRegister(info).updateValue(value);
+            setSubRegisterValue(ABCStarSubRegister::_from_string(subRegName.c_str()), value);
         }
 
-        uint32_t getSubRegisterValue(std::string subRegName) {
-            auto info = m_info->abcSubRegisterMap_all[ABCStarSubRegister::_from_string(subRegName.c_str())];
-            auto &reg = getRegister(info->m_regAddress);
-            return reg.getSubRegister(info).getValue();
+        void setSubRegisterValue(ABCStarSubRegister r, uint32_t value) {
+            auto &info = AbcStarRegInfo::subRegister(r);
+            auto &reg = m_registers[info.m_regAddress];
+            reg = info.updateValue(reg, value);
+        }
+
+        uint32_t getSubRegisterValue(std::string subRegName) const {
+            return getSubRegisterValue(ABCStarSubRegister::_from_string(subRegName.c_str()));
+        }
+
+        uint32_t getSubRegisterValue(ABCStarSubRegister r) const {
+            auto &info = AbcStarRegInfo::subRegister(r);
+            return info.getValue(m_registers[info.m_regAddress]);
         }
 
         int getSubRegisterParentAddr(std::string subRegName) const {
-            return m_info->getSubRegisterParentAddr(subRegName);
+            return AbcStarRegInfo::getSubRegisterParentAddr(subRegName);
         }
 
         uint32_t getSubRegisterParentValue(std::string subRegName) const {
-            auto info = m_info->abcSubRegisterMap_all[ABCStarSubRegister::_from_string(subRegName.c_str())];
-            return getRegister(info->m_regAddress).getValue();
+            return m_registers[getSubRegisterParentAddr(subRegName)];
         }
 
-        uint32_t getRegisterValue(ABCStarRegister addr) const;
+        uint32_t getRegisterValue(ABCStarRegister addr) const {
+            return m_registers[(unsigned int)addr];
+        }
 
-        void setRegisterValue(ABCStarRegister addr, uint32_t val);
+        void setRegisterValue(ABCStarRegister addr, uint32_t val) {
+            m_registers[(unsigned int)addr] = val;
+        }
 
         /// Set trim DAC for particular channel (as calculated by StarCfg)
         void setTrimDACRaw(unsigned channel, int value);
@@ -147,17 +143,16 @@ class AbcCfg {
         /// Is channel masked
         bool isMasked(unsigned channel) const {
             uint8_t maskIndex = ((channel & 0x7f) << 1) | ((channel & 0x80) >> 7);
-            int maskReg = ABCStarRegister::MaskInput((maskIndex>>5) & 0x7);
-            uint32_t maskValue = getRegister(maskReg).getValue();
+            int maskReg = ABCStarRegs::MaskInput0 + ((maskIndex>>5) & 0x7);
+            uint32_t maskValue = m_registers[maskReg];
             return maskValue & (1 << (maskIndex&0x1f));
         }
 
         /// Set mask for strip
         void setMask(unsigned channel, bool mask) {
             uint8_t maskIndex = ((channel & 0x7f) << 1) | ((channel & 0x80) >> 7);
-            int maskReg = ABCStarRegister::MaskInput((maskIndex>>5) & 0x7);
-            auto &reg = getRegister(maskReg);
-            uint32_t maskValue = reg.getValue();
+            int maskReg = ABCStarRegs::MaskInput0 + ((maskIndex>>5) & 0x7);
+            uint32_t &maskValue = m_registers[maskReg];
             uint32_t maskPattern =  1 << (maskIndex&0x1f);
 
             if(mask) {
@@ -165,41 +160,7 @@ class AbcCfg {
             } else {
               maskValue &= ~maskPattern; 
             }
-            reg.setValue(maskValue);
         }
-
-    private:
-        SubRegister getSubRegister(ABCStarSubRegister r) {
-            auto info = m_info->abcSubRegisterMap_all[r];
-            return getRegister(info->m_regAddress).getSubRegister(info);
-        }
-
-        ConstSubRegister getSubRegister(ABCStarSubRegister r) const {
-            auto info = m_info->abcSubRegisterMap_all[r];
-            return getRegister(info->m_regAddress).getSubRegister(info);
-        }
-
-        const Register &getRegister(ABCStarRegister addr) const {
-            auto index = m_registerMap.at((unsigned int)addr);
-            return m_registerSet[index];
-        }
-
-        Register &getRegister(ABCStarRegister addr) {
-            auto index = m_registerMap.at((unsigned int)addr);
-            return m_registerSet[index];
-        }
-
-        const Register &getRegister(unsigned int addr) const {
-            auto index = m_registerMap.at(addr);
-            return m_registerSet[index];
-        }
-
-        Register &getRegister(unsigned int addr) {
-            auto index = m_registerMap.at(addr);
-            return m_registerSet[index];
-        }
-
-        void setupMaps();
 };
 
 #endif
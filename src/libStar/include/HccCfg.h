@@ -1,8 +1,8 @@
 #ifndef HCC_STAR_CFG_INCLUDE
 #define HCC_STAR_CFG_INCLUDE
 
-#include <map>
-#include <vector>
+#include <array>
+#include <string>
 
 #include "enum.h"
 
@@ -36,38 +36,21 @@ BETTER_ENUM(HCCStarSubRegister, int,
             LCBERRCOUNTTHR, R3L1ERRCOUNTTHR,
             AMENABLE, AMCALIB, AMSW0, AMSW1, AMSW2, AMSW60, AMSW80, AMSW100, ANASET, THERMOFFSET)
 
-/// Lookup information on HCCStar register map
-class HccStarRegInfo {
-    public:
-        /// Fills the maps appropriately
-        HccStarRegInfo();
-
-        //This is a map from each register address to the register info.  Thus hccregisterMap[addr]
-        std::map<unsigned, std::shared_ptr<RegisterInfo>> hccregisterMap;
+/// Lookup information on HCCStar register map, tables built at compile time
+namespace HccStarRegInfo {
+    /// Registers are stored by address, not all addresses are used
+    constexpr unsigned numRegisters = HCCStarRegister::ADCcfg + 1;
 
-        //This is a 2D map of each subregister to the HCC subregister name.  For example hccSubRegisterMap_all[NAME]
-        // SubRegister is owned by the Registers
-        std::map<HCCStarSubRegister, std::shared_ptr<SubRegisterInfo>> hccSubRegisterMap_all;   //register record
-
-        static std::shared_ptr<HccStarRegInfo> instance() {
-            if(!m_instance) m_instance.reset(new HccStarRegInfo);
-            return m_instance;
-        }
-   private:
-        static std::shared_ptr<HccStarRegInfo> m_instance;
-};
+    /// Position of a sub register
+    const SubRegisterInfo &subRegister(HCCStarSubRegister r);
+}
 
 /// Configuration for an individual HCCStar
 class HccCfg {
         unsigned m_hccID;
 
-        //This is a map from address to register (pointers into register set)
-        std::map<unsigned, Register*> m_registerMap;
-
-        // Store of registers in arbitrary order
-        std::vector< Register > m_registerSet;
-
-        std::shared_ptr< HccStarRegInfo > m_info;
+        /// Register values indexed by address
+        std::array<uint32_t, HccStarRegInfo::numRegisters> m_registers;
 
     public:
         HccCfg();
@@ -75,8 +58,7 @@ class HccCfg {
         HccCfg(const HccCfg &) = delete;
         HccCfg &operator =(const HccCfg &) = delete;
         HccCfg &operator =(HccCfg &&) = delete;
-        // Default doesn't work as won't change pointers!
-        HccCfg(HccCfg &&other) = delete;
+        HccCfg(HccCfg &&other) = default;
 
         void setDefaults();
 
@@ -86,44 +68,39 @@ class HccCfg {
         }
 
         void setSubRegisterValue(std::string subRegName, uint32_t value) {
-            auto info = m_info->hccSubRegisterMap_all[HCCStarSubRegister::_from_string(subRegName.c_str())];
-            m_registerMap.at(info->m_regAddress)->getSubRegister(info).updateValue(value);
+            setSubRegisterValue(HCCStarSubRegister::_from_string(subRegName.c_str()), value);
         }
 
-        uint32_t getSubRegisterValue(std::string subRegName) {
-            auto info = m_info->hccSubRegisterMap_all[HCCStarSubRegister::_from_string(subRegName.c_str())];
-            return m_registerMap.at(info->m_regAddress)->getSubRegister(info).getValue();
+        void setSubRegisterValue(HCCStarSubRegister r, uint32_t value) {
+            auto &info = HccStarRegInfo::subRegister(r);
+            auto &reg = m_registers[info.m_regAddress];
+            reg = info.updateValue(reg, value);
         }
 
-        int getSubRegisterParentAddr(std::string subRegName) const {
-            auto info = m_info->hccSubRegisterMap_all[HCCStarSubRegister::_from_string(subRegName.c_str())];
-            return info->getRegAddress();
+        uint32_t getSubRegisterValue(std::string subRegName) const {
+            return getSubRegisterValue(HCCStarSubRegister::_from_string(subRegName.c_str()));
         }
 
-        uint32_t getSubRegisterParentValue(std::string subRegName) const {
-            auto info = m_info->hccSubRegisterMap_all[HCCStarSubRegister::_from_string(subRegName.c_str())];
-            return m_registerMap.at(info->m_regAddress)->getValue();
+        uint32_t getSubRegisterValue(HCCStarSubRegister r) const {
+            auto &info = HccStarRegInfo::subRegister(r);
+            return info.getValue(m_registers[info.m_regAddress]);
         }
 
-        uint32_t getRegisterValue(HCCStarRegister addr) const;
-
-        void setRegisterValue(HCCStarRegister addr, uint32_t val);
-
-    private:
-        SubRegister getSubRegister(HCCStarSubRegister r) const {
-            auto info = m_info->hccSubRegisterMap_all[r];
-            return m_registerMap.at(info->m_regAddress)->getSubRegister(info);
+        int getSubRegisterParentAddr(std::string subRegName) const {
+            return HccStarRegInfo::subRegister(HCCStarSubRegister::_from_string(subRegName.c_str())).getRegAddress();
         }
 
-        const Register &getRegister(HCCStarRegister addr) const {
-            return *m_registerMap.at((unsigned int)addr);
+        uint32_t getSubRegisterParentValue(std::string subRegName) const {
+            return m_registers[getSubRegisterParentAddr(subRegName)];
         }
 
-        Register &getRegister(HCCStarRegister addr) {
-            return *m_registerMap.at((unsigned int)addr);
+        uint32_t getRegisterValue(HCCStarRegister addr) const {
+            return m_registers[(unsigned int)addr];
         }
 
-        void setupMaps();
+        void setRegisterValue(HCCStarRegister addr, uint32_t val) {
+            m_registers[(unsigned int)addr] = val;
+        }
 };
 
 
@@ -1,6 +1,7 @@
 #ifndef STAR_LCB_HEADER
 #define STAR_LCB_HEADER
 
+#include <cstdint>
 #include <tuple>
 
 namespace SixEight {
@@ -13,7 +14,7 @@ namespace SixEight {
     return (2*count_bits(d))-6;
   }
 
-  inline uint8_t encode(uint8_t data6) {
+  constexpr uint8_t encode(uint8_t data6) {
     int d = disparity(data6);
     switch(d) {
     case  0: return 0x80 | data6; // Prepend 10
@@ -47,7 +48,7 @@ namespace SixEight {
     return 0xff;
   }
 
-  inline uint8_t kcode(int k) {
+  constexpr uint8_t kcode(int k) {
     switch(k) {
     case 0: case 56: return 0x78;
     case 1: case 21: return 0x55;
@@ -150,10 +151,10 @@ namespace LCB {
 
   typedef uint16_t Frame;
 
-  const uint8_t K0 = SixEight::kcode(0);
-  const uint8_t K1 = SixEight::kcode(1);
-  const uint8_t K2 = SixEight::kcode(2);
-  const uint8_t K3 = SixEight::kcode(3);
+  constexpr uint8_t K0 = SixEight::kcode(0);
+  constexpr uint8_t K1 = SixEight::kcode(1);
+  constexpr uint8_t K2 = SixEight::kcode(2);
+  constexpr uint8_t K3 = SixEight::kcode(3);
 
   enum FastCmdType {
     NONE = 0,
@@ -184,9 +185,9 @@ namespace LCB {
   }
 
   /// Idle frame
-  const Frame IDLE = build_pair(K0, K1);
+  constexpr Frame IDLE = build_pair(K0, K1);
 
-  inline Frame raw_bits(uint16_t bits) {
+  constexpr Frame raw_bits(uint16_t bits) {
     return (SixEight::encode((bits>>6) & 0x3f) << 8) | SixEight::encode(bits&0x3f);
   }
 
@@ -232,9 +233,19 @@ namespace LCB {
     return twelve & 0x7f;
   }
 
+  /// Frames for all 7 bits of command data, encoded at compile time
+  struct CommandTable {
+    constexpr CommandTable() : frames() {
+      for(uint16_t d=0; d<128; d++) frames[d] = raw_bits(d);
+    }
+    Frame frames[128];
+  };
+
+  inline constexpr CommandTable command_table;
+
   /// Data for command (register r/w)
   inline Frame command_bits(uint16_t data) {
-    return raw_bits(data & 0x7f);
+    return command_table.frames[data & 0x7f];
   }
 
   /// Extract command data (register r/w)
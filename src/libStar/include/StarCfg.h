@@ -53,9 +53,14 @@ class StarCfg : public FrontEndCfg {
   void addABCchipID(unsigned int chipID) {
     m_ABCchips.push_back({});
     m_ABCchips.back().setABCChipId(chipID);
+    if(chipID >= m_abcIndexByID.size()) m_abcIndexByID.resize(chipID+1, -1);
+    m_abcIndexByID[chipID] = m_ABCchips.size()-1;
   }
 
-  void clearABCchipIDs() { m_ABCchips.clear(); }
+  void clearABCchipIDs() {
+    m_ABCchips.clear();
+    m_abcIndexByID.clear();
+  }
 
   void setSubRegisterValue(int chipIndex, std::string subRegName, uint32_t value) {
     if (!chipIndex && HCCStarSubRegister::_is_valid(subRegName.c_str())) { //If HCC, looking name
@@ -79,11 +84,25 @@ class StarCfg : public FrontEndCfg {
     return 0;
   }
 
+  /// Without the name lookup, for the emulator
+  void setSubRegisterValue(HCCStarSubRegister r, uint32_t value) {
+    m_hcc.setSubRegisterValue(r, value);
+  }
+  uint32_t getSubRegisterValue(HCCStarSubRegister r) const {
+    return m_hcc.getSubRegisterValue(r);
+  }
+  void setSubRegisterValue(int chipIndex, ABCStarSubRegister r, uint32_t value) {
+    abcFromIndex(chipIndex).setSubRegisterValue(r, value);
+  }
+  uint32_t getSubRegisterValue(int chipIndex, ABCStarSubRegister r) const {
+    return abcFromIndex(chipIndex).getSubRegisterValue(r);
+  }
+
   int getSubRegisterParentAddr(int chipIndex, std::string subRegName) {
     if (!chipIndex && HCCStarSubRegister::_is_valid(subRegName.c_str())) { //If HCC, looking name
       return m_hcc.getSubRegisterParentAddr(subRegName);
     } else if (chipIndex && ABCStarSubRegister::_is_valid(subRegName.c_str())) { //If looking for an ABC subregister enum
-      return AbcStarRegInfo::instance()->getSubRegisterParentAddr(subRegName);
+      return AbcStarRegInfo::getSubRegisterParentAddr(subRegName);
     }else {
       std::cerr << " --> Error: Could not find register \""<< subRegName << "\"" << std::endl;
     }
@@ -138,8 +157,11 @@ class StarCfg : public FrontEndCfg {
 
  protected:
   AbcCfg &abcFromChipID(unsigned int chipID) {
-    return *std::find_if(m_ABCchips.begin(), m_ABCchips.end(),
-                        [this, chipID](auto &it) { return it.getABCchipID() == chipID; });
+    int index = hccChannelForABCchipID(chipID);
+    if(index >= m_ABCchips.size()) {
+      throw std::runtime_error("No ABC with chip ID " + std::to_string(chipID));
+    }
+    return m_ABCchips[index];
   }
 
   uint32_t m_sn=0;//serial number set by eFuse bits
@@ -148,6 +170,9 @@ class StarCfg : public FrontEndCfg {
 
   std::vector<AbcCfg> m_ABCchips;
 
+  /// Index into m_ABCchips by chip ID, -1 if not used
+  std::vector<int> m_abcIndexByID;
+
   AbcCfg &abcFromIndex(int chipIndex) {
     assert(chipIndex > 0);
     assert(chipIndex <= m_ABCchips.size());
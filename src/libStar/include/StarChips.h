@@ -48,15 +48,18 @@ class StarChips : public StarCfg, public StarCmd, public FrontEnd {
   void reset();
   void sendCmd(std::array<uint16_t, 9> cmd);
   void sendCmd(uint16_t cmd);
+  /// Send all commands in the stream in one burst. Same words as sending
+  /// them one by one, but a TX core that pads in releaseFifo (the emulator
+  /// adds a 0x0 word) does so once per burst instead of once per command.
+  void sendCmd(const StarCmdStream &stream);
 
   bool writeRegisters();
   void readRegisters();
 
   void writeHCCRegister(int addr);
 
-  void writeABCRegister(int addr) {
-    eachAbc([&](auto &abc) { writeABCRegister(addr, abc); });
-  }
+  /// Write the register of all ABCs in one burst
+  void writeABCRegister(int addr);
 
   void readHCCRegister(int addr);
 
@@ -101,6 +104,10 @@ class StarChips : public StarCfg, public StarCmd, public FrontEnd {
 
   void writeABCRegister(int addr, AbcCfg &cfg);
 
+  /// Add register writes with the current values to a stream
+  void queueHCCRegister(StarCmdStream &stream, HCCStarRegister addr);
+  void queueABCRegister(StarCmdStream &stream, ABCStarRegister addr, const AbcCfg &cfg);
+
     TxCore * m_txcore;
 };
 
@@ -7,6 +7,8 @@
 // ################################
 
 #include <array>
+#include <cstddef>
+#include <vector>
 
 #include "LCBUtils.h"
 
@@ -42,4 +44,29 @@ class StarCmd {
   
 };
 
+/**
+ * Command sequences collected in one buffer, sent to the TxCore in one burst.
+ *
+ * Each command is padded with the same idle frames as when sent on its own.
+ */
+class StarCmdStream {
+ public:
+  /// Register read or write sequence
+  void add(const std::array<LCB::Frame, 9> &cmd);
+
+  /// Single frame, eg fast command
+  void add(LCB::Frame cmd);
+
+  const uint32_t *data() const { return m_words.data(); }
+  std::size_t size() const { return m_words.size(); }
+  bool empty() const { return m_words.empty(); }
+  void clear() { m_words.clear(); }
+
+  /// Make space for this many register sequences
+  void reserve(std::size_t commands) { m_words.reserve(m_words.size() + commands*9); }
+
+ private:
+  std::vector<uint32_t> m_words;
+};
+
 #endif
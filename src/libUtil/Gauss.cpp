@@ -1,36 +1,230 @@
 #include "Gauss.h"
 
+#include <atomic>
 #include <cmath>
-#include <cstdlib>
+#include <initializer_list>
+#include <random>
+
+namespace {
+    uint64_t splitmix64(uint64_t &x) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    inline uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // Ziggurat with 128 layers (Marsaglia & Tsang, in the form of Doornik's ZIGNOR)
+    const unsigned zigLayers = 128;
+    const double zigR = 3.442619855899;
+    const double zigV = 9.91256303526217e-3;
+
+    struct ZigguratTables {
+        double x[zigLayers+1];
+        double ratio[zigLayers];
+
+        ZigguratTables() {
+            double f = exp(-0.5*zigR*zigR);
+            x[0] = zigV/f;
+            x[1] = zigR;
+            x[zigLayers] = 0;
+            for (unsigned i=2; i<zigLayers; i++) {
+                x[i] = sqrt(-2*log(zigV/x[i-1] + f));
+                f = exp(-0.5*x[i]*x[i]);
+            }
+            for (unsigned i=0; i<zigLayers; i++) {
+                ratio[i] = x[i+1]/x[i];
+            }
+        }
+    };
+    const ZigguratTables zig;
+
+    std::atomic<uint64_t> baseSeed(0);
+    std::atomic<unsigned> seedEpoch(0);
+    std::atomic<unsigned> seededThreads(0);
+}
 
 namespace Gauss {
-// should use a better function than this (box muller method - stolen from the internet)
-double rand_normal(double mean, double sigma, bool can_be_negative) {
-    static double n2 = 0.0;
-    static int n2_cached = 0;
-    if (!n2_cached) {
-        double x, y, r;
+
+Generator::Generator(uint64_t seed) {
+    this->seed(seed);
+}
+
+void Generator::seed(uint64_t seed) {
+    for (unsigned i=0; i<4; i++)
+        s[i] = splitmix64(seed);
+}
+
+uint64_t Generator::next() {
+    const uint64_t result = rotl(s[1]*5, 7)*9;
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+double Generator::uniform() {
+    return ((next() >> 11) + 0.5)*0x1.0p-53;
+}
+
+double Generator::normal() {
+    for (;;) {
+        // Upper bits for the coordinate, lowest bits pick the layer
+        uint64_t r = next();
+        unsigned i = r & (zigLayers-1);
+        double u = 2*(((r >> 11) + 0.5)*0x1.0p-53) - 1;
+
+        // Inside the rectangle of the layer
+        if (fabs(u) < zig.ratio[i])
+            return u*zig.x[i];
+
+        // Base layer, sample from the tail beyond zigR
+        if (i == 0) {
+            double x, y;
+            do {
+                x = log(uniform())/zigR;
+                y = log(uniform());
+            } while (-2*y < x*x);
+            return (u < 0) ? x - zigR : zigR - x;
+        }
+
+        // Wedge between the rectangle and the density
+        double x = u*zig.x[i];
+        double f0 = exp(-0.5*(zig.x[i]*zig.x[i] - x*x));
+        double f1 = exp(-0.5*(zig.x[i+1]*zig.x[i+1] - x*x));
+        if (f1 + uniform()*(f0 - f1) < 1.0)
+            return x;
+    }
+}
+
+double Generator::normal(double mean, double sigma) {
+    return mean + sigma*normal();
+}
+
+double Generator::truncatedNormal(double mean, double sigma, double low) {
+    if (sigma <= 0)
+        return (mean < low) ? low : mean;
+    double a = (low - mean)/sigma;
+    if (a < 0) {
+        // At least half of the samples are accepted
+        double z;
         do {
-            x = 2.0 * rand() / RAND_MAX - 1;
-            y = 2.0 * rand() / RAND_MAX - 1;
-
-            r = x * x + y * y;
-        } while (r == 0.0 || r > 1.0);
-        double d = sqrt(-2.0 * log(r) / r);
-        double n1 = x * d;
-        n2 = y * d;
-        double result = n1 * sigma + mean;
-        n2_cached = 1;
-        if (!can_be_negative && result < 0) {
-            rand_normal(mean, sigma, can_be_negative);
+            z = normal();
+        } while (z < a);
+        return mean + sigma*z;
+    }
+    // Exponential proposal (Robert 1995), efficient for any a >= 0
+    double alpha = 0.5*(a + sqrt(a*a + 4));
+    double z;
+    do {
+        z = a - log(uniform())/alpha;
+    } while (uniform() > exp(-0.5*(z - alpha)*(z - alpha)));
+    return mean + sigma*z;
+}
+
+unsigned Generator::poisson(double mean) {
+    if (mean <= 0)
+        return 0;
+    if (mean < 10) {
+        // Multiply uniforms until below exp(-mean) (Knuth)
+        double limit = exp(-mean);
+        double prod = uniform();
+        unsigned k = 0;
+        while (prod > limit) {
+            prod *= uniform();
+            k++;
         }
-        return result;
-    } else {
-        n2_cached = 0;
-        if (!can_be_negative && n2 * sigma + mean < 0) {
-            rand_normal(mean, sigma, can_be_negative);
+        return k;
+    }
+    // Transformed rejection with squeeze (Hoermann 1993, PTRS)
+    double slam = sqrt(mean);
+    double loglam = log(mean);
+    double b = 0.931 + 2.53*slam;
+    double a = -0.059 + 0.02483*b;
+    double invalpha = 1.1239 + 1.1328/(b - 3.4);
+    double vr = 0.9277 - 3.6224/(b - 2);
+    for (;;) {
+        double u = uniform() - 0.5;
+        double v = uniform();
+        double us = 0.5 - fabs(u);
+        double k = floor((2*a/us + b)*u + mean + 0.43);
+        if (us >= 0.07 && v <= vr)
+            return k;
+        if (k < 0 || (us < 0.013 && v > us))
+            continue;
+        if (log(v) + log(invalpha) - log(a/(us*us) + b) <= -mean + k*loglam - lgamma(k + 1))
+            return k;
+    }
+}
+
+void Generator::fillNormal(double *out, unsigned n, double mean, double sigma) {
+    for (unsigned i=0; i<n; i++)
+        out[i] = normal();
+    for (unsigned i=0; i<n; i++)
+        out[i] = mean + sigma*out[i];
+}
+
+void Generator::fillNormal(float *out, unsigned n, float mean, float sigma) {
+    for (unsigned i=0; i<n; i++)
+        out[i] = normal();
+    for (unsigned i=0; i<n; i++)
+        out[i] = mean + sigma*out[i];
+}
+
+Generator& threadGenerator() {
+    thread_local Generator gen;
+    thread_local unsigned epoch = 0;
+    thread_local bool seeded = false;
+
+    unsigned current = seedEpoch.load(std::memory_order_acquire);
+    if (!seeded || epoch != current) {
+        if (current == 0) {
+            std::random_device rd;
+            gen.seed(((uint64_t)rd() << 32) | rd());
+        } else {
+            uint64_t stream = seededThreads++;
+            uint64_t seed = baseSeed.load(std::memory_order_relaxed);
+            gen.seed(seed ^ splitmix64(stream));
         }
-        return n2 * sigma + mean;
+        epoch = current;
+        seeded = true;
     }
+    return gen;
+}
+
+void setSeed(uint64_t seed) {
+    baseSeed = seed;
+    seededThreads = 0;
+    seedEpoch++;
+}
+
+uint64_t streamSeed(uint64_t key1, uint64_t key2, uint64_t key3) {
+    if (seedEpoch.load(std::memory_order_acquire) == 0)
+        return threadGenerator().next();
+
+    // Chained, so the order of the keys matters
+    uint64_t x = baseSeed.load(std::memory_order_relaxed);
+    for (uint64_t key : {key1, key2, key3}) {
+        x ^= key;
+        x = splitmix64(x);
+    }
+    return x;
+}
+
+double rand_normal(double mean, double sigma, bool can_be_negative) {
+    if (can_be_negative)
+        return threadGenerator().normal(mean, sigma);
+    return threadGenerator().truncatedNormal(mean, sigma, 0.0);
+}
+
+void fill_normal(float *out, unsigned n, float mean, float sigma) {
+    threadGenerator().fillNormal(out, n, mean, sigma);
 }
 }
@@ -8,8 +8,16 @@
 
 #include "GraphErrors.h"
 #include <stdio.h>
+#include <algorithm>
 #include <cstring>
 
+#include "PlotRenderer.h"
+#include "logging.h"
+
+namespace {
+    auto glog = logging::make_log("GraphErrors");
+}
+
 GraphErrors::GraphErrors(std::string arg_name, int arg_n, const double *arg_x, const double *arg_y, const double *arg_x_err, const double *arg_y_err, std::type_index t) : HistogramBase(arg_name, t) {
     data_n = arg_n;
     data_x = new double[data_n];
@@ -176,30 +184,25 @@ void GraphErrors::toFile(std::string prefix, std::string dir, bool header) {
 }
 
 void GraphErrors::plot(std::string prefix, std::string dir) {
-    // Put raw histo data in tmp file
-    std::string tmp_name = std::string(getenv("USER")) + "/tmp_yarr_histo1d_" + prefix;
-    this->toFile(tmp_name, "/tmp/", false);
-    std::string cmd = "gnuplot | epstopdf -f > " + dir + prefix + "_" + HistogramBase::name + ".pdf";
-
-    // Open gnuplot as file and pipe commands
-    FILE *gnu = popen(cmd.c_str(), "w");
-    
-    fprintf(gnu, "set terminal postscript enhanced color \"Helvetica\" 18 eps\n");
-    fprintf(gnu, "unset key\n");
-    fprintf(gnu, "set title \"%s\"\n" , HistogramBase::name.c_str());
-    fprintf(gnu, "set xlabel \"%s\"\n" , HistogramBase::xAxisTitle.c_str());
-    fprintf(gnu, "set ylabel \"%s\"\n" , HistogramBase::yAxisTitle.c_str());
-    if (is_xmin_limit && is_xmax_limit) fprintf(gnu, "set xrange[%f:%f]\n", xmin_limit, xmax_limit);
-    else if (is_xmin_limit) fprintf(gnu, "set xrange[%f:]\n", xmin_limit);
-    else if (is_xmax_limit) fprintf(gnu, "set xrange[:%f]\n", xmax_limit);
-//    fprintf(gnu, "set yrange[0:*]\n");
-//    fprintf(gnu, "set grid\n");
-//    fprintf(gnu, "set style line 1 lt 1 lc rgb '#A6CEE3'\n");
-//    fprintf(gnu, "set style fill solid 0.5\n");
-    fprintf(gnu, "plot \"%s\" using 1:2", ("/tmp/" + tmp_name + "_" + name + ".dat").c_str());
-    if (is_x_err && is_y_err) fprintf(gnu, ":3:4 with xyerrorbars");
-    else if (is_x_err) fprintf(gnu, ":3 with xerrorbars");
-    else if (is_y_err) fprintf(gnu, ":4 with yerrorbars");
-    fprintf(gnu, " pointtype 7 lc rgb \"black\" \n");
-    pclose(gnu);
+    glog->info("Plotting {}", HistogramBase::name);
+    std::string filename = dir + prefix + "_" + HistogramBase::name + ".pdf";
+
+    // Without limits the renderer fits the x axis to the points, an open side
+    // of a single limit follows the points
+    PlotRenderer::Axis x = {HistogramBase::xAxisTitle, 0, 0};
+    if ((is_xmin_limit || is_xmax_limit) && data_n > 0) {
+        x.low = data_x[0] - data_x_err[0];
+        x.high = data_x[0] + data_x_err[0];
+        for (int i=1; i<data_n; i++) {
+            x.low = std::min(x.low, data_x[i] - data_x_err[i]);
+            x.high = std::max(x.high, data_x[i] + data_x_err[i]);
+        }
+        if (is_xmin_limit) x.low = xmin_limit;
+        if (is_xmax_limit) x.high = xmax_limit;
+    }
+
+    if (!PlotRenderer::plotGraph(filename, HistogramBase::name, x, HistogramBase::yAxisTitle, data_n,
+                data_x, data_y, is_x_err ? data_x_err : nullptr, is_y_err ? data_y_err : nullptr)) {
+        glog->error("Could not plot {}", filename);
+    }
 }
@@ -8,6 +8,7 @@
 
 #include "Histo1d.h"
 
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include <cmath>
@@ -15,6 +16,8 @@
 
 #include "storage.hpp"
 
+#include "HistoMath.h"
+#include "PlotRenderer.h"
 #include "logging.h"
 
 namespace {
@@ -67,26 +70,18 @@ unsigned Histo1d::getEntries() const {
 double Histo1d::getMean() {
     if (sum == 0 || entries == 0)
         return 0;
-    double weighted_sum = 0;
-    double n = 0;
-    for (unsigned i=0; i<bins; i++) {
-        weighted_sum += data[i]*(((i)*binWidth)+xlow+(binWidth/2.0));
-        n += data[i];
-    }
-    if (n == 0) {
+    HistoMath::Stats s = HistoMath::binnedStats(data.data(), bins, xlow+(binWidth/2.0), binWidth);
+    if (s.n == 0) {
         return 0;
     }
-    return weighted_sum/n;
+    return s.mean;
 }
 
 double Histo1d::getStdDev() {
     if (sum == 0 || entries == 0)
         return 0;
-    double mean = this->getMean();
-    double mu = 0;
-    for (unsigned i=0; i<bins; i++)
-        mu += data[i] * pow((((i)*binWidth)+xlow+(binWidth/2.0))-mean,2);
-    return sqrt(mu/(double)sum);
+    HistoMath::Stats s = HistoMath::binnedStats(data.data(), bins, xlow+(binWidth/2.0), binWidth);
+    return sqrt(s.m2/(double)sum);
 }
 
 void Histo1d::fill(double x, double v) {
@@ -126,9 +121,7 @@ double Histo1d::getBin(unsigned n) const {
 }
 
 void Histo1d::scale(const double s) {
-    for (unsigned int i=0; i<bins; i++) {
-        data[i] = data[i] * s;
-    }
+    HistoMath::scale(data.data(), s, bins);
     overflow = overflow*s;
     underflow = underflow*s;
     sum = sum*s;
@@ -205,58 +198,92 @@ bool Histo1d::fromFile(std::string filename) {
         hlog->error("Error opening histogram: {}", e.what());
         return false;
     }
+    file.close();
+    return this->fromJson(j);
+}
+
+bool Histo1d::fromJson(json &j) {
     // Check for type
     if (j["Type"].empty()) {
-        hlog->error("Tried loading 1d Histogram from file {}, but file has no header: {}", filename);
+        hlog->error("Tried loading 1d Histogram, but file has no header");
         return false;
-    } else {
-        if (j["Type"] == "Histo1d") {
-            hlog->error("Tried loading 1d Histogram from file {}, but file has incorrect header: {}", filename, std::string(j["Type"]));
-            return false;
-        }
+    }
+    if (static_cast<std::string>(j["Type"]) != "Histo1d") {
+        hlog->error("Tried loading 1d Histogram, but file has incorrect header: {}", static_cast<std::string>(j["Type"]));
+        return false;
+    }
+
+    name = static_cast<std::string>(j["Name"]);
+    xAxisTitle = static_cast<std::string>(j["x"]["AxisTitle"]);
+    yAxisTitle = static_cast<std::string>(j["y"]["AxisTitle"]);
+    zAxisTitle = static_cast<std::string>(j["z"]["AxisTitle"]);
 
-        name = j["Name"];
-        xAxisTitle = j["x"]["AxisTitle"];
-        yAxisTitle = j["y"]["AxisTitle"];
-        zAxisTitle = j["z"]["AxisTitle"];
+    bins = j["x"]["Bins"];
+    xlow = j["x"]["Low"];
+    xhigh = j["x"]["High"];
 
-        bins = j["x"]["Bins"];
-        xlow = j["x"]["Low"];
-        xhigh = j["x"]["High"];
+    underflow = j["Underflow"];
+    overflow = j["Overflow"];
+
+    data.resize(bins);
+    for (unsigned i=0; i<bins; i++)
+        data[i] = j["Data"][i];
+    this->loaded();
+    return true;
+}
 
-        underflow = j["underflow"];
-        overflow = j["overflow"];
+void Histo1d::toFileBinary(std::ostream &handle) const {
+    this->titlesToBinary(handle);
+    uint32_t n = bins;
+    double range[4] = {xlow, xhigh, underflow, overflow};
+    handle.write((const char*)&n, sizeof(n));
+    handle.write((const char*)range, sizeof(range));
+    handle.write((const char*)data.data(), data.size()*sizeof(double));
+}
 
-        data.resize(bins);
-        for (unsigned i=0; i<bins; i++)
-            data[i] = j["data"][i];
+bool Histo1d::fromFileBinary(std::istream &handle) {
+    uint32_t n;
+    double range[4];
+    if (!this->titlesFromBinary(handle)
+            || !handle.read((char*)&n, sizeof(n))
+            || !handle.read((char*)range, sizeof(range))) {
+        return false;
     }
-    file.close();
+    bins = n;
+    xlow = range[0];
+    xhigh = range[1];
+    underflow = range[2];
+    overflow = range[3];
+
+    data.resize(bins);
+    if (!handle.read((char*)data.data(), data.size()*sizeof(double)))
+        return false;
+    this->loaded();
     return true;
 }
 
+void Histo1d::loaded() {
+    // Number of fills is not stored, count every bin with content once
+    binWidth = (xhigh - xlow)/bins;
+    entries = 0;
+    sum = 0;
+    min = 0;
+    max = 0;
+    for (double v : data) {
+        if (v != 0) entries++;
+        sum += v;
+        if (v < min) min = v;
+        if (v > max) max = v;
+    }
+}
+
 void Histo1d::plot(std::string prefix, std::string dir) {
     hlog->info("Plotting: {}", HistogramBase::name);
-    // Put raw histo data in tmp file
-    std::string tmp_name = std::string(getenv("USER")) + "/tmp_yarr_histo1d_" + prefix;
-    this->toFile(tmp_name, "/tmp/", false);
-    std::string cmd = "gnuplot | epstopdf -f > " + dir + prefix + "_" + HistogramBase::name + ".pdf";
-
-    // Open gnuplot as file and pipe commands
-    FILE *gnu = popen(cmd.c_str(), "w");
-    
-    fprintf(gnu, "set terminal postscript enhanced color \"Helvetica\" 18 eps\n");
-    fprintf(gnu, "unset key\n");
-    fprintf(gnu, "set title \"%s\"\n" , HistogramBase::name.c_str());
-    fprintf(gnu, "set xlabel \"%s\"\n" , HistogramBase::xAxisTitle.c_str());
-    fprintf(gnu, "set ylabel \"%s\"\n" , HistogramBase::yAxisTitle.c_str());
-    fprintf(gnu, "set xrange[%f:%f]\n", xlow, xhigh);
-    fprintf(gnu, "set yrange[0:*]\n");
-    //fprintf(gnu, "set \n");
-    fprintf(gnu, "set grid\n");
-    fprintf(gnu, "set style line 1 lt 1 lc rgb '#A6CEE3'\n");
-    fprintf(gnu, "set style fill solid 0.5\n");
-    fprintf(gnu, "set boxwidth %f*0.9 absolute\n", binWidth);
-    fprintf(gnu, "plot \"%s\" matrix u ((($1)*(%f))+%f+(%f/2)):3 with boxes\n", ("/tmp/" + tmp_name + "_" + name + ".dat").c_str(), binWidth, xlow, binWidth);
-    pclose(gnu);
+    std::string filename = dir + prefix + "_" + HistogramBase::name + ".pdf";
+
+    PlotRenderer::Axis x = {HistogramBase::xAxisTitle, xlow, xhigh};
+    if (!PlotRenderer::plot1d(filename, HistogramBase::name, x, HistogramBase::yAxisTitle,
+                data.data(), bins)) {
+        hlog->error("Could not plot {}", filename);
+    }
 }
@@ -8,6 +8,7 @@
 
 #include "Histo2d.h"
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -15,6 +16,7 @@
 
 #include "storage.hpp"
 
+#include "PlotRenderer.h"
 #include "logging.h"
 
 namespace {
@@ -38,9 +40,9 @@ Histo2d::Histo2d(std::string arg_name, unsigned arg_xbins, double arg_xlow, doub
     underflow = 0;
     overflow = 0;
     data = std::vector<double>(xbins*ybins,0);
-    isFilled = std::vector<bool>(xbins*ybins,false);
+    isFilled = std::vector<uint8_t>(xbins*ybins,0);
     entries = 0;
-
+    statsValid = false;
 }
 
 Histo2d::Histo2d(std::string arg_name, unsigned arg_xbins, double arg_xlow, double arg_xhigh, 
@@ -60,8 +62,9 @@ Histo2d::Histo2d(std::string arg_name, unsigned arg_xbins, double arg_xlow, doub
     underflow = 0;
     overflow = 0;
     data = std::vector<double>(xbins*ybins,0);
-    isFilled =  std::vector<bool>(xbins*ybins,false);
+    isFilled =  std::vector<uint8_t>(xbins*ybins,0);
     entries = 0;
+    statsValid = false;
 }
 
 Histo2d::Histo2d(Histo2d *h) : HistogramBase(h->getName(), h->getType()) {
@@ -81,11 +84,12 @@ Histo2d::Histo2d(Histo2d *h) : HistogramBase(h->getName(), h->getType()) {
     overflow = h->getOverflow();
 
     data = std::vector<double>(xbins*ybins,0);
-    isFilled = std::vector<bool>(xbins*ybins,false);
+    isFilled = std::vector<uint8_t>(xbins*ybins,0);
     for(unsigned i=0; i<xbins*ybins; i++)
         data[i] = h->getBin(i);
     entries = h->getNumOfEntries();
     lStat = h->getStat();
+    statsValid = false;
 }
 
 Histo2d::~Histo2d() {
@@ -114,7 +118,8 @@ void Histo2d::fill(double x, double y, double v) {
             max = v;
         if (v < min)
             min = v;
-        isFilled[ybin+(xbin*ybins)] = true;
+        isFilled[ybin+(xbin*ybins)] = 1;
+        statsValid = false;
     }
     entries++;
 }
@@ -126,70 +131,75 @@ void Histo2d::setAll(double v) {
             entries++;
         }
     }
+    statsValid = false;
 }
 
 void Histo2d::add(const Histo2d &h) {
     if (this->size() != h.size())
         return;
-    for (unsigned int i=0; i<(xbins*ybins); i++) {
-        data[i] += h.getBin(i);
-    }
+    HistoMath::add(data.data(), h.data.data(), this->size());
     entries += h.numOfEntries();
+    statsValid = false;
+}
+
+void Histo2d::subtract(const Histo2d &h) {
+    if (this->size() != h.size())
+        return;
+    HistoMath::subtract(data.data(), h.data.data(), this->size());
+    // Undoes add(h)
+    entries -= std::min(entries, h.numOfEntries());
+    statsValid = false;
 }
 
 void Histo2d::divide(const Histo2d &h) {
     if (this->size() != h.size())
         return;
-    for (unsigned int i=0; i<(xbins*ybins); i++) {
-        if (h.getBin(i) == 0) {
-            data[i] = 0;
-        } else {
-            data[i] = data[i]/h.getBin(i);
-        }
-    }
+    HistoMath::divide(data.data(), h.data.data(), this->size());
     entries += h.numOfEntries();
+    statsValid = false;
 }
 
 void Histo2d::multiply(const Histo2d &h) {
     if (this->size() != h.size())
         return;
-    for (unsigned int i=0; i<(xbins*ybins); i++) {
-        data[i] = data[i]*h.getBin(i);
-    }
+    HistoMath::multiply(data.data(), h.data.data(), this->size());
     entries += h.numOfEntries();
+    statsValid = false;
 }
 
 void Histo2d::scale(const double s) {
-    for (unsigned int i=0; i<(xbins*ybins); i++) {
-        data[i] = data[i]*s;
+    HistoMath::scale(data.data(), s, this->size());
+    statsValid = false;
+}
+
+void Histo2d::addScaled(const Histo2d &h, const double s) {
+    if (this->size() != h.size())
+        return;
+    HistoMath::addScaled(data.data(), h.data.data(), s, this->size());
+    entries += h.numOfEntries();
+    statsValid = false;
+}
+
+const HistoMath::Stats& Histo2d::getStats() {
+    if (!statsValid) {
+        stats = HistoMath::stats(data.data(), isFilled.data(), this->size());
+        statsValid = true;
     }
+    return stats;
+}
+
+void Histo2d::prepareShared() {
+    this->getStats();
 }
 
 double Histo2d::getMean() {
-    double sum = 0;
-    double entries = 0;
-    for (unsigned int i=0; i<(xbins*ybins); i++) {
-        if (isFilled[i]) {
-            sum += data[i];
-            entries++;
-        }
-    }
-    if (entries < 1) return 0;
-    return sum/entries;
+    const HistoMath::Stats &s = this->getStats();
+    if (s.n < 1) return 0;
+    return s.mean;
 }
 
 double Histo2d::getStdDev() {
-    double mean = this->getMean();
-    double mu = 0;
-    double entries = 0;
-    for (unsigned int i=0; i<(xbins*ybins); i++) {
-        if (isFilled[i]) {
-             mu += pow(data[i]-mean, 2);
-             entries++;
-        }
-    }
-    if (entries < 2) return 0;
-    return sqrt(mu/(double)(entries-1));
+    return this->getStats().stdDev();
 }
 
 
@@ -204,7 +214,8 @@ double Histo2d::getBin(unsigned n) const {
 void Histo2d::setBin(unsigned n, double v) {
     if (n < this->size()) {
         data[n] = v;
-        isFilled[n] = true;
+        isFilled[n] = 1;
+        statsValid = false;
     }
 }
 
@@ -289,73 +300,111 @@ bool Histo2d::fromFile(std::string filename) {
         std::cerr << "#ERROR# opening histogram: " << e.what() << std::endl;
         return false;
     }
+    file.close();
+    return this->fromJson(j);
+}
+
+bool Histo2d::fromJson(json &j) {
     // Check for type
     if (j["Type"].empty()) {
         std::cerr << "#ERROR# this does not seem to be a histogram file, could not parse." << std::endl;
         return false;
-    } else {
-        if (j["Type"] == "Histo2d") {
-            std::cerr << "#ERROR# File contains the wrong type: " << j["Type"] <<  std::endl;
-            return false;
-        }
+    }
+    if (static_cast<std::string>(j["Type"]) != "Histo2d") {
+        std::cerr << "#ERROR# File contains the wrong type: " << static_cast<std::string>(j["Type"]) <<  std::endl;
+        return false;
+    }
 
-        name = j["Name"];
-        xAxisTitle = j["x"]["AxisTitle"];
-        yAxisTitle = j["y"]["AxisTitle"];
-        zAxisTitle = j["z"]["AxisTitle"];
+    name = static_cast<std::string>(j["Name"]);
+    xAxisTitle = static_cast<std::string>(j["x"]["AxisTitle"]);
+    yAxisTitle = static_cast<std::string>(j["y"]["AxisTitle"]);
+    zAxisTitle = static_cast<std::string>(j["z"]["AxisTitle"]);
 
-        xbins = j["x"]["Bins"];
-        xlow = j["x"]["Low"];
-        xhigh = j["x"]["High"];
+    xbins = j["x"]["Bins"];
+    xlow = j["x"]["Low"];
+    xhigh = j["x"]["High"];
+    xbinWidth = (xhigh - xlow)/xbins;
 
-        ybins = j["y"]["Bins"];
-        xlow = j["y"]["Low"];
-        xhigh = j["y"]["High"];
-        
-        underflow = j["underflow"];
-        overflow = j["overflow"];
+    ybins = j["y"]["Bins"];
+    ylow = j["y"]["Low"];
+    yhigh = j["y"]["High"];
+    ybinWidth = (yhigh - ylow)/ybins;
 
-        data = std::vector<double>(xbins*ybins);
-        for (unsigned int x=0; x<ybins; x++) {
-            for (unsigned int y=0; y<xbins; y++) {
-                data[x+(y*ybins)] = j["Data"][x][y];
-            }
+    underflow = j["Underflow"];
+    overflow = j["Overflow"];
+
+    data = std::vector<double>(xbins*ybins);
+    for (unsigned int x=0; x<xbins; x++) {
+        for (unsigned int y=0; y<ybins; y++) {
+            data[y+(x*ybins)] = j["Data"][x][y];
         }
     }
-    file.close();
+    this->loaded();
     return true;
 }
 
+void Histo2d::toFileBinary(std::ostream &handle) const {
+    this->titlesToBinary(handle);
+    uint32_t bins[2] = {xbins, ybins};
+    double range[6] = {xlow, xhigh, ylow, yhigh, underflow, overflow};
+    handle.write((const char*)bins, sizeof(bins));
+    handle.write((const char*)range, sizeof(range));
+    handle.write((const char*)data.data(), data.size()*sizeof(double));
+}
+
+bool Histo2d::fromFileBinary(std::istream &handle) {
+    uint32_t bins[2];
+    double range[6];
+    if (!this->titlesFromBinary(handle)
+            || !handle.read((char*)bins, sizeof(bins))
+            || !handle.read((char*)range, sizeof(range))) {
+        return false;
+    }
+    xbins = bins[0];
+    ybins = bins[1];
+    xlow = range[0];
+    xhigh = range[1];
+    ylow = range[2];
+    yhigh = range[3];
+    underflow = range[4];
+    overflow = range[5];
+    xbinWidth = (xhigh - xlow)/xbins;
+    ybinWidth = (yhigh - ylow)/ybins;
+
+    data = std::vector<double>(xbins*ybins);
+    if (!handle.read((char*)data.data(), data.size()*sizeof(double)))
+        return false;
+    this->loaded();
+    return true;
+}
+
+void Histo2d::loaded() {
+    // Which bins were filled is not stored, take all with content
+    isFilled = std::vector<uint8_t>(xbins*ybins);
+    entries = 0;
+    min = 0;
+    max = 0;
+    for (unsigned i=0; i<data.size(); i++) {
+        isFilled[i] = (data[i] != 0);
+        entries += isFilled[i];
+        if (i == 0 || data[i] < min) min = data[i];
+        if (i == 0 || data[i] > max) max = data[i];
+    }
+    statsValid = false;
+}
+
 void Histo2d::plot(std::string prefix, std::string dir) {
     hlog->info("Plotting {}", HistogramBase::name);
-    // Put raw histo data in tmp file
-    std::string tmp_name = std::string(getenv("USER")) + "/tmp_yarr_histo2d_" + prefix;
-    this->toFile(tmp_name, "/tmp/", false);
-    //std::string cmd = "gnuplot | epstopdf -f > " + dir + prefix + "_" + HistogramBase::name;
-    std::string cmd = "gnuplot > " + dir + prefix + "_" + HistogramBase::name;
+    std::string filename = dir + prefix + "_" + HistogramBase::name;
     for (unsigned i=0; i<lStat.size(); i++)
-        cmd += "_" + std::to_string(lStat.get(i));
-    //cmd += ".pdf";
-    cmd += ".png";
-
-    // Open gnuplot as file and pipe commands
-    FILE *gnu = popen(cmd.c_str(), "w");
-    
-    //fprintf(gnu, "set terminal postscript enhanced color \"Helvetica\" 18 eps\n");
-    fprintf(gnu, "set terminal png size 1280, 1024\n");
-    fprintf(gnu, "set palette negative defined ( 0 '#D53E4F', 1 '#F46D43', 2 '#FDAE61', 3 '#FEE08B', 4 '#E6F598', 5 '#ABDDA4', 6 '#66C2A5', 7 '#3288BD')\n");
-    //fprintf(gnu, "set pm3d map\n");
-    fprintf(gnu, "unset key\n");
-    fprintf(gnu, "set title \"%s\"\n" , HistogramBase::name.c_str());
-    fprintf(gnu, "set xlabel \"%s\"\n" , HistogramBase::xAxisTitle.c_str());
-    fprintf(gnu, "set ylabel \"%s\"\n" , HistogramBase::yAxisTitle.c_str());
-    fprintf(gnu, "set cblabel \"%s\"\n" , HistogramBase::zAxisTitle.c_str());
-    fprintf(gnu, "set xrange[%f:%f]\n", xlow, xhigh);
-    fprintf(gnu, "set yrange[%f:%f]\n", ylow, yhigh);
-    //fprintf(gnu, "set cbrange[0:120]\n");
-    //fprintf(gnu, "splot \"/tmp/tmp_%s.dat\" matrix u (($1)*((%f-%f)/%d)):(($2)*((%f-%f)/%d)):3\n", HistogramBase::name.c_str(), xhigh, xlow, xbins, yhigh, ylow, ybins);
-    fprintf(gnu, "plot \"%s\" matrix u (($1)*((%f-%f)/%d.0)+%f):(($2)*((%f-%f)/%d.0)+%f):3 with image\n", ("/tmp/" + tmp_name + "_" + name + ".dat").c_str(), xhigh, xlow, xbins, xlow +(xhigh-xlow)/(xbins*2.0), yhigh, ylow, ybins, ylow+(yhigh-ylow)/(ybins*2.0));
-   // fprintf(gnu, "plot \"%s\" matrix u (($1)):(($2)):3 with image\n", ("/tmp/" + tmp_name + "_" + name + ".dat").c_str());
-    pclose(gnu);
+        filename += "_" + std::to_string(lStat.get(i));
+    filename += ".png";
+
+    PlotRenderer::Axis x = {HistogramBase::xAxisTitle, xlow, xhigh};
+    PlotRenderer::Axis y = {HistogramBase::yAxisTitle, ylow, yhigh};
+    if (!PlotRenderer::plot2d(filename, HistogramBase::name, x, y, HistogramBase::zAxisTitle,
+                data.data(), xbins, ybins)) {
+        hlog->error("Could not plot {}", filename);
+    }
 }
 
@@ -12,6 +12,13 @@
 #include <cmath>
 #include <fstream>
 
+#include "PlotRenderer.h"
+#include "logging.h"
+
+namespace {
+    auto hlog = logging::make_log("Histo3d");
+}
+
 Histo3d::Histo3d(std::string arg_name, unsigned arg_xbins, double arg_xlow, double arg_xhigh, 
         unsigned arg_ybins, double arg_ylow, double arg_yhigh, 
         unsigned arg_zbins, double arg_zlow, double arg_zhigh, 
@@ -298,33 +305,24 @@ bool Histo3d::fromFile(std::string filename) {
 }
 
 void Histo3d::plot(std::string prefix, std::string dir) {
-    // Put raw histo data in tmp file
-    std::string tmp_name = std::string(getenv("USER")) + "/tmp_yarr_histo2d_" + prefix;
-    this->toFile(tmp_name, "/tmp/", false);
-    //std::string cmd = "gnuplot | epstopdf -f > " + dir + prefix + "_" + HistogramBase::name;
-    std::string cmd = "gnuplot > " + dir + prefix + "_" + HistogramBase::name;
+    hlog->info("Plotting {}", HistogramBase::name);
+    std::string filename = dir + prefix + "_" + HistogramBase::name;
     for (unsigned i=0; i<lStat.size(); i++)
-        cmd += "_" + std::to_string(lStat.get(i));
-    //cmd += ".pdf";
-    cmd += ".png";
+        filename += "_" + std::to_string(lStat.get(i));
+    filename += ".png";
+
+    // Map of the x-y plane summed over z
+    std::vector<double> projection(xbins*ybins, 0);
+    for (unsigned int i=0; i<xbins*ybins; i++) {
+        for (unsigned int k=0; k<zbins; k++) {
+            projection[i] += data[i*zbins+k];
+        }
+    }
 
-    // Open gnuplot as file and pipe commands
-    FILE *gnu = popen(cmd.c_str(), "w");
-    
-    //fprintf(gnu, "set terminal postscript enhanced color \"Helvetica\" 18 eps\n");
-    fprintf(gnu, "set terminal png size 1280, 1024\n");
-    fprintf(gnu, "set palette negative defined ( 0 '#D53E4F', 1 '#F46D43', 2 '#FDAE61', 3 '#FEE08B', 4 '#E6F598', 5 '#ABDDA4', 6 '#66C2A5', 7 '#3288BD')\n");
-    //fprintf(gnu, "set pm3d map\n");
-    fprintf(gnu, "unset key\n");
-    fprintf(gnu, "set title \"%s\"\n" , HistogramBase::name.c_str());
-    fprintf(gnu, "set xlabel \"%s\"\n" , HistogramBase::xAxisTitle.c_str());
-    fprintf(gnu, "set ylabel \"%s\"\n" , HistogramBase::yAxisTitle.c_str());
-    fprintf(gnu, "set cblabel \"%s\"\n" , HistogramBase::zAxisTitle.c_str());
-    fprintf(gnu, "set xrange[%f:%f]\n", xlow, xhigh);
-    fprintf(gnu, "set yrange[%f:%f]\n", ylow, yhigh);
-    //fprintf(gnu, "set cbrange[0:120]\n");
-    //fprintf(gnu, "splot \"/tmp/tmp_%s.dat\" matrix u (($1)*((%f-%f)/%d)):(($2)*((%f-%f)/%d)):3\n", HistogramBase::name.c_str(), xhigh, xlow, xbins, yhigh, ylow, ybins);
-    fprintf(gnu, "plot \"%s\" matrix u (($1)*((%f-%f)/%d.0)+%f):(($2)*((%f-%f)/%d.0)+%f):3 with image\n", ("/tmp/" + tmp_name + "_" + name + ".dat").c_str(), xhigh, xlow, xbins, xlow +(xhigh-xlow)/(xbins*2.0), yhigh, ylow, ybins, ylow+(yhigh-ylow)/(ybins*2.0));
-   // fprintf(gnu, "plot \"%s\" matrix u (($1)):(($2)):3 with image\n", ("/tmp/" + tmp_name + "_" + name + ".dat").c_str());
-    pclose(gnu);
+    PlotRenderer::Axis x = {HistogramBase::xAxisTitle, xlow, xhigh};
+    PlotRenderer::Axis y = {HistogramBase::yAxisTitle, ylow, yhigh};
+    if (!PlotRenderer::plot2d(filename, HistogramBase::name, x, y, HistogramBase::zAxisTitle,
+                projection.data(), xbins, ybins)) {
+        hlog->error("Could not plot {}", filename);
+    }
 }
@@ -0,0 +1,202 @@
+// #################################
+// # Project: Yarr
+// # Description: Bin array kernels for histograms
+// # Comment: Statistics are computed per block of bins (vectorizable sums
+// #          on data in L1) and blocks are merged with Chan's formula.
+// #          Selects after division rely on -fno-trapping-math, see CMakeLists
+// ################################
+
+#include "HistoMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    const unsigned blockSize = 256;
+
+    // Merge partial statistics b into a (Chan et al.)
+    void merge(HistoMath::Stats &a, const HistoMath::Stats &b) {
+        if (b.n == 0) return;
+        if (a.n == 0) {
+            a = b;
+            return;
+        }
+        double n = a.n + b.n;
+        double delta = b.mean - a.mean;
+        a.mean += delta*(b.n/n);
+        a.m2 += b.m2 + delta*delta*(a.n*b.n/n);
+        a.n = n;
+        a.min = std::min(a.min, b.min);
+        a.max = std::max(a.max, b.max);
+    }
+
+    // Independent accumulators, breaks the dependency chain of the sums
+    const unsigned lanes = 4;
+
+    template<bool useMask>
+    inline bool filled(const uint8_t *mask, unsigned i) {
+        return useMask ? (mask[i] != 0) : true;
+    }
+
+    template<bool useMask>
+    HistoMath::Stats blockStats(const double *__restrict data, const uint8_t *__restrict mask, unsigned n) {
+        const double inf = std::numeric_limits<double>::infinity();
+        double cnt[lanes] = {0}, sum[lanes] = {0}, lo[lanes], hi[lanes];
+        std::fill(lo, lo+lanes, inf);
+        std::fill(hi, hi+lanes, -inf);
+        // Branch free selects, the mask is often random
+        unsigned i = 0;
+        for (; i+lanes<=n; i+=lanes) {
+            for (unsigned k=0; k<lanes; k++) {
+                bool f = filled<useMask>(mask, i+k);
+                double v = data[i+k];
+                cnt[k] += f ? 1.0 : 0.0;
+                sum[k] += f ? v : 0.0;
+                lo[k] = std::min(lo[k], f ? v : inf);
+                hi[k] = std::max(hi[k], f ? v : -inf);
+            }
+        }
+        for (; i<n; i++) {
+            bool f = filled<useMask>(mask, i);
+            double v = data[i];
+            cnt[0] += f ? 1.0 : 0.0;
+            sum[0] += f ? v : 0.0;
+            lo[0] = std::min(lo[0], f ? v : inf);
+            hi[0] = std::max(hi[0], f ? v : -inf);
+        }
+        HistoMath::Stats s;
+        for (unsigned k=0; k<lanes; k++) {
+            s.n += cnt[k];
+            s.mean += sum[k];
+        }
+        if (s.n == 0) return HistoMath::Stats();
+        s.mean /= s.n;
+        s.min = *std::min_element(lo, lo+lanes);
+        s.max = *std::max_element(hi, hi+lanes);
+
+        // Second sweep only touches the block, which is still in L1
+        double m2[lanes] = {0};
+        for (i=0; i+lanes<=n; i+=lanes) {
+            for (unsigned k=0; k<lanes; k++) {
+                double d = data[i+k] - s.mean;
+                m2[k] += filled<useMask>(mask, i+k) ? d*d : 0.0;
+            }
+        }
+        for (; i<n; i++) {
+            double d = data[i] - s.mean;
+            m2[0] += filled<useMask>(mask, i) ? d*d : 0.0;
+        }
+        for (unsigned k=0; k<lanes; k++)
+            s.m2 += m2[k];
+        return s;
+    }
+
+    template<bool useMask>
+    HistoMath::Stats allStats(const double *data, const uint8_t *mask, unsigned n) {
+        HistoMath::Stats s;
+        for (unsigned i=0; i<n; i+=blockSize) {
+            unsigned len = std::min(blockSize, n-i);
+            merge(s, blockStats<useMask>(data+i, useMask ? mask+i : nullptr, len));
+        }
+        return s;
+    }
+}
+
+namespace HistoMath {
+
+double Stats::variance() const {
+    if (n < 2) return 0;
+    return m2/(n-1);
+}
+
+double Stats::stdDev() const {
+    return std::sqrt(this->variance());
+}
+
+void add(double *__restrict a, const double *__restrict b, unsigned n) {
+    if (a == b) return scale(a, 2.0, n);
+    for (unsigned i=0; i<n; i++)
+        a[i] += b[i];
+}
+
+void subtract(double *__restrict a, const double *__restrict b, unsigned n) {
+    if (a == b) return scale(a, 0.0, n);
+    for (unsigned i=0; i<n; i++)
+        a[i] -= b[i];
+}
+
+void multiply(double *__restrict a, const double *__restrict b, unsigned n) {
+    if (a == b) {
+        for (unsigned i=0; i<n; i++)
+            a[i] *= a[i];
+        return;
+    }
+    for (unsigned i=0; i<n; i++)
+        a[i] *= b[i];
+}
+
+void divide(double *__restrict a, const double *__restrict b, unsigned n) {
+    if (a == b) {
+        for (unsigned i=0; i<n; i++)
+            a[i] = (a[i] == 0) ? 0.0 : 1.0;
+        return;
+    }
+    for (unsigned i=0; i<n; i++) {
+        // Divide unconditionally and select, keeps the loop branch free
+        double q = a[i]/b[i];
+        a[i] = (b[i] == 0) ? 0.0 : q;
+    }
+}
+
+void scale(double *__restrict a, double s, unsigned n) {
+    for (unsigned i=0; i<n; i++)
+        a[i] *= s;
+}
+
+void addScaled(double *__restrict a, const double *__restrict b, double s, unsigned n) {
+    if (a == b) return scale(a, 1.0+s, n);
+    for (unsigned i=0; i<n; i++)
+        a[i] += s*b[i];
+}
+
+Stats stats(const double *data, const uint8_t *mask, unsigned n) {
+    return allStats<true>(data, mask, n);
+}
+
+Stats stats(const double *data, unsigned n) {
+    return allStats<false>(data, nullptr, n);
+}
+
+Stats binnedStats(const double *data, unsigned n, double x0, double width) {
+    Stats s;
+    for (unsigned i=0; i<n; i+=blockSize) {
+        unsigned len = std::min(blockSize, n-i);
+        const double *w = data+i;
+        double xb = x0 + i*width;
+        double sumw = 0, sumwx = 0;
+        unsigned first = len, last = 0;
+        for (unsigned j=0; j<len; j++) {
+            sumw += w[j];
+            sumwx += w[j]*(xb + j*width);
+            first = std::min(first, (w[j] != 0) ? j : len);
+            last = std::max(last, (w[j] != 0) ? j : 0u);
+        }
+        if (sumw == 0) continue;
+        Stats b;
+        b.n = sumw;
+        b.mean = sumwx/sumw;
+        double m2 = 0;
+        for (unsigned j=0; j<len; j++) {
+            double d = (xb + j*width) - b.mean;
+            m2 += w[j]*d*d;
+        }
+        b.m2 = m2;
+        b.min = xb + first*width;
+        b.max = xb + last*width;
+        merge(s, b);
+    }
+    return s;
+}
+
+}
@@ -0,0 +1,828 @@
+// #################################
+// # Project: Yarr
+// # Description: Native histogram renderer
+// # Comment: Draws 1D/2D histograms directly from bin memory to PNG or PDF,
+// #          output format is selected by the file extension
+// ################################
+
+#include "PlotRenderer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "logging.h"
+
+namespace {
+    auto plog = logging::make_log("PlotRenderer");
+
+    // Logical canvas size, PNG is written 1:1 and PDF at half scale in points
+    const unsigned canvasWidth = 1280;
+    const unsigned canvasHeight = 1024;
+    const double pdfScale = 0.5;
+
+    struct Color {
+        uint8_t r, g, b;
+    };
+
+    const Color black = {0x00, 0x00, 0x00};
+    const Color white = {0xff, 0xff, 0xff};
+    const Color gridColor = {0xd0, 0xd0, 0xd0};
+    const Color boxFill = {0xa6, 0xce, 0xe3};
+    const Color boxLine = {0x1f, 0x78, 0xb4};
+
+    // Same palette as the former gnuplot output (with "negative")
+    const Color palette[8] = {
+        {0xd5, 0x3e, 0x4f}, {0xf4, 0x6d, 0x43}, {0xfd, 0xae, 0x61}, {0xfe, 0xe0, 0x8b},
+        {0xe6, 0xf5, 0x98}, {0xab, 0xdd, 0xa4}, {0x66, 0xc2, 0xa5}, {0x32, 0x88, 0xbd}};
+
+    Color paletteColor(double t) {
+        t = std::min(1.0, std::max(0.0, t));
+        double u = (1.0-t)*7.0;
+        unsigned i = std::min(6u, (unsigned)u);
+        double f = u - i;
+        const Color &a = palette[i];
+        const Color &b = palette[i+1];
+        return {(uint8_t)std::lround(a.r + f*(b.r-a.r)),
+                (uint8_t)std::lround(a.g + f*(b.g-a.g)),
+                (uint8_t)std::lround(a.b + f*(b.b-a.b))};
+    }
+
+    // 8x14 bitmap font for ASCII 32..126, one byte per row, MSB is the left pixel
+    const unsigned fontWidth = 8;
+    const unsigned fontHeight = 14;
+    const uint8_t font[95][fontHeight] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // space
+    {0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00}, // '!'
+    {0x00, 0x00, 0x2c, 0x2c, 0x2c, 0x2c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '"'
+    {0x00, 0x12, 0x16, 0x14, 0x7f, 0x24, 0x2c, 0xfe, 0x68, 0x48, 0x48, 0x00, 0x00, 0x00}, // '#'
+    {0x00, 0x00, 0x00, 0x3c, 0x6a, 0x60, 0x38, 0x1e, 0x02, 0x4e, 0x3c, 0x00, 0x00, 0x00}, // '$'
+    {0x00, 0x00, 0x70, 0x90, 0x90, 0x76, 0x18, 0x6e, 0x0b, 0x0b, 0x0e, 0x00, 0x00, 0x00}, // '%'
+    {0x00, 0x00, 0x3c, 0x60, 0x20, 0x30, 0x5b, 0xcb, 0xc6, 0x46, 0x3b, 0x00, 0x00, 0x00}, // '&'
+    {0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '''
+    {0x08, 0x08, 0x18, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x18, 0x08, 0x08, 0x00, 0x00}, // '('
+    {0x30, 0x10, 0x18, 0x18, 0x08, 0x08, 0x08, 0x08, 0x18, 0x18, 0x10, 0x30, 0x00, 0x00}, // ')'
+    {0x00, 0x00, 0x10, 0x56, 0x3c, 0x3c, 0x56, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '*'
+    {0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0xfe, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00}, // '+'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x10, 0x10, 0x00}, // ','
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '-'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00}, // '.'
+    {0x00, 0x00, 0x06, 0x04, 0x0c, 0x08, 0x18, 0x10, 0x10, 0x30, 0x20, 0x60, 0x40, 0x00}, // '/'
+    {0x00, 0x00, 0x3c, 0x64, 0x46, 0x42, 0x5a, 0x42, 0x46, 0x64, 0x3c, 0x00, 0x00, 0x00}, // '0'
+    {0x00, 0x00, 0x78, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x3e, 0x00, 0x00, 0x00}, // '1'
+    {0x00, 0x00, 0x3c, 0x44, 0x06, 0x06, 0x0c, 0x18, 0x30, 0x60, 0x7e, 0x00, 0x00, 0x00}, // '2'
+    {0x00, 0x00, 0x3c, 0x44, 0x06, 0x04, 0x3c, 0x06, 0x06, 0x46, 0x3c, 0x00, 0x00, 0x00}, // '3'
+    {0x00, 0x00, 0x0c, 0x1c, 0x14, 0x24, 0x64, 0x44, 0x7e, 0x04, 0x04, 0x00, 0x00, 0x00}, // '4'
+    {0x00, 0x00, 0x7c, 0x60, 0x60, 0x7c, 0x04, 0x06, 0x06, 0x44, 0x7c, 0x00, 0x00, 0x00}, // '5'
+    {0x00, 0x00, 0x3c, 0x60, 0x40, 0x7c, 0x66, 0x42, 0x42, 0x66, 0x3c, 0x00, 0x00, 0x00}, // '6'
+    {0x00, 0x00, 0x7e, 0x06, 0x04, 0x0c, 0x08, 0x18, 0x18, 0x10, 0x30, 0x00, 0x00, 0x00}, // '7'
+    {0x00, 0x00, 0x3c, 0x66, 0x46, 0x66, 0x3c, 0x66, 0x42, 0x66, 0x3c, 0x00, 0x00, 0x00}, // '8'
+    {0x00, 0x00, 0x3c, 0x64, 0x46, 0x46, 0x66, 0x3e, 0x06, 0x04, 0x38, 0x00, 0x00, 0x00}, // '9'
+    {0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00}, // ':'
+    {0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x18, 0x18, 0x10, 0x10, 0x00}, // ';'
+    {0x00, 0x00, 0x00, 0x00, 0x02, 0x1c, 0x70, 0x70, 0x1c, 0x02, 0x00, 0x00, 0x00, 0x00}, // '<'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x00, 0x00, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00}, // '='
+    {0x00, 0x00, 0x00, 0x00, 0xc0, 0x78, 0x0e, 0x0e, 0x78, 0xc0, 0x00, 0x00, 0x00, 0x00}, // '>'
+    {0x00, 0x00, 0x3c, 0x26, 0x06, 0x0c, 0x18, 0x10, 0x00, 0x10, 0x10, 0x00, 0x00, 0x00}, // '?'
+    {0x00, 0x00, 0x3c, 0x62, 0x42, 0xdf, 0x93, 0x93, 0x93, 0xdf, 0x40, 0x60, 0x1c, 0x00}, // '@'
+    {0x00, 0x00, 0x18, 0x18, 0x3c, 0x2c, 0x24, 0x66, 0x7e, 0x42, 0xc3, 0x00, 0x00, 0x00}, // 'A'
+    {0x00, 0x00, 0x7c, 0x46, 0x46, 0x46, 0x7c, 0x46, 0x42, 0x46, 0x7c, 0x00, 0x00, 0x00}, // 'B'
+    {0x00, 0x00, 0x1c, 0x22, 0x60, 0x40, 0x40, 0x40, 0x60, 0x22, 0x1c, 0x00, 0x00, 0x00}, // 'C'
+    {0x00, 0x00, 0x78, 0x4c, 0x46, 0x46, 0x42, 0x42, 0x46, 0x4c, 0x78, 0x00, 0x00, 0x00}, // 'D'
+    {0x00, 0x00, 0x7e, 0x60, 0x60, 0x60, 0x7e, 0x60, 0x60, 0x60, 0x7e, 0x00, 0x00, 0x00}, // 'E'
+    {0x00, 0x00, 0x7e, 0x60, 0x60, 0x60, 0x7e, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00}, // 'F'
+    {0x00, 0x00, 0x3c, 0x62, 0x40, 0x40, 0x4e, 0x42, 0x42, 0x62, 0x3c, 0x00, 0x00, 0x00}, // 'G'
+    {0x00, 0x00, 0x42, 0x42, 0x42, 0x42, 0x7e, 0x42, 0x42, 0x42, 0x42, 0x00, 0x00, 0x00}, // 'H'
+    {0x00, 0x00, 0x7e, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7e, 0x00, 0x00, 0x00}, // 'I'
+    {0x00, 0x00, 0x3c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x4c, 0x78, 0x00, 0x00, 0x00}, // 'J'
+    {0x00, 0x00, 0x42, 0x44, 0x48, 0x70, 0x78, 0x48, 0x4c, 0x46, 0x43, 0x00, 0x00, 0x00}, // 'K'
+    {0x00, 0x00, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x7e, 0x00, 0x00, 0x00}, // 'L'
+    {0x00, 0x00, 0xe6, 0xe6, 0xe6, 0xfa, 0xda, 0xda, 0xc2, 0xc2, 0xc2, 0x00, 0x00, 0x00}, // 'M'
+    {0x00, 0x00, 0x62, 0x62, 0x72, 0x52, 0x5a, 0x4a, 0x4e, 0x46, 0x46, 0x00, 0x00, 0x00}, // 'N'
+    {0x00, 0x00, 0x3c, 0x66, 0x46, 0x42, 0x42, 0x42, 0x46, 0x66, 0x3c, 0x00, 0x00, 0x00}, // 'O'
+    {0x00, 0x00, 0x7c, 0x66, 0x62, 0x62, 0x66, 0x7c, 0x60, 0x60, 0x60, 0x00, 0x00, 0x00}, // 'P'
+    {0x00, 0x00, 0x3c, 0x66, 0x46, 0x42, 0x42, 0x42, 0x46, 0x66, 0x3c, 0x0c, 0x04, 0x00}, // 'Q'
+    {0x00, 0x00, 0x7c, 0x46, 0x46, 0x46, 0x7c, 0x4c, 0x46, 0x42, 0x43, 0x00, 0x00, 0x00}, // 'R'
+    {0x00, 0x00, 0x3c, 0x64, 0x40, 0x60, 0x3c, 0x06, 0x02, 0x46, 0x3c, 0x00, 0x00, 0x00}, // 'S'
+    {0x00, 0x00, 0xff, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00}, // 'T'
+    {0x00, 0x00, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x46, 0x66, 0x3c, 0x00, 0x00, 0x00}, // 'U'
+    {0x00, 0x00, 0xc2, 0x42, 0x46, 0x64, 0x24, 0x2c, 0x3c, 0x18, 0x18, 0x00, 0x00, 0x00}, // 'V'
+    {0x00, 0x00, 0x83, 0xc3, 0xc3, 0xda, 0x5a, 0x5a, 0x6e, 0x66, 0x66, 0x00, 0x00, 0x00}, // 'W'
+    {0x00, 0x00, 0x42, 0x66, 0x3c, 0x18, 0x18, 0x3c, 0x24, 0x66, 0xc2, 0x00, 0x00, 0x00}, // 'X'
+    {0x00, 0x00, 0xc2, 0x66, 0x24, 0x3c, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x00, 0x00}, // 'Y'
+    {0x00, 0x00, 0x7e, 0x06, 0x04, 0x0c, 0x18, 0x10, 0x20, 0x60, 0x7f, 0x00, 0x00, 0x00}, // 'Z'
+    {0x1c, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1c, 0x00, 0x00}, // '['
+    {0x00, 0x00, 0x40, 0x60, 0x20, 0x30, 0x10, 0x10, 0x18, 0x08, 0x0c, 0x04, 0x06, 0x00}, // 'backslash'
+    {0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x38, 0x00, 0x00}, // ']'
+    {0x00, 0x00, 0x18, 0x3c, 0x64, 0x42, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '^'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff}, // '_'
+    {0x00, 0x30, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '`'
+    {0x00, 0x00, 0x00, 0x00, 0x3c, 0x46, 0x06, 0x3e, 0x46, 0x46, 0x7e, 0x00, 0x00, 0x00}, // 'a'
+    {0x40, 0x40, 0x40, 0x40, 0x7c, 0x66, 0x62, 0x62, 0x62, 0x66, 0x7c, 0x00, 0x00, 0x00}, // 'b'
+    {0x00, 0x00, 0x00, 0x00, 0x1c, 0x22, 0x60, 0x60, 0x60, 0x22, 0x1c, 0x00, 0x00, 0x00}, // 'c'
+    {0x06, 0x06, 0x06, 0x06, 0x3e, 0x66, 0x46, 0x46, 0x46, 0x66, 0x3e, 0x00, 0x00, 0x00}, // 'd'
+    {0x00, 0x00, 0x00, 0x00, 0x3c, 0x66, 0x42, 0x7e, 0x40, 0x62, 0x3c, 0x00, 0x00, 0x00}, // 'e'
+    {0x0e, 0x18, 0x10, 0x10, 0x7e, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00}, // 'f'
+    {0x00, 0x00, 0x00, 0x00, 0x3e, 0x66, 0x46, 0x46, 0x46, 0x66, 0x3e, 0x06, 0x04, 0x38}, // 'g'
+    {0x60, 0x60, 0x60, 0x60, 0x7c, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00}, // 'h'
+    {0x18, 0x00, 0x00, 0x00, 0x38, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7e, 0x00, 0x00, 0x00}, // 'i'
+    {0x08, 0x00, 0x00, 0x00, 0x38, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x18, 0x70}, // 'j'
+    {0x60, 0x60, 0x60, 0x60, 0x66, 0x6c, 0x78, 0x78, 0x6c, 0x66, 0x62, 0x00, 0x00, 0x00}, // 'k'
+    {0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x18, 0x0e, 0x00, 0x00, 0x00}, // 'l'
+    {0x00, 0x00, 0x00, 0x00, 0x7e, 0x5a, 0x5a, 0x5a, 0x5a, 0x5a, 0x5a, 0x00, 0x00, 0x00}, // 'm'
+    {0x00, 0x00, 0x00, 0x00, 0x7c, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x00, 0x00, 0x00}, // 'n'
+    {0x00, 0x00, 0x00, 0x00, 0x3c, 0x66, 0x46, 0x42, 0x46, 0x66, 0x3c, 0x00, 0x00, 0x00}, // 'o'
+    {0x00, 0x00, 0x00, 0x00, 0x7c, 0x66, 0x62, 0x62, 0x62, 0x66, 0x7c, 0x40, 0x40, 0x40}, // 'p'
+    {0x00, 0x00, 0x00, 0x00, 0x3e, 0x66, 0x46, 0x46, 0x46, 0x66, 0x3e, 0x06, 0x06, 0x06}, // 'q'
+    {0x00, 0x00, 0x00, 0x00, 0x3e, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x00, 0x00, 0x00}, // 'r'
+    {0x00, 0x00, 0x00, 0x00, 0x3c, 0x64, 0x60, 0x3c, 0x06, 0x46, 0x3c, 0x00, 0x00, 0x00}, // 's'
+    {0x00, 0x00, 0x10, 0x10, 0x7e, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1e, 0x00, 0x00, 0x00}, // 't'
+    {0x00, 0x00, 0x00, 0x00, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x3e, 0x00, 0x00, 0x00}, // 'u'
+    {0x00, 0x00, 0x00, 0x00, 0x42, 0x46, 0x64, 0x24, 0x3c, 0x18, 0x18, 0x00, 0x00, 0x00}, // 'v'
+    {0x00, 0x00, 0x00, 0x00, 0x83, 0xc3, 0xda, 0x5a, 0x7e, 0x6e, 0x64, 0x00, 0x00, 0x00}, // 'w'
+    {0x00, 0x00, 0x00, 0x00, 0x66, 0x24, 0x18, 0x18, 0x3c, 0x24, 0x42, 0x00, 0x00, 0x00}, // 'x'
+    {0x00, 0x00, 0x00, 0x00, 0x42, 0x66, 0x24, 0x24, 0x3c, 0x18, 0x18, 0x18, 0x10, 0x70}, // 'y'
+    {0x00, 0x00, 0x00, 0x00, 0x7e, 0x04, 0x0c, 0x18, 0x30, 0x20, 0x7e, 0x00, 0x00, 0x00}, // 'z'
+    {0x0e, 0x18, 0x18, 0x18, 0x18, 0x70, 0x10, 0x18, 0x18, 0x18, 0x18, 0x0e, 0x00, 0x00}, // '{'
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00}, // '|'
+    {0x70, 0x10, 0x18, 0x18, 0x18, 0x0e, 0x18, 0x18, 0x18, 0x18, 0x10, 0x70, 0x00, 0x00}, // '}'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x72, 0x0e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '~'
+    };
+
+    // Minimal zlib stream writer using fixed Huffman codes and LZ77 matching
+    class BitWriter {
+        public:
+            BitWriter(std::vector<uint8_t> &arg_out) : out(arg_out), buf(0), n(0) {}
+
+            void put(uint32_t bits, unsigned count) {
+                buf |= bits << n;
+                n += count;
+                while (n >= 8) {
+                    out.push_back(buf & 0xff);
+                    buf >>= 8;
+                    n -= 8;
+                }
+            }
+
+            // Huffman codes are packed starting from the most significant bit
+            void putCode(uint32_t code, unsigned len) {
+                uint32_t rev = 0;
+                for (unsigned i=0; i<len; i++) {
+                    rev = (rev << 1) | ((code >> i) & 0x1);
+                }
+                put(rev, len);
+            }
+
+            void flush() {
+                if (n > 0) out.push_back(buf & 0xff);
+                buf = 0;
+                n = 0;
+            }
+
+        private:
+            std::vector<uint8_t> &out;
+            uint32_t buf;
+            unsigned n;
+    };
+
+    const unsigned lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    const unsigned lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    const unsigned distBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    const unsigned distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    void putSymbol(BitWriter &bw, unsigned v) {
+        if (v < 144) {
+            bw.putCode(0x30+v, 8);
+        } else if (v < 256) {
+            bw.putCode(0x190+v-144, 9);
+        } else if (v < 280) {
+            bw.putCode(v-256, 7);
+        } else {
+            bw.putCode(0xc0+v-280, 8);
+        }
+    }
+
+    void putMatch(BitWriter &bw, unsigned len, unsigned dist) {
+        unsigned i = 28;
+        while (lengthBase[i] > len) i--;
+        putSymbol(bw, 257+i);
+        bw.put(len-lengthBase[i], lengthExtra[i]);
+        unsigned j = 29;
+        while (distBase[j] > dist) j--;
+        bw.putCode(j, 5);
+        bw.put(dist-distBase[j], distExtra[j]);
+    }
+
+    std::vector<uint8_t> zlibCompress(const std::vector<uint8_t> &in) {
+        const unsigned window = 1 << 15;
+        const unsigned hashSize = 1 << 15;
+        const unsigned maxChain = 16;
+        const unsigned maxLen = 258;
+
+        std::vector<uint8_t> out;
+        out.reserve(in.size()/8 + 64);
+        out.push_back(0x78);
+        out.push_back(0x01);
+
+        BitWriter bw(out);
+        bw.put(1, 1); // Final block
+        bw.put(1, 2); // Fixed Huffman codes
+
+        std::vector<int32_t> head(hashSize, -1);
+        std::vector<int32_t> prev(window, -1);
+        const size_t n = in.size();
+        auto hash = [&](size_t p) {
+            return ((in[p] << 10) ^ (in[p+1] << 5) ^ in[p+2]) & (hashSize-1);
+        };
+        auto insert = [&](size_t p) {
+            if (p+2 < n) {
+                unsigned h = hash(p);
+                prev[p & (window-1)] = head[h];
+                head[h] = p;
+            }
+        };
+
+        size_t i = 0;
+        while (i < n) {
+            unsigned bestLen = 0;
+            unsigned bestDist = 0;
+            if (i+2 < n) {
+                int32_t cand = head[hash(i)];
+                unsigned limit = std::min<size_t>(maxLen, n-i);
+                for (unsigned chain=0; cand >= 0 && i-cand < window && chain < maxChain; chain++) {
+                    unsigned l = 0;
+                    while (l < limit && in[cand+l] == in[i+l]) l++;
+                    if (l > bestLen) {
+                        bestLen = l;
+                        bestDist = i-cand;
+                        if (l == limit) break;
+                    }
+                    int32_t next = prev[cand & (window-1)];
+                    if (next >= cand) break;
+                    cand = next;
+                }
+            }
+            if (bestLen >= 3) {
+                putMatch(bw, bestLen, bestDist);
+                for (unsigned k=0; k<bestLen; k++) insert(i+k);
+                i += bestLen;
+            } else {
+                putSymbol(bw, in[i]);
+                insert(i);
+                i++;
+            }
+        }
+        putSymbol(bw, 256);
+        bw.flush();
+
+        uint32_t a = 1, b = 0;
+        for (uint8_t c : in) {
+            a = (a + c) % 65521;
+            b = (b + a) % 65521;
+        }
+        uint32_t adler = (b << 16) | a;
+        for (int s=24; s>=0; s-=8) out.push_back((adler >> s) & 0xff);
+        return out;
+    }
+
+    uint32_t crc32(const uint8_t *data, size_t len, uint32_t crc=0) {
+        static const std::array<uint32_t, 256> table = [] {
+            std::array<uint32_t, 256> t;
+            for (uint32_t n=0; n<256; n++) {
+                uint32_t c = n;
+                for (unsigned k=0; k<8; k++)
+                    c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+                t[n] = c;
+            }
+            return t;
+        }();
+        crc = ~crc;
+        for (size_t i=0; i<len; i++)
+            crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    /// Drawing backend, coordinates are canvas pixels with origin top left
+    class Painter {
+        public:
+            virtual ~Painter() {}
+            virtual void fillRect(double x0, double y0, double x1, double y1, Color c) = 0;
+            virtual void line(double x0, double y0, double x1, double y1, Color c, double width=2) = 0;
+            /// align: -1 left, 0 center, 1 right; y is the vertical center of the text
+            virtual void text(double x, double y, const std::string &str, double size, int align, bool vertical=false) = 0;
+            /// w*h RGB pixels, first row at the top
+            virtual void image(double x0, double y0, double x1, double y1, unsigned w, unsigned h, const std::vector<uint8_t> &rgb) = 0;
+            virtual bool write(const std::string &filename) = 0;
+    };
+
+    class RasterPainter : public Painter {
+        public:
+            RasterPainter(unsigned w, unsigned h) : width(w), height(h), pixels(w*h*3, 0xff) {}
+
+            void fillRect(double x0, double y0, double x1, double y1, Color c) override {
+                int ix0 = clampX(std::lround(std::min(x0, x1)));
+                int ix1 = clampX(std::lround(std::max(x0, x1)));
+                int iy0 = clampY(std::lround(std::min(y0, y1)));
+                int iy1 = clampY(std::lround(std::max(y0, y1)));
+                for (int y=iy0; y<iy1; y++) {
+                    uint8_t *p = &pixels[(y*width+ix0)*3];
+                    for (int x=ix0; x<ix1; x++) {
+                        *p++ = c.r;
+                        *p++ = c.g;
+                        *p++ = c.b;
+                    }
+                }
+            }
+
+            void line(double x0, double y0, double x1, double y1, Color c, double w) override {
+                double half = w/2.0;
+                if (x0 == x1 || y0 == y1) {
+                    fillRect(std::min(x0, x1)-half, std::min(y0, y1)-half,
+                            std::max(x0, x1)+half, std::max(y0, y1)+half, c);
+                    return;
+                }
+                unsigned steps = std::ceil(std::max(std::fabs(x1-x0), std::fabs(y1-y0)));
+                for (unsigned i=0; i<=steps; i++) {
+                    double x = x0 + (x1-x0)*i/steps;
+                    double y = y0 + (y1-y0)*i/steps;
+                    fillRect(x-half, y-half, x+half, y+half, c);
+                }
+            }
+
+            void text(double x, double y, const std::string &str, double size, int align, bool vertical) override {
+                int s = std::max(1l, std::lround(size/fontHeight));
+                double len = str.size()*fontWidth*s;
+                double start = (align < 0) ? 0 : (align == 0 ? len/2.0 : len);
+                double across = fontHeight*s/2.0;
+                for (unsigned i=0; i<str.size(); i++) {
+                    unsigned char ch = str[i];
+                    if (ch < 32 || ch > 126) ch = '?';
+                    const uint8_t *glyph = font[ch-32];
+                    for (unsigned gy=0; gy<fontHeight; gy++) {
+                        for (unsigned gx=0; gx<fontWidth; gx++) {
+                            if (!(glyph[gy] & (0x80 >> gx))) continue;
+                            double along = (i*fontWidth + gx)*s - start;
+                            if (vertical) {
+                                double px = x - across + gy*s;
+                                double py = y - along - s;
+                                fillRect(px, py, px+s, py+s, black);
+                            } else {
+                                double px = x + along;
+                                double py = y - across + gy*s;
+                                fillRect(px, py, px+s, py+s, black);
+                            }
+                        }
+                    }
+                }
+            }
+
+            void image(double x0, double y0, double x1, double y1, unsigned w, unsigned h, const std::vector<uint8_t> &rgb) override {
+                int ix0 = clampX(std::lround(x0));
+                int ix1 = clampX(std::lround(x1));
+                int iy0 = clampY(std::lround(y0));
+                int iy1 = clampY(std::lround(y1));
+                if (ix1 <= ix0 || iy1 <= iy0 || w == 0 || h == 0) return;
+                for (int y=iy0; y<iy1; y++) {
+                    unsigned sy = std::min<unsigned>(h-1, (unsigned)((y-iy0)*(uint64_t)h/(iy1-iy0)));
+                    uint8_t *p = &pixels[(y*width+ix0)*3];
+                    for (int x=ix0; x<ix1; x++) {
+                        unsigned sx = std::min<unsigned>(w-1, (unsigned)((x-ix0)*(uint64_t)w/(ix1-ix0)));
+                        const uint8_t *q = &rgb[(sy*w+sx)*3];
+                        *p++ = q[0];
+                        *p++ = q[1];
+                        *p++ = q[2];
+                    }
+                }
+            }
+
+            bool write(const std::string &filename) override {
+                // Every scanline uses the "up" filter, flat areas then compress to zeros
+                std::vector<uint8_t> raw;
+                raw.reserve(height*(width*3+1));
+                const unsigned stride = width*3;
+                for (unsigned y=0; y<height; y++) {
+                    raw.push_back(2);
+                    const uint8_t *row = &pixels[y*stride];
+                    const uint8_t *above = (y == 0) ? nullptr : row - stride;
+                    for (unsigned x=0; x<stride; x++) {
+                        raw.push_back(above ? (uint8_t)(row[x] - above[x]) : row[x]);
+                    }
+                }
+
+                std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!file) return false;
+                const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+                file.write((const char*)signature, 8);
+
+                std::vector<uint8_t> ihdr;
+                putBE32(ihdr, width);
+                putBE32(ihdr, height);
+                ihdr.push_back(8); // Bit depth
+                ihdr.push_back(2); // Truecolor
+                ihdr.push_back(0); // Deflate
+                ihdr.push_back(0); // Adaptive filtering
+                ihdr.push_back(0); // No interlace
+                writeChunk(file, "IHDR", ihdr);
+                writeChunk(file, "IDAT", zlibCompress(raw));
+                writeChunk(file, "IEND", std::vector<uint8_t>());
+                return file.good();
+            }
+
+        private:
+            int clampX(long x) const {return std::min<long>(width, std::max(0l, x));}
+            int clampY(long y) const {return std::min<long>(height, std::max(0l, y));}
+
+            static void putBE32(std::vector<uint8_t> &v, uint32_t x) {
+                for (int s=24; s>=0; s-=8) v.push_back((x >> s) & 0xff);
+            }
+
+            static void writeChunk(std::ofstream &file, const char *type, const std::vector<uint8_t> &data) {
+                std::vector<uint8_t> buf;
+                putBE32(buf, data.size());
+                buf.insert(buf.end(), type, type+4);
+                buf.insert(buf.end(), data.begin(), data.end());
+                putBE32(buf, crc32(&buf[4], buf.size()-4));
+                file.write((const char*)buf.data(), buf.size());
+            }
+
+            unsigned width;
+            unsigned height;
+            std::vector<uint8_t> pixels;
+    };
+
+    class PdfPainter : public Painter {
+        public:
+            PdfPainter(unsigned w, unsigned h, double s) : width(w), height(h), scale(s) {
+                content.setf(std::ios::fixed);
+                content.precision(2);
+                // Flip y axis, so canvas coordinates can be used directly
+                content << scale << " 0 0 " << -scale << " 0 " << height*scale << " cm\n";
+            }
+
+            void fillRect(double x0, double y0, double x1, double y1, Color c) override {
+                setFill(c);
+                content << x0 << " " << y0 << " " << x1-x0 << " " << y1-y0 << " re f\n";
+            }
+
+            void line(double x0, double y0, double x1, double y1, Color c, double w) override {
+                content << c.r/255.0 << " " << c.g/255.0 << " " << c.b/255.0 << " RG " << w << " w "
+                        << x0 << " " << y0 << " m " << x1 << " " << y1 << " l S\n";
+            }
+
+            void text(double x, double y, const std::string &str, double size, int align, bool vertical) override {
+                // Helvetica has no fixed advance, use an average glyph width
+                double len = str.size()*size*0.52;
+                double start = (align < 0) ? 0 : (align == 0 ? len/2.0 : len);
+                double shift = size*0.35;
+                setFill(black);
+                content << "BT /F1 1 Tf ";
+                if (vertical) {
+                    content << "0 " << -size << " " << -size << " 0 " << x+shift << " " << y+start << " Tm ";
+                } else {
+                    content << size << " 0 0 " << -size << " " << x-start << " " << y+shift << " Tm ";
+                }
+                content << "(";
+                for (char c : str) {
+                    if (c == '(' || c == ')' || c == '\\') content << '\\';
+                    content << c;
+                }
+                content << ") Tj ET\n";
+            }
+
+            void image(double x0, double y0, double x1, double y1, unsigned w, unsigned h, const std::vector<uint8_t> &rgb) override {
+                content << "q " << x1-x0 << " 0 0 " << y0-y1 << " " << x0 << " " << y1 << " cm /Im" << images.size() << " Do Q\n";
+                images.push_back({w, h, zlibCompress(rgb)});
+            }
+
+            bool write(const std::string &filename) override {
+                std::ostringstream pdf;
+                std::vector<size_t> offsets;
+                auto object = [&](const std::string &dict, const std::vector<uint8_t> *stream=nullptr) {
+                    offsets.push_back(pdf.tellp());
+                    pdf << offsets.size() << " 0 obj\n" << dict;
+                    if (stream) {
+                        pdf << "\nstream\n";
+                        pdf.write((const char*)stream->data(), stream->size());
+                        pdf << "\nendstream";
+                    }
+                    pdf << "\nendobj\n";
+                };
+
+                pdf << "%PDF-1.4\n";
+                object("<< /Type /Catalog /Pages 2 0 R >>");
+                object("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+                std::ostringstream page;
+                page << "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 " << width*scale << " " << height*scale << "]"
+                     << " /Resources << /Font << /F1 4 0 R >> /XObject <<";
+                for (unsigned i=0; i<images.size(); i++)
+                    page << " /Im" << i << " " << 6+i << " 0 R";
+                page << " >> >> /Contents 5 0 R >>";
+                object(page.str());
+                object("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+
+                std::string text = content.str();
+                std::vector<uint8_t> stream = zlibCompress(std::vector<uint8_t>(text.begin(), text.end()));
+                object("<< /Length " + std::to_string(stream.size()) + " /Filter /FlateDecode >>", &stream);
+                for (auto &img : images) {
+                    object("<< /Type /XObject /Subtype /Image /Width " + std::to_string(img.w)
+                            + " /Height " + std::to_string(img.h)
+                            + " /ColorSpace /DeviceRGB /BitsPerComponent 8 /Interpolate false"
+                            + " /Length " + std::to_string(img.data.size()) + " /Filter /FlateDecode >>", &img.data);
+                }
+
+                size_t xref = pdf.tellp();
+                pdf << "xref\n0 " << offsets.size()+1 << "\n0000000000 65535 f \n";
+                for (size_t off : offsets) {
+                    char entry[21];
+                    snprintf(entry, sizeof(entry), "%010zu 00000 n \n", off);
+                    pdf << entry;
+                }
+                pdf << "trailer\n<< /Size " << offsets.size()+1 << " /Root 1 0 R >>\nstartxref\n" << xref << "\n%%EOF\n";
+
+                std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!file) return false;
+                file << pdf.str();
+                return file.good();
+            }
+
+        private:
+            void setFill(Color c) {
+                content << c.r/255.0 << " " << c.g/255.0 << " " << c.b/255.0 << " rg ";
+            }
+
+            struct Image {
+                unsigned w, h;
+                std::vector<uint8_t> data;
+            };
+
+            unsigned width;
+            unsigned height;
+            double scale;
+            std::ostringstream content;
+            std::vector<Image> images;
+    };
+
+    std::unique_ptr<Painter> makePainter(const std::string &filename) {
+        size_t pos = filename.find_last_of('.');
+        std::string ext = (pos == std::string::npos) ? "" : filename.substr(pos);
+        if (ext == ".png") {
+            return std::unique_ptr<Painter>(new RasterPainter(canvasWidth, canvasHeight));
+        } else if (ext == ".pdf") {
+            return std::unique_ptr<Painter>(new PdfPainter(canvasWidth, canvasHeight, pdfScale));
+        }
+        plog->error("Unknown plot format for {}", filename);
+        return nullptr;
+    }
+
+    /// Plot area in canvas coordinates and the axis ranges mapped onto it
+    struct Frame {
+        double x0, y0, x1, y1;
+        double xlow, xhigh, ylow, yhigh;
+
+        double mapX(double x) const {return x0 + (x-xlow)/(xhigh-xlow)*(x1-x0);}
+        double mapY(double y) const {return y1 - (y-ylow)/(yhigh-ylow)*(y1-y0);}
+    };
+
+    std::vector<double> niceTicks(double low, double high, unsigned target=8) {
+        std::vector<double> ticks;
+        if (!(high > low) || !std::isfinite(high-low)) return ticks;
+        double raw = (high-low)/target;
+        double mag = std::pow(10, std::floor(std::log10(raw)));
+        double norm = raw/mag;
+        double step = (norm < 1.5 ? 1 : (norm < 3 ? 2 : (norm < 7 ? 5 : 10)))*mag;
+        double first = std::ceil(low/step - 1e-9)*step;
+        for (unsigned i=0; first+i*step <= high+step*1e-9; i++) {
+            double t = first + i*step;
+            ticks.push_back(std::fabs(t) < step*1e-9 ? 0 : t);
+        }
+        return ticks;
+    }
+
+    std::string tickLabel(double v) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%g", v);
+        return buf;
+    }
+
+    void drawGrid(Painter &p, const Frame &f) {
+        for (double t : niceTicks(f.xlow, f.xhigh))
+            p.line(f.mapX(t), f.y0, f.mapX(t), f.y1, gridColor, 1);
+        for (double t : niceTicks(f.ylow, f.yhigh))
+            p.line(f.x0, f.mapY(t), f.x1, f.mapY(t), gridColor, 1);
+    }
+
+    void drawAxes(Painter &p, const Frame &f, const std::string &title,
+            const std::string &xTitle, const std::string &yTitle) {
+        for (double t : niceTicks(f.xlow, f.xhigh)) {
+            double x = f.mapX(t);
+            p.line(x, f.y1, x, f.y1-10, black);
+            p.line(x, f.y0, x, f.y0+10, black);
+            p.text(x, f.y1+22, tickLabel(t), 18, 0);
+        }
+        for (double t : niceTicks(f.ylow, f.yhigh)) {
+            double y = f.mapY(t);
+            p.line(f.x0, y, f.x0+10, y, black);
+            p.line(f.x1, y, f.x1-10, y, black);
+            p.text(f.x0-12, y, tickLabel(t), 18, 1);
+        }
+        p.line(f.x0, f.y0, f.x1, f.y0, black);
+        p.line(f.x0, f.y1, f.x1, f.y1, black);
+        p.line(f.x0, f.y0, f.x0, f.y1, black);
+        p.line(f.x1, f.y0, f.x1, f.y1, black);
+
+        p.text((f.x0+f.x1)/2.0, 40, title, 28, 0);
+        p.text((f.x0+f.x1)/2.0, f.y1+70, xTitle, 24, 0);
+        p.text(f.x0-110, (f.y0+f.y1)/2.0, yTitle, 24, 0, true);
+    }
+}
+
+namespace PlotRenderer {
+
+bool plot1d(const std::string &filename, const std::string &title,
+        const Axis &x, const std::string &yTitle,
+        const double *data, unsigned bins) {
+    std::unique_ptr<Painter> p = makePainter(filename);
+    if (!p || bins == 0) return false;
+
+    double ymin = 0;
+    double ymax = 0;
+    for (unsigned i=0; i<bins; i++) {
+        if (!std::isfinite(data[i])) continue;
+        ymin = std::min(ymin, data[i]);
+        ymax = std::max(ymax, data[i]);
+    }
+    if (ymax <= ymin) {
+        ymax = ymin + 1;
+    } else {
+        ymax += (ymax-ymin)*0.05;
+    }
+
+    Frame f = {150, 80, canvasWidth-60.0, canvasHeight-130.0, x.low, x.high, ymin, ymax};
+    drawGrid(*p, f);
+
+    double binWidth = (x.high-x.low)/bins;
+    for (unsigned i=0; i<bins; i++) {
+        if (!std::isfinite(data[i]) || data[i] == 0) continue;
+        double bx0 = f.mapX(x.low + (i+0.05)*binWidth);
+        double bx1 = f.mapX(x.low + (i+0.95)*binWidth);
+        double by0 = f.mapY(std::max(data[i], 0.0));
+        double by1 = f.mapY(std::min(data[i], 0.0));
+        p->fillRect(bx0, by0, bx1, by1, boxFill);
+        p->line(bx0, by1, bx0, by0, boxLine, 1);
+        p->line(bx0, by0, bx1, by0, boxLine, 1);
+        p->line(bx1, by0, bx1, by1, boxLine, 1);
+    }
+
+    drawAxes(*p, f, title, x.title, yTitle);
+    if (!p->write(filename)) {
+        plog->error("Could not write plot {}", filename);
+        return false;
+    }
+    return true;
+}
+
+bool plot2d(const std::string &filename, const std::string &title,
+        const Axis &x, const Axis &y, const std::string &zTitle,
+        const double *data, unsigned xbins, unsigned ybins) {
+    std::unique_ptr<Painter> p = makePainter(filename);
+    if (!p || xbins == 0 || ybins == 0) return false;
+
+    bool found = false;
+    double zmin = 0;
+    double zmax = 1;
+    for (unsigned i=0; i<xbins*ybins; i++) {
+        if (!std::isfinite(data[i])) continue;
+        if (!found) {
+            zmin = zmax = data[i];
+            found = true;
+        }
+        zmin = std::min(zmin, data[i]);
+        zmax = std::max(zmax, data[i]);
+    }
+    if (zmax <= zmin) zmax = zmin + 1;
+
+    // First image row is the highest y bin
+    std::vector<uint8_t> rgb(xbins*ybins*3);
+    for (unsigned row=0; row<ybins; row++) {
+        unsigned ybin = ybins-1-row;
+        for (unsigned xbin=0; xbin<xbins; xbin++) {
+            double v = data[ybin+(xbin*ybins)];
+            Color c = std::isfinite(v) ? paletteColor((v-zmin)/(zmax-zmin)) : white;
+            uint8_t *q = &rgb[(row*xbins+xbin)*3];
+            q[0] = c.r;
+            q[1] = c.g;
+            q[2] = c.b;
+        }
+    }
+
+    Frame f = {150, 80, canvasWidth-230.0, canvasHeight-130.0, x.low, x.high, y.low, y.high};
+    p->image(f.x0, f.y0, f.x1, f.y1, xbins, ybins, rgb);
+    drawAxes(*p, f, title, x.title, y.title);
+
+    // Color bar
+    const unsigned steps = 256;
+    std::vector<uint8_t> bar(steps*3);
+    for (unsigned i=0; i<steps; i++) {
+        Color c = paletteColor(1.0 - (double)i/(steps-1));
+        bar[i*3] = c.r;
+        bar[i*3+1] = c.g;
+        bar[i*3+2] = c.b;
+    }
+    Frame cb = {f.x1+30, f.y0, f.x1+60, f.y1, 0, 1, zmin, zmax};
+    p->image(cb.x0, cb.y0, cb.x1, cb.y1, 1, steps, bar);
+    p->line(cb.x0, cb.y0, cb.x1, cb.y0, black);
+    p->line(cb.x0, cb.y1, cb.x1, cb.y1, black);
+    p->line(cb.x0, cb.y0, cb.x0, cb.y1, black);
+    p->line(cb.x1, cb.y0, cb.x1, cb.y1, black);
+    for (double t : niceTicks(zmin, zmax)) {
+        double ty = cb.mapY(t);
+        p->line(cb.x1, ty, cb.x1-8, ty, black);
+        p->text(cb.x1+10, ty, tickLabel(t), 18, -1);
+    }
+    p->text(canvasWidth-30.0, (f.y0+f.y1)/2.0, zTitle, 24, 0, true);
+
+    if (!p->write(filename)) {
+        plog->error("Could not write plot {}", filename);
+        return false;
+    }
+    return true;
+}
+
+bool plotGraph(const std::string &filename, const std::string &title,
+        const Axis &x, const std::string &yTitle, unsigned n,
+        const double *xs, const double *ys, const double *xErr, const double *yErr) {
+    std::unique_ptr<Painter> p = makePainter(filename);
+    if (!p || n == 0) return false;
+
+    // Ranges including the error bars
+    bool fitX = !(x.high > x.low);
+    double xmin = fitX ? xs[0] : x.low;
+    double xmax = fitX ? xs[0] : x.high;
+    double ymin = ys[0];
+    double ymax = ys[0];
+    for (unsigned i=0; i<n; i++) {
+        double ex = xErr ? xErr[i] : 0;
+        double ey = yErr ? yErr[i] : 0;
+        if (fitX) {
+            xmin = std::min(xmin, xs[i]-ex);
+            xmax = std::max(xmax, xs[i]+ex);
+        }
+        ymin = std::min(ymin, ys[i]-ey);
+        ymax = std::max(ymax, ys[i]+ey);
+    }
+    if (!std::isfinite(xmin) || !std::isfinite(xmax) || !std::isfinite(ymin) || !std::isfinite(ymax))
+        return false;
+    if (xmax <= xmin) {
+        xmin -= 0.5;
+        xmax += 0.5;
+    } else if (fitX) {
+        double pad = (xmax-xmin)*0.05;
+        xmin -= pad;
+        xmax += pad;
+    }
+    if (ymax <= ymin) {
+        ymin -= 0.5;
+        ymax += 0.5;
+    } else {
+        double pad = (ymax-ymin)*0.05;
+        ymin -= pad;
+        ymax += pad;
+    }
+
+    Frame f = {150, 80, canvasWidth-60.0, canvasHeight-130.0, xmin, xmax, ymin, ymax};
+    drawGrid(*p, f);
+
+    for (unsigned i=0; i<n; i++) {
+        if (xs[i] < xmin || xs[i] > xmax) continue;
+        double px = f.mapX(xs[i]);
+        double py = f.mapY(ys[i]);
+        if (xErr && xErr[i] != 0) {
+            double ex0 = f.mapX(std::max(xs[i]-xErr[i], xmin));
+            double ex1 = f.mapX(std::min(xs[i]+xErr[i], xmax));
+            p->line(ex0, py, ex1, py, black, 1);
+        }
+        if (yErr && yErr[i] != 0) {
+            p->line(px, f.mapY(ys[i]-yErr[i]), px, f.mapY(ys[i]+yErr[i]), black, 1);
+        }
+        p->fillRect(px-4, py-4, px+4, py+4, black);
+    }
+
+    drawAxes(*p, f, title, x.title, yTitle);
+    if (!p->write(filename)) {
+        plog->error("Could not write plot {}", filename);
+        return false;
+    }
+    return true;
+}
+
+}
@@ -1,8 +1,59 @@
 #ifndef GAUSS_H
 #define GAUSS_H
 
+// #################################
+// # Project: Yarr
+// # Description: Random numbers for the emulators
+// # Comment: xoshiro256** generator with a ziggurat normal sampler,
+// #          Poisson counts for hit generation,
+// #          one generator per thread or per stream
+// ################################
+
+#include <cstdint>
+
 namespace Gauss {
+    class Generator {
+        public:
+            explicit Generator(uint64_t seed = 0);
+
+            /// State is expanded from the seed with splitmix64
+            void seed(uint64_t seed);
+
+            uint64_t next();
+            /// Uniform in (0, 1)
+            double uniform();
+            /// Standard normal
+            double normal();
+            double normal(double mean, double sigma);
+            /// Normal restricted to values >= low
+            double truncatedNormal(double mean, double sigma, double low);
+            /// Poisson distributed count
+            unsigned poisson(double mean);
+
+            void fillNormal(double *out, unsigned n, double mean, double sigma);
+            void fillNormal(float *out, unsigned n, float mean, float sigma);
+
+        private:
+            uint64_t s[4];
+    };
+
+    /// Generator of the calling thread
+    Generator& threadGenerator();
+
+    /// Reseed all thread generators: the n-th thread to draw a number after this
+    /// call uses a stream derived from seed and n. Without a seed they start
+    /// from std::random_device. This is only reproducible when the threads start
+    /// drawing in a fixed order, use streamSeed otherwise.
+    void setSeed(uint64_t seed);
+
+    /// Seed for a Generator of one stream, derived from the seed of setSeed and
+    /// the keys (e.g. channel, trigger and column). The same keys give the same
+    /// stream whichever thread draws from it. Without a seed it is random.
+    uint64_t streamSeed(uint64_t key1, uint64_t key2 = 0, uint64_t key3 = 0);
+
+    /// Draws from the thread generator, truncated at 0 unless can_be_negative
     double rand_normal(double mean, double sigma, bool can_be_negative);
+    void fill_normal(float *out, unsigned n, float mean, float sigma);
 }
 
 #endif
@@ -9,12 +9,15 @@
 // # Comment: 
 // ################################
 
+#include <iosfwd>
 #include <string>
 #include <typeinfo>
 #include <typeindex>
 
 #include "HistogramBase.h"
 
+#include "storage.hpp"
+
 class Histo1d : public HistogramBase {
     public:
         Histo1d(std::string arg_name, unsigned arg_bins, double arg_xlow, double arg_xhigh, std::type_index t);
@@ -39,9 +42,18 @@ class Histo1d : public HistogramBase {
         
         void toFile(std::string filename, std::string dir = "", bool header=true);
         bool fromFile(std::string filename);
+        /// Content of a parsed json file, false if it is not a Histo1d
+        bool fromJson(json &j);
         void plot(std::string filename, std::string dir = "");
 
+        /// Same content as the json file in native binary, much faster to read back
+        void toFileBinary(std::ostream &handle) const;
+        bool fromFileBinary(std::istream &handle);
+
     private:
+        /// Derived members after the bins were read from a file
+        void loaded();
+
         std::vector<double> data;
         double underflow;
         double overflow;
@@ -9,13 +9,18 @@
 // # Comment: 
 // ################################
 
+#include <cstdint>
+#include <iosfwd>
 #include <string>
 #include <typeinfo>
 #include <typeindex>
 
 #include "HistogramBase.h"
+#include "HistoMath.h"
 #include "ResultBase.h"
 
+#include "storage.hpp"
+
 class Histo2d : public HistogramBase {
     public:
         Histo2d(std::string arg_name, unsigned arg_xbins, double arg_xlow, double arg_xhigh, 
@@ -32,10 +37,13 @@ class Histo2d : public HistogramBase {
         void setAll(double v = 1);
         
         void add(const Histo2d &h);
+        /// Takes the entries of h off again
         void subtract(const Histo2d &h);
         void multiply(const Histo2d &h);
         void divide(const Histo2d &h);
         void scale(const double s);
+        /// Fused this += s*h
+        void addScaled(const Histo2d &h, const double s);
         void setBin(unsigned x, double v);
 
         double getMean();
@@ -61,11 +69,28 @@ class Histo2d : public HistogramBase {
         
         void toFile(std::string filename, std::string dir = "", bool header=true);
         bool fromFile(std::string filename);
+        /// Content of a parsed json file, false if it is not a Histo2d
+        bool fromJson(json &j);
         void plot(std::string filename, std::string dir = "");
 
+        /// Same content as the json file in native binary, much faster to read back
+        void toFileBinary(std::ostream &handle) const;
+        bool fromFileBinary(std::istream &handle);
+
+        void prepareShared() override;
+
     private:
+        const HistoMath::Stats& getStats();
+        /// Derived members after the bins were read from a file
+        void loaded();
+
         std::vector<double> data;
-        std::vector<bool> isFilled;
+        std::vector<uint8_t> isFilled;
+
+        // Statistics of filled bins, recomputed after any change of data.
+        // Not thread-safe, prepareShared() fills it before sharing the histogram.
+        HistoMath::Stats stats;
+        bool statsValid;
 
         double underflow;
         double overflow;
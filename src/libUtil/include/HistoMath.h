@@ -0,0 +1,47 @@
+#ifndef HISTOMATH_H
+#define HISTOMATH_H
+
+// #################################
+// # Project: Yarr
+// # Description: Bin array kernels for histograms
+// # Comment: Plain loops over raw arrays without aliasing, written to be
+// #          auto-vectorized by the compiler
+// ################################
+
+#include <cstdint>
+
+namespace HistoMath {
+    struct Stats {
+        double n = 0;     // Number of entries (or sum of weights)
+        double mean = 0;
+        double m2 = 0;    // Sum of squared deviations from the mean
+        double min = 0;
+        double max = 0;
+
+        /// Sample variance, 0 for less than two entries
+        double variance() const;
+        double stdDev() const;
+    };
+
+    // In place: a[i] = a[i] <op> b[i]. The kernels take restrict pointers, a and b
+    // are either the same array (h.add(h)) or do not overlap.
+    void add(double *a, const double *b, unsigned n);
+    void subtract(double *a, const double *b, unsigned n);
+    void multiply(double *a, const double *b, unsigned n);
+    /// Bins with b[i] == 0 are set to 0
+    void divide(double *a, const double *b, unsigned n);
+
+    void scale(double *a, double s, unsigned n);
+    /// a[i] += s*b[i]
+    void addScaled(double *a, const double *b, double s, unsigned n);
+
+    /// Mean, variance, min and max of all bins with mask[i] != 0 in a single pass
+    Stats stats(const double *data, const uint8_t *mask, unsigned n);
+    /// Same for all bins
+    Stats stats(const double *data, unsigned n);
+    /// Statistics of bin centers x0+i*width weighted with the bin contents,
+    /// min/max are the outermost centers of non-empty bins
+    Stats binnedStats(const double *data, unsigned n, double x0, double width);
+}
+
+#endif
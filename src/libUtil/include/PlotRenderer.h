@@ -0,0 +1,37 @@
+#ifndef PLOTRENDERER_H
+#define PLOTRENDERER_H
+
+// #################################
+// # Project: Yarr
+// # Description: Native histogram renderer
+// # Comment: Draws 1D/2D histograms directly from bin memory to PNG or PDF,
+// #          output format is selected by the file extension
+// ################################
+
+#include <string>
+
+namespace PlotRenderer {
+    struct Axis {
+        std::string title;
+        double low;
+        double high;
+    };
+
+    /// Plot bins as boxes, y axis starts at zero
+    bool plot1d(const std::string &filename, const std::string &title,
+            const Axis &x, const std::string &yTitle,
+            const double *data, unsigned bins);
+
+    /// Plot color map of bins, data is indexed as data[y+(x*ybins)]
+    bool plot2d(const std::string &filename, const std::string &title,
+            const Axis &x, const Axis &y, const std::string &zTitle,
+            const double *data, unsigned xbins, unsigned ybins);
+
+    /// Plot points with error bars, errors may be null. The y axis and an x axis
+    /// with low >= high are fitted to the points.
+    bool plotGraph(const std::string &filename, const std::string &title,
+            const Axis &x, const std::string &yTitle, unsigned n,
+            const double *xs, const double *ys, const double *xErr, const double *yErr);
+}
+
+#endif
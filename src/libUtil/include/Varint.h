@@ -0,0 +1,46 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+// #################################
+// # Project: Yarr
+// # Description: Variable length integer encoding
+// # Comment: 7 bits per byte, low bits first, the top bit marks a following
+// #          byte; signed values are zigzag encoded so small magnitudes stay short
+// ################################
+
+#include <cstdint>
+#include <vector>
+
+namespace Varint {
+    inline void put(std::vector<char> &buf, uint32_t value) {
+        while (value >= 0x80) {
+            buf.push_back((char)(value | 0x80));
+            value >>= 7;
+        }
+        buf.push_back((char)value);
+    }
+
+    inline void putSigned(std::vector<char> &buf, int32_t value) {
+        put(buf, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+    }
+
+    /// Advances pos, false if the buffer ends first
+    inline bool get(const char *&pos, const char *end, uint32_t &value) {
+        value = 0;
+        for (unsigned shift = 0; pos < end && shift < 35; shift += 7) {
+            uint8_t byte = *pos++;
+            value |= (uint32_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    inline bool getSigned(const char *&pos, const char *end, int32_t &value) {
+        uint32_t raw;
+        if (!get(pos, end, raw)) return false;
+        value = (int32_t)(raw >> 1) ^ -(int32_t)(raw & 0x1);
+        return true;
+    }
+}
+
+#endif
@@ -23,12 +23,33 @@ AnalysisProcessor::AnalysisProcessor(Bookkeeper *b, unsigned ch)
 }
 
 AnalysisProcessor::~AnalysisProcessor() {
+    this->stopWorkers();
 }
 
 void AnalysisProcessor::init() {
+    routes.clear();
+    catchAll.clear();
+    this->stopWorkers();
     for (unsigned i=0; i<algorithms.size(); i++) {
         algorithms[i]->connect(output);
         algorithms[i]->init(scan);
+
+        const auto &types = algorithms[i]->getInputTypes();
+        if (types.empty()) {
+            catchAll.push_back(i);
+        }
+        for (auto &t : types) {
+            routes[t].push_back(i);
+        }
+    }
+
+    // Own threads only pay off if there is more than one algorithm
+    for (unsigned i=0; i<algorithms.size(); i++) {
+        workers.emplace_back(nullptr);
+        if (algorithms[i]->isConcurrent() && algorithms.size() > 1) {
+            workers[i].reset(new Worker);
+            workers[i]->thread = std::thread(&AnalysisProcessor::work, this, i);
+        }
     }
 }
 
@@ -74,17 +95,62 @@ void AnalysisProcessor::process() {
 
 void AnalysisProcessor::process_core() {
     while(!input->empty()) {
-        auto h = input->popData();
+        SharedHisto h(input->popData());
         if (h != nullptr) {
-            for (unsigned i=0; i<algorithms.size(); i++) {
-                algorithms[i]->processHistogram(&*h);
+            auto route = routes.find(h->getType());
+            std::vector<unsigned> targets = catchAll;
+            if (route != routes.end()) {
+                targets.insert(targets.begin(), route->second.begin(), route->second.end());
+            }
+
+            // Workers only read the histogram, caches are filled beforehand
+            for (unsigned i : targets) {
+                if (i < workers.size() && workers[i] != nullptr) {
+                    h->prepareShared();
+                    break;
+                }
+            }
+
+            for (unsigned i : targets) {
+                dispatch(i, h);
             }
         }
     }
 }
 
+void AnalysisProcessor::dispatch(unsigned i, const SharedHisto &h) {
+    if (i < workers.size() && workers[i] != nullptr) {
+        workers[i]->input.pushData(std::unique_ptr<SharedHisto>(new SharedHisto(h)));
+    } else {
+        algorithms[i]->processHistogram(h.get());
+    }
+}
+
+void AnalysisProcessor::work(unsigned i) {
+    ClipBoard<SharedHisto> &queue = workers[i]->input;
+    while (true) {
+        queue.waitNotEmptyOrDone();
+        while (!queue.empty()) {
+            std::unique_ptr<SharedHisto> h = queue.popData();
+            if (h != nullptr) algorithms[i]->processHistogram(h->get());
+        }
+        if (queue.isDone() && queue.empty()) break;
+    }
+}
+
+void AnalysisProcessor::stopWorkers() {
+    for (auto &w : workers) {
+        if (w == nullptr) continue;
+        w->input.finish();
+        if (w->thread.joinable()) w->thread.join();
+    }
+    workers.clear();
+}
+
 void AnalysisProcessor::end() {
     SPDLOG_LOGGER_TRACE(alog, "");
+    // Concurrent algorithms have to finish their input before end()
+    this->stopWorkers();
     for (unsigned i=0; i<algorithms.size(); i++) {
         algorithms[i]->end();
     }
@@ -25,13 +25,20 @@ Bookkeeper::Bookkeeper(TxCore *arg_tx, RxCore *arg_rx) {
 
 // Delete all leftover data, Bookkeeper should be deleted last
 Bookkeeper::~Bookkeeper() {
-    for(unsigned int k=0; k<feList.size(); k++) {
-        delete feList[k];
-        feList.erase(feList.begin() + k);
+    for(FrontEnd *fe : feList) {
+        delete fe;
     }
+    feList.clear();
     delete g_fe;
 }
 
+void Bookkeeper::resetClipBoards() {
+    rawData.reset();
+    for (auto &c : eventMap) c.second.reset();
+    for (auto &c : histoMap) c.second.reset();
+    for (auto &c : resultMap) c.second.reset();
+}
+
 // RxChannel is unique ident
 void Bookkeeper::addFe(FrontEnd *fe, unsigned txChannel, unsigned rxChannel) {
     if(isChannelUsed(rxChannel)) {
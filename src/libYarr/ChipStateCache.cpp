@@ -0,0 +1,125 @@
+// #################################
+// # Project: Yarr
+// # Description: Last configuration written to a chip
+// ################################
+
+#include "ChipStateCache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include <unistd.h>
+
+#include "logging.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    auto cslog = logging::make_log("ChipStateCache");
+
+    /// State file: magic, version, time of the last full configuration and the state
+    const char stateMagic[8] = {'Y', 'A', 'R', 'R', 'S', 'T', 'A', '\0'};
+    const uint32_t stateVersion = 1;
+
+    bool forceFull = false;
+    std::chrono::seconds refreshInterval(3600);
+    std::string directory;
+
+    std::string stateDirectory() {
+        if (!directory.empty()) return directory;
+        const char *home = getenv("HOME");
+        return std::string(home ? home : ".") + "/.yarr/chipState";
+    }
+
+    int64_t now() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
+
+ChipStateCache::ChipStateCache(const std::string &key) : m_lastFull(0) {
+    // The key is used as file name
+    for (char c : key) {
+        bool plain = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '.';
+        m_key += plain ? c : '_';
+    }
+}
+
+bool ChipStateCache::take(std::vector<char> &state) {
+    std::string path = stateDirectory() + "/" + m_key;
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    char magic[sizeof(stateMagic)];
+    uint32_t version = 0;
+    int64_t lastFull = 0;
+    uint64_t bytes = 0;
+    bool ok = file.read(magic, sizeof(magic)) && memcmp(magic, stateMagic, sizeof(magic)) == 0
+            && file.read((char*)&version, sizeof(version)) && version == stateVersion
+            && file.read((char*)&lastFull, sizeof(lastFull))
+            && file.read((char*)&bytes, sizeof(bytes)) && bytes < (1u<<30);
+    if (ok) {
+        state.resize(bytes);
+        ok = (bool)file.read(state.data(), bytes);
+    }
+    file.close();
+    std::remove(path.c_str());
+
+    if (!ok) {
+        cslog->warn("Ignoring unreadable chip state {}", path);
+        state.clear();
+        return false;
+    }
+    m_lastFull = lastFull;
+    return true;
+}
+
+void ChipStateCache::store(const void *data, size_t bytes) {
+    std::string dir = stateDirectory();
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+
+    // Written under a temporary name, another process never reads a partial state
+    std::string path = dir + "/" + m_key;
+    std::string tmp = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        uint64_t size = bytes;
+        file.write(stateMagic, sizeof(stateMagic));
+        file.write((const char*)&stateVersion, sizeof(stateVersion));
+        file.write((const char*)&m_lastFull, sizeof(m_lastFull));
+        file.write((const char*)&size, sizeof(size));
+        file.write((const char*)data, bytes);
+        if (!file) {
+            cslog->warn("Could not write chip state {}", path);
+            file.close();
+            std::remove(tmp.c_str());
+            return;
+        }
+    }
+    fs::rename(tmp, path, ec);
+}
+
+void ChipStateCache::fullWritten() {
+    m_lastFull = now();
+}
+
+bool ChipStateCache::fullDue() const {
+    return forceFull || m_lastFull == 0 || now() - m_lastFull > refreshInterval.count();
+}
+
+void ChipStateCache::setForceFull(bool force) {
+    forceFull = force;
+}
+
+void ChipStateCache::setRefreshInterval(std::chrono::seconds interval) {
+    refreshInterval = interval;
+}
+
+void ChipStateCache::setDirectory(const std::string &dir) {
+    directory = dir;
+}
@@ -8,6 +8,26 @@
 
 #include "HistogramBase.h"
 
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+namespace {
+    void stringToBinary(std::ostream &handle, const std::string &s) {
+        uint32_t length = s.size();
+        handle.write((const char*)&length, sizeof(length));
+        handle.write(s.data(), length);
+    }
+
+    bool stringFromBinary(std::istream &handle, std::string &s) {
+        uint32_t length = 0;
+        if (!handle.read((char*)&length, sizeof(length)))
+            return false;
+        s.resize(length);
+        return (bool)handle.read(&s[0], length);
+    }
+}
+
 HistogramBase::HistogramBase(std::string arg_name, std::type_index t, LoopStatus &stat)
   : type(typeid(void)), lStat(stat) {
     name = arg_name;
@@ -63,3 +83,15 @@ void HistogramBase::setYaxisTitle(std::string name) {
 void HistogramBase::setZaxisTitle(std::string name) {
     zAxisTitle = name;
 }
+
+void HistogramBase::titlesToBinary(std::ostream &handle) const {
+    stringToBinary(handle, name);
+    stringToBinary(handle, xAxisTitle);
+    stringToBinary(handle, yAxisTitle);
+    stringToBinary(handle, zAxisTitle);
+}
+
+bool HistogramBase::titlesFromBinary(std::istream &handle) {
+    return stringFromBinary(handle, name) && stringFromBinary(handle, xAxisTitle)
+        && stringFromBinary(handle, yAxisTitle) && stringFromBinary(handle, zAxisTitle);
+}
@@ -0,0 +1,348 @@
+#include "RawDataFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "logging.h"
+
+namespace {
+    auto rflog = logging::make_log("RawDataFile");
+
+    uint64_t roundUp(uint64_t bytes) {
+        return (bytes + RawDataFile::blockSize - 1) / RawDataFile::blockSize * RawDataFile::blockSize;
+    }
+}
+
+/// Block aligned memory of one chunk and where it goes in the file
+struct RawDataFileWriter::Buffer {
+    Buffer(size_t words) : capacity(words), used(0), offset(0) {
+        void *ptr = NULL;
+        if (posix_memalign(&ptr, RawDataFile::blockSize, words*sizeof(uint32_t)) != 0) {
+            throw std::bad_alloc();
+        }
+        data = (uint32_t*)ptr;
+    }
+    ~Buffer() {free(data);}
+
+    /// Zero the padding up to the next block boundary
+    void pad() {
+        size_t padded = roundUp(used*sizeof(uint32_t))/sizeof(uint32_t);
+        std::fill(data+used, data+padded, 0);
+        used = padded;
+    }
+
+    uint32_t *data;
+    size_t capacity;
+    size_t used;
+    uint64_t offset;
+};
+
+RawDataFileWriter::RawDataFileWriter(const std::string &filename, bool direct, uint32_t chunkBytes)
+    : m_fd(-1), m_direct(false), m_chunkWords(roundUp(chunkBytes)/sizeof(uint32_t)),
+      m_offset(0), m_cur(NULL), m_closing(false), m_failed(false) {
+#ifdef O_DIRECT
+    if (direct) {
+        m_fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        if (m_fd < 0) {
+            rflog->info("O_DIRECT not supported for {}, using buffered writes", filename);
+        } else {
+            m_direct = true;
+        }
+    }
+#endif
+    if (m_fd < 0) {
+        m_fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (m_fd < 0) {
+        throw std::runtime_error("could not create raw data file " + filename + ": " + strerror(errno));
+    }
+
+    Buffer *head = this->getBuffer(RawDataFile::blockSize/sizeof(uint32_t));
+    memcpy(head->data, RawDataFile::magic, sizeof(RawDataFile::magic));
+    head->data[2] = RawDataFile::version;
+    head->data[3] = RawDataFile::blockSize;
+    head->used = 4;
+    head->pad();
+    this->writeOut(*head);
+    m_offset = head->used*sizeof(uint32_t);
+    m_free.push_back(head);
+
+    m_thread = std::thread(&RawDataFileWriter::writeLoop, this);
+}
+
+RawDataFileWriter::~RawDataFileWriter() {
+    this->close();
+    for (Buffer *buf : m_free) delete buf;
+}
+
+RawDataFileWriter::Buffer* RawDataFileWriter::getBuffer(size_t words) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (unsigned i=0; i<m_free.size(); i++) {
+            if (m_free[i]->capacity >= words) {
+                Buffer *buf = m_free[i];
+                m_free.erase(m_free.begin()+i);
+                buf->used = 0;
+                return buf;
+            }
+        }
+    }
+    // Only when the disk is slower than the data, nothing is dropped
+    return new Buffer(roundUp(words*sizeof(uint32_t))/sizeof(uint32_t));
+}
+
+void RawDataFileWriter::write(const RawDataContainer &rdc) {
+    size_t words = 3 + rdc.stat.size() + 2*rdc.adr.size();
+    for (unsigned n : rdc.words) words += n;
+
+    if (m_cur && m_cur->used + words > m_cur->capacity) {
+        this->queueChunk();
+    }
+    if (!m_cur) {
+        // Room for the chunk header
+        m_cur = this->getBuffer(std::max<size_t>(m_chunkWords, words + 3));
+        m_cur->used = 3;
+        m_curChunk.records = 0;
+        m_curChunk.adrMask = 0;
+        m_curChunk.first.resize(rdc.stat.size());
+        for (unsigned i=0; i<rdc.stat.size(); i++) m_curChunk.first[i] = rdc.stat.get(i);
+    }
+
+    uint32_t *out = m_cur->data + m_cur->used;
+    *out++ = RawDataFile::marker;
+    *out++ = rdc.stat.size();
+    *out++ = rdc.adr.size();
+    for (unsigned i=0; i<rdc.stat.size(); i++) {
+        *out++ = rdc.stat.get(i);
+    }
+    for (unsigned i=0; i<rdc.adr.size(); i++) {
+        *out++ = rdc.adr[i];
+        *out++ = rdc.words[i];
+        if (rdc.adr[i] < 32) m_curChunk.adrMask |= (1 << rdc.adr[i]);
+    }
+    for (unsigned i=0; i<rdc.adr.size(); i++) {
+        out = std::copy(rdc.buf[i], rdc.buf[i] + rdc.words[i], out);
+    }
+    m_cur->used += words;
+
+    m_curChunk.records++;
+    m_curChunk.last.resize(rdc.stat.size());
+    for (unsigned i=0; i<rdc.stat.size(); i++) m_curChunk.last[i] = rdc.stat.get(i);
+}
+
+void RawDataFileWriter::queueChunk() {
+    if (!m_cur) return;
+    m_cur->data[0] = RawDataFile::chunkMarker;
+    m_cur->data[1] = m_curChunk.records;
+    m_cur->data[2] = m_cur->used - 3;
+    m_cur->pad();
+    m_cur->offset = m_offset;
+
+    m_curChunk.offset = m_offset;
+    m_curChunk.bytes = m_cur->used*sizeof(uint32_t);
+    m_offset += m_curChunk.bytes;
+    m_index.push_back(m_curChunk);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_full.push_back(m_cur);
+    }
+    m_cv.notify_one();
+    m_cur = NULL;
+}
+
+void RawDataFileWriter::writeLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [&] { return m_closing || !m_full.empty(); });
+        if (m_full.empty()) break;
+        Buffer *buf = m_full.front();
+        m_full.pop_front();
+
+        lock.unlock();
+        this->writeOut(*buf);
+        lock.lock();
+        m_free.push_back(buf);
+    }
+}
+
+void RawDataFileWriter::writeOut(const Buffer &buf) {
+    const char *data = (const char*)buf.data;
+    size_t left = buf.used*sizeof(uint32_t);
+    uint64_t offset = buf.offset;
+    while (left > 0 && !m_failed) {
+        ssize_t n = ::pwrite(m_fd, data, left, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            rflog->error("Writing raw data failed, stopping the recording: {}", strerror(errno));
+            m_failed = true;
+            break;
+        }
+        data += n;
+        offset += n;
+        left -= n;
+    }
+}
+
+void RawDataFileWriter::close() {
+    if (m_fd < 0) return;
+    this->queueChunk();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_cv.notify_one();
+    if (m_thread.joinable()) m_thread.join();
+
+    // Index entries are offset, bytes (64 bit each), records, address mask,
+    // then the first and the last loop status, each with its length in front
+    std::vector<uint32_t> idx = {RawDataFile::indexMarker, (uint32_t)m_index.size()};
+    for (auto &chunk : m_index) {
+        idx.insert(idx.end(), {(uint32_t)chunk.offset, (uint32_t)(chunk.offset >> 32),
+                               (uint32_t)chunk.bytes, (uint32_t)(chunk.bytes >> 32),
+                               chunk.records, chunk.adrMask});
+        idx.push_back(chunk.first.size());
+        idx.insert(idx.end(), chunk.first.begin(), chunk.first.end());
+        idx.push_back(chunk.last.size());
+        idx.insert(idx.end(), chunk.last.begin(), chunk.last.end());
+    }
+
+    // The trailer takes the last words of the last block
+    Buffer *buf = this->getBuffer(idx.size() + 4);
+    std::copy(idx.begin(), idx.end(), buf->data);
+    buf->used = idx.size() + 4;
+    buf->pad();
+    uint32_t *trailer = buf->data + buf->used - 4;
+    trailer[0] = (uint32_t)m_offset;
+    trailer[1] = (uint32_t)(m_offset >> 32);
+    trailer[2] = m_index.size();
+    trailer[3] = RawDataFile::trailerMarker;
+    buf->offset = m_offset;
+    this->writeOut(*buf);
+    m_offset += buf->used*sizeof(uint32_t);
+    m_free.push_back(buf);
+
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+RawDataFileReader::RawDataFileReader(const std::string &filename)
+    : m_file(filename, std::ios::in | std::ios::binary), m_next(0), m_records(0) {
+    if (!m_file) {
+        throw std::runtime_error("could not open raw data file " + filename);
+    }
+    char magic[sizeof(RawDataFile::magic)];
+    uint32_t head[2] = {0, 0};
+    m_file.read(magic, sizeof(magic));
+    m_file.read((char*)head, sizeof(head));
+    if (!m_file || memcmp(magic, RawDataFile::magic, sizeof(magic)) != 0) {
+        throw std::runtime_error(filename + " is not a raw data file");
+    }
+    if (head[0] != RawDataFile::version || head[1] != RawDataFile::blockSize) {
+        throw std::runtime_error("unsupported raw data file version " + std::to_string(head[0]));
+    }
+    m_first = RawDataFile::blockSize;
+
+    // Index of a properly closed file
+    m_file.seekg(0, std::ios::end);
+    uint64_t size = m_file.tellg();
+    uint32_t trailer[4] = {0, 0, 0, 0};
+    if (size >= 2*RawDataFile::blockSize) {
+        m_file.seekg(size - sizeof(trailer));
+        m_file.read((char*)trailer, sizeof(trailer));
+    }
+    if (m_file && trailer[3] == RawDataFile::trailerMarker) {
+        m_file.seekg(trailer[0] | ((uint64_t)trailer[1] << 32));
+        uint32_t idxHead[2] = {0, 0};
+        m_file.read((char*)idxHead, sizeof(idxHead));
+        for (unsigned i=0; m_file && idxHead[0] == RawDataFile::indexMarker && i<idxHead[1]; i++) {
+            uint32_t entry[6];
+            RawDataFile::Chunk chunk;
+            m_file.read((char*)entry, sizeof(entry));
+            chunk.offset = entry[0] | ((uint64_t)entry[1] << 32);
+            chunk.bytes = entry[2] | ((uint64_t)entry[3] << 32);
+            chunk.records = entry[4];
+            chunk.adrMask = entry[5];
+            for (auto stat : {&chunk.first, &chunk.last}) {
+                uint32_t n = 0;
+                m_file.read((char*)&n, sizeof(n));
+                stat->resize(n);
+                m_file.read((char*)stat->data(), n*sizeof(uint32_t));
+            }
+            m_index.push_back(chunk);
+        }
+        if (!m_file || m_index.size() != trailer[2]) {
+            rflog->warn("Broken index in {}, reading without it", filename);
+            m_index.clear();
+        }
+    }
+    this->rewind();
+}
+
+bool RawDataFileReader::nextChunk() {
+    uint32_t head[3];
+    m_file.seekg(m_next);
+    if (!m_file.read((char*)head, sizeof(head)) || head[0] != RawDataFile::chunkMarker) {
+        // Index or end of the file
+        return false;
+    }
+    m_records = head[1];
+    m_next += roundUp((3 + (uint64_t)head[2])*sizeof(uint32_t));
+    return true;
+}
+
+std::unique_ptr<RawDataContainer> RawDataFileReader::read() {
+    while (m_records == 0) {
+        if (!this->nextChunk()) return NULL;
+    }
+    m_records--;
+    return this->readRecord();
+}
+
+std::unique_ptr<RawDataContainer> RawDataFileReader::readRecord() {
+    uint32_t head[3];
+    if (!m_file.read((char*)head, sizeof(head))) {
+        return NULL;
+    }
+    if (head[0] != RawDataFile::marker) {
+        rflog->error("Corrupted raw data record, stopping");
+        m_file.setstate(std::ios::failbit);
+        return NULL;
+    }
+
+    std::vector<unsigned> stat(head[1]);
+    std::vector<uint32_t> blocks(2*head[2]);
+    m_file.read((char*)stat.data(), stat.size()*sizeof(uint32_t));
+    m_file.read((char*)blocks.data(), blocks.size()*sizeof(uint32_t));
+
+    std::unique_ptr<RawDataContainer> rdc(new RawDataContainer(LoopStatus(std::move(stat))));
+    for (unsigned i=0; i<head[2]; i++) {
+        uint32_t words = blocks[2*i+1];
+        uint32_t *buf = new uint32_t[words];
+        m_file.read((char*)buf, words*sizeof(uint32_t));
+        rdc->add(new RawData(blocks[2*i], buf, words));
+    }
+    if (!m_file) {
+        rflog->error("Truncated raw data record, stopping");
+        return NULL;
+    }
+    return rdc;
+}
+
+void RawDataFileReader::rewind() {
+    m_file.clear();
+    m_next = m_first;
+    m_records = 0;
+}
+
+void RawDataFileReader::seek(const RawDataFile::Chunk &chunk) {
+    m_file.clear();
+    m_next = chunk.offset;
+    m_records = 0;
+}
@@ -0,0 +1,56 @@
+#include "RawDataRecorder.h"
+
+#include "logging.h"
+
+namespace {
+    auto rrlog = logging::make_log("RawDataRecorder");
+}
+
+RawDataRecorder::RawDataRecorder(const std::string &filename, bool direct)
+    : m_input(NULL), m_output(NULL), m_writer(filename, direct), m_count(0) {
+    rrlog->info("Recording raw data to {}", filename);
+}
+
+RawDataRecorder::~RawDataRecorder() {
+    this->join();
+}
+
+void RawDataRecorder::connect(ClipBoard<RawDataContainer> *input, ClipBoard<RawDataContainer> *output) {
+    m_input = input;
+    m_output = output;
+}
+
+void RawDataRecorder::run() {
+    m_thread.reset(new std::thread(&RawDataRecorder::process, this));
+}
+
+void RawDataRecorder::join() {
+    if (!m_thread || !m_thread->joinable()) return;
+    m_thread->join();
+    m_output->finish();
+    m_writer.close();
+    rrlog->info("Recorded {} containers, {} bytes", m_count, m_writer.bytesWritten());
+}
+
+void RawDataRecorder::process() {
+    while (true) {
+        m_input->waitNotEmptyOrDone();
+
+        process_core();
+
+        if (m_input->isDone()) {
+            process_core(); // this line is needed if the data comes in before done flag is changed.
+            break;
+        }
+    }
+}
+
+void RawDataRecorder::process_core() {
+    while (!m_input->empty()) {
+        std::unique_ptr<RawDataContainer> rdc = m_input->popData();
+        if (rdc == NULL) continue;
+        m_writer.write(*rdc);
+        m_count++;
+        m_output->pushData(std::move(rdc));
+    }
+}
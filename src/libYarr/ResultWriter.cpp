@@ -0,0 +1,76 @@
+// #################################
+// # Project: Yarr
+// # Description: Asynchronous result output stage
+// # Comment: Writes and plots results on a worker pool as they
+// #          appear in the result clipboards, while the scan runs
+// ################################
+
+#include "ResultWriter.h"
+
+#include <algorithm>
+
+#include "logging.h"
+
+namespace {
+    auto rlog = logging::make_log("ResultWriter");
+}
+
+ResultWriter::ResultWriter(std::string arg_outputDir, unsigned nThreads)
+    : outputDir(arg_outputDir)
+{
+    pool.reset(new TaskScheduler(std::max(1u, nThreads)));
+}
+
+ResultWriter::~ResultWriter() {
+    this->join();
+}
+
+void ResultWriter::addOutput(std::string name, ClipBoard<HistogramBase> *results) {
+    std::unique_ptr<Output> out(new Output);
+    out->name = name;
+    out->results = results;
+    out->count = 0;
+    outputs.push_back(std::move(out));
+}
+
+void ResultWriter::run() {
+    for (auto &out : outputs) {
+        collectors.emplace_back(&ResultWriter::collect, this, std::ref(*out));
+    }
+}
+
+void ResultWriter::join() {
+    for (auto &t : collectors) {
+        if (t.joinable()) t.join();
+    }
+    collectors.clear();
+    // Destructor of the pool drains outstanding writes
+    pool.reset();
+}
+
+unsigned ResultWriter::getCount(const std::string &name) const {
+    unsigned count = 0;
+    for (auto &out : outputs) {
+        if (out->name == name) count += out->count;
+    }
+    return count;
+}
+
+void ResultWriter::collect(Output &out) {
+    while (true) {
+        out.results->waitNotEmptyOrDone();
+        while (!out.results->empty()) {
+            std::shared_ptr<HistogramBase> h(out.results->popData());
+            if (h == nullptr) continue;
+            out.count++;
+            pool->submit([this, &out, h] { this->write(out, h); });
+        }
+        if (out.results->isDone() && out.results->empty()) break;
+    }
+    SPDLOG_LOGGER_DEBUG(rlog, "Collected {} results of {}", out.count, out.name);
+}
+
+void ResultWriter::write(Output &out, std::shared_ptr<HistogramBase> h) {
+    h->toFile(out.name, outputDir);
+    h->plot(out.name, outputDir);
+}
@@ -1,9 +1,14 @@
 #include "ScanHelper.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <exception>
 #include <iomanip>
+#include <iterator>
+#include <sstream>
 
 #include "AllAnalyses.h"
 #include "AllChips.h"
@@ -22,6 +27,95 @@ namespace {
     auto shlog = logging::make_log("ScanHelper");
     auto bhlog = logging::make_log("ScanBuildHistogrammers");
     auto balog = logging::make_log("ScanBuildAnalyses");
+
+    /// Sidecar of a chip config: magic, version, hash of the json text it
+    /// was written with, the json without the pixel config and then the
+    /// pixel registers of the front end
+    const char pixCfgMagic[8] = {'Y', 'A', 'R', 'R', 'P', 'I', 'X', '\0'};
+    const uint32_t pixCfgVersion = 1;
+
+    // FNV-1a
+    uint64_t hashText(const std::string &text) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : text) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    std::string pixCfgPath(const std::string &filename) {
+        const std::string ext = ".json";
+        std::string base = filename;
+        if (base.size() > ext.size() && base.compare(base.size()-ext.size(), ext.size(), ext) == 0)
+            base.erase(base.size()-ext.size());
+        return base + ".pixcfg";
+    }
+
+    /// Pixel config is in the section of the chip type, e.g. j["RD53A"]["PixelConfig"]
+    void erasePixelConfig(json &j) {
+        for (auto &section : j) {
+            if (section.is_object())
+                section.erase("PixelConfig");
+        }
+    }
+
+    /// Takes the full json of the chip, the pixel config is removed from it
+    void writePixCfg(FrontEndCfg *feCfg, const std::string &filename, uint64_t hash, json &j) {
+        std::string path = pixCfgPath(filename);
+        std::string tmp = path + ".tmp";
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            shlog->debug("Can not write pixel config sidecar {}", path);
+            return;
+        }
+        erasePixelConfig(j);
+        std::stringstream ss;
+        ss << j;
+        std::string text = ss.str();
+        uint32_t length = text.size();
+        file.write(pixCfgMagic, sizeof(pixCfgMagic));
+        file.write((const char*)&pixCfgVersion, sizeof(pixCfgVersion));
+        file.write((const char*)&hash, sizeof(hash));
+        file.write((const char*)&length, sizeof(length));
+        file.write(text.data(), length);
+        bool ok = feCfg->pixelsToBinary(file);
+        file.close();
+        if (ok && file) {
+            std::rename(tmp.c_str(), path.c_str());
+        } else {
+            std::remove(tmp.c_str());
+        }
+    }
+
+    /// Loads the config from the sidecar if it belongs to the json text
+    bool readPixCfg(FrontEndCfg *feCfg, const std::string &filename, uint64_t hash) {
+        std::ifstream file(pixCfgPath(filename), std::ios::binary);
+        char magic[sizeof(pixCfgMagic)];
+        uint32_t version = 0;
+        uint64_t fileHash = 0;
+        uint32_t length = 0;
+        if (!file.read(magic, sizeof(magic)) || memcmp(magic, pixCfgMagic, sizeof(magic)) != 0
+                || !file.read((char*)&version, sizeof(version)) || version != pixCfgVersion
+                || !file.read((char*)&fileHash, sizeof(fileHash)) || fileHash != hash
+                || !file.read((char*)&length, sizeof(length))) {
+            return false;
+        }
+        std::string text(length, '\0');
+        if (!file.read(&text[0], length))
+            return false;
+        json j;
+        try {
+            j = json::parse(text);
+        } catch (json::parse_error &e) {
+            return false;
+        }
+        if (j.is_null())
+            return false;
+        // If the pixels are truncated all of the json is loaded after this
+        feCfg->fromFileJson(j);
+        return feCfg->pixelsFromBinary(file);
+    }
 }
 
 namespace ScanHelper {
@@ -84,6 +178,58 @@ unsigned newRunCounter() {
         return j;
     }
 
+    void loadChipConfig(FrontEndCfg *feCfg, const std::string &filename) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("could not open file");
+        }
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+        uint64_t hash = hashText(text);
+
+        if (readPixCfg(feCfg, filename, hash)) {
+            shlog->debug("Loaded config from {}", pixCfgPath(filename));
+            return;
+        }
+
+        json j;
+        try {
+            j = json::parse(text);
+        } catch (json::parse_error &e) {
+            throw std::runtime_error(e.what());
+        }
+        // variant produces null for some parse errors
+        if (j.is_null()) {
+            throw std::runtime_error("Parsing json file produced null");
+        }
+        feCfg->fromFileJson(j);
+        writePixCfg(feCfg, filename, hash, j);
+    }
+
+    std::string dumpChipConfig(FrontEndCfg *feCfg) {
+        json j;
+        feCfg->toFileJson(j);
+        std::stringstream ss;
+        ss << std::setw(4) << j;
+        return ss.str();
+    }
+
+    std::string saveChipConfig(FrontEndCfg *feCfg, const std::string &filename) {
+        json j;
+        feCfg->toFileJson(j);
+        std::stringstream ss;
+        ss << std::setw(4) << j;
+        std::string text = ss.str();
+
+        std::ofstream file(filename);
+        file << text;
+        file.close();
+        if (file) {
+            writePixCfg(feCfg, filename, hashText(text), j);
+        }
+        return text;
+    }
+
     // Load controller config and return fully loaded object
     std::unique_ptr<HwController> loadController(json &ctrlCfg) {
         std::unique_ptr<HwController> hwCtrl = nullptr;
@@ -141,28 +287,22 @@ unsigned newRunCounter() {
                     std::ifstream cfgFile(chipConfigPath);
                     if (cfgFile) {
                         // Load config
+                        cfgFile.close();
                         shlog->info("Loading config file: {}", chipConfigPath);
-                        json cfg;
                         try {
-                            cfg = ScanHelper::openJsonFile(chipConfigPath);
+                            ScanHelper::loadChipConfig(feCfg, chipConfigPath);
                         } catch (std::runtime_error &e) {
                             shlog->error("Error opening chip config: {}", e.what());
                             throw(std::runtime_error("loadChips failure"));
                         }
-                        feCfg->fromFileJson(cfg);
                         if (!chip["locked"].empty())
                             feCfg->setLocked((int)chip["locked"]);
-                        cfgFile.close();
                     } else {
                         shlog->warn("Config file not found, using default!");
                         // Rename in case of multiple default configs
                         feCfg->setName(feCfg->getName() + "_" + std::to_string((int)chip["rx"]));
                         shlog->warn("Creating new config of FE {} at {}", feCfg->getName(),chipConfigPath);
-                        json jTmp;
-                        feCfg->toFileJson(jTmp);
-                        std::ofstream oFTmp(chipConfigPath);
-                        oFTmp << std::setw(4) << jTmp;
-                        oFTmp.close();
+                        ScanHelper::saveChipConfig(feCfg, chipConfigPath);
                     }
                     // Save path to config
                     std::size_t botDirPos = chipConfigPath.find_last_of("/");
@@ -172,9 +312,7 @@ unsigned newRunCounter() {
                     // Create backup of current config
                     // TODO fix folder
                     std::ofstream backupCfgFile(outputDir + feCfg->getConfigFile() + ".before");
-                    json backupCfg;
-                    feCfg->toFileJson(backupCfg);
-                    backupCfgFile << std::setw(4) << backupCfg;
+                    backupCfgFile << ScanHelper::dumpChipConfig(feCfg);
                     backupCfgFile.close();
                 }
             }
@@ -203,13 +341,18 @@ void buildHistogrammers( std::map<FrontEnd*, std::unique_ptr<DataProcessor>>& hi
 
             histogrammer.connect(fe->clipData, fe->clipHisto);
 
-            auto add_histo = [&](std::string algo_name) {
+            auto add_histo = [&](json algoCfg) {
+                std::string algo_name = algoCfg["algorithm"];
                 auto histo = StdDict::getHistogrammer(algo_name);
                 if(histo) {
                     bhlog->debug("  ... adding {}", algo_name);
                     histogrammer.addHistogrammer(std::move(histo));
                 } else if (algo_name == "DataArchiver") {
-                    histo.reset(new DataArchiver((outputDir + dynamic_cast<FrontEndCfg*>(fe)->getName() + "_data.raw")));
+                    bool compact = false;
+                    if (!algoCfg["compact"].empty()) {
+                        compact = algoCfg["compact"];
+                    }
+                    histo.reset(new DataArchiver((outputDir + dynamic_cast<FrontEndCfg*>(fe)->getName() + "_data.raw"), compact));
                     histogrammer.addHistogrammer(std::move(histo));
                     bhlog->debug("  ... adding {}", algo_name);
                 } else {
@@ -221,14 +364,12 @@ void buildHistogrammers( std::map<FrontEnd*, std::unique_ptr<DataProcessor>>& hi
                 int nHistos = histoCfg["n_count"];
 
                 for (int j=0; j<nHistos; j++) {
-                    std::string algo_name = histoCfg[std::to_string(j)]["algorithm"];
-                    add_histo(algo_name);
+                    add_histo(histoCfg[std::to_string(j)]);
                 }
             } catch(/* json::type_error &te*/ ... ) { //FIXME
                 int nHistos = histoCfg.size();
                 for (int j=0; j<nHistos; j++) {
-                    std::string algo_name = histoCfg[j]["algorithm"];
-                    add_histo(algo_name);
+                    add_histo(histoCfg[j]);
                 }
             }
             histogrammer.setMapSize(fe->geo.nCol, fe->geo.nRow);
@@ -0,0 +1,205 @@
+// #################################
+// # Project: Yarr
+// # Description: Work-stealing task scheduler
+// # Comment: Each worker has its own task deque and steals from the
+// #          others when it runs dry, tasks are stored without allocation
+// ################################
+
+#include "TaskScheduler.h"
+
+#include <chrono>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "logging.h"
+
+namespace {
+    auto tlog = logging::make_log("TaskScheduler");
+
+    // Scheduler and index of a worker thread
+    thread_local const TaskScheduler *currentScheduler = nullptr;
+    thread_local unsigned currentIndex = 0;
+}
+
+TaskScheduler::TaskScheduler(unsigned nWorkers, bool pinWorkers)
+    : queued(0), nextWorker(0), idle(0), stop(false)
+{
+    for (unsigned i=0; i<nWorkers; i++) {
+        workers.emplace_back(new Worker);
+    }
+    // All deques exist before the first worker looks for work
+    for (unsigned i=0; i<nWorkers; i++) {
+        workers[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+    }
+
+    if (pinWorkers) {
+#ifdef __linux__
+        unsigned nCpus = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i=0; i<nWorkers; i++) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(i % nCpus, &cpus);
+            if (pthread_setaffinity_np(workers[i]->thread.native_handle(), sizeof(cpus), &cpus) != 0) {
+                tlog->warn("Could not pin worker {} to CPU {}", i, i % nCpus);
+            }
+        }
+#else
+        tlog->warn("Pinning of workers is not supported on this platform");
+#endif
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lk(sleepMutex);
+        stop = true;
+    }
+    sleepCv.notify_all();
+    for (auto &w : workers) {
+        w->thread.join();
+    }
+}
+
+unsigned TaskScheduler::defaultWorkers() {
+    return std::max(1u, std::thread::hardware_concurrency()) - 1;
+}
+
+TaskScheduler &TaskScheduler::shared() {
+    static TaskScheduler scheduler(defaultWorkers());
+    return scheduler;
+}
+
+unsigned TaskScheduler::self() const {
+    return currentScheduler == this ? currentIndex : size();
+}
+
+void TaskScheduler::push(Task &&task) {
+    // Workers fill their own deque, everybody else deals round robin
+    unsigned index = self();
+    if (index == size()) {
+        index = nextWorker.fetch_add(1, std::memory_order_relaxed) % size();
+    }
+
+    Worker &w = *workers[index];
+    {
+        std::lock_guard<std::mutex> lk(w.mutex);
+        w.tasks.push_back(std::move(task));
+        queued++;
+    }
+
+    // Checked after the count went up, a worker going to sleep checks the
+    // count after announcing itself
+    if (idle.load() > 0) {
+        std::lock_guard<std::mutex> lk(sleepMutex);
+        sleepCv.notify_one();
+    }
+}
+
+bool TaskScheduler::take(Task &task) {
+    if (queued.load() == 0) return false;
+
+    // Newest task of the own deque first, still warm in the cache
+    unsigned index = self();
+    if (index < size()) {
+        Worker &w = *workers[index];
+        std::lock_guard<std::mutex> lk(w.mutex);
+        if (!w.tasks.empty()) {
+            task = std::move(w.tasks.back());
+            w.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+
+    // Steal the oldest task of another deque
+    unsigned start = index < size() ? index + 1 : nextWorker.load(std::memory_order_relaxed);
+    for (unsigned i=0; i<size(); i++) {
+        Worker &w = *workers[(start + i) % size()];
+        std::lock_guard<std::mutex> lk(w.mutex);
+        if (!w.tasks.empty()) {
+            task = std::move(w.tasks.front());
+            w.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::execute(Task &task) {
+    try {
+        task();
+    } catch (std::exception &e) {
+        tlog->error("Task failed: {}", e.what());
+    } catch (...) {
+        tlog->error("Task failed with an unknown exception");
+    }
+    task.reset();
+}
+
+bool TaskScheduler::runOne() {
+    Task task;
+    if (!take(task)) return false;
+    execute(task);
+    return true;
+}
+
+void TaskScheduler::workerLoop(unsigned index) {
+    currentScheduler = this;
+    currentIndex = index;
+
+    Task task;
+    while (true) {
+        if (take(task)) {
+            execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(sleepMutex);
+        idle++;
+        sleepCv.wait(lk, [this] { return stop || queued.load() > 0; });
+        idle--;
+        if (stop && queued.load() == 0) return;
+    }
+}
+
+TaskGroup::~TaskGroup() {
+    try {
+        this->wait();
+    } catch (std::exception &e) {
+        tlog->error("Task of a group failed: {}", e.what());
+    } catch (...) {
+        tlog->error("Task of a group failed with an unknown exception");
+    }
+}
+
+void TaskGroup::done(std::exception_ptr e) {
+    // Under the lock, the group can go away as soon as the waiter sees nothing pending
+    std::lock_guard<std::mutex> lk(mutex);
+    if (e && !error) error = e;
+    if (--pending == 0) cv.notify_all();
+}
+
+void TaskGroup::wait() {
+    std::unique_lock<std::mutex> lk(mutex);
+    while (pending > 0) {
+        lk.unlock();
+        bool ran = scheduler.runOne();
+        lk.lock();
+        // Nothing left to help with, the remaining tasks are running elsewhere.
+        // Woken up on completion, the timeout is for newly queued tasks.
+        if (!ran && pending > 0) {
+            cv.wait_for(lk, std::chrono::milliseconds(1));
+        }
+    }
+
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
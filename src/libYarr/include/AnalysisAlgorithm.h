@@ -1,7 +1,11 @@
 #ifndef YARR_ANALYSIS_ALGORITHM_H
 #define YARR_ANALYSIS_ALGORITHM_H
 
+#include <algorithm>
 #include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
 
 #include "Bookkeeper.h"
 #include "DataProcessor.h"
@@ -19,6 +23,7 @@ class AnalysisAlgorithm {
             nCol = 80;
             nRow = 336;
             make_mask = true;
+            concurrent = false;
         }
         virtual ~AnalysisAlgorithm() {}
         
@@ -42,13 +47,28 @@ class AnalysisAlgorithm {
         void disMasking() {make_mask = false;}
         void setMasking(bool val) {make_mask = val;}
 
+        /// Histogram types passed to processHistogram(), all types if none are declared
+        const std::vector<std::type_index>& getInputTypes() const {return inputTypes;}
+        /// Algorithm shares no state with others and can run in its own thread
+        bool isConcurrent() const {return concurrent;}
+
     protected:
+        /// Declare a consumed histogram type, to be called in init()
+        void consume(std::type_index t) {
+            if (std::find(inputTypes.begin(), inputTypes.end(), t) == inputTypes.end())
+                inputTypes.push_back(t);
+        }
+
         Bookkeeper *bookie;
         unsigned channel;
         ScanBase *scan;
         ClipBoard<HistogramBase> *output;
         bool make_mask;
+        bool concurrent;
         unsigned nCol, nRow;
+
+    private:
+        std::vector<std::type_index> inputTypes;
 };
 
 /**
@@ -89,6 +109,19 @@ class AnalysisProcessor : public DataProcessor {
         }
 
     private:
+        // Histograms are shared by all algorithms consuming their type
+        typedef std::shared_ptr<HistogramBase> SharedHisto;
+
+        // Input queue and thread of a concurrent algorithm
+        struct Worker {
+            ClipBoard<SharedHisto> input;
+            std::thread thread;
+        };
+
+        void dispatch(unsigned i, const SharedHisto &h);
+        void work(unsigned i);
+        void stopWorkers();
+
         Bookkeeper *bookie;
         unsigned channel;
         ClipBoard<HistogramBase> *input;
@@ -97,6 +130,13 @@ class AnalysisProcessor : public DataProcessor {
         std::unique_ptr<std::thread> thread_ptr;
         
         std::vector<std::unique_ptr<AnalysisAlgorithm>> algorithms;
+
+        // Algorithm indices per histogram type, built in init()
+        std::unordered_map<std::type_index, std::vector<unsigned>> routes;
+        // Algorithms without declared types get every histogram
+        std::vector<unsigned> catchAll;
+        // One per algorithm, nullptr if it runs in the processor thread
+        std::vector<std::unique_ptr<Worker>> workers;
 };
 
 #endif
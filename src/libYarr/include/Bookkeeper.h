@@ -54,6 +54,9 @@ class Bookkeeper {
         void setTargetCharge(int v) {target_charge = v;}
         int getTargetCharge() {return target_charge;}
 
+        /// Accept data again after all clipboards were finished by a scan
+        void resetClipBoards();
+
         template<typename T> T* globalFe() {return dynamic_cast<T*>(g_fe);}
         // TODO make private, not nice like that
         FrontEnd *g_fe;
@@ -0,0 +1,47 @@
+#ifndef CHIPSTATECACHE_H
+#define CHIPSTATECACHE_H
+
+// #################################
+// # Project: Yarr
+// # Description: Last configuration written to a chip
+// # Comment: Kept between runs, so a front-end only needs to write what
+// #          changed since the previous scan
+// ################################
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ChipStateCache {
+    public:
+        /// The key identifies the chip, e.g. controller type, chip name and channels
+        ChipStateCache(const std::string &key);
+
+        /// State stored by the previous run. The file is removed, so if this
+        /// run ends without store() the next one writes the full configuration
+        bool take(std::vector<char> &state);
+
+        /// Keep the state written to the chip for the next run
+        void store(const void *data, size_t bytes);
+
+        /// Called after the full configuration was written to the chip
+        void fullWritten();
+
+        /// True if forced, or if the last full configuration is older than the refresh interval
+        bool fullDue() const;
+
+        /// Write the full configuration in every run, e.g. after power cycling the chips
+        static void setForceFull(bool force);
+        /// Guards against upsets of the chip state, default 1 hour
+        static void setRefreshInterval(std::chrono::seconds interval);
+        /// Default ~/.yarr/chipState
+        static void setDirectory(const std::string &dir);
+
+    private:
+        std::string m_key;
+        /// Seconds since epoch, 0 if not known
+        int64_t m_lastFull;
+};
+
+#endif
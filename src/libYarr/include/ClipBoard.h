@@ -65,6 +65,11 @@ class ClipBoard {
             cvNotEmpty.notify_all();
         }
 
+        /// Undo finish(), for the next scan of a sequence
+        void reset() {
+            doneFlag = false;
+        }
+
         void waitNotEmptyOrDone() {
           std::unique_lock<std::mutex> lk(queueMutex);
           cvNotEmpty.wait(lk,
@@ -9,6 +9,7 @@
 // # Comment: Combined multiple FE 
 // ################################
 
+#include <iosfwd>
 #include <string>
 
 #include "ClipBoard.h"
@@ -73,6 +74,11 @@ class FrontEndCfg {
         virtual void toFileJson(json&)=0;
         virtual void fromFileJson(json&)=0;
 
+        /// Pixel registers for the binary sidecar of the config file, read
+        /// in place of the "PixelConfig" of the json. False if not supported
+        virtual bool pixelsToBinary(std::ostream&) {return false;}
+        virtual bool pixelsFromBinary(std::istream&) {return false;}
+
 		
         unsigned getChannel() {return rxChannel;}
 		unsigned getTxChannel() {return txChannel;}
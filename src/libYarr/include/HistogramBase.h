@@ -9,6 +9,7 @@
 // # Comment: 
 // ################################
 
+#include <iosfwd>
 #include <string>
 #include <typeinfo>
 #include <typeindex>
@@ -23,10 +24,12 @@ class HistogramBase {
 
         std::string getName();
 
-        LoopStatus getStat() {return lStat;}
+        const LoopStatus& getStat() const {return lStat;}
 
         virtual void toFile(std::string basename, std::string dir = "", bool header=true) {}
         virtual void plot(std::string basename, std::string dir = "") {}
+        /// Compute lazily cached values, afterwards the histogram can be read from several threads
+        virtual void prepareShared() {}
         
         void setAxisTitle(std::string x, std::string y="y", std::string z="z");
         void setXaxisTitle(std::string);
@@ -39,6 +42,10 @@ class HistogramBase {
 
         std::type_index getType() {return type;}
     protected:
+        /// Name and axis titles, start of the binary layout of the histograms
+        void titlesToBinary(std::ostream &handle) const;
+        bool titlesFromBinary(std::istream &handle);
+
         std::string name;
         std::string xAxisTitle;
         std::string yAxisTitle;
@@ -21,6 +21,13 @@ class HwController : virtual public TxCore, virtual public RxCore {
         virtual void setupMode() {}
         virtual void runMode() {}
 
+        /// False if there are no front-ends to answer, e.g. when playing back recorded data
+        virtual bool hasFrontEnds() {return true;}
+
+        /// False if the front-ends lose their configuration when the program
+        /// ends, then it is written in full at the start of every scan
+        virtual bool hasPersistentChips() {return hasFrontEnds();}
+
         virtual ~HwController() {}
 };
 
@@ -0,0 +1,124 @@
+#ifndef RAWDATAFILE_H
+#define RAWDATAFILE_H
+
+// #################################
+// # Project: Yarr
+// # Description: Binary file of a raw data stream
+// # Comment: Records of RawDataContainers, grouped into block aligned chunks
+// #          and followed by an index of the chunks, see docs/replay.md
+// ################################
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RawData.h"
+
+namespace RawDataFile {
+    /// Start of the file, followed by the format version
+    const char magic[8] = {'Y', 'A', 'R', 'R', 'R', 'A', 'W', '\0'};
+    const uint32_t version = 2;
+
+    /// Header, chunks and index start on block boundaries, as needed for O_DIRECT
+    const uint32_t blockSize = 4096;
+
+    /// Start of each container record
+    const uint32_t marker = 0x52444331;
+    const uint32_t chunkMarker = 0x4b4e4843;
+    const uint32_t indexMarker = 0x58444e49;
+    const uint32_t trailerMarker = 0x524c5254;
+
+    /// Entry of the index, enough to pick chunks without reading them
+    struct Chunk {
+        /// Position in the file and length including padding, in bytes
+        uint64_t offset;
+        uint64_t bytes;
+        uint32_t records;
+        /// Bit n is set if a block with address n is in the chunk
+        uint32_t adrMask;
+        /// Loop status of the first and the last record
+        std::vector<unsigned> first;
+        std::vector<unsigned> last;
+    };
+}
+
+class RawDataFileWriter {
+    public:
+        /// Full chunks are written by a background thread, with O_DIRECT if
+        /// asked for and supported by the file system.
+        /// Throws std::runtime_error if the file can not be created
+        RawDataFileWriter(const std::string &filename, bool direct = false,
+                          uint32_t chunkBytes = 4 << 20);
+        ~RawDataFileWriter();
+
+        /// Copies the container into the current chunk
+        void write(const RawDataContainer &rdc);
+
+        /// Writes the last chunk and the index, waits for the writer thread
+        void close();
+
+        uint64_t bytesWritten() {return m_offset;}
+
+    private:
+        struct Buffer;
+        Buffer* getBuffer(size_t words);
+        void queueChunk();
+        void writeLoop();
+        void writeOut(const Buffer &buf);
+
+        int m_fd;
+        bool m_direct;
+        uint32_t m_chunkWords;
+        uint64_t m_offset;
+
+        Buffer *m_cur;
+        RawDataFile::Chunk m_curChunk;
+        std::vector<RawDataFile::Chunk> m_index;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<Buffer*> m_full;
+        std::vector<Buffer*> m_free;
+        bool m_closing;
+        bool m_failed;
+        std::thread m_thread;
+};
+
+class RawDataFileReader {
+    public:
+        /// Throws std::runtime_error if the file can not be opened or is not a raw data file
+        RawDataFileReader(const std::string &filename);
+
+        /// Next container of the stream, NULL at the end of the file
+        std::unique_ptr<RawDataContainer> read();
+
+        /// Start again from the first container
+        void rewind();
+
+        /// Chunks of the file, empty if the file was not closed properly,
+        /// it can then still be read from the start
+        const std::vector<RawDataFile::Chunk>& index() {return m_index;}
+
+        /// Continue reading with the first container of a chunk
+        void seek(const RawDataFile::Chunk &chunk);
+
+    private:
+        bool nextChunk();
+        std::unique_ptr<RawDataContainer> readRecord();
+
+        std::ifstream m_file;
+        std::streampos m_first;
+        std::vector<RawDataFile::Chunk> m_index;
+
+        /// Where the next chunk starts and records left in the current one
+        uint64_t m_next;
+        uint32_t m_records;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef RAWDATARECORDER_H
+#define RAWDATARECORDER_H
+
+// #################################
+// # Project: Yarr
+// # Description: Tap recording the raw data stream
+// # Comment: Sits between the data loop and the data processor, each
+// #          container is copied into the file and passed on unchanged
+// ################################
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "ClipBoard.h"
+#include "RawData.h"
+#include "RawDataFile.h"
+
+class RawDataRecorder {
+    public:
+        /// Throws std::runtime_error if the file can not be created
+        RawDataRecorder(const std::string &filename, bool direct = false);
+        ~RawDataRecorder();
+
+        void connect(ClipBoard<RawDataContainer> *input, ClipBoard<RawDataContainer> *output);
+
+        void run();
+        /// Waits for the input to finish, then finishes the output and closes the file
+        void join();
+
+    private:
+        void process();
+        void process_core();
+
+        ClipBoard<RawDataContainer> *m_input;
+        ClipBoard<RawDataContainer> *m_output;
+        RawDataFileWriter m_writer;
+        std::unique_ptr<std::thread> m_thread;
+        unsigned m_count;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+// #################################
+// # Project: Yarr
+// # Description: Asynchronous result output stage
+// # Comment: Writes and plots results on a worker pool as they
+// #          appear in the result clipboards, while the scan runs
+// ################################
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ClipBoard.h"
+#include "HistogramBase.h"
+#include "TaskScheduler.h"
+
+class ResultWriter {
+    public:
+        /// nThreads workers write and plot results
+        ResultWriter(std::string arg_outputDir, unsigned nThreads);
+        ~ResultWriter();
+
+        /// Register result clipboard of one FE, has to be called before run()
+        void addOutput(std::string name, ClipBoard<HistogramBase> *results);
+
+        void run();
+        /// Returns once all clipboards are finished and every result is written
+        void join();
+
+        /// Number of results written for an output, valid after join()
+        unsigned getCount(const std::string &name) const;
+
+    private:
+        struct Output {
+            std::string name;
+            ClipBoard<HistogramBase> *results;
+            std::atomic<unsigned> count;
+        };
+
+        void collect(Output &out);
+        void write(Output &out, std::shared_ptr<HistogramBase> h);
+
+        std::string outputDir;
+
+        std::vector<std::unique_ptr<Output>> outputs;
+        std::vector<std::thread> collectors;
+        std::unique_ptr<TaskScheduler> pool;
+};
+
+#endif
@@ -23,6 +23,16 @@ namespace ScanHelper {
         unsigned newRunCounter();
 
         json openJsonFile(std::string filepath);
+
+        /// Loads a chip config. It is read from the binary .pixcfg sidecar
+        /// next to it if that was written with the same json text, otherwise
+        /// from the json and the sidecar is (re)written.
+        /// Throws std::runtime_error if the file can not be read
+        void loadChipConfig(FrontEndCfg *feCfg, const std::string &filename);
+        /// Json text of a chip config
+        std::string dumpChipConfig(FrontEndCfg *feCfg);
+        /// Writes the chip config and its sidecar, returns the json text
+        std::string saveChipConfig(FrontEndCfg *feCfg, const std::string &filename);
         std::unique_ptr<HwController> loadController(json &ctrlCfg);
         std::string loadChips(json &j, Bookkeeper &bookie, HwController *hwCtrl, std::map<FrontEnd*, std::string> &feCfgMap, std::string &outputDir);
 
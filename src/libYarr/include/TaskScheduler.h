@@ -0,0 +1,220 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+// #################################
+// # Project: Yarr
+// # Description: Work-stealing task scheduler
+// # Comment: Each worker has its own task deque and steals from the
+// #          others when it runs dry, tasks are stored without allocation
+// ################################
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// Type-erased void() callable kept in a fixed inline buffer
+class Task {
+    public:
+        static constexpr std::size_t capacity = 48;
+
+        Task() noexcept : manage(nullptr) {}
+
+        template<class F, class = std::enable_if_t<!std::is_same<std::decay_t<F>, Task>::value>>
+        Task(F &&f) {
+            using Fn = std::decay_t<F>;
+            static_assert(sizeof(Fn) <= capacity, "Task callable does not fit the inline storage, capture less or by reference");
+            static_assert(alignof(Fn) <= alignof(std::max_align_t), "Task callable is over-aligned");
+            static_assert(std::is_nothrow_move_constructible<Fn>::value, "Task callable has to be nothrow movable");
+            new (storage) Fn(std::forward<F>(f));
+            manage = &Task::manageFn<Fn>;
+        }
+
+        Task(Task &&other) noexcept : manage(other.manage) {
+            if (manage) manage(Op::Move, this, &other);
+        }
+
+        Task &operator=(Task &&other) noexcept {
+            if (this != &other) {
+                reset();
+                manage = other.manage;
+                if (manage) manage(Op::Move, this, &other);
+            }
+            return *this;
+        }
+
+        Task(const Task&) = delete;
+        Task &operator=(const Task&) = delete;
+
+        ~Task() { reset(); }
+
+        void operator()() { manage(Op::Call, this, nullptr); }
+        explicit operator bool() const { return manage != nullptr; }
+
+        void reset() {
+            if (manage) {
+                manage(Op::Destroy, this, nullptr);
+                manage = nullptr;
+            }
+        }
+
+    private:
+        enum class Op { Call, Move, Destroy };
+
+        template<class Fn>
+        static void manageFn(Op op, Task *self, Task *other) {
+            Fn *fn = reinterpret_cast<Fn*>(self->storage);
+            switch (op) {
+                case Op::Call:
+                    (*fn)();
+                    break;
+                case Op::Move: {
+                    Fn *src = reinterpret_cast<Fn*>(other->storage);
+                    new (self->storage) Fn(std::move(*src));
+                    src->~Fn();
+                    other->manage = nullptr;
+                    break;
+                }
+                case Op::Destroy:
+                    fn->~Fn();
+                    break;
+            }
+        }
+
+        void (*manage)(Op, Task*, Task*);
+        alignas(std::max_align_t) unsigned char storage[capacity];
+};
+
+class TaskScheduler {
+    public:
+        /// Without workers tasks run in the submitting thread, pinned workers are
+        /// bound to one CPU each
+        explicit TaskScheduler(unsigned nWorkers, bool pinWorkers = false);
+        /// Runs all queued tasks before joining the workers
+        ~TaskScheduler();
+
+        TaskScheduler(const TaskScheduler&) = delete;
+        TaskScheduler &operator=(const TaskScheduler&) = delete;
+
+        unsigned size() const { return workers.size(); }
+
+        /// Queue a task, exceptions escaping it are logged
+        template<class F>
+        void submit(F &&f);
+
+        /// Run one queued task in the calling thread, false if there is none
+        bool runOne();
+
+        /// Call f(first, last) on chunks of grain indices of [begin, end), the
+        /// calling thread takes part. A grain of 0 makes one chunk per thread.
+        template<class F>
+        void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const F &f);
+
+        /// One worker less than the number of cores, the waiting thread helps out
+        static unsigned defaultWorkers();
+        /// Scheduler for everything within the process which has no reason for its own
+        static TaskScheduler &shared();
+
+    private:
+        struct Worker {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+            std::thread thread;
+        };
+
+        void push(Task &&task);
+        bool take(Task &task);
+        void execute(Task &task);
+        void workerLoop(unsigned index);
+        /// Index of the calling thread in this scheduler, size() if it is no worker
+        unsigned self() const;
+
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        // Tasks in all deques, changed with the lock of the deque
+        std::atomic<std::size_t> queued;
+        std::atomic<unsigned> nextWorker;
+
+        // Idle workers sleep here
+        std::mutex sleepMutex;
+        std::condition_variable sleepCv;
+        std::atomic<unsigned> idle;
+        bool stop;
+};
+
+/// Tasks which are waited for together, the waiting thread runs queued tasks meanwhile
+class TaskGroup {
+    public:
+        explicit TaskGroup(TaskScheduler &s) : scheduler(s), pending(0) {}
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup &operator=(const TaskGroup&) = delete;
+
+        template<class F>
+        void run(F &&f);
+
+        /// Returns when all tasks are done, rethrows the first exception of one of them
+        void wait();
+
+    private:
+        void done(std::exception_ptr e);
+
+        TaskScheduler &scheduler;
+        std::size_t pending;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+};
+
+template<class F>
+void TaskScheduler::submit(F &&f) {
+    Task task(std::forward<F>(f));
+    if (workers.empty()) {
+        execute(task);
+    } else {
+        push(std::move(task));
+    }
+}
+
+template<class F>
+void TaskScheduler::parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const F &f) {
+    if (begin >= end) return;
+    if (grain == 0) grain = (end - begin + size()) / (size() + 1);
+
+    TaskGroup group(*this);
+    for (std::size_t first = begin + grain; first < end; first += grain) {
+        std::size_t last = std::min(first + grain, end);
+        group.run([&f, first, last] { f(first, last); });
+    }
+    f(begin, std::min(begin + grain, end));
+    group.wait();
+}
+
+template<class F>
+void TaskGroup::run(F &&f) {
+    {
+        std::lock_guard<std::mutex> lk(mutex);
+        pending++;
+    }
+    scheduler.submit([this, fn = std::forward<F>(f)] () mutable {
+        std::exception_ptr e;
+        try {
+            fn();
+        } catch (...) {
+            e = std::current_exception();
+        }
+        done(e);
+    });
+}
+
+#endif
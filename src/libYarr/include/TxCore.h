@@ -9,6 +9,7 @@
 // # Comment: Transmitter Core
 // ################################
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -28,6 +29,10 @@ class TxCore {
     public:
         // Write to FE interface
         virtual void writeFifo(uint32_t) = 0;
+        // Write several words, controllers with a faster path override this
+        virtual void writeFifoBlock(const uint32_t *words, size_t count) {
+            for (size_t i=0; i<count; i++) writeFifo(words[i]);
+        }
         virtual void releaseFifo() = 0;
         virtual void setCmdEnable(uint32_t) = 0;
         virtual void setCmdEnable(std::vector<uint32_t>) = 0;
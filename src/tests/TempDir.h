@@ -0,0 +1,35 @@
+#ifndef YARR_TEST_TEMP_DIR_H
+#define YARR_TEST_TEMP_DIR_H
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <system_error>
+
+// Directory of its own under the system temp directory, removed with
+// everything in it when going out of scope
+class TempDir {
+public:
+  explicit TempDir(const std::string &prefix) {
+    std::random_device rd;
+    do {
+      dir = std::filesystem::temp_directory_path() / (prefix + "_" + std::to_string(rd()));
+    } while(!std::filesystem::create_directory(dir));
+  }
+
+  ~TempDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+  }
+
+  TempDir(const TempDir&) = delete;
+  TempDir &operator=(const TempDir&) = delete;
+
+  std::string path() const { return dir.string(); }
+  std::string file(const std::string &name) const { return (dir / name).string(); }
+
+private:
+  std::filesystem::path dir;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#include "catch.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "Fei4EventData.h"
+#include "Fei4EventReader.h"
+#include "Fei4Histogrammer.h"
+
+#include "../TempDir.h"
+
+TEST_CASE("HistogramDataArchiver", "[Histogrammer][Fei4][DataArchiver]") {
+    TempDir tmp("test_data_archiver");
+    const std::string filename = tmp.file("events.raw");
+    bool compact = GENERATE(false, true);
+
+    Fei4Data data;
+    for (unsigned i=0; i<1000; i++) {
+        data.newEvent(i%8, i%32, i);
+        for (unsigned h=0; h<i%5; h++) {
+            data.curEvent->addHit(100+h, 40-h, 1+(i+h)%15);
+        }
+    }
+
+    {
+        DataArchiver archiver(filename, compact);
+        archiver.processEvent(&data);
+    }
+
+    std::ifstream file(filename, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::vector<Fei4Event> events;
+    if (compact) {
+        REQUIRE (memcmp(bytes.data(), Fei4EventFile::compactMagic, sizeof(Fei4EventFile::compactMagic)) == 0);
+        size_t pos = sizeof(Fei4EventFile::compactMagic);
+        while (pos < bytes.size()) {
+            events.emplace_back();
+            size_t used = events.back().fromBufferCompact(&bytes[pos], bytes.size() - pos);
+            REQUIRE (used > 0);
+            pos += used;
+        }
+    } else {
+        // Readable event by event
+        std::fstream in(filename, std::fstream::in | std::fstream::binary);
+        for (unsigned i=0; i<data.events.size(); i++) {
+            events.emplace_back();
+            events.back().fromFileBinary(in);
+        }
+        REQUIRE (in.tellg() == (std::streampos)bytes.size());
+    }
+
+    // Same events through the memory mapped reader
+    {
+        Fei4EventReader reader(filename);
+        REQUIRE (reader.isCompact() == compact);
+        REQUIRE (reader.size() == bytes.size());
+        Fei4EventReader::Header h;
+        size_t pos = reader.begin();
+        unsigned n = 0;
+        std::vector<Fei4Hit> hits;
+        for (; reader.header(pos, h); pos = h.next, n++) {
+            REQUIRE (n < events.size());
+            REQUIRE (h.tag == events[n].tag);
+            REQUIRE (h.l1id == events[n].l1id);
+            REQUIRE (h.bcid == events[n].bcid);
+            REQUIRE (h.nHits == events[n].nHits);
+            hits.clear();
+            reader.hits(h, hits);
+            REQUIRE (hits.size() == events[n].hits.size());
+            auto hit = events[n].hits.begin();
+            for (const Fei4Hit &hh : hits) {
+                REQUIRE (hh.col == hit->col);
+                REQUIRE (hh.row == hit->row);
+                REQUIRE (hh.tot == hit->tot);
+                ++hit;
+            }
+        }
+        REQUIRE (n == events.size());
+        REQUIRE (pos == bytes.size());
+    }
+
+    REQUIRE (events.size() == data.events.size());
+    auto it = data.events.begin();
+    for (const Fei4Event &event : events) {
+        REQUIRE (event.tag == it->tag);
+        REQUIRE (event.l1id == it->l1id);
+        REQUIRE (event.bcid == it->bcid);
+        REQUIRE (event.nHits == it->nHits);
+        auto hit = it->hits.begin();
+        for (const Fei4Hit &h : event.hits) {
+            REQUIRE (h.col == hit->col);
+            REQUIRE (h.row == hit->row);
+            REQUIRE (h.tot == hit->tot);
+            ++hit;
+        }
+        ++it;
+    }
+}
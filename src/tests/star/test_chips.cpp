@@ -9,6 +9,8 @@
 
 #include "../EmptyHw.h"
 
+namespace {
+
 /**
    Override TxCore to record what is written to FIFO.
  */
@@ -40,20 +42,24 @@ public:
     return (buffer[offset] >> (16*side)) & 0xffff;
   }
 
-  void getRegValueForBuffer(int buff_id,
-                            uint8_t &reg, uint32_t &value,
-                            uint32_t &other) const {
-    // reg = 0;
-    value = 0;
+  struct RegCommand {
+    uint8_t reg;
+    uint32_t value;
+    uint32_t other;
+  };
+
+  /// Register commands of one burst, in the order they were sent
+  std::vector<RegCommand> getRegValuesForBuffer(int buff_id) const {
+    std::vector<RegCommand> commands;
+    uint8_t reg = 0xff;
+    uint32_t value = 0;
+    uint32_t other = 0xffffffff;
     int progress = 0;
     for(int i=0; i<buffers[buff_id].size()*2; i++) {
       LCB::Frame f = getFrame(buff_id, i);
       CAPTURE (buff_id, i, f, progress);
       if(f == LCB::IDLE) continue;
 
-      // Nothing beyond end
-      REQUIRE (progress < 9);
-
       uint8_t code0 = (f >> 8) & 0xff;
       uint8_t code1 = f & 0xff;
 
@@ -73,7 +79,11 @@ public:
           // End (ignore flags)
           other &= 0x00ffffff;
           other |= SixEight::decode(code1) << 24;
-          progress ++;
+          commands.push_back({reg, value, other});
+          reg = 0xff;
+          value = 0;
+          other = 0xffffffff;
+          progress = 0;
           continue;
         }
       }
@@ -109,6 +119,10 @@ public:
 
       progress ++;
     }
+
+    // Nothing left half sent
+    REQUIRE (progress == 0);
+    return commands;
   }
 };
 
@@ -121,6 +135,8 @@ public:
   void loadConfig(json &j) override {}
 };
 
+}
+
 TEST_CASE("StarBasicConfig", "[star][chips]") {
   MyHwController hw;
 
@@ -157,13 +173,17 @@ TEST_CASE("StarBasicConfig", "[star][chips]") {
 #endif
 
   // This just checks that the above code can parse the commands sent
+  size_t reg_count = 0;
   for(int i=0; i<buf_count; i++) {
-    uint8_t reg = 0xff;
-    uint32_t value;
-    uint32_t flags = 0xffffffff;
-    tx.getRegValueForBuffer(i, reg, value, flags);
-    l->debug(" reg from {:3}: {:3} {:08x} {:08x}", i, reg, value, flags);
+    for(auto &c: tx.getRegValuesForBuffer(i)) {
+      l->debug(" reg from {:3}: {:3} {:08x} {:08x}", i, c.reg, c.value, c.other);
+      reg_count++;
+    }
   }
+
+  // All registers of each stage are sent in one burst
+  REQUIRE (reg_count >= HCCStarRegister::_size());
+  REQUIRE (buf_count < 10);
 }
 
 TEST_CASE("StarChipsNamedConfig", "[star][chips]") {
@@ -230,12 +250,10 @@ TEST_CASE("StarChipsNamedConfig", "[star][chips]") {
 
   // This just checks that the above code can parse the commands sent
   for(int i=0; i<buf_count; i++) {
-    uint8_t reg = 0xff;
-    uint32_t value;
-    uint32_t flags = 0xffffffff;
-    tx.getRegValueForBuffer(i, reg, value, flags);
-    l->debug(" reg from {:3}: {:3} {:08x} {:08x}", i, reg, value, flags);
-    found_regs.insert(std::make_pair(reg, value));
+    for(auto &c: tx.getRegValuesForBuffer(i)) {
+      l->debug(" reg from {:3}: {:3} {:08x} {:08x}", i, c.reg, c.value, c.other);
+      found_regs.insert(std::make_pair(c.reg, c.value));
+    }
   }
 
   for(auto &r: expected_regs) {
@@ -260,3 +278,43 @@ TEST_CASE("StarChips", "[star][chips]") {
   StarChips test_config;
   //  test_config.setHCCChipId(4);
 }
+
+TEST_CASE("StarCmdStream", "[star][chips]") {
+  StarCmd cmd;
+  auto write = cmd.write_abc_register(32, 0x12345678, 3, 5);
+  auto fast = LCB::fast_command(LCB::ABC_REG_RESET, 0);
+
+  // Words the single command path used to write: two idle words, the
+  // register command padded with idle, two idle words
+  const uint32_t idle = (LCB::IDLE << 16) | LCB::IDLE;
+  std::vector<uint32_t> expected;
+  for(int i=0; i<2; i++) {
+    expected.insert(expected.end(), {
+      idle, idle,
+      (uint32_t(write[0]) << 16) | write[1],
+      (uint32_t(write[2]) << 16) | write[3],
+      (uint32_t(write[4]) << 16) | write[5],
+      (uint32_t(write[6]) << 16) | write[7],
+      (uint32_t(write[8]) << 16) | LCB::IDLE,
+      idle, idle});
+  }
+  // Fast command between one idle word on either side
+  expected.insert(expected.end(), {idle, (uint32_t(fast) << 16) | LCB::IDLE, idle});
+
+  StarCmdStream stream;
+  stream.add(write);
+  stream.add(write);
+  stream.add(fast);
+  REQUIRE (stream.size() == 9 + 9 + 3);
+  REQUIRE (std::vector<uint32_t>(stream.data(), stream.data() + stream.size()) == expected);
+
+  MyTxCore tx;
+  tx.writeFifoBlock(stream.data(), stream.size());
+  REQUIRE (tx.buffers.size() == 1);
+  REQUIRE (tx.buffers[0] == expected);
+
+  auto regs = tx.getRegValuesForBuffer(0);
+  REQUIRE (regs.size() == 2);
+  REQUIRE (regs[1].reg == 32);
+  REQUIRE (regs[1].value == 0x12345678);
+}
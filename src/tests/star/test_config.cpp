@@ -131,3 +131,34 @@ TEST_CASE("StarCfgTrims", "[star][config]") {
   // void setTrimDAC(unsigned col, unsigned row, int value);
   // int getTrimDAC(unsigned col, unsigned row);
 }
+
+TEST_CASE("StarCfgSubRegisterTables", "[star][config]") {
+  StarCfg test_config;
+  test_config.addABCchipID(5);
+  test_config.addABCchipID(2);
+  test_config.addABCchipID(9);
+
+  REQUIRE (test_config.hccChannelForABCchipID(2) == 1);
+  REQUIRE (test_config.hccChannelForABCchipID(9) == 2);
+  REQUIRE (test_config.hccChannelForABCchipID(7) == 3);
+
+  // Each sub register only changes its own bits
+  for(ABCStarSubRegister r: ABCStarSubRegister::_values()) {
+    CAPTURE (r._to_string());
+    auto &info = AbcStarRegInfo::subRegister(r);
+    REQUIRE (info.getRegAddress() == test_config.getSubRegisterParentAddr(2, r._to_string()));
+
+    test_config.setABCRegister(info.getRegAddress(), 0, 2);
+    test_config.setSubRegisterValue(2, r._to_string(), info.mask());
+    CHECK (test_config.getABCRegister(info.getRegAddress(), 2) == info.mask() << info.m_bOffset);
+    CHECK (test_config.getABCRegister(info.getRegAddress(), 5) != info.mask() << info.m_bOffset);
+  }
+
+  for(HCCStarSubRegister r: HCCStarSubRegister::_values()) {
+    CAPTURE (r._to_string());
+    auto &info = HccStarRegInfo::subRegister(r);
+    test_config.setHCCRegister(info.getRegAddress(), 0);
+    test_config.setSubRegisterValue(0, r._to_string(), info.mask());
+    CHECK (test_config.getHCCRegister(info.getRegAddress()) == info.mask() << info.m_bOffset);
+  }
+}
@@ -1,5 +1,9 @@
 #include "catch.hpp"
 
+#include <chrono>
+#include <map>
+#include <thread>
+
 #include "LCBUtils.h"
 #include "StarCmd.h"
 #include "StarChipPacket.h"
@@ -356,6 +360,51 @@ TEST_CASE("StarEmulatorHPR", "[star][emulator]") {
   checkData(emu.get(), expected, mask_pattern);
 }
 
+TEST_CASE("StarEmulatorHCCs", "[star][emulator]") {
+  std::shared_ptr<HwController> emu = StdDict::getHwController("emu_Star");
+
+  REQUIRE (emu);
+
+  json cfg = json::parse(R"({"hccs": [{"rx": 0, "hccId": 1, "abcIds": [2, 3]},
+                                      {"rx": 4, "hccId": 2, "abcIds": [5]}]})");
+  emu->loadConfig(cfg);
+
+  emu->setCmdEnable(0);
+  emu->setRxEnable(std::vector<uint32_t>{0, 4});
+
+  StarCmd star;
+
+  // Only the second HCC answers
+  std::array<LCB::Frame, 9> readHCCCmd = star.read_hcc_register(17, 2);
+  sendCommand(*emu, readHCCCmd);
+  // All ABCs of both HCCs answer
+  std::array<LCB::Frame, 9> readABCCmd = star.read_abc_register(34);
+  sendCommand(*emu, readABCCmd);
+
+  emu->releaseFifo();
+
+  while(!emu->isCmdEmpty())
+    ;
+
+  // Packet type and ABC ID by rx channel
+  std::map<uint32_t, std::vector<std::pair<int, int>>> packets;
+  for(int reads=0; reads<1000 && packets[0].size() + packets[4].size() < 4; reads++) {
+    std::unique_ptr<RawData> data(emu->readData());
+    if(!data) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+    REQUIRE (data->words >= 2);
+    int type = (data->buf[0] >> 4) & 0xf;
+    int abc = (data->buf[1] >> 16) & 0xf;
+    packets[data->adr].push_back({type, type == 4 ? abc : -1});
+    delete [] data->buf;
+  }
+
+  REQUIRE (packets[0] == std::vector<std::pair<int, int>>{{4, 2}, {4, 3}});
+  REQUIRE (packets[4] == std::vector<std::pair<int, int>>{{8, -1}, {4, 5}});
+}
+
 template<typename PacketT>
 void checkData(HwController* emu, std::deque<PacketT>& expected, const PacketT& mask_pattern)
 {
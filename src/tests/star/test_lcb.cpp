@@ -80,3 +80,13 @@ TEST_CASE("Other data", "[star][lcb]") {
     REQUIRE ( !LCB::is_fast_command(f) );
   }
 }
+
+TEST_CASE("Command table", "[star][lcb]") {
+  for(uint16_t d=0; d<128; d++) {
+    CAPTURE (d);
+    auto f = LCB::command_bits(d);
+    REQUIRE (f == LCB::raw_bits(d));
+    REQUIRE (LCB::is_valid(f));
+    REQUIRE (LCB::get_command_bits(f) == d);
+  }
+}
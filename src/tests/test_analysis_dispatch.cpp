@@ -0,0 +1,69 @@
+#include "catch.hpp"
+
+#include <atomic>
+
+#include "AnalysisAlgorithm.h"
+#include "Histo1d.h"
+
+namespace {
+  struct TypeA {};
+  struct TypeB {};
+
+  class CountingAnalysis : public AnalysisAlgorithm {
+    public:
+      CountingAnalysis(std::type_index t, bool c, std::atomic<unsigned> &n)
+        : type(t), isConc(c), count(n) {}
+
+      void init(ScanBase *s) override {
+        consume(type);
+        concurrent = isConc;
+      }
+      void processHistogram(HistogramBase *h) override {
+        // No REQUIRE here, this may run in a worker thread
+        count += (h->getType() == type) ? 1 : 1000;
+      }
+    private:
+      std::type_index type;
+      bool isConc;
+      std::atomic<unsigned> &count;
+  };
+
+  class CatchAllAnalysis : public AnalysisAlgorithm {
+    public:
+      CatchAllAnalysis(std::atomic<unsigned> &n) : count(n) {}
+      void processHistogram(HistogramBase *h) override { count++; }
+    private:
+      std::atomic<unsigned> &count;
+  };
+}
+
+TEST_CASE("AnalysisDispatch", "[AnalysisProcessor]") {
+  bool concurrent = GENERATE(false, true);
+
+  std::atomic<unsigned> countA(0), countB(0), countAll(0);
+  ClipBoard<HistogramBase> input, output;
+
+  AnalysisProcessor proc(nullptr, 0);
+  proc.addAlgorithm(std::unique_ptr<AnalysisAlgorithm>(new CountingAnalysis(typeid(TypeA*), concurrent, countA)));
+  proc.addAlgorithm(std::unique_ptr<AnalysisAlgorithm>(new CountingAnalysis(typeid(TypeB*), concurrent, countB)));
+  proc.addAlgorithm(std::unique_ptr<AnalysisAlgorithm>(new CatchAllAnalysis(countAll)));
+  proc.connect(nullptr, &input, &output);
+  proc.init();
+  // Workers of the first init are stopped
+  proc.init();
+
+  for (unsigned i=0; i<10; i++) {
+    input.pushData(std::unique_ptr<HistogramBase>(new Histo1d("A", 1, 0, 1, typeid(TypeA*))));
+  }
+  for (unsigned i=0; i<3; i++) {
+    input.pushData(std::unique_ptr<HistogramBase>(new Histo1d("B", 1, 0, 1, typeid(TypeB*))));
+  }
+  input.pushData(std::unique_ptr<HistogramBase>(new Histo1d("C", 1, 0, 1, typeid(void))));
+
+  proc.process_core();
+  proc.end();
+
+  REQUIRE (countA == 10);
+  REQUIRE (countB == 3);
+  REQUIRE (countAll == 14);
+}
@@ -0,0 +1,98 @@
+#include "catch.hpp"
+
+#include <memory>
+
+#include "ChipStateCache.h"
+#include "EmptyHw.h"
+#include "Rd53a.h"
+#include "TempDir.h"
+
+namespace {
+  class CountingHw : public EmptyHw {
+   public:
+    void writeFifo(uint32_t) override {words++;}
+    unsigned words = 0;
+  };
+
+  void setPixels(Rd53a &fe, unsigned seed) {
+    for(unsigned col=0; col<Rd53aPixelCfg::n_Col; col+=7) {
+      for(unsigned row=0; row<Rd53aPixelCfg::n_Row; row+=5) {
+        fe.setEn(col, row, (col+row+seed)%2);
+        fe.setTDAC(col, row, (col+seed)%16);
+      }
+    }
+  }
+
+  unsigned configure(CountingHw &hw, Rd53a &fe) {
+    hw.words = 0;
+    fe.configure();
+    return hw.words;
+  }
+}
+
+TEST_CASE("Rd53aChipState", "[Rd53a][ChipState]") {
+  TempDir tmp("test_chip_state");
+  ChipStateCache::setDirectory(tmp.path());
+
+  CountingHw hw;
+  unsigned full;
+  {
+    Rd53a fe(&hw, 0);
+    fe.setName("StateChip");
+    setPixels(fe, 0);
+    full = configure(hw, fe);
+  }
+
+  std::unique_ptr<Rd53a> fe(new Rd53a(&hw, 0));
+  fe->setName("StateChip");
+  setPixels(*fe, 0);
+
+  SECTION("Unchanged") {
+    REQUIRE (configure(hw, *fe) < full/50);
+  }
+
+  SECTION("Changed") {
+    fe->setTDAC(10, 10, 3);
+    fe->setEn(100, 50, 1-fe->getEn(100, 50));
+    // Most of one double column, it is written in full
+    for(unsigned row=0; row<150; row++)
+      fe->setTDAC(300, row, 7);
+    REQUIRE (configure(hw, *fe) < full/50);
+
+    // The next run starts from what this one wrote
+    fe.reset();
+    Rd53a next(&hw, 0);
+    next.setName("StateChip");
+    setPixels(next, 0);
+    REQUIRE (configure(hw, next) < full/50);
+  }
+
+  SECTION("Forced") {
+    ChipStateCache::setForceFull(true);
+    REQUIRE (configure(hw, *fe) == full);
+    ChipStateCache::setForceFull(false);
+  }
+
+  SECTION("Other chip") {
+    Rd53a other(&hw, 1);
+    other.setName("StateChip");
+    setPixels(other, 0);
+    REQUIRE (configure(hw, other) == full);
+  }
+
+  SECTION("Other controller") {
+    fe.reset();
+    EmptyHw other_hw;
+    Rd53a other(&other_hw, 0);
+    other.setName("StateChip");
+    other.configure();
+    // The state kept for the first controller is untouched
+    fe.reset(new Rd53a(&hw, 0));
+    fe->setName("StateChip");
+    setPixels(*fe, 0);
+    REQUIRE (configure(hw, *fe) < full/50);
+  }
+
+  fe.reset();
+  ChipStateCache::setDirectory("");
+}
@@ -0,0 +1,58 @@
+#include "catch.hpp"
+
+#include "ClusterFinder.h"
+#include "Fei4EventData.h"
+
+TEST_CASE("ClusterFinder", "[Fei4][Clustering]") {
+  // Diagonal pair, isolated hit, L-shape with one pixel gap
+  std::vector<Fei4Hit> hits = {
+    {10, 10, 2}, {11, 11, 6},
+    {50, 100, 1},
+    {30, 5, 1}, {30, 7, 1}, {31, 7, 2},
+  };
+
+  SECTION("Default adjacency") {
+    ClusterFinder finder;
+    finder.find(hits);
+    auto &clusters = finder.getClusters();
+    REQUIRE (clusters.size() == 4);
+    REQUIRE (finder.getLabels() == std::vector<unsigned>({0, 0, 1, 2, 3, 3}));
+
+    REQUIRE (clusters[0].nHits == 2);
+    REQUIRE (clusters[0].sumTot == 8);
+    REQUIRE (clusters[0].col == Approx(10.75));
+    REQUIRE (clusters[0].row == Approx(10.75));
+    REQUIRE (clusters[3].getColLength() == 2);
+    REQUIRE (clusters[3].getRowWidth() == 1);
+  }
+
+  SECTION("No diagonal") {
+    ClusterFinder finder(1, 1, false);
+    finder.find(hits);
+    REQUIRE (finder.getClusters().size() == 5);
+  }
+
+  SECTION("Gap of one pixel, reused between calls") {
+    ClusterFinder finder(2, 2);
+    finder.find(hits);
+    REQUIRE (finder.getClusters().size() == 3);
+    REQUIRE (finder.getClusters()[2].getRowWidth() == 3);
+
+    std::vector<Fei4Hit> other = {{400, 192, 0}, {399, 191, 0}};
+    finder.find(other);
+    REQUIRE (finder.getClusters().size() == 1);
+    REQUIRE (finder.getClusters()[0].col == Approx(399.5));
+  }
+
+  SECTION("Fei4Event") {
+    Fei4Event event;
+    for (auto &hit : hits) {
+      event.addHit(hit.row, hit.col, hit.tot);
+    }
+    event.doClustering();
+    REQUIRE (event.clusters.size() == 3);
+    REQUIRE (event.clusters[2].nHits == 3);
+    REQUIRE (event.clusters[2].getColLength() == 2);
+    REQUIRE (event.clusters[2].getRowWidth() == 3);
+  }
+}
@@ -0,0 +1,74 @@
+#include "catch.hpp"
+
+#include <memory>
+#include <vector>
+
+#include "EmuRxCore.h"
+#include "EmuTxCore.h"
+#include "Fei4.h"
+#include "Rd53a.h"
+#include "RingBuffer.h"
+
+TEST_CASE("EmuChannelsTx", "[Emu]") {
+  RingBuffer a(16), b(16);
+  EmuTxCore<Rd53a> tx;
+  tx.setCom(0, &a);
+  tx.setCom(3, &b);
+
+  // Only channel 0 by default
+  tx.writeFifo(1);
+  REQUIRE (a.getCurSize() == 4);
+  REQUIRE (b.isEmpty());
+
+  tx.setCmdEnable({0, 3});
+  REQUIRE (tx.getCmdEnable() == 0x9);
+  tx.writeFifo(2);
+  REQUIRE (a.getCurSize() == 8);
+  REQUIRE (b.read32() == 2);
+  REQUIRE (!tx.isCmdEmpty());
+
+  tx.maskCmdEnable(0x0, 0x1);
+  REQUIRE (tx.getCmdEnable() == 0x8);
+  tx.writeFifo(3);
+  REQUIRE (a.getCurSize() == 8);
+  REQUIRE (b.read32() == 3);
+}
+
+TEST_CASE("EmuChannelsRx", "[Emu]") {
+  RingBuffer a(16), b(16), c(16);
+
+  SECTION("Rd53a") {
+    EmuRxCore<Rd53a> rx;
+    rx.setCom(2, &a);
+    rx.setCom(0, &b);
+    rx.setCom(1, &c);
+    rx.setRxEnable({2, 0});
+
+    for (uint32_t w : {0xa0, 0xa1, 0xa2}) a.write32(w);
+    b.write32(0xb0);
+    c.write32(0xc0);
+
+    // One frame per channel in turn, channel 0 first; disabled channel dropped
+    std::unique_ptr<RawData> data(rx.readData());
+    REQUIRE (data);
+    std::vector<uint32_t> words(data->buf, data->buf + data->words);
+    REQUIRE (words == std::vector<uint32_t>{0xb0, 0xFFFFFFFF, 0xa0, 0xa1,
+                                            0xFFFFFFFF, 0xFFFFFFFF, 0xa2, 0xFFFFFFFF});
+    REQUIRE (rx.isBridgeEmpty());
+    REQUIRE (rx.readData() == nullptr);
+  }
+
+  SECTION("Fei4") {
+    EmuRxCore<Fei4> rx;
+    rx.setCom(0, &a);
+    rx.setCom(5, &b);
+    rx.setRxEnable({0, 5});
+
+    a.write32(0xe90001);
+    b.write32(0xe90002);
+    std::unique_ptr<RawData> data(rx.readData());
+    REQUIRE (data->words == 2);
+    REQUIRE (data->buf[0] == 0xe90001);
+    REQUIRE (data->buf[1] == ((5u << 26) | 0xe90002));
+  }
+}
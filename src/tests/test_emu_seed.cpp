@@ -0,0 +1,128 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "EmptyHw.h"
+#include "EmuTxCore.h"
+#include "Gauss.h"
+#include "Rd53a.h"
+#include "Rd53aEmu.h"
+#include "RingBuffer.h"
+#include "TaskScheduler.h"
+#include "TempDir.h"
+
+namespace {
+  // Commands of the chip go to the emulator, its data is read from the ring directly
+  class EmuTxHw : public HwController, public EmuTxCore<Rd53a>, public EmptyRxCore {
+   public:
+    void loadConfig(json &j) override {}
+  };
+
+  // Thresholds without spread, noise large enough to decide about every hit
+  void writeFeCfg(const std::string &name) {
+    std::ofstream f(name);
+    const unsigned n = Rd53aPixelCfg::n_Col*Rd53aPixelCfg::n_Row;
+    f << "{\"Vthreshold_gauss_vector\": [";
+    for (unsigned i=0; i<n; i++) f << (i ? ",100" : "100");
+    f << "], \"noise_sigma_gauss_vector\": [";
+    for (unsigned i=0; i<n; i++) f << (i ? ",5000" : "5000");
+    f << "]}";
+  }
+
+  // Output words of nTriggers analog injections into the first core row
+  std::vector<uint32_t> runEmulator(const std::string &feCfg, uint64_t seed,
+                                    unsigned nWorkers, unsigned nTriggers) {
+    Gauss::setSeed(seed);
+    TaskScheduler scheduler(nWorkers);
+    RingBuffer tx(1 << 14), rx(1 << 20);
+    Rd53aEmu emu(&rx, &tx, feCfg, 0, scheduler);
+    std::thread loop(&Rd53aEmu::executeLoop, &emu);
+
+    EmuTxHw hw;
+    hw.setCom(&tx);
+    Rd53a fe(&hw);
+    for (unsigned col=0; col<Rd53aPixelCfg::n_Col; col++) {
+      for (unsigned row=0; row<8; row++) {
+        fe.setEn(col, row, 1);
+        fe.setInjEn(col, row, 1);
+      }
+    }
+    for (auto reg : {&Rd53a::CalColprSync1, &Rd53a::CalColprSync2, &Rd53a::CalColprSync3,
+                     &Rd53a::CalColprSync4, &Rd53a::CalColprLin1, &Rd53a::CalColprLin2,
+                     &Rd53a::CalColprLin3, &Rd53a::CalColprLin4, &Rd53a::CalColprLin5,
+                     &Rd53a::CalColprDiff1, &Rd53a::CalColprDiff2, &Rd53a::CalColprDiff3,
+                     &Rd53a::CalColprDiff4, &Rd53a::CalColprDiff5}) {
+      (fe.*reg).write(0xFFFF);
+    }
+    fe.InjEnDig.write(0);
+    fe.LatencyConfig.write(0);
+    fe.configure();
+
+    // The emulator has no auto row, the injected pixels are written one by one like in the mask loop
+    std::vector<std::pair<unsigned, unsigned>> pixels;
+    for (unsigned col=0; col<Rd53aPixelCfg::n_Col; col+=2) {
+      for (unsigned row=0; row<8; row++) pixels.emplace_back(col, row);
+    }
+    fe.configurePixels(pixels);
+
+    // The first BC of each trigger sees the injection
+    for (unsigned i=0; i<nTriggers; i++) {
+      fe.cal(0, 1, 0, 50, 0, 0);
+      fe.trigger(0x8, i%32, 0, 0);
+    }
+
+    // Each event is written in one block starting with its header
+    std::vector<uint32_t> out;
+    unsigned headers = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (headers < nTriggers && std::chrono::steady_clock::now() - start < std::chrono::seconds(60)) {
+      uint32_t n = rx.getCurSize()/sizeof(uint32_t);
+      if (n == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+      size_t first = out.size();
+      out.resize(first + n);
+      rx.readBlock32(&out[first], n);
+      for (size_t i=first; i<out.size(); i++) {
+        if ((out[i] >> 25) == 0x7f) headers++;
+      }
+    }
+
+    emu.run = false;
+    loop.join();
+    REQUIRE (headers == nTriggers);
+    return out;
+  }
+}
+
+TEST_CASE("Rd53aEmuSeeded", "[Emu][Gauss]") {
+  TempDir tmp("test_emu_seed");
+  const std::string feCfg = tmp.file("emu_fe.json");
+  writeFeCfg(feCfg);
+
+  // The emulator plots its hits into the working directory when stopped
+  auto cwd = std::filesystem::current_path();
+  std::filesystem::current_path(tmp.path());
+
+  const unsigned nTriggers = 10;
+  std::vector<uint32_t> first = runEmulator(feCfg, 1234, 3, nTriggers);
+  std::vector<uint32_t> again = runEmulator(feCfg, 1234, 3, nTriggers);
+  std::vector<uint32_t> single = runEmulator(feCfg, 1234, 0, nTriggers);
+  std::vector<uint32_t> other = runEmulator(feCfg, 4321, 3, nTriggers);
+
+  std::filesystem::current_path(cwd);
+
+  // Only part of the pixels fire, which ones is up to the noise
+  REQUIRE (first.size() > nTriggers);
+  REQUIRE (first.size() < nTriggers*(1 + Rd53aPixelCfg::n_Col*8/4));
+  REQUIRE (again == first);
+  REQUIRE (other != first);
+
+  // Independent of how the core columns are split between the threads
+  REQUIRE (single == first);
+}
@@ -0,0 +1,98 @@
+#include "catch.hpp"
+
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "Gauss.h"
+
+namespace {
+  void moments(const std::vector<double> &v, double &mean, double &sigma) {
+    double sum = 0, sum2 = 0;
+    for (double x : v) {
+      sum += x;
+      sum2 += x*x;
+    }
+    mean = sum/v.size();
+    sigma = sqrt(sum2/v.size() - mean*mean);
+  }
+}
+
+TEST_CASE("GaussNormal", "[Gauss]") {
+  Gauss::Generator gen(1234);
+  std::vector<double> v(200000);
+  gen.fillNormal(v.data(), v.size(), 5.0, 2.0);
+
+  double mean, sigma;
+  moments(v, mean, sigma);
+  REQUIRE (mean == Approx(5.0).margin(0.02));
+  REQUIRE (sigma == Approx(2.0).margin(0.02));
+
+  // About 0.27% outside of 3 sigma, the ziggurat tail is exercised
+  unsigned outside = 0;
+  for (double x : v) {
+    if (fabs(x - 5.0) > 6.0) outside++;
+  }
+  REQUIRE (outside > 400);
+  REQUIRE (outside < 700);
+}
+
+TEST_CASE("GaussTruncated", "[Gauss]") {
+  Gauss::Generator gen(99);
+  std::vector<double> v(100000);
+  unsigned below = 0;
+  for (double &x : v) {
+    x = gen.truncatedNormal(0.0, 1.0, 1.0);
+    if (x < 1.0) below++;
+  }
+  REQUIRE (below == 0);
+  // Mean of the standard normal above 1 is phi(1)/(1-Phi(1))
+  double mean, sigma;
+  moments(v, mean, sigma);
+  REQUIRE (mean == Approx(1.5251).margin(0.01));
+
+  // Mostly negative distribution still gives only positive values
+  below = 0;
+  for (unsigned i=0; i<1000; i++) {
+    if (Gauss::rand_normal(-1.0, 0.5, false) < 0.0) below++;
+  }
+  REQUIRE (below == 0);
+}
+
+TEST_CASE("GaussPoisson", "[Gauss]") {
+  Gauss::Generator gen(77);
+  // Both the small and the large mean method
+  for (double mu : {2.5, 40.0}) {
+    std::vector<double> v(100000);
+    for (double &x : v) x = gen.poisson(mu);
+    double mean, sigma;
+    moments(v, mean, sigma);
+    REQUIRE (mean == Approx(mu).epsilon(0.01));
+    REQUIRE (sigma*sigma == Approx(mu).epsilon(0.03));
+  }
+  REQUIRE (gen.poisson(0.0) == 0);
+}
+
+TEST_CASE("GaussSeeding", "[Gauss]") {
+  Gauss::Generator a(7), b(7);
+  for (unsigned i=0; i<100; i++) {
+    REQUIRE (a.next() == b.next());
+  }
+
+  auto draw = [] {
+    std::vector<double> v(10);
+    for (double &x : v) x = Gauss::rand_normal(0, 1, true);
+    return v;
+  };
+
+  Gauss::setSeed(42);
+  std::vector<double> first = draw();
+  Gauss::setSeed(42);
+  REQUIRE (draw() == first);
+
+  // A second thread gets its own stream
+  std::vector<double> other;
+  std::thread t([&] { other = draw(); });
+  t.join();
+  REQUIRE (other != first);
+}
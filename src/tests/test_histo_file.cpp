@@ -0,0 +1,78 @@
+#include "catch.hpp"
+
+#include <sstream>
+#include <string>
+
+#include "Histo1d.h"
+#include "Histo2d.h"
+#include "TempDir.h"
+
+TEST_CASE("Histo2dFile", "[Histo][File]") {
+  Histo2d h("Map", 8, 0.5, 8.5, 6, 0.5, 6.5, typeid(void));
+  h.setAxisTitle("Column", "Row", "Hits");
+  for(unsigned x=1; x<=8; x++)
+    for(unsigned y=1; y<=6; y++)
+      h.fill(x, y, x*10+y);
+  h.fill(20, 1);
+
+  Histo2d r("Temp", 1, 0.0, 1.0, 1, 0.0, 1.0, typeid(void));
+  SECTION("Json") {
+    TempDir tmp("test_histo_file");
+    h.toFile("test_histo_file", tmp.path() + "/");
+    REQUIRE (r.fromFile(tmp.file("test_histo_file_Map.json")));
+
+    // Only a Histo2d is read
+    Histo1d h1("Dist", 4, 0, 4, typeid(void));
+    h1.toFile("test_histo_file", tmp.path() + "/");
+    REQUIRE (!r.fromFile(tmp.file("test_histo_file_Dist.json")));
+  }
+
+  SECTION("Binary") {
+    std::stringstream s;
+    h.toFileBinary(s);
+    REQUIRE (r.fromFileBinary(s));
+  }
+
+  REQUIRE (r.getName() == "Map");
+  REQUIRE (r.getYaxisTitle() == "Row");
+  REQUIRE (r.getXbins() == 8);
+  REQUIRE (r.getYbins() == 6);
+  REQUIRE (r.getYlow() == 0.5);
+  REQUIRE (r.getYhigh() == 6.5);
+  REQUIRE (r.getOverflow() == 1);
+  for(unsigned i=0; i<h.size(); i++)
+    REQUIRE (r.getBin(i) == h.getBin(i));
+}
+
+TEST_CASE("Histo1dFile", "[Histo][File]") {
+  Histo1d h("Dist", 16, -0.5, 15.5, typeid(void));
+  h.setXaxisTitle("ToT");
+  for(unsigned i=0; i<16; i++)
+    h.fill(i, i*i);
+  h.fill(-3);
+
+  Histo1d r("Temp", 1, 0.0, 1.0, typeid(void));
+  SECTION("Json") {
+    TempDir tmp("test_histo_file");
+    h.toFile("test_histo_file", tmp.path() + "/");
+    REQUIRE (r.fromFile(tmp.file("test_histo_file_Dist.json")));
+  }
+
+  SECTION("Binary") {
+    std::stringstream s;
+    h.toFileBinary(s);
+    REQUIRE (r.fromFileBinary(s));
+
+    // Truncated
+    std::string bytes = s.str();
+    std::stringstream t(bytes.substr(0, bytes.size()-1));
+    REQUIRE (!r.fromFileBinary(t));
+  }
+
+  REQUIRE (r.getName() == "Dist");
+  REQUIRE (r.getXaxisTitle() == "ToT");
+  REQUIRE (r.size() == 16);
+  REQUIRE (r.getUnderflow() == 1);
+  for(unsigned i=0; i<16; i++)
+    REQUIRE (r.getBin(i) == i*i);
+}
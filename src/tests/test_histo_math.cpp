@@ -0,0 +1,100 @@
+#include "catch.hpp"
+
+#include <cmath>
+#include <vector>
+
+#include "HistoMath.h"
+#include "Histo1d.h"
+#include "Histo2d.h"
+
+TEST_CASE("HistoMathKernels", "[HistoMath]") {
+  const unsigned n = 1027;
+  std::vector<double> a(n), b(n), c(n);
+  for(unsigned i=0; i<n; i++) {
+    a[i] = i;
+    b[i] = 2.0*i;
+    c[i] = (i%3 == 0) ? 0 : 4.0;
+  }
+
+  SECTION("Divide by zero gives zero") {
+    HistoMath::divide(b.data(), c.data(), n);
+    for(unsigned i=0; i<n; i++) {
+      REQUIRE (b[i] == ((i%3 == 0) ? 0 : i/2.0));
+    }
+  }
+
+  SECTION("Same array on both sides") {
+    HistoMath::add(a.data(), a.data(), n);
+    HistoMath::divide(c.data(), c.data(), n);
+    for(unsigned i=0; i<n; i++) {
+      REQUIRE (a[i] == 2.0*i);
+      REQUIRE (c[i] == ((i%3 == 0) ? 0 : 1));
+    }
+  }
+
+  SECTION("Add scaled") {
+    HistoMath::addScaled(a.data(), b.data(), 0.5, n);
+    for(unsigned i=0; i<n; i++) {
+      REQUIRE (a[i] == 2.0*i);
+    }
+  }
+}
+
+TEST_CASE("HistoMathStats", "[HistoMath]") {
+  const unsigned n = 1000;
+  std::vector<double> data(n);
+  std::vector<uint8_t> mask(n);
+  double sum = 0, cnt = 0;
+  for(unsigned i=0; i<n; i++) {
+    data[i] = 1e6 + (i%17)*0.25;
+    mask[i] = (i%5 != 0);
+    if (mask[i]) {
+      sum += data[i];
+      cnt++;
+    }
+  }
+  double mean = sum/cnt;
+  double mu = 0;
+  for(unsigned i=0; i<n; i++) {
+    if (mask[i]) mu += pow(data[i]-mean, 2);
+  }
+
+  HistoMath::Stats s = HistoMath::stats(data.data(), mask.data(), n);
+  REQUIRE (s.n == cnt);
+  REQUIRE (s.mean == Approx(mean));
+  REQUIRE (s.stdDev() == Approx(sqrt(mu/(cnt-1))));
+  REQUIRE (s.min == 1e6);
+  REQUIRE (s.max == 1e6 + 16*0.25);
+
+  HistoMath::Stats empty = HistoMath::stats(data.data(), mask.data(), 1);
+  REQUIRE (empty.n == 0);
+  REQUIRE (empty.stdDev() == 0);
+}
+
+TEST_CASE("HistoArithmetic", "[HistoMath]") {
+  Histo2d a("A", 4, 0.5, 4.5, 3, 0.5, 3.5, typeid(void));
+  Histo2d b("B", 4, 0.5, 4.5, 3, 0.5, 3.5, typeid(void));
+  for(unsigned i=0; i<a.size(); i++) {
+    a.setBin(i, i+1);
+    b.setBin(i, 1);
+  }
+  a.subtract(b);
+  REQUIRE (a.getBin(0) == 0);
+  REQUIRE (a.getBin(11) == 11);
+  REQUIRE (a.getMean() == Approx(5.5));
+  REQUIRE (a.getStdDev() == Approx(sqrt(13.0)));
+
+  b.fill(1, 1);
+  a.add(b);
+  a.subtract(b);
+  REQUIRE (a.numOfEntries() == 0);
+  REQUIRE (a.getBin(11) == 11);
+  a.add(a);
+  REQUIRE (a.getBin(11) == 22);
+
+  Histo1d h("H", 10, -0.5, 9.5, typeid(void));
+  h.fill(2, 1);
+  h.fill(4, 3);
+  REQUIRE (h.getMean() == Approx(3.5));
+  REQUIRE (h.getStdDev() == Approx(sqrt(0.75)));
+}
@@ -0,0 +1,49 @@
+#include "catch.hpp"
+
+#include <vector>
+
+#include "Gauss.h"
+#include "PixelArray.h"
+
+TEST_CASE("PixelArrayResponse", "[Emu][PixelArray]") {
+  // Threshold charge 100 + 10*(2*vth - 5*(tdac-8)), ToT of 1 per 1000 above threshold
+  const PixelArray::Response resp { 100, 10, 8, -5, 0, 1e-3, 14, 0xf };
+
+  PixelArray pixels(4, 3);
+  pixels.setPixel(1, 2, 2.0, 0.0);
+  pixels.setPixel(3, 0, 2.0, 50.0);
+  REQUIRE (pixels.col(pixels.index(3, 2)) == 3);
+  REQUIRE (pixels.row(pixels.index(3, 2)) == 2);
+
+  REQUIRE (pixels.threshold(resp, 1, 2, 100, 8) == Approx(2100));
+  REQUIRE (pixels.threshold(resp, 1, 2, 100, 10) == Approx(2000));
+  // Smeared threshold DAC does not go below 0
+  REQUIRE (pixels.threshold(resp, 1, 2, 10, 20) == Approx(100));
+
+  // Without noise: below threshold, in range and saturated
+  PixelArray::Selection sel;
+  pixels.select(sel, resp, 1, 2, 100, 8, 2000);
+  pixels.select(sel, resp, 1, 2, 100, 8, 7200);
+  pixels.select(sel, resp, 1, 2, 100, 8, 50000);
+  REQUIRE (sel.size() == 3);
+  std::vector<uint8_t> tot(sel.size());
+  Gauss::Generator gen(5);
+  PixelArray::respond(resp, sel, tot.data(), gen);
+  REQUIRE (tot[0] == 0xf);
+  REQUIRE (tot[1] == 5);
+  REQUIRE (tot[2] == 14);
+
+  // Injected at threshold, noise makes half of the pixels fire
+  sel.clear();
+  for (unsigned i=0; i<1000; i++) {
+    pixels.select(sel, resp, 3, 0, 100, 8, 2100);
+  }
+  tot.resize(sel.size());
+  PixelArray::respond(resp, sel, tot.data(), gen);
+  unsigned hits = 0;
+  for (uint8_t t : tot) {
+    if (t != 0xf) hits++;
+  }
+  REQUIRE (hits > 430);
+  REQUIRE (hits < 570);
+}
@@ -0,0 +1,113 @@
+#include "catch.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "Fei4Cfg.h"
+#include "Rd53aCfg.h"
+#include "ScanHelper.h"
+#include "TempDir.h"
+
+static void fillPixels(Rd53aCfg &cfg) {
+  for(unsigned col=0; col<Rd53aPixelCfg::n_Col; col++) {
+    for(unsigned row=0; row<Rd53aPixelCfg::n_Row; row++) {
+      cfg.setEn(col, row, (col+row)%2);
+      cfg.setHitbus(col, row, (col*row)%3 == 0);
+      cfg.setInjEn(col, row, row%5 == 0);
+      cfg.setTDAC(col, row, col<264 ? (int)((col+row)%16) : (int)((col+row)%31) - 15);
+    }
+  }
+}
+
+static bool samePixels(Rd53aCfg &a, Rd53aCfg &b) {
+  return a.pixRegs == b.pixRegs;
+}
+
+TEST_CASE("Rd53aPixelCfgJson", "[PixelCfg]") {
+  Rd53aCfg cfg;
+  fillPixels(cfg);
+
+  json j;
+  cfg.toFileJson(j);
+  REQUIRE (j["RD53A"]["PixelConfig"].size() == Rd53aPixelCfg::n_Col);
+  REQUIRE ((int)j["RD53A"]["PixelConfig"][300]["Col"] == 300);
+  REQUIRE ((int)j["RD53A"]["PixelConfig"][300]["TDAC"][7] == cfg.getTDAC(300, 7));
+
+  Rd53aCfg back;
+  back.fromFileJson(j);
+  REQUIRE (samePixels(cfg, back));
+}
+
+TEST_CASE("Fei4PixelCfgJson", "[PixelCfg]") {
+  Fei4Cfg cfg;
+  for(unsigned col=1; col<=Fei4PixelCfg::n_Col; col++) {
+    for(unsigned row=1; row<=Fei4PixelCfg::n_Row; row++) {
+      cfg.setEn(col, row, (col+row)%2);
+      cfg.setTDAC(col, row, (col*7+row)%32);
+      cfg.setFDAC(col, row, (col+row*3)%16);
+    }
+  }
+
+  json j;
+  cfg.toFileJson(j);
+  Fei4Cfg back;
+  back.fromFileJson(j);
+  for(unsigned col=1; col<=Fei4PixelCfg::n_Col; col++) {
+    for(unsigned row=1; row<=Fei4PixelCfg::n_Row; row++) {
+      REQUIRE (back.getEn(col, row) == cfg.getEn(col, row));
+      REQUIRE (back.getTDAC(col, row) == cfg.getTDAC(col, row));
+      REQUIRE (back.getFDAC(col, row) == cfg.getFDAC(col, row));
+    }
+  }
+}
+
+TEST_CASE("PixelCfgSidecar", "[PixelCfg][ScanHelper]") {
+  TempDir tmp("test_pixel_cfg");
+  const std::string filename = tmp.file("chip.json");
+  const std::string sidecar = tmp.file("chip.pixcfg");
+
+  Rd53aCfg cfg;
+  fillPixels(cfg);
+  cfg.setName("SidecarChip");
+  std::string text = ScanHelper::saveChipConfig(&cfg, filename);
+  REQUIRE (text == ScanHelper::dumpChipConfig(&cfg));
+  REQUIRE (std::ifstream(sidecar).good());
+
+  SECTION("Matching") {
+    Rd53aCfg back;
+    ScanHelper::loadChipConfig(&back, filename);
+    REQUIRE (back.getName() == "SidecarChip");
+    REQUIRE (samePixels(cfg, back));
+  }
+
+  SECTION("Json changed") {
+    // Edited by hand, the sidecar is stale and must not be used
+    Rd53aCfg edited;
+    fillPixels(edited);
+    edited.setName("SidecarChip");
+    edited.setTDAC(10, 10, 3);
+    edited.setEn(11, 11, 1-edited.getEn(11, 11));
+    std::ofstream(filename) << ScanHelper::dumpChipConfig(&edited);
+
+    Rd53aCfg back;
+    ScanHelper::loadChipConfig(&back, filename);
+    REQUIRE (samePixels(edited, back));
+
+    // The sidecar was rewritten for the new json
+    Rd53aCfg again;
+    ScanHelper::loadChipConfig(&again, filename);
+    REQUIRE (samePixels(edited, again));
+  }
+
+  SECTION("Truncated") {
+    {
+      std::ifstream in(sidecar, std::ios::binary);
+      std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+      std::ofstream(sidecar, std::ios::binary | std::ios::trunc) << bytes.substr(0, bytes.size()/2);
+    }
+    Rd53aCfg back;
+    ScanHelper::loadChipConfig(&back, filename);
+    REQUIRE (samePixels(cfg, back));
+  }
+}
@@ -0,0 +1,69 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "PlotRenderer.h"
+#include "TempDir.h"
+
+static std::string readFile(const std::string &name) {
+  std::ifstream f(name, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+static uint32_t readBE32(const std::string &s, size_t pos) {
+  uint32_t v = 0;
+  for(size_t i=pos; i<pos+4; i++) v = (v << 8) | static_cast<uint8_t>(s[i]);
+  return v;
+}
+
+TEST_CASE("PlotRenderer", "[PlotRenderer]") {
+  std::vector<double> data(80*336);
+  for(unsigned i=0; i<data.size(); i++) data[i] = i%100;
+
+  PlotRenderer::Axis x = {"Column", 0.5, 80.5};
+  PlotRenderer::Axis y = {"Row", 0.5, 336.5};
+  TempDir tmp("test_plot_renderer");
+
+  SECTION("PNG") {
+    std::string name = tmp.file("map.png");
+    REQUIRE (PlotRenderer::plot2d(name, "Map", x, y, "Hits", data.data(), 80, 336));
+    std::string out = readFile(name);
+    REQUIRE (out.size() > 33);
+    REQUIRE (out.substr(0, 8) == "\x89PNG\r\n\x1a\n");
+    REQUIRE (out.substr(out.size()-8, 4) == "IEND");
+
+    // The canvas is written 1:1 as 8 bit RGB
+    REQUIRE (out.substr(12, 4) == "IHDR");
+    CHECK (readBE32(out, 16) == 1280);
+    CHECK (readBE32(out, 20) == 1024);
+    CHECK (out[24] == 8);
+    CHECK (out[25] == 2);
+  }
+
+  SECTION("PDF") {
+    std::string name = tmp.file("dist.pdf");
+    REQUIRE (PlotRenderer::plot1d(name, "Dist", x, "Pixels", data.data(), 80));
+    std::string out = readFile(name);
+    REQUIRE (out.substr(0, 5) == "%PDF-");
+    REQUIRE (out.find("%%EOF") != std::string::npos);
+
+    // One page of the canvas at half scale in points
+    CHECK (out.find("/Count 1 ") != std::string::npos);
+    CHECK (out.find("/MediaBox [0 0 640 512]") != std::string::npos);
+  }
+
+  SECTION("Graph") {
+    std::string name = tmp.file("graph.pdf");
+    std::vector<double> err(80, 0.5);
+    PlotRenderer::Axis fit = {"Charge", 0, 0};
+    REQUIRE (PlotRenderer::plotGraph(name, "Graph", fit, "ToT", 80, data.data(), data.data()+80, nullptr, err.data()));
+    REQUIRE (readFile(name).substr(0, 5) == "%PDF-");
+  }
+
+  SECTION("Unknown format") {
+    REQUIRE_FALSE (PlotRenderer::plot1d(tmp.file("dist.xyz"), "Dist", x, "Pixels", data.data(), 80));
+  }
+}
@@ -0,0 +1,98 @@
+#include "catch.hpp"
+
+#include <memory>
+
+#include "RawDataFile.h"
+#include "ReplayController.h"
+#include "TempDir.h"
+
+TEST_CASE("ReplayController", "[Replay]") {
+  TempDir tmp("test_replay");
+  const std::string filename = tmp.file("replay.raw");
+  {
+    RawDataFileWriter writer(filename);
+    for (unsigned i=0; i<2; i++) {
+      RawDataContainer rdc(LoopStatus({i, 7}));
+      rdc.add(new RawData(0x0, new uint32_t[2]{i, 0xa}, 2));
+      rdc.add(new RawData(0x1, new uint32_t[1]{0xb}, 1));
+      writer.write(rdc);
+    }
+  }
+
+  SECTION("Reader") {
+    RawDataFileReader reader(filename);
+    for (unsigned i=0; i<2; i++) {
+      auto rdc = reader.read();
+      REQUIRE (rdc);
+      REQUIRE (rdc->stat.size() == 2);
+      REQUIRE (rdc->stat.get(0) == i);
+      REQUIRE (rdc->size() == 2);
+      REQUIRE (rdc->adr[1] == 0x1);
+      REQUIRE (rdc->words[0] == 2);
+      REQUIRE (rdc->buf[0][0] == i);
+    }
+    REQUIRE (reader.read() == nullptr);
+  }
+
+  SECTION("Index") {
+    // Chunks of one block hold three of these records
+    const std::string chunked = tmp.file("chunked.raw");
+    {
+      RawDataFileWriter writer(chunked, true, 4096);
+      for (unsigned i=0; i<10; i++) {
+        RawDataContainer rdc(LoopStatus({i}));
+        rdc.add(new RawData(i%2, new uint32_t[300](), 300));
+        writer.write(rdc);
+      }
+    }
+
+    RawDataFileReader reader(chunked);
+    auto &index = reader.index();
+    REQUIRE (index.size() == 4);
+    REQUIRE (index[1].offset == 2*4096);
+    REQUIRE (index[1].records == 3);
+    REQUIRE (index[1].adrMask == 0x3);
+    REQUIRE (index[1].first == std::vector<unsigned>{3});
+    REQUIRE (index[1].last == std::vector<unsigned>{5});
+    REQUIRE (index[3].records == 1);
+
+    reader.seek(index[2]);
+    for (unsigned i=6; i<10; i++) {
+      auto rdc = reader.read();
+      REQUIRE (rdc);
+      REQUIRE (rdc->stat.get(0) == i);
+      REQUIRE (rdc->words[0] == 300);
+    }
+    REQUIRE (reader.read() == nullptr);
+  }
+
+  SECTION("Controller") {
+    json cfg;
+    cfg["file"] = filename;
+    ReplayController ctrl;
+    ctrl.loadConfig(cfg);
+
+    // Nothing is played before the trigger
+    ctrl.writeFifo(0x1234);
+    REQUIRE (ctrl.readData() == nullptr);
+
+    // One recorded container per trigger
+    for (unsigned i=0; i<2; i++) {
+      ctrl.setTrigEnable(0x1);
+      REQUIRE (!ctrl.isTrigDone());
+      REQUIRE (ctrl.getCurCount() == 3);
+      RawDataContainer rdc(LoopStatus::empty());
+      while (RawData *data = ctrl.readData()) rdc.add(data);
+      REQUIRE (ctrl.isTrigDone());
+      REQUIRE (rdc.size() == 2);
+      REQUIRE (rdc.buf[0][0] == i);
+      REQUIRE (rdc.buf[1][0] == 0xb);
+      ctrl.setTrigEnable(0x0);
+    }
+
+    // End of file, the trigger is done immediately
+    ctrl.setTrigEnable(0x1);
+    REQUIRE (ctrl.isTrigDone());
+    REQUIRE (ctrl.readData() == nullptr);
+  }
+}
@@ -0,0 +1,53 @@
+#include "catch.hpp"
+
+#include <thread>
+#include <vector>
+
+#include "RingBuffer.h"
+
+TEST_CASE("RingBufferBlocks", "[Emu][RingBuffer]") {
+  RingBuffer ring(6);
+  REQUIRE (ring.getCapacity() == 8);
+  REQUIRE (ring.isEmpty());
+
+  std::vector<uint32_t> in = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+  std::vector<uint32_t> out(8);
+
+  // Full buffer takes no more
+  REQUIRE (ring.tryWriteBlock32(in.data(), 9) == 8);
+  REQUIRE (ring.getCurSize() == 8*sizeof(uint32_t));
+  REQUIRE (ring.tryWriteBlock32(in.data(), 1) == 0);
+
+  REQUIRE (ring.readBlock32(out.data(), 5) == 1);
+  REQUIRE (out[4] == 5);
+
+  // Write and read across the wrap
+  ring.writeBlock32(in.data(), 5);
+  REQUIRE (ring.readBlock32(out.data(), 9) == 0);
+  REQUIRE (ring.readBlock32(out.data(), 8) == 1);
+  REQUIRE (out == std::vector<uint32_t>({6, 7, 8, 1, 2, 3, 4, 5}));
+  REQUIRE (ring.isEmpty());
+}
+
+TEST_CASE("RingBufferThreads", "[Emu][RingBuffer]") {
+  RingBuffer ring(16);
+  const uint32_t n = 100000;
+
+  std::thread producer([&] {
+    std::vector<uint32_t> buf(7);
+    for (uint32_t i=0; i<n; i+=buf.size()) {
+      uint32_t len = std::min<uint32_t>(buf.size(), n-i);
+      for (uint32_t j=0; j<len; j++) buf[j] = i+j;
+      ring.writeBlock32(buf.data(), len);
+    }
+  });
+
+  uint32_t errors = 0;
+  for (uint32_t i=0; i<n; i++) {
+    if (ring.read32() != i) errors++;
+  }
+  producer.join();
+
+  REQUIRE (errors == 0);
+  REQUIRE (ring.isEmpty());
+}
@@ -0,0 +1,91 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "TaskScheduler.h"
+
+TEST_CASE("TaskSchedulerParallelFor", "[TaskScheduler]") {
+  for (unsigned nWorkers : {0u, 1u, 3u}) {
+    TaskScheduler scheduler(nWorkers);
+    REQUIRE (scheduler.size() == nWorkers);
+
+    std::vector<unsigned> hits(1000, 0);
+    scheduler.parallelFor(0, hits.size(), 7, [&](size_t first, size_t last) {
+      for (size_t i=first; i<last; i++) hits[i]++;
+    });
+    REQUIRE (hits == std::vector<unsigned>(1000, 1));
+
+    // One chunk per thread
+    std::atomic<unsigned> chunks(0);
+    scheduler.parallelFor(0, 100, 0, [&](size_t, size_t) { chunks++; });
+    REQUIRE (chunks == nWorkers + 1);
+  }
+}
+
+TEST_CASE("TaskSchedulerGroups", "[TaskScheduler]") {
+  TaskScheduler scheduler(2);
+
+  // Tasks queue more tasks, which are stolen by the other worker and the waiter
+  std::atomic<unsigned> count(0);
+  {
+    TaskGroup outer(scheduler);
+    for (unsigned i=0; i<10; i++) {
+      outer.run([&] {
+        TaskGroup inner(scheduler);
+        for (unsigned j=0; j<10; j++) {
+          inner.run([&] { count++; });
+        }
+        inner.wait();
+      });
+    }
+    outer.wait();
+  }
+  REQUIRE (count == 100);
+
+  // The first exception reaches the waiter, all tasks are still run
+  TaskGroup group(scheduler);
+  for (unsigned i=0; i<5; i++) {
+    group.run([&, i] {
+      count++;
+      if (i == 2) throw std::runtime_error("task failed");
+    });
+  }
+  REQUIRE_THROWS_AS (group.wait(), std::runtime_error);
+  REQUIRE (count == 105);
+  REQUIRE_NOTHROW (group.wait());
+}
+
+TEST_CASE("TaskSchedulerDrain", "[TaskScheduler]") {
+  // Queued tasks are run before the workers stop, the task storage owns its captures
+  auto token = std::make_shared<int>(0);
+  std::atomic<unsigned> count(0);
+  {
+    // The worker is held in the first task until the captures are checked
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    TaskScheduler scheduler(1, true);
+    scheduler.submit([released] { released.wait(); });
+    for (unsigned i=0; i<50; i++) {
+      scheduler.submit([&count, token] {
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+        count++;
+      });
+    }
+    REQUIRE (token.use_count() == 51);
+    release.set_value();
+  }
+  REQUIRE (count == 50);
+  REQUIRE (token.use_count() == 1);
+
+  Task task([&count] { count++; });
+  Task moved(std::move(task));
+  REQUIRE (!task);
+  moved();
+  REQUIRE (count == 51);
+}
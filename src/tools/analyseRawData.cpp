@@ -1,13 +1,130 @@
 #include <iostream>
 #include <fstream>
 #include <array>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
+#include <unistd.h>
+
+#include "ClusterFinder.h"
 #include "Fei4EventData.h"
+#include "Fei4EventReader.h"
 #include "Histo1d.h"
 #include "Histo2d.h"
 
+namespace {
+    // Only valid tag to l1id association
+    //const std::array<unsigned, 16> l1ToTag = {{0,0,1,1,1,1,2,2,2,2,3,3,3,3,0,0}};
+    const std::array<unsigned, 32> l1ToTag = {{0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,
+                                               4,4,5,5,5,5,6,6,6,6,7,7,7,7,0,0}};
+
+    bool isValid(const Fei4EventReader::Header &h) {
+        return h.l1id < l1ToTag.size() && l1ToTag[h.l1id] == h.tag;
+    }
+
+    /// Events of one trigger (L1ID 0 to 31), invalid events in between are skipped on reading
+    struct Trigger {
+        size_t begin;
+        size_t end;
+        uint16_t bcid;
+        unsigned nHits;
+    };
+
+    /// Hits of all valid events of a trigger
+    void readHits(const Fei4EventReader &file, const Trigger &trigger, std::vector<Fei4Hit> &hits) {
+        hits.clear();
+        Fei4EventReader::Header h;
+        for (size_t pos = trigger.begin; pos < trigger.end && file.header(pos, h); pos = h.next) {
+            if (isValid(h)) file.hits(h, hits);
+        }
+    }
+
+    /// Histograms filled per trigger, one set per thread which are added up at the end
+    struct Shard {
+        Shard() :
+            hitsPerEvent("hitsPerEvent", 31, -0.5, 30.5, typeid(void)),
+            hitsPerCluster("hitsPerCluster", 31, -0.5, 30.5, typeid(void)),
+            clusterColLength("clusterColLength", 31, -0.5, 30.5, typeid(void)),
+            clusterRowWidth("clusterRowWidth", 31, -0.5, 30.5, typeid(void)),
+            clusterWidthLengthCorr("clusterWidthLengthCorr", 11, -0.5, 10.5, 11, -0.5, 10.5, typeid(void)),
+            clustersPerEvent("clustersPerEvent", 11, -0.5, 10.5, typeid(void)),
+            occupancy("occupancy", 400, 0.5, 400.5, 192, 0.5, 192.5, typeid(void)) {}
+
+        void fill(const Fei4EventReader &file, const std::vector<Trigger> &triggers, size_t first, size_t last) {
+            // Hits up to one pixel gap apart belong to the same cluster, as in Fei4Event
+            ClusterFinder finder(2, 2);
+            std::vector<Fei4Hit> hits;
+            for (size_t i=first; i<last; i++) {
+                hitsPerEvent.fill(triggers[i].nHits);
+                if (triggers[i].nHits == 0) continue;
+
+                readHits(file, triggers[i], hits);
+                finder.find(hits);
+                clustersPerEvent.fill(finder.getClusters().size());
+                for (const Fei4Hit &hit : hits) {
+                    occupancy.fill(hit.col, hit.row);
+                }
+                for (const ClusterFinder::Cluster &cluster : finder.getClusters()) {
+                    hitsPerCluster.fill(cluster.nHits);
+                    if (cluster.nHits > 1) {
+                        clusterColLength.fill(cluster.getColLength());
+                        clusterRowWidth.fill(cluster.getRowWidth());
+                        clusterWidthLengthCorr.fill(cluster.getColLength(), cluster.getRowWidth());
+                    }
+                }
+            }
+        }
+
+        void add(const Shard &s) {
+            hitsPerEvent.add(s.hitsPerEvent);
+            hitsPerCluster.add(s.hitsPerCluster);
+            clusterColLength.add(s.clusterColLength);
+            clusterRowWidth.add(s.clusterRowWidth);
+            clusterWidthLengthCorr.add(s.clusterWidthLengthCorr);
+            clustersPerEvent.add(s.clustersPerEvent);
+            occupancy.add(s.occupancy);
+        }
+
+        Histo1d hitsPerEvent;
+        Histo1d hitsPerCluster;
+        Histo1d clusterColLength;
+        Histo1d clusterRowWidth;
+        Histo2d clusterWidthLengthCorr;
+        Histo1d clustersPerEvent;
+        Histo2d occupancy;
+    };
+
+    void printHelp(const char *name) {
+        std::cout << "Usage: " << name << " [-v] [-j <threads>] <data.raw> [<data2.raw> ...]" << std::endl;
+        std::cout << " -v: Print every event." << std::endl;
+        std::cout << " -j <threads>: Number of analysis threads. (Default all cores)" << std::endl;
+    }
+}
+
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
+    bool verbose = false;
+    unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+    int c;
+    while ((c = getopt(argc, argv, "hvj:")) != -1) {
+        switch (c) {
+            case 'h':
+                printHelp(argv[0]);
+                return 0;
+            case 'v':
+                verbose = true;
+                break;
+            case 'j':
+                nThreads = std::max(1, atoi(optarg));
+                break;
+            default:
+                printHelp(argv[0]);
+                return -1;
+        }
+    }
+
+    if (optind >= argc) {
         std::cout << "#ERROR# Provide input file(s)!" << std::endl;
         return -1;
     }
@@ -18,35 +135,26 @@ int main(int argc, char* argv[]) {
 
     // Define histograms
 
-    Histo1d hitsPerEvent("hitsPerEvent", 31, -0.5, 30.5, typeid(void));
-    hitsPerEvent.setXaxisTitle("# of Hits");
-    hitsPerEvent.setYaxisTitle("# of Events");
+    Shard all;
+    all.hitsPerEvent.setXaxisTitle("# of Hits");
+    all.hitsPerEvent.setYaxisTitle("# of Events");
 
-    Histo1d hitsPerCluster("hitsPerCluster", 31, -0.5, 30.5, typeid(void));
-    hitsPerCluster.setXaxisTitle("# of Hits");
-    hitsPerCluster.setYaxisTitle("# of Events");
+    all.hitsPerCluster.setXaxisTitle("# of Hits");
+    all.hitsPerCluster.setYaxisTitle("# of Events");
 
     Histo2d *eventScreen = NULL;
 
-    Histo1d clusterColLength("clusterColLength", 31, -0.5, 30.5, typeid(void));
-    clusterColLength.setXaxisTitle("Cluster Column Length");
-    clusterColLength.setYaxisTitle("# of Clusters");
-
-    Histo1d clusterRowWidth("clusterRowWidth", 31, -0.5, 30.5, typeid(void));
-    clusterRowWidth.setXaxisTitle("Cluster Row Width");
-    clusterRowWidth.setYaxisTitle("# of Clusters");
+    all.clusterColLength.setXaxisTitle("Cluster Column Length");
+    all.clusterColLength.setYaxisTitle("# of Clusters");
 
-    Histo2d clusterWidthLengthCorr("clusterWidthLengthCorr", 11, -0.5, 10.5, 11, -0.5, 10.5, typeid(void));
-    clusterWidthLengthCorr.setXaxisTitle("Cluster Col Length");
-    clusterWidthLengthCorr.setYaxisTitle("Cluster Row Width");
+    all.clusterRowWidth.setXaxisTitle("Cluster Row Width");
+    all.clusterRowWidth.setYaxisTitle("# of Clusters");
 
-    Histo1d clustersPerEvent("clustersPerEvent", 11, -0.5, 10.5, typeid(void));
-    clustersPerEvent.setXaxisTitle("# of Clusters");
-    clustersPerEvent.setYaxisTitle("# of Events");
+    all.clusterWidthLengthCorr.setXaxisTitle("Cluster Col Length");
+    all.clusterWidthLengthCorr.setYaxisTitle("Cluster Row Width");
 
-    Histo1d hitsPerTrigger("clustersPerEvent", 11, -0.5, 10.5, typeid(void));
-    hitsPerTrigger.setXaxisTitle("# of Clusters");
-    hitsPerTrigger.setYaxisTitle("# of Events");
+    all.clustersPerEvent.setXaxisTitle("# of Clusters");
+    all.clustersPerEvent.setYaxisTitle("# of Events");
 
     Histo1d bcid("bcid", 32768, -0.5, 32767.5, typeid(void));
     bcid.setXaxisTitle("BCID");
@@ -60,182 +168,163 @@ int main(int argc, char* argv[]) {
     l1id.setXaxisTitle("L1Id");
     l1id.setYaxisTitle("Number of Trigger");
 
-    Histo2d occupancy("occupancy", 400, 0.5, 400.5, 192, 0.5, 192.5, typeid(void));
+    Histo2d &occupancy = all.occupancy;
     occupancy.setXaxisTitle("Column");
     occupancy.setYaxisTitle("Row");
     occupancy.setZaxisTitle("Hits");
 
-    // Only valid tag to l1id association
-    //const std::array<unsigned, 16> l1ToTag = {{0,0,1,1,1,1,2,2,2,2,3,3,3,3,0,0}};
-    const std::array<unsigned, 32> l1ToTag = {{0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,
-                                               4,4,5,5,5,5,6,6,6,6,7,7,7,7,0,0}};
-
     // Loop over input files
     int skipped = 0;
-    for (int i=1; i<argc; i++) {
+    for (int i=optind; i<argc; i++) {
         std::cout << "Opening file: " << argv[i] << std::endl;
-        std::fstream file(argv[i], std::fstream::in | std::fstream::binary);
-
-        file.seekg(0, std::ios_base::end);
-        int size = file.tellg();
-        file.seekg(0, std::ios_base::beg);
-        std::cout << "Size of " << argv[i] << " is: " << size/1024.0/1024.0 << " MB" << std::endl;        
+        std::unique_ptr<Fei4EventReader> file;
+        try {
+            file.reset(new Fei4EventReader(argv[i]));
+        } catch (std::runtime_error &e) {
+            std::cout << "#ERROR# " << e.what() << std::endl;
+            continue;
+        }
+        std::cout << "Size of " << argv[i] << " is: " << file->size()/1024.0/1024.0 << " MB"
+                  << (file->isCompact() ? " (compact)" : "") << std::endl;
 
         int count = 0;
         int nonZero_cnt = 0;
         int plotIt = 0;
         int old_bcid = 0;
-        int other_old_bcid = 0;
         int max_bcid = 0;
         int trigger = 0;
 
         int l1_count = 0;
 
-        Fei4Event *multiEvent = NULL;
-        std::list<Fei4Event*> eventList;
+        // First pass over the event headers only: validate the sequence and
+        // index the triggers
+        std::vector<Trigger> triggerList;
+        Trigger multiEvent = {0, 0, 0, 0};
+        bool open = false;
         int error = 0;
 
-        while (file) {
-            int now = file.tellg();
-            //std::cout << "\r Loaded " << (double)now/(double)size*100 << "%                       " << std::flush;
-
-            Fei4Event *event = new Fei4Event();
-            event->fromFileBinary(file);
-            
+        Fei4EventReader::Header event;
+        for (size_t pos = file->begin(); file->header(pos, event); pos = event.next) {
             // Print event
-            std::cout << "L1 count: " << l1_count << " at event " << count << " L1ID(" << event->l1id <<") BCID(" << event->bcid << ") TAG(" << event->tag << ") HITS(" << event->nHits << ")" << std::endl;
+            if (verbose) {
+                std::cout << "L1 count: " << l1_count << " at event " << count << " L1ID(" << event.l1id <<") BCID(" << event.bcid << ") TAG(" << event.tag << ") HITS(" << event.nHits << ")" << std::endl;
+            }
 
             // Skip if not valid event
-            if (l1ToTag[event->l1id] != event->tag) {
+            if (!isValid(event)) {
                 skipped++;
-                std::cout << " Skipped " << std::endl;
+                if (verbose) std::cout << " Skipped " << std::endl;
                 continue;
             }
 
-            // Skip if EOF
-            if (!file) {
-                break;
+            if (!open) {
+                multiEvent = {pos, pos, event.bcid, 0};
+                open = true;
             }
+            // Add to muti-event container
+            multiEvent.end = event.next;
+            multiEvent.nHits += event.nHits;
 
-            if (multiEvent == NULL) {
-                multiEvent = event;
-            } else {
-                // Add to muti-event container
-                multiEvent->addEvent(*event);
-            }
-            
-            if (l1_count - event->l1id != 0) {
+            if (l1_count - event.l1id != 0) {
                 error++;
-                std::cout << " L1ID off " << std::endl;
+                if (verbose) std::cout << " L1ID off " << std::endl;
             }
 
-            if (event->bcid - old_bcid != 1 && l1_count != 0) {
+            if (event.bcid - old_bcid != 1 && l1_count != 0) {
                 error++;
-                std::cout << " BCID off " << std::endl;
+                if (verbose) std::cout << " BCID off " << std::endl;
             }
-            old_bcid = event->bcid; 
+            old_bcid = event.bcid;
 
             // Valid event
             l1_count++;
             // First event should have l1id 0
-            if (l1_count == 1 && event->l1id != 0) {
+            if (l1_count == 1 && event.l1id != 0) {
                 std::cout << "... wierd first event does not have the right l1id" << std::endl;
-                //exit(-1);
             }
 
-            
-            for (auto hit : event->hits) {
-                l1id.fill(event->l1id);
-                (void) hit;
-                //std::cout << "      Col(" << hit.col << ") Row(" << hit.row << ") ToT(" << hit.tot << ")" << std::endl;
+            for (unsigned h=0; h<event.nHits; h++) {
+                l1id.fill(event.l1id);
             }
-            
-            
-            // Start new multi-event container after 16 events
-            //if (l1_count == 32) {
-            if (event->l1id == 31) {
-                eventList.push_back(multiEvent);
-                multiEvent = NULL;
+
+            // Start new multi-event container after 32 events
+            if (event.l1id == 31) {
+                triggerList.push_back(multiEvent);
+                open = false;
                 l1_count = 0;
                 trigger++;
-                std::cout << " #### Event " << trigger << " #### " << std::endl;
+                if (verbose) std::cout << " #### Event " << trigger << " #### " << std::endl;
             }
         }
         std::cout << " Number of errors: " << error << std::endl;
         std::cout << std::endl << "Fully loaded events ... analysing" << std::endl;
 
-        // Loop over event List
-        for (auto event: eventList) {
-            hitsPerEvent.fill(event->nHits);
-
+        // BCID of the triggers in order
+        for (const Trigger &t : triggerList) {
+            if (max_bcid < t.bcid)
+                max_bcid = t.bcid;
 
-            if (max_bcid < event->bcid)
-                max_bcid = event->bcid;
+            bcid.fill(t.bcid, t.nHits);
 
-            if (count==0)
-                other_old_bcid = event->bcid;
-            (void)other_old_bcid;
-
-            bcid.fill(event->bcid, event->nHits);
-
-            if ((int)event->bcid - old_bcid < 0 && ((int)event->bcid-old_bcid+32768) > 16) {// wrap around, just reset
-                bcidDiff.fill((int)event->bcid-old_bcid+32768);
-                old_bcid = event->bcid;
-            } else if ((int)event->bcid - old_bcid > 16) { 
-                bcidDiff.fill((int)event->bcid-old_bcid);
-                old_bcid = event->bcid;
-            }
-
-            if (event->nHits > 0) {
-                event->doClustering();
-                clustersPerEvent.fill(event->clusters.size());
-                nonZero_cnt++;
-                for (auto hit : event->hits) {
-                    occupancy.fill(hit.col, hit.row);
-                }
+            if ((int)t.bcid - old_bcid < 0 && ((int)t.bcid-old_bcid+32768) > 16) {// wrap around, just reset
+                bcidDiff.fill((int)t.bcid-old_bcid+32768);
+                old_bcid = t.bcid;
+            } else if ((int)t.bcid - old_bcid > 16) {
+                bcidDiff.fill((int)t.bcid-old_bcid);
+                old_bcid = t.bcid;
             }
+            count ++;
+        }
 
-            for (auto cluster : event->clusters) {
-                hitsPerCluster.fill(cluster.nHits);
-                if (cluster.nHits > 1) {
-                    clusterColLength.fill(cluster.getColLength());
-                    clusterRowWidth.fill(cluster.getRowWidth());
-                    clusterWidthLengthCorr.fill(cluster.getColLength(), cluster.getRowWidth());
-                }
+        // Hits and clusters of the triggers in parallel
+        std::vector<std::unique_ptr<Shard>> shards;
+        std::vector<std::thread> threads;
+        size_t perThread = (triggerList.size() + nThreads - 1) / nThreads;
+        for (unsigned t=0; t<nThreads && t*perThread < triggerList.size(); t++) {
+            shards.emplace_back(new Shard);
+            size_t last = std::min(triggerList.size(), (t+1)*perThread);
+            threads.emplace_back(&Shard::fill, shards.back().get(), std::cref(*file),
+                                 std::cref(triggerList), t*perThread, last);
+        }
+        for (unsigned t=0; t<threads.size(); t++) {
+            threads[t].join();
+            all.add(*shards[t]);
+        }
 
+        // Event displays of the first triggers with hits
+        ClusterFinder finder(2, 2);
+        std::vector<Fei4Hit> hits;
+        for (const Trigger &t : triggerList) {
+            if (plotIt >= 100) break;
+            if (t.nHits == 0) continue;
+            nonZero_cnt++;
+
+            readHits(*file, t, hits);
+            finder.find(hits);
+            if (eventScreen == NULL) {
+                eventScreen = new Histo2d((std::to_string(nonZero_cnt) + "-eventScreen"), 400, 0.5, 400.5, 192, 0.5, 192.5, typeid(void));
+                eventScreen->setXaxisTitle("Column");
+                eventScreen->setYaxisTitle("Row");
+                eventScreen->setZaxisTitle("ToT");
             }
-            if (event->clusters.size() > 0 && plotIt < 100) {
-                if (eventScreen == NULL) {
-                    eventScreen = new Histo2d((std::to_string(nonZero_cnt) + "-eventScreen"), 400, 0.5, 400.5, 192, 0.5, 192.5, typeid(void));
-                    eventScreen->setXaxisTitle("Column");
-                    eventScreen->setYaxisTitle("Row");
-                    eventScreen->setZaxisTitle("ToT");
-                }
-                int cluster_cnt = 1;
-                for (auto cluster: event->clusters) {
-                    for (auto hit : cluster.hits) {
-                        //std::cout << hit->col << " " << hit->row << std::endl;
-                        eventScreen->fill(hit->col, hit->row, hit->tot);
-                    }
-                    cluster_cnt++;
-                }
-                if (plotIt%10 == 9) {
-                    eventScreen->plot(std::to_string(plotIt), "offline/");
-                    delete eventScreen;
-                    eventScreen = new Histo2d((std::to_string(nonZero_cnt) + "-eventScreen"), 400, 0.5, 400.5, 192, 0.5, 192.5, typeid(void));
-                    eventScreen->setXaxisTitle("Column");
-                    eventScreen->setYaxisTitle("Row");
-                    eventScreen->setZaxisTitle("ToT");
-                }
-                plotIt++;
+            for (const Fei4Hit &hit : hits) {
+                eventScreen->fill(hit.col, hit.row, hit.tot);
             }
-            count ++;
+            if (plotIt%10 == 9) {
+                eventScreen->plot(std::to_string(plotIt), "offline/");
+                delete eventScreen;
+                eventScreen = new Histo2d((std::to_string(nonZero_cnt) + "-eventScreen"), 400, 0.5, 400.5, 192, 0.5, 192.5, typeid(void));
+                eventScreen->setXaxisTitle("Column");
+                eventScreen->setYaxisTitle("Row");
+                eventScreen->setZaxisTitle("ToT");
+            }
+            plotIt++;
         }
         std::cout << std::endl;
-        file.close();
         std::cout << "Max BCID: " << max_bcid << std::endl;
         std::cout << "Numer of trigger: " << trigger << std::endl;
     }
+    delete eventScreen;
 
     int sum = 0;
     for (unsigned i=0; i<400*192; i++) {
@@ -243,7 +332,7 @@ int main(int argc, char* argv[]) {
     }
     double mean=(double)sum/(400.0*192.0);
     std::cout << "Occupancy mean = " << mean << std::endl;
-    if (mean < 3.0) 
+    if (mean < 3.0)
         mean = 3;
     for (unsigned i=0; i<400*192; i++) {
         if (occupancy.getBin(i) > (mean*5)) {
@@ -257,20 +346,20 @@ int main(int argc, char* argv[]) {
     bcid.plot("offline", "offline/");
     l1id.plot("offline", "offline/");
     bcidDiff.plot("offline", "offline/");
-    hitsPerEvent.plot("offline", "offline/");
-    hitsPerCluster.plot("offline", "offline/");
-    clusterColLength.plot("offline", "offline/");
-    clusterRowWidth.plot("offline", "offline/");
-    clusterWidthLengthCorr.plot("offline", "offline/");
-    clustersPerEvent.plot("offline", "offline/");
+    all.hitsPerEvent.plot("offline", "offline/");
+    all.hitsPerCluster.plot("offline", "offline/");
+    all.clusterColLength.plot("offline", "offline/");
+    all.clusterRowWidth.plot("offline", "offline/");
+    all.clusterWidthLengthCorr.plot("offline", "offline/");
+    all.clustersPerEvent.plot("offline", "offline/");
     occupancy.plot("offline", "offline/");
 
-    std::cout << "Cluster Column Length mean: " << clusterColLength.getMean() << " +- " << clusterColLength.getStdDev() << std::endl;
-    std::cout << "Cluster Row Width mean:     " << clusterRowWidth.getMean() << " +- " << clusterRowWidth.getStdDev() << std::endl;
+    std::cout << "Cluster Column Length mean: " << all.clusterColLength.getMean() << " +- " << all.clusterColLength.getStdDev() << std::endl;
+    std::cout << "Cluster Row Width mean:     " << all.clusterRowWidth.getMean() << " +- " << all.clusterRowWidth.getStdDev() << std::endl;
     std::cout << "BCID entries: " << bcid.getEntries() << std::endl;
     std::cout << "BCIDdiff entries: " << bcidDiff.getEntries() << std::endl;
-    std::cout << "Number of clusters: " << clustersPerEvent.getEntries() << std::endl;
-    std::cout << "Number of events: " << hitsPerEvent.getEntries() << std::endl;
+    std::cout << "Number of clusters: " << all.clustersPerEvent.getEntries() << std::endl;
+    std::cout << "Number of events: " << all.hitsPerEvent.getEntries() << std::endl;
     std::cout << "Number of skipped events: " << skipped << std::endl;
 
     return 0;
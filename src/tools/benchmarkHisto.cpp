@@ -0,0 +1,131 @@
+// #################################
+// # Project: Yarr
+// # Description: Benchmark of Histo2d arithmetic and statistics
+// # Comment: Compares against the former scalar implementation
+// ################################
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Histo2d.h"
+
+namespace {
+    // Former implementation, bin access through bounds checked getBin()
+    namespace Scalar {
+        void add(std::vector<double> &a, const Histo2d &h) {
+            for (unsigned i=0; i<a.size(); i++)
+                a[i] += h.getBin(i);
+        }
+
+        void divide(std::vector<double> &a, const Histo2d &h) {
+            for (unsigned i=0; i<a.size(); i++) {
+                if (h.getBin(i) == 0) {
+                    a[i] = 0;
+                } else {
+                    a[i] = a[i]/h.getBin(i);
+                }
+            }
+        }
+
+        void scale(std::vector<double> &a, double s) {
+            for (unsigned i=0; i<a.size(); i++)
+                a[i] = a[i]*s;
+        }
+
+        double mean(const std::vector<double> &a, const std::vector<bool> &filled) {
+            double sum = 0;
+            double entries = 0;
+            for (unsigned i=0; i<a.size(); i++) {
+                if (filled[i]) {
+                    sum += a[i];
+                    entries++;
+                }
+            }
+            if (entries < 1) return 0;
+            return sum/entries;
+        }
+
+        double stdDev(const std::vector<double> &a, const std::vector<bool> &filled) {
+            double m = mean(a, filled);
+            double mu = 0;
+            double entries = 0;
+            for (unsigned i=0; i<a.size(); i++) {
+                if (filled[i]) {
+                    mu += pow(a[i]-m, 2);
+                    entries++;
+                }
+            }
+            if (entries < 2) return 0;
+            return sqrt(mu/(double)(entries-1));
+        }
+    }
+
+    // Returns ns per call
+    double measure(unsigned repetitions, std::function<void()> f) {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i=0; i<repetitions; i++)
+            f();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end-start).count()/repetitions;
+    }
+
+    void report(std::string name, double scalar, double kernel) {
+        std::cout << std::left << std::setw(12) << name << std::right
+                  << std::setw(12) << std::fixed << std::setprecision(1) << scalar/1000.0 << " us"
+                  << std::setw(12) << kernel/1000.0 << " us"
+                  << std::setw(10) << std::setprecision(2) << scalar/kernel << "x" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    unsigned repetitions = 1000;
+    if (argc > 1) repetitions = std::atoi(argv[1]);
+
+    // Rd53a sized map
+    const unsigned nCol = 400;
+    const unsigned nRow = 192;
+    Histo2d a("A", nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(void));
+    Histo2d b("B", nCol, 0.5, nCol+0.5, nRow, 0.5, nRow+0.5, typeid(void));
+
+    std::mt19937 gen(42);
+    std::normal_distribution<double> dist(100, 10);
+    std::vector<double> ref(a.size());
+    std::vector<bool> filled(a.size());
+    for (unsigned i=0; i<a.size(); i++) {
+        double v = dist(gen);
+        a.setBin(i, v);
+        b.setBin(i, (i%7 == 0) ? 0 : v);
+        ref[i] = v;
+        filled[i] = true;
+    }
+
+    std::cout << "Histo2d " << nCol << "x" << nRow << ", " << repetitions << " repetitions" << std::endl;
+    std::cout << std::left << std::setw(12) << "Operation" << std::right
+              << std::setw(15) << "Scalar" << std::setw(15) << "Kernel" << std::setw(11) << "Speedup" << std::endl;
+
+    report("add",
+            measure(repetitions, [&] { Scalar::add(ref, b); }),
+            measure(repetitions, [&] { a.add(b); }));
+    report("divide",
+            measure(repetitions, [&] { Scalar::divide(ref, b); }),
+            measure(repetitions, [&] { a.divide(b); }));
+    report("scale",
+            measure(repetitions, [&] { Scalar::scale(ref, 1.0001); }),
+            measure(repetitions, [&] { a.scale(1.0001); }));
+
+    volatile double sink = 0;
+    report("mean+stddev",
+            measure(repetitions, [&] { sink = Scalar::mean(ref, filled) + Scalar::stdDev(ref, filled); }),
+            // setBin() invalidates the cached statistics, so every repetition recomputes them
+            measure(repetitions, [&] { a.setBin(0, 1.0); sink = a.getMean() + a.getStdDev(); }));
+    (void)sink;
+
+    return 0;
+}
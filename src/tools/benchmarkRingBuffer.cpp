@@ -0,0 +1,133 @@
+// #################################
+// # Project: Yarr
+// # Description: Throughput benchmark of the emulator RingBuffer
+// # Comment: One producer and one consumer thread, compared against the
+// #          former mutex and condition variable implementation
+// ################################
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RingBuffer.h"
+
+namespace {
+    // Former implementation, one lock round trip per word
+    class LockedRing {
+        public:
+            LockedRing(uint32_t size) : buffer(size), read_index(0), write_index(0) {}
+
+            void write32(uint32_t word) {
+                std::unique_lock<std::mutex> lk(mtx);
+                cv.wait(lk, [&] { return (write_index+1)%buffer.size() != read_index; });
+                buffer[write_index] = word;
+                write_index = (write_index+1)%buffer.size();
+                cv.notify_all();
+            }
+
+            uint32_t read32() {
+                std::unique_lock<std::mutex> lk(mtx);
+                cv.wait(lk, [&] { return read_index != write_index; });
+                uint32_t word = buffer[read_index];
+                read_index = (read_index+1)%buffer.size();
+                cv.notify_all();
+                return word;
+            }
+
+        private:
+            std::vector<uint32_t> buffer;
+            uint32_t read_index;
+            uint32_t write_index;
+            std::mutex mtx;
+            std::condition_variable cv;
+    };
+
+    // Returns Mwords/s, the consumer checks the sequence
+    double measure(uint64_t words, std::function<void(uint64_t)> produce,
+                   std::function<uint64_t(uint64_t)> consume) {
+        auto start = std::chrono::steady_clock::now();
+        std::thread producer(produce, words);
+        uint64_t errors = consume(words);
+        producer.join();
+        auto end = std::chrono::steady_clock::now();
+        if (errors) {
+            std::cerr << "#ERROR# " << errors << " words out of sequence" << std::endl;
+        }
+        return words/std::chrono::duration<double, std::micro>(end-start).count();
+    }
+
+    void report(std::string name, double rate) {
+        std::cout << std::left << std::setw(28) << name << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(1) << rate << " Mwords/s" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t words = 1 << 24;
+    uint32_t size = 1 << 12;
+    const uint32_t block = 256;
+    if (argc > 1) words = std::atoll(argv[1]);
+    if (argc > 2) size = std::atoi(argv[2]);
+
+    std::cout << words << " words through a " << size << " word buffer" << std::endl;
+
+    {
+        LockedRing ring(size);
+        report("mutex, word by word", measure(words,
+                    [&](uint64_t n) { for (uint64_t i=0; i<n; i++) ring.write32(i); },
+                    [&](uint64_t n) {
+                        uint64_t errors = 0;
+                        for (uint64_t i=0; i<n; i++) errors += (ring.read32() != (uint32_t)i);
+                        return errors;
+                    }));
+    }
+
+    {
+        RingBuffer ring(size);
+        report("lock-free, word by word", measure(words,
+                    [&](uint64_t n) { for (uint64_t i=0; i<n; i++) ring.write32(i); },
+                    [&](uint64_t n) {
+                        uint64_t errors = 0;
+                        for (uint64_t i=0; i<n; i++) errors += (ring.read32() != (uint32_t)i);
+                        return errors;
+                    }));
+    }
+
+    {
+        // Producer writes blocks, consumer drains whatever is there like EmuRxCore
+        RingBuffer ring(size);
+        report("lock-free, blocks", measure(words,
+                    [&](uint64_t n) {
+                        std::vector<uint32_t> buf(block);
+                        for (uint64_t i=0; i<n; i+=block) {
+                            uint32_t len = std::min<uint64_t>(block, n-i);
+                            for (uint32_t j=0; j<len; j++) buf[j] = i+j;
+                            ring.writeBlock32(buf.data(), len);
+                        }
+                    },
+                    [&](uint64_t n) {
+                        uint64_t errors = 0;
+                        std::vector<uint32_t> buf(ring.getCapacity());
+                        for (uint64_t i=0; i<n; ) {
+                            uint32_t len = ring.tryReadBlock32(buf.data(), buf.size());
+                            if (len == 0) {
+                                std::this_thread::yield();
+                                continue;
+                            }
+                            for (uint32_t j=0; j<len; j++) errors += (buf[j] != (uint32_t)(i+j));
+                            i += len;
+                        }
+                        return errors;
+                    }));
+    }
+
+    return 0;
+}
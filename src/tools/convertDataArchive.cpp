@@ -0,0 +1,63 @@
+// #################################
+// # Project: Yarr
+// # Description: Converts a compact DataArchiver file to the plain layout
+// # Comment: The plain layout is the one read by Fei4Event::fromFileBinary
+// ################################
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "Fei4EventData.h"
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <compact_data.raw> <plain_data.raw>" << std::endl;
+        return -1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    char magic[sizeof(Fei4EventFile::compactMagic)];
+    if (!in.read(magic, sizeof(magic)) ||
+        memcmp(magic, Fei4EventFile::compactMagic, sizeof(magic)) != 0) {
+        std::cout << "#ERROR# " << argv[1] << " is not a compact data archive" << std::endl;
+        return -1;
+    }
+    std::fstream out(argv[2], std::fstream::out | std::fstream::binary | std::fstream::trunc);
+    if (!out) {
+        std::cout << "#ERROR# Could not create " << argv[2] << std::endl;
+        return -1;
+    }
+
+    // Events may span the blocks read, the unparsed rest is carried over
+    const size_t blockSize = 1 << 20;
+    std::vector<char> inBuf;
+    std::vector<char> outBuf;
+    size_t events = 0;
+    while (in) {
+        size_t rest = inBuf.size();
+        inBuf.resize(rest + blockSize);
+        in.read(inBuf.data() + rest, blockSize);
+        inBuf.resize(rest + in.gcount());
+
+        size_t pos = 0;
+        while (pos < inBuf.size()) {
+            Fei4Event event;
+            size_t used = event.fromBufferCompact(inBuf.data() + pos, inBuf.size() - pos);
+            if (used == 0) break;
+            event.toBuffer(outBuf);
+            pos += used;
+            events++;
+        }
+        out.write(outBuf.data(), outBuf.size());
+        outBuf.clear();
+        inBuf.erase(inBuf.begin(), inBuf.begin() + pos);
+    }
+
+    if (!inBuf.empty()) {
+        std::cout << "#WARNING# " << inBuf.size() << " bytes of a truncated event at the end" << std::endl;
+    }
+    std::cout << "Converted " << events << " events" << std::endl;
+    return 0;
+}
@@ -1,23 +1,252 @@
-#include <string>
+// #################################
+// # Project: Yarr
+// # Description: Redraw stored histograms
+// # Comment: Histogram files are loaded and plotted concurrently, the parsed
+// #          content is cached in a binary file next to each json file
+// ################################
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
 
-#include "Histo2d.h"
 #include "Histo1d.h"
+#include "Histo2d.h"
+#include "TaskScheduler.h"
+#include "storage.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+    /// Cache file: magic, version, type, modification time and size of the
+    /// json file it was made from, then the histogram in binary layout
+    const char cacheMagic[8] = {'Y', 'A', 'R', 'R', 'H', 'S', 'T', '\0'};
+    const uint32_t cacheVersion = 1;
+    const std::string cacheExtension = ".histo";
+
+    struct CacheKey {
+        int64_t mtime;
+        uint64_t size;
+
+        bool operator==(const CacheKey &o) const {return mtime == o.mtime && size == o.size;}
+    };
+
+    enum class Result {Plotted, UpToDate, NoHisto, Failed};
+
+    struct Options {
+        bool force = false;
+        std::string outDir;
+    };
+
+    int64_t toNs(fs::file_time_type t) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    std::unique_ptr<HistogramBase> makeHisto(uint32_t type) {
+        if (type == 1) return std::make_unique<Histo1d>("Temp1", 1, 0.0, 1.0, typeid(void));
+        if (type == 2) return std::make_unique<Histo2d>("Temp2", 1, 0.0, 1.0, 1, 0.0, 1.0, typeid(void));
+        return nullptr;
+    }
+
+    /// Histogram of the cache if it was made from this version of the json file
+    std::unique_ptr<HistogramBase> readCache(const fs::path &path, const CacheKey &key) {
+        std::ifstream file(path, std::ios::binary);
+        char magic[sizeof(cacheMagic)];
+        uint32_t header[2];
+        CacheKey cached;
+        if (!file.read(magic, sizeof(magic)) || memcmp(magic, cacheMagic, sizeof(magic)) != 0
+                || !file.read((char*)header, sizeof(header)) || header[0] != cacheVersion
+                || !file.read((char*)&cached.mtime, sizeof(cached.mtime))
+                || !file.read((char*)&cached.size, sizeof(cached.size))
+                || !(cached == key)) {
+            return nullptr;
+        }
+        std::unique_ptr<HistogramBase> h = makeHisto(header[1]);
+        bool ok = false;
+        if (header[1] == 1) ok = static_cast<Histo1d*>(h.get())->fromFileBinary(file);
+        if (header[1] == 2) ok = static_cast<Histo2d*>(h.get())->fromFileBinary(file);
+        return ok ? std::move(h) : nullptr;
+    }
+
+    /// Written under a temporary name, so concurrent readers never see a partial file
+    void writeCache(const fs::path &path, const CacheKey &key, uint32_t type, const HistogramBase &h) {
+        fs::path tmp = path;
+        tmp += "." + std::to_string(getpid()) + ".tmp";
+        {
+            std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+            if (!file) return;
+            uint32_t header[2] = {cacheVersion, type};
+            file.write(cacheMagic, sizeof(cacheMagic));
+            file.write((const char*)header, sizeof(header));
+            file.write((const char*)&key.mtime, sizeof(key.mtime));
+            file.write((const char*)&key.size, sizeof(key.size));
+            if (type == 1) static_cast<const Histo1d&>(h).toFileBinary(file);
+            if (type == 2) static_cast<const Histo2d&>(h).toFileBinary(file);
+            if (!file) {
+                file.close();
+                std::error_code ec;
+                fs::remove(tmp, ec);
+                return;
+            }
+        }
+        std::error_code ec;
+        fs::rename(tmp, path, ec);
+    }
+
+    /// Parses the json file, type is 0 if it does not hold a histogram
+    std::unique_ptr<HistogramBase> readJson(const fs::path &path, uint32_t &type) {
+        type = 0;
+        std::ifstream file(path);
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        // Configs and logs share the directories, don't parse them
+        bool is1d = text.find("\"Histo1d\"") != std::string::npos;
+        bool is2d = text.find("\"Histo2d\"") != std::string::npos;
+        if (!is1d && !is2d) return nullptr;
+
+        json j;
+        try {
+            j = json::parse(text);
+        } catch (json::parse_error &e) {
+            std::cerr << "#ERROR# Could not parse " << path.string() << ": " << e.what() << std::endl;
+            return nullptr;
+        }
+        if (j["Type"].empty()) return nullptr;
+        std::string t = static_cast<std::string>(j["Type"]);
+        type = (t == "Histo1d") ? 1 : (t == "Histo2d") ? 2 : 0;
+        std::unique_ptr<HistogramBase> h = makeHisto(type);
+        bool ok = false;
+        if (type == 1) ok = static_cast<Histo1d*>(h.get())->fromJson(j);
+        if (type == 2) ok = static_cast<Histo2d*>(h.get())->fromJson(j);
+        if (!ok) type = 0;
+        return ok ? std::move(h) : nullptr;
+    }
+
+    Result replot(const fs::path &path, const Options &opt) {
+        std::error_code ec;
+        CacheKey key = {toNs(fs::last_write_time(path, ec)), fs::file_size(path, ec)};
+        if (ec) {
+            std::cerr << "#ERROR# Could not open " << path.string() << ": " << ec.message() << std::endl;
+            return Result::Failed;
+        }
+
+        fs::path cachePath = path;
+        cachePath.replace_extension(cacheExtension);
+        std::unique_ptr<HistogramBase> h = readCache(cachePath, key);
+        if (!h) {
+            uint32_t type;
+            h = readJson(path, type);
+            if (!h) return Result::NoHisto;
+            writeCache(cachePath, key, type, *h);
+        }
+
+        // Same naming as the plots of the scan: json files are <prefix>_<name>.json
+        std::string stem = path.stem().string();
+        std::string suffix = "_" + h->getName();
+        std::string prefix = stem;
+        if (stem.size() > suffix.size() && stem.compare(stem.size() - suffix.size(), suffix.size(), suffix) == 0)
+            prefix = stem.substr(0, stem.size() - suffix.size());
+        std::string dir = opt.outDir.empty() ? path.parent_path().string() : opt.outDir;
+        if (!dir.empty() && dir.back() != '/') dir += "/";
+
+        std::string ext = dynamic_cast<Histo1d*>(h.get()) ? ".pdf" : ".png";
+        fs::path out = dir + prefix + "_" + h->getName() + ext;
+        if (!opt.force && fs::exists(out, ec) && toNs(fs::last_write_time(out, ec)) >= key.mtime)
+            return Result::UpToDate;
+
+        h->plot(prefix, dir);
+        return fs::exists(out, ec) ? Result::Plotted : Result::Failed;
+    }
+
+    void printHelp(const char *name) {
+        std::cout << "Usage: " << name << " [-f] [-j <threads>] [-o <dir>] <histo.json|directory> ..." << std::endl;
+        std::cout << " Directories are searched for histogram files recursively." << std::endl;
+        std::cout << " -f: Plot all histograms, also if the plot is newer than the json file." << std::endl;
+        std::cout << " -j <threads>: Number of threads. (Default all cores)" << std::endl;
+        std::cout << " -o <dir>: Write plots to dir instead of next to the json file." << std::endl;
+    }
+}
 
 int main(int argc, char*argv[]) {
-	if (argc < 2 || argc > 2) {
-		std::cout << "Usage: " << argv[0] << " <filename>" << std::endl;
-		return -1;
-	}
-	Histo1d h1("Temp1", 1, 0.0, 1.0, typeid(void));
-	Histo2d h2("Temp2", 1, 0.0, 1.0, 1, 0.0, 1.0, typeid(void));
-
-	if(h1.fromFile(std::string(argv[1]))){
-		h1.plot("replot", "./");
-	} else if (h2.fromFile(std::string(argv[1]))) {
-		h2.plot("replot", "./");
-	} else {
-		std::cout << "ABORTING: Could not read as either 1D or 2D histogram for replotting" << std::endl;
-	}
-	return 0;
-}
\ No newline at end of file
+    Options opt;
+    unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+    int c;
+    while ((c = getopt(argc, argv, "hfj:o:")) != -1) {
+        switch (c) {
+            case 'h':
+                printHelp(argv[0]);
+                return 0;
+            case 'f':
+                opt.force = true;
+                break;
+            case 'j':
+                nThreads = std::max(1, atoi(optarg));
+                break;
+            case 'o':
+                opt.outDir = optarg;
+                break;
+            default:
+                printHelp(argv[0]);
+                return -1;
+        }
+    }
+    if (optind >= argc) {
+        printHelp(argv[0]);
+        return -1;
+    }
+
+    std::vector<fs::path> files;
+    for (int i=optind; i<argc; i++) {
+        std::error_code ec;
+        if (fs::is_directory(argv[i], ec)) {
+            for (auto it = fs::recursive_directory_iterator(argv[i], ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (it->is_regular_file(ec) && it->path().extension() == ".json")
+                    files.push_back(it->path());
+            }
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (!opt.outDir.empty()) {
+        std::error_code ec;
+        fs::create_directories(opt.outDir, ec);
+    }
+
+    // The main thread plots as well
+    std::vector<Result> results(files.size());
+    {
+        TaskScheduler pool(std::min<size_t>(nThreads, std::max<size_t>(files.size(), 1)) - 1);
+        pool.parallelFor(0, files.size(), 1, [&](size_t first, size_t last) {
+            for (size_t i=first; i<last; i++) results[i] = replot(files[i], opt);
+        });
+    }
+
+    unsigned count[4] = {0, 0, 0, 0};
+    for (Result r : results) {
+        count[(int)r]++;
+    }
+    std::cout << "Plotted " << count[(int)Result::Plotted] << ", up to date "
+              << count[(int)Result::UpToDate] << ", failed " << count[(int)Result::Failed];
+    if (count[(int)Result::NoHisto])
+        std::cout << ", not a histogram " << count[(int)Result::NoHisto];
+    std::cout << std::endl;
+
+    // A single file which is not a histogram is an error, as before
+    if (files.size() == 1 && count[(int)Result::NoHisto]) {
+        std::cout << "ABORTING: Could not read as either 1D or 2D histogram for replotting" << std::endl;
+        return -1;
+    }
+    return count[(int)Result::Failed] ? -1 : 0;
+}
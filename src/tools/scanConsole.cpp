@@ -15,6 +15,7 @@
 #include <vector>
 #include <iomanip>
 #include <map>
+#include <algorithm>
 #include <sstream>
 
 #include "logging.h"
@@ -32,6 +33,9 @@
 #include "AllStdActions.h"
 
 #include "Bookkeeper.h"
+#include "ChipStateCache.h"
+#include "RawDataRecorder.h"
+#include "ResultWriter.h"
 
 // For masking
 #include "Fei4.h"
@@ -59,6 +63,16 @@ void listKnown();
 
 std::unique_ptr<ScanBase> buildScan( const std::string& scanType, Bookkeeper& bookie );
 
+/// One scan of a sequence, or the scan of the command line
+struct ScanStep {
+    std::string scanType;
+    int target_charge;
+    int target_tot;
+    int mask_opt;
+};
+
+std::vector<ScanStep> loadSequence(const std::string &path, const ScanStep &defaults);
+
 static std::string getHostname() {
   std::string hostname = "default_host";
   if (getenv("HOSTNAME")) {
@@ -103,10 +117,12 @@ int main(int argc, char *argv[]) {
 
     // Init parameters
     std::string scanType = "";
+    std::string sequencePath = "";
     std::vector<std::string> cConfigPaths;
     std::string outputDir = "./data/";
     std::string ctrlCfgPath = "";
     bool doPlots = false;
+    bool doRecord = false;
     int target_charge = -1;
     int target_tot = -1;
     int mask_opt = -1;
@@ -120,7 +136,7 @@ int main(int argc, char *argv[]) {
     
     int nThreads = 4;
     int c;
-    while ((c = getopt(argc, argv, "hn:ks:n:m:g:r:c:t:po:Wd:u:i:l:")) != -1) {
+    while ((c = getopt(argc, argv, "hn:ks:S:n:m:g:r:c:t:pRFo:Wd:u:i:l:")) != -1) {
         int count = 0;
         switch (c) {
             case 'h':
@@ -136,6 +152,9 @@ int main(int argc, char *argv[]) {
             case 's':
                 scanType = std::string(optarg);
                 break;
+            case 'S':
+                sequencePath = std::string(optarg);
+                break;
             case 'm':
                 mask_opt = atoi(optarg);
                 break;
@@ -153,6 +172,12 @@ int main(int argc, char *argv[]) {
             case 'p':
                 doPlots = true;
                 break;
+            case 'R':
+                doRecord = true;
+                break;
+            case 'F':
+                ChipStateCache::setForceFull(true);
+                break;
             case 'o':
                 outputDir = std::string(optarg);
                 if (outputDir.back() != '/')
@@ -221,80 +246,102 @@ int main(int argc, char *argv[]) {
     }
     // Can use actual logger now
 
-    unsigned runCounter = ScanHelper::newRunCounter();
-
     if (cConfigPaths.size() == 0) {
         logger->error("Error: no config files given, please specify config file name under -c option, even if file does not exist!");
         return -1;
     }
 
-    std::size_t pathPos = scanType.find_last_of('/');
-    std::size_t suffixPos = scanType.find_last_of('.');
-    std::string strippedScan;
-    if (pathPos != std::string::npos && suffixPos != std::string::npos) {
-        strippedScan = scanType.substr(pathPos+1, suffixPos-pathPos-1);
+    // A single scan, or all scans of the sequence with hardware and chips kept in between
+    std::vector<ScanStep> steps;
+    ScanStep cmdLineStep = {scanType, target_charge, target_tot, mask_opt};
+    if (!sequencePath.empty()) {
+        try {
+            steps = loadSequence(sequencePath, cmdLineStep);
+        } catch (std::runtime_error &e) {
+            logger->critical("Error opening scan sequence: {}", e.what());
+            return -1;
+        }
+        logger->info("Scan sequence {} with {} scans", sequencePath, steps.size());
     } else {
-        strippedScan = scanType;
+        steps.push_back(cmdLineStep);
     }
 
     std::string dataDir = outputDir;
-    outputDir += (toString(runCounter, 6) + "_" + strippedScan + "/");
+    std::string commandLineStr= "";
+    for (int i=1;i<argc;i++) commandLineStr.append(std::string(argv[i]).append(" "));
 
-    logger->info("Scan Type/Config {}", scanType);
+    // Run number, output directory and scan log of a scan
+    unsigned runCounter = 0;
+    std::string strippedScan;
+    json scanLog;
+    std::time_t now;
+    auto startStep = [&](const ScanStep &step) {
+        runCounter = ScanHelper::newRunCounter();
+        scanType = step.scanType;
+
+        std::size_t pathPos = scanType.find_last_of('/');
+        std::size_t suffixPos = scanType.find_last_of('.');
+        if (pathPos != std::string::npos && suffixPos != std::string::npos) {
+            strippedScan = scanType.substr(pathPos+1, suffixPos-pathPos-1);
+        } else {
+            strippedScan = scanType;
+        }
 
-    logger->info("Connectivity:");
-    for(std::string const& sTmp : cConfigPaths){
-        logger->info("    {}", sTmp);
-    }
-    logger->info("Target ToT: {}", target_tot);
-    logger->info("Target Charge: {}", target_charge);
-    logger->info("Output Plots: {}", doPlots);
-    logger->info("Output Directory: {}", outputDir);
-
-    // Create folder
-    //for some reason, 'make' issues that mkdir is an undefined reference
-    //a test program on another machine has worked fine
-    //a test program on this machine has also worked fine
-    //    int mDExSt = mkdir(outputDir.c_str(), 0777); //mkdir exit status
-    //    mode_t myMode = 0777;
-    //    int mDExSt = mkdir(outputDir.c_str(), myMode); //mkdir exit status
-    std::string cmdStr = "mkdir -p "; //I am not proud of this ):
-    cmdStr += outputDir;
-    int sysExSt = system(cmdStr.c_str());
-    if(sysExSt != 0){
-        logger->error("Error creating output directory - plots might not be saved!");
-    }
-    //read errno variable and catch some errors, if necessary
-    //errno=1 is permission denied, errno = 17 is dir already exists, ...
-    //see /usr/include/asm-generic/errno-base.h and [...]/errno.h for all codes
-
-    // Make symlink
-    cmdStr = "rm -f " + dataDir + "last_scan && ln -s " + toString(runCounter, 6) + "_" + strippedScan + " " + dataDir + "last_scan";
-    sysExSt = system(cmdStr.c_str());
-    if(sysExSt != 0){
-        logger->error("Error creating symlink to output directory!");
-    }
+        outputDir = dataDir + (toString(runCounter, 6) + "_" + strippedScan + "/");
 
-    // Timestamp
-    std::time_t now = std::time(NULL);
-    struct tm *lt = std::localtime(&now);
-    char timestamp[20];
-    strftime(timestamp, 20, "%F_%H:%M:%S", lt);
-    logger->info("Timestamp: {}", timestamp);
-    logger->info("Run Number: {}", runCounter);
+        logger->info("Scan Type/Config {}", scanType);
 
-    std::string commandLineStr= "";
-    for (int i=1;i<argc;i++) commandLineStr.append(std::string(argv[i]).append(" "));
+        logger->info("Connectivity:");
+        for(std::string const& sTmp : cConfigPaths){
+            logger->info("    {}", sTmp);
+        }
+        logger->info("Target ToT: {}", step.target_tot);
+        logger->info("Target Charge: {}", step.target_charge);
+        logger->info("Output Plots: {}", doPlots);
+        logger->info("Output Directory: {}", outputDir);
+
+        // Create folder
+        //for some reason, 'make' issues that mkdir is an undefined reference
+        //a test program on another machine has worked fine
+        //a test program on this machine has also worked fine
+        //    int mDExSt = mkdir(outputDir.c_str(), 0777); //mkdir exit status
+        //    mode_t myMode = 0777;
+        //    int mDExSt = mkdir(outputDir.c_str(), myMode); //mkdir exit status
+        std::string cmdStr = "mkdir -p "; //I am not proud of this ):
+        cmdStr += outputDir;
+        int sysExSt = system(cmdStr.c_str());
+        if(sysExSt != 0){
+            logger->error("Error creating output directory - plots might not be saved!");
+        }
+        //read errno variable and catch some errors, if necessary
+        //errno=1 is permission denied, errno = 17 is dir already exists, ...
+        //see /usr/include/asm-generic/errno-base.h and [...]/errno.h for all codes
+
+        // Make symlink
+        cmdStr = "rm -f " + dataDir + "last_scan && ln -s " + toString(runCounter, 6) + "_" + strippedScan + " " + dataDir + "last_scan";
+        sysExSt = system(cmdStr.c_str());
+        if(sysExSt != 0){
+            logger->error("Error creating symlink to output directory!");
+        }
 
-    json scanLog;
-    // Add to scan log
-    scanLog["exec"] = commandLineStr;
-    scanLog["timestamp"] = std::string(timestamp);
-    scanLog["startTime"] = (int)now;
-    scanLog["runNumber"] = runCounter;
-    scanLog["targetCharge"] = target_charge;
-    scanLog["targetTot"] = target_tot;
-    scanLog["testType"] = strippedScan;
+        // Timestamp
+        now = std::time(NULL);
+        struct tm *lt = std::localtime(&now);
+        char timestamp[20];
+        strftime(timestamp, 20, "%F_%H:%M:%S", lt);
+        logger->info("Timestamp: {}", timestamp);
+        logger->info("Run Number: {}", runCounter);
+
+        // Add to scan log
+        scanLog["exec"] = commandLineStr;
+        scanLog["timestamp"] = std::string(timestamp);
+        scanLog["startTime"] = (int)now;
+        scanLog["runNumber"] = runCounter;
+        scanLog["targetCharge"] = step.target_charge;
+        scanLog["targetTot"] = step.target_tot;
+        scanLog["testType"] = strippedScan;
+    };
+    startStep(steps[0]);
 
     // Initial setting local DBHandler
     DBHandler *database = new DBHandler();
@@ -343,9 +390,6 @@ int main(int argc, char *argv[]) {
 
     std::map<FrontEnd*, std::string> feCfgMap;
 
-    bookie.setTargetTot(target_tot);
-    bookie.setTargetCharge(target_charge);
-
     logger->info("\033[1;31m#######################\033[0m");
     logger->info("\033[1;31m##  Loading Configs  ##\033[0m");
     logger->info("\033[1;31m#######################\033[0m");
@@ -373,292 +417,349 @@ int main(int argc, char *argv[]) {
         database->setConnCfg(cConfigPaths);
     }
 
-    // Reset masks
-    if (mask_opt == 1) {
-        for (FrontEnd* fe : bookie.feList) {
-            // TODO make mask generic?
-            if (chipType == "FEI4B") {
-                auto fei4 = dynamic_cast<Fei4*>(fe);
-                logger->info("Resetting enable/hitbus pixel mask to all enabled!");
-                for (unsigned int dc = 0; dc < fei4->n_DC; dc++) {
-                    fei4->En(dc).setAll(1);
-                    fei4->Hitbus(dc).setAll(0);
+    bookie.initGlobalFe(StdDict::getFrontEnd(chipType).release());
+    // Star sends the broadcast ID on makeGlobal, the controller has to be set first
+    bookie.getGlobalFe()->init(&*hwCtrl, 0, 0);
+    bookie.getGlobalFe()->makeGlobal();
+
+    for (unsigned stepIndex=0; stepIndex<steps.size(); stepIndex++) {
+        const ScanStep &step = steps[stepIndex];
+        if (stepIndex > 0) {
+            logger->info("\033[1;31m#################\033[0m");
+            logger->info("\033[1;31m# Next scan {}/{} #\033[0m", stepIndex+1, steps.size());
+            logger->info("\033[1;31m#################\033[0m");
+            startStep(step);
+            hwCtrl->setupMode();
+            hwCtrl->setTrigEnable(0);
+            bookie.resetClipBoards();
+
+            // The configs are taken over in memory from the previous scan
+            for (FrontEnd* fe : bookie.feList) {
+                if (fe->isActive()) {
+                    auto feCfg = dynamic_cast<FrontEndCfg*>(fe);
+                    std::ofstream backupCfgFile(outputDir + feCfg->getConfigFile() + ".before");
+                    backupCfgFile << ScanHelper::dumpChipConfig(feCfg);
                 }
-            } else if (chipType == "RD53A") {
-                auto rd53a = dynamic_cast<Rd53a*>(fe);
-                logger->info("Resetting enable/hitbus pixel mask to all enabled!");
-                for (unsigned int col = 0; col < rd53a->n_Col; col++) {
-                    for (unsigned row = 0; row < rd53a->n_Row; row ++) {
-                        rd53a->setEn(col, row, 1);
-                        rd53a->setHitbus(col, row, 1);
+            }
+        }
+
+        bookie.setTargetTot(step.target_tot);
+        bookie.setTargetCharge(step.target_charge);
+
+        // Reset masks
+        if (step.mask_opt == 1) {
+            for (FrontEnd* fe : bookie.feList) {
+                // TODO make mask generic?
+                if (chipType == "FEI4B") {
+                    auto fei4 = dynamic_cast<Fei4*>(fe);
+                    logger->info("Resetting enable/hitbus pixel mask to all enabled!");
+                    for (unsigned int dc = 0; dc < fei4->n_DC; dc++) {
+                        fei4->En(dc).setAll(1);
+                        fei4->Hitbus(dc).setAll(0);
+                    }
+                } else if (chipType == "RD53A") {
+                    auto rd53a = dynamic_cast<Rd53a*>(fe);
+                    logger->info("Resetting enable/hitbus pixel mask to all enabled!");
+                    for (unsigned int col = 0; col < rd53a->n_Col; col++) {
+                        for (unsigned row = 0; row < rd53a->n_Row; row ++) {
+                            rd53a->setEn(col, row, 1);
+                            rd53a->setHitbus(col, row, 1);
+                        }
                     }
                 }
             }
+            // TODO add FE65p2
         }
-        // TODO add FE65p2
-    }
 
-    bookie.initGlobalFe(StdDict::getFrontEnd(chipType).release());
-    bookie.getGlobalFe()->makeGlobal();
-    bookie.getGlobalFe()->init(&*hwCtrl, 0, 0);
-
-    logger->info("\033[1;31m#################\033[0m");
-    logger->info("\033[1;31m# Configure FEs #\033[0m");
-    logger->info("\033[1;31m#################\033[0m");
+        logger->info("\033[1;31m#################\033[0m");
+        logger->info("\033[1;31m# Configure FEs #\033[0m");
+        logger->info("\033[1;31m#################\033[0m");
 
-    std::chrono::steady_clock::time_point cfg_start = std::chrono::steady_clock::now();
-    for ( FrontEnd* fe : bookie.feList ) {
-        auto feCfg = dynamic_cast<FrontEndCfg*>(fe);
-        logger->info("Configuring {}", feCfg->getName());
-        // Select correct channel
-        hwCtrl->setCmdEnable(feCfg->getTxChannel());
-        // Configure
-        fe->configure();
-        // Wait for fifo to be empty
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
-        while(!hwCtrl->isCmdEmpty());
-    }
-    std::chrono::steady_clock::time_point cfg_end = std::chrono::steady_clock::now();
-    logger->info("All FEs configured in {} ms!",
-                 std::chrono::duration_cast<std::chrono::milliseconds>(cfg_end-cfg_start).count());
+        std::chrono::steady_clock::time_point cfg_start = std::chrono::steady_clock::now();
+        for ( FrontEnd* fe : bookie.feList ) {
+            auto feCfg = dynamic_cast<FrontEndCfg*>(fe);
+            logger->info("Configuring {}", feCfg->getName());
+            // Select correct channel
+            hwCtrl->setCmdEnable(feCfg->getTxChannel());
+            // Configure
+            fe->configure();
+            // Wait for fifo to be empty
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            while(!hwCtrl->isCmdEmpty());
+        }
+        std::chrono::steady_clock::time_point cfg_end = std::chrono::steady_clock::now();
+        logger->info("All FEs configured in {} ms!",
+                     std::chrono::duration_cast<std::chrono::milliseconds>(cfg_end-cfg_start).count());
     
-    // Wait for rx to sync with FE stream
-    // TODO Check RX sync
-    std::this_thread::sleep_for(std::chrono::microseconds(1000));
-    hwCtrl->flushBuffer();
-    for ( FrontEnd* fe : bookie.feList ) {
-        auto feCfg = dynamic_cast<FrontEndCfg*>(fe);
-        logger->info("Checking com {}", feCfg->getName());
-        // Select correct channel
-        hwCtrl->setCmdEnable(feCfg->getTxChannel());
-        hwCtrl->setRxEnable(feCfg->getRxChannel());
-        // Configure
-        if (fe->checkCom() != 1) {
-            logger->critical("Can't establish communication, aborting!");
-            return -1;
+        // Wait for rx to sync with FE stream
+        // TODO Check RX sync
+        std::this_thread::sleep_for(std::chrono::microseconds(1000));
+        hwCtrl->flushBuffer();
+        for ( FrontEnd* fe : bookie.feList ) {
+            auto feCfg = dynamic_cast<FrontEndCfg*>(fe);
+            if (!hwCtrl->hasFrontEnds()) {
+                logger->info("Not checking com {}, no front-ends behind the controller", feCfg->getName());
+                continue;
+            }
+            logger->info("Checking com {}", feCfg->getName());
+            // Select correct channel
+            hwCtrl->setCmdEnable(feCfg->getTxChannel());
+            hwCtrl->setRxEnable(feCfg->getRxChannel());
+            // Configure
+            if (fe->checkCom() != 1) {
+                logger->critical("Can't establish communication, aborting!");
+                return -1;
+            }
+            logger->info("... success!");
         }
-        logger->info("... success!");
-    }
-
-    // Enable all active channels
-    logger->info("Enabling Tx channels");
-    hwCtrl->setCmdEnable(bookie.getTxMask());
-    for (uint32_t channel : bookie.getTxMask()) {
-        logger->info("Enabling Tx channel {}", channel);
-    }
-    logger->info("Enabling Rx channels");
-    hwCtrl->setRxEnable(bookie.getRxMask());
-    for (uint32_t channel : bookie.getRxMask()) {
-        logger->info("Enabling Rx channel {}", channel);
-    }
-
-    hwCtrl->runMode();
 
-    logger->info("\033[1;31m##############\033[0m");
-    logger->info("\033[1;31m# Setup Scan #\033[0m");
-    logger->info("\033[1;31m##############\033[0m");
+        // Enable all active channels
+        logger->info("Enabling Tx channels");
+        hwCtrl->setCmdEnable(bookie.getTxMask());
+        for (uint32_t channel : bookie.getTxMask()) {
+            logger->info("Enabling Tx channel {}", channel);
+        }
+        logger->info("Enabling Rx channels");
+        hwCtrl->setRxEnable(bookie.getRxMask());
+        for (uint32_t channel : bookie.getRxMask()) {
+            logger->info("Enabling Rx channel {}", channel);
+        }
 
-    // Make backup of scan config
+        hwCtrl->runMode();
 
-    // Create backup of current config
-    if (scanType.find("json") != std::string::npos) {
-        // TODO fix folder
-        std::ifstream cfgFile(scanType);
-        std::ofstream backupCfgFile(outputDir + strippedScan + ".json");
-        backupCfgFile << cfgFile.rdbuf();
-        backupCfgFile.close();
-        cfgFile.close();
-    }
+        logger->info("\033[1;31m##############\033[0m");
+        logger->info("\033[1;31m# Setup Scan #\033[0m");
+        logger->info("\033[1;31m##############\033[0m");
 
-    // TODO Make this nice
-    std::unique_ptr<ScanBase> s;
-    try {
-        s = buildScan(scanType, bookie );
-    } catch (const char *msg) {
-        logger->warn("No scan to run, exiting with msg: {}", msg);
-        return 0;
-    }
+        // Make backup of scan config
 
-    // Use the abstract class instead of concrete -- in the future, this will be useful...
-    std::map<FrontEnd*, std::unique_ptr<DataProcessor> > histogrammers;
-    std::map<FrontEnd*, std::unique_ptr<DataProcessor> > analyses;
+        // Create backup of current config
+        if (scanType.find("json") != std::string::npos) {
+            // TODO fix folder
+            std::ifstream cfgFile(scanType);
+            std::ofstream backupCfgFile(outputDir + strippedScan + ".json");
+            backupCfgFile << cfgFile.rdbuf();
+            backupCfgFile.close();
+            cfgFile.close();
+        }
 
-    // TODO not to use the raw pointer!
-    ScanHelper::buildHistogrammers( histogrammers, scanType, bookie.feList, s.get(), outputDir);
-    ScanHelper::buildAnalyses( analyses, scanType, bookie, s.get(), mask_opt);
+        // TODO Make this nice
+        std::unique_ptr<ScanBase> s;
+        try {
+            s = buildScan(scanType, bookie );
+        } catch (const char *msg) {
+            logger->warn("No scan to run, exiting with msg: {}", msg);
+            return 0;
+        }
 
-    logger->info("Running pre scan!");
-    s->init();
-    s->preScan();
+        // Use the abstract class instead of concrete -- in the future, this will be useful...
+        std::map<FrontEnd*, std::unique_ptr<DataProcessor> > histogrammers;
+        std::map<FrontEnd*, std::unique_ptr<DataProcessor> > analyses;
+
+        // TODO not to use the raw pointer!
+        ScanHelper::buildHistogrammers( histogrammers, scanType, bookie.feList, s.get(), outputDir);
+        ScanHelper::buildAnalyses( analyses, scanType, bookie, s.get(), step.mask_opt);
+
+        logger->info("Running pre scan!");
+        s->init();
+        s->preScan();
+
+        // Results are written and plotted while the scan is running
+        std::unique_ptr<ResultWriter> writer;
+        if (doPlots||dbUse) {
+            unsigned nWriters = std::max(1u, std::thread::hardware_concurrency());
+            writer.reset(new ResultWriter(outputDir, nWriters));
+            for ( FrontEnd* fe : bookie.feList ) {
+                if (fe->isActive()) {
+                    writer->addOutput(dynamic_cast<FrontEndCfg*>(fe)->getName(), fe->clipResult);
+                }
+            }
+            writer->run();
+        }
 
-    // Run from downstream to upstream
-    logger->info("Starting histogrammer and analysis threads:");
-    for ( FrontEnd* fe : bookie.feList ) {
-        if (fe->isActive()) {
-          analyses[fe]->init();
-          analyses[fe]->run();
+        // Run from downstream to upstream
+        logger->info("Starting histogrammer and analysis threads:");
+        for ( FrontEnd* fe : bookie.feList ) {
+            if (fe->isActive()) {
+              analyses[fe]->init();
+              analyses[fe]->run();
 
-          histogrammers[fe]->init();
-          histogrammers[fe]->run();
+              histogrammers[fe]->init();
+              histogrammers[fe]->run();
           
-          logger->info(" .. started threads of Fe {}", dynamic_cast<FrontEndCfg*>(fe)->getRxChannel());
+              logger->info(" .. started threads of Fe {}", dynamic_cast<FrontEndCfg*>(fe)->getRxChannel());
+            }
         }
-    }
 
-    std::shared_ptr<DataProcessor> proc = StdDict::getDataProcessor(chipType);
-    //Fei4DataProcessor proc(bookie.globalFe<Fei4>()->getValue(&Fei4::HitDiscCnfg));
-    proc->connect( &bookie.rawData, &bookie.eventMap );
-    if(nThreads>0) proc->setThreads(nThreads); // override number of used threads
-    proc->init();
-    proc->run();
+        std::shared_ptr<DataProcessor> proc = StdDict::getDataProcessor(chipType);
+        //Fei4DataProcessor proc(bookie.globalFe<Fei4>()->getValue(&Fei4::HitDiscCnfg));
+        // The recorder taps the raw data on its way to the processor
+        std::unique_ptr<RawDataRecorder> recorder;
+        ClipBoard<RawDataContainer> recordedData;
+        if (doRecord) {
+            try {
+                recorder.reset(new RawDataRecorder(outputDir + "rawdata.raw", true));
+            } catch (std::runtime_error &e) {
+                logger->error("Not recording raw data: {}", e.what());
+            }
+        }
+        if (recorder) {
+            recorder->connect(&bookie.rawData, &recordedData);
+            recorder->run();
+            proc->connect( &recordedData, &bookie.eventMap );
+        } else {
+            proc->connect( &bookie.rawData, &bookie.eventMap );
+        }
+        if(nThreads>0) proc->setThreads(nThreads); // override number of used threads
+        proc->init();
+        proc->run();
 
-    // Now the all downstream processors are ready --> Run scan
+        // Now the all downstream processors are ready --> Run scan
 
-    logger->info("\033[1;31m########\033[0m");
-    logger->info("\033[1;31m# Scan #\033[0m");
-    logger->info("\033[1;31m########\033[0m");
+        logger->info("\033[1;31m########\033[0m");
+        logger->info("\033[1;31m# Scan #\033[0m");
+        logger->info("\033[1;31m########\033[0m");
 
-    logger->info("Starting scan!");
-    std::chrono::steady_clock::time_point scan_start = std::chrono::steady_clock::now();
-    s->run();
-    s->postScan();
-    logger->info("Scan done!");
+        logger->info("Starting scan!");
+        std::chrono::steady_clock::time_point scan_start = std::chrono::steady_clock::now();
+        s->run();
+        s->postScan();
+        logger->info("Scan done!");
 
-    // Join from upstream to downstream.
+        // Join from upstream to downstream.
 
-    bookie.rawData.finish();
+        bookie.rawData.finish();
+        if (recorder) recorder->join();
 
-    std::chrono::steady_clock::time_point scan_done = std::chrono::steady_clock::now();
-    logger->info("Waiting for processors to finish ...");
-    // Join Fei4DataProcessor
-    proc->join();
-    std::chrono::steady_clock::time_point processor_done = std::chrono::steady_clock::now();
-    logger->info("Processor done, waiting for histogrammer ...");
+        std::chrono::steady_clock::time_point scan_done = std::chrono::steady_clock::now();
+        logger->info("Waiting for processors to finish ...");
+        // Join Fei4DataProcessor
+        proc->join();
+        std::chrono::steady_clock::time_point processor_done = std::chrono::steady_clock::now();
+        logger->info("Processor done, waiting for histogrammer ...");
     
-    for (unsigned i=0; i<bookie.feList.size(); i++) {
-        FrontEnd *fe = bookie.feList[i];
-        if (fe->isActive()) {
-          fe->clipData->finish();
+        for (unsigned i=0; i<bookie.feList.size(); i++) {
+            FrontEnd *fe = bookie.feList[i];
+            if (fe->isActive()) {
+              fe->clipData->finish();
+            }
         }
-    }
 
-    // Join histogrammers
-    for( auto& histogrammer : histogrammers ) {
-      histogrammer.second->join();
-    }
+        // Join histogrammers
+        for( auto& histogrammer : histogrammers ) {
+          histogrammer.second->join();
+        }
     
-    logger->info("Processor done, waiting for analysis ...");
+        logger->info("Processor done, waiting for analysis ...");
     
-    for (unsigned i=0; i<bookie.feList.size(); i++) {
-        FrontEnd *fe = bookie.feList[i];
-        if (fe->isActive()) {
-          fe->clipHisto->finish();
+        for (unsigned i=0; i<bookie.feList.size(); i++) {
+            FrontEnd *fe = bookie.feList[i];
+            if (fe->isActive()) {
+              fe->clipHisto->finish();
+            }
         }
-    }
-
-    // Join analyses
-    for( auto& ana : analyses ) {
-      ana.second->join();
-    }
-
-    std::chrono::steady_clock::time_point all_done = std::chrono::steady_clock::now();
-    logger->info("All done!");
-
-    // Joining is done.
-
-    hwCtrl->disableCmd();
-    hwCtrl->disableRx();
 
-    logger->info("\033[1;31m##########\033[0m");
-    logger->info("\033[1;31m# Timing #\033[0m");
-    logger->info("\033[1;31m##########\033[0m");
+        // Join analyses
+        for( auto& ana : analyses ) {
+          ana.second->join();
+        }
 
-    logger->info("-> Configuration: {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(cfg_end-cfg_start).count());
-    logger->info("-> Scan:          {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(scan_done-scan_start).count());
-    logger->info("-> Processing:    {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(processor_done-scan_done).count());
-    logger->info("-> Analysis:      {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(all_done-processor_done).count());
+        for (unsigned i=0; i<bookie.feList.size(); i++) {
+            FrontEnd *fe = bookie.feList[i];
+            if (fe->isActive()) {
+              fe->clipResult->finish();
+            }
+        }
 
-    scanLog["stopwatch"]["config"] = (uint32_t) std::chrono::duration_cast<std::chrono::milliseconds>(cfg_end-cfg_start).count();
-    scanLog["stopwatch"]["scan"] = (uint32_t) std::chrono::duration_cast<std::chrono::milliseconds>(scan_done-scan_start).count();
-    scanLog["stopwatch"]["processing"] = (uint32_t) std::chrono::duration_cast<std::chrono::milliseconds>(processor_done-scan_done).count();
-    scanLog["stopwatch"]["analysis"] = (uint32_t) std::chrono::duration_cast<std::chrono::milliseconds>(all_done-processor_done).count();
+        std::chrono::steady_clock::time_point all_done = std::chrono::steady_clock::now();
+        logger->info("All done!");
 
-    logger->info("\033[1;31m###########\033[0m");
-    logger->info("\033[1;31m# Cleanup #\033[0m");
-    logger->info("\033[1;31m###########\033[0m");
+        // Joining is done.
 
-    // Call constructor (eg shutdown Emu threads)
-    hwCtrl.reset();
-
-    // Save scan log
-    now = std::time(NULL);
-    scanLog["finishTime"] = (int)now;
-    std::ofstream scanLogFile(outputDir + "scanLog.json");
-    scanLogFile << std::setw(4) << scanLog;
-    scanLogFile.close();
+        hwCtrl->disableCmd();
+        hwCtrl->disableRx();
 
-    // Need this folder to plot
-    if (system("mkdir -p /tmp/$USER") < 0) {
-        logger->error("Problem creating /tmp/$USER folder. Plots might work.");
-    }
+        logger->info("\033[1;31m##########\033[0m");
+        logger->info("\033[1;31m# Timing #\033[0m");
+        logger->info("\033[1;31m##########\033[0m");
 
-    // Cleanup
-    //delete s;
-    for (unsigned i=0; i<bookie.feList.size(); i++) {
-        FrontEnd *fe = bookie.feList[i];
-        if (fe->isActive()) {
-            auto feCfg = dynamic_cast<FrontEndCfg*>(fe);
+        logger->info("-> Configuration: {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(cfg_end-cfg_start).count());
+        logger->info("-> Scan:          {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(scan_done-scan_start).count());
+        logger->info("-> Processing:    {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(processor_done-scan_done).count());
+        logger->info("-> Analysis:      {} ms", std::chrono::duration_cast<std::chrono::milliseconds>(all_done-processor_done).count());
 
-            // Save config
-            if (!feCfg->isLocked()) {
-                logger->info("Saving config of FE {} to {}",
-                             feCfg->getName(), feCfgMap.at(fe));
-                json jTmp;
-                feCfg->toFileJson(jTmp);
-                std::ofstream oFTmp(feCfgMap.at(fe));
-                oFTmp << std::setw(4) << jTmp;
-                oFTmp.close();
-            } else {
-                logger->warn("Not saving config for FE {} as it is protected!", feCfg->getName());
-            }
+        scanLog["stopwatch"]["config"] = (uint32_t) std::chrono::duration_cast<std::chrono::milliseconds>(cfg_end-cfg_start).count();
+        scanLog["stopwatch"]["scan"] = (uint32_t) std::chrono::duration_cast<std::chrono::milliseconds>(scan_done-scan_start).count();
+        scanLog["stopwatch"]["processing"] = (uint32_t) std::chrono::duration_cast<std::chrono::milliseconds>(processor_done-scan_done).count();
+        scanLog["stopwatch"]["analysis"] = (uint32_t) std::chrono::duration_cast<std::chrono::milliseconds>(all_done-processor_done).count();
 
-            // Save extra config in data folder
-            std::ofstream backupCfgFile(outputDir + feCfg->getConfigFile() + ".after");
-            json backupCfg;
-            feCfg->toFileJson(backupCfg);
-            backupCfgFile << std::setw(4) << backupCfg;
-            backupCfgFile.close();
+        logger->info("\033[1;31m###########\033[0m");
+        logger->info("\033[1;31m# Cleanup #\033[0m");
+        logger->info("\033[1;31m###########\033[0m");
 
-            // Plot
-            if (doPlots||dbUse) {
-                logger->info("-> Plotting histograms of FE {}", feCfg->getRxChannel());
-                std::string outputDirTmp = outputDir;
+        // Save scan log
+        now = std::time(NULL);
+        scanLog["finishTime"] = (int)now;
+        std::ofstream scanLogFile(outputDir + "scanLog.json");
+        scanLogFile << std::setw(4) << scanLog;
+        scanLogFile.close();
 
-                auto &output = *fe->clipResult;
-                std::string name = feCfg->getName();
+        if (writer) {
+            logger->info("Waiting for output of results ...");
+            writer->join();
+        }
 
-                if (output.empty()) {
-                    logger->warn("There were no results for chip {}, this usually means that the chip did not send any data at all.", name);
+        // Cleanup
+        //delete s;
+        for (unsigned i=0; i<bookie.feList.size(); i++) {
+            FrontEnd *fe = bookie.feList[i];
+            if (fe->isActive()) {
+                auto feCfg = dynamic_cast<FrontEndCfg*>(fe);
+
+                // Save config
+                std::string cfgText;
+                if (!feCfg->isLocked()) {
+                    logger->info("Saving config of FE {} to {}",
+                                 feCfg->getName(), feCfgMap.at(fe));
+                    cfgText = ScanHelper::saveChipConfig(feCfg, feCfgMap.at(fe));
                 } else {
-                    while(!output.empty()) {
-                        std::unique_ptr<HistogramBase> histo = output.popData();
-                        histo->plot(name, outputDirTmp);
-                        histo->toFile(name, outputDir);
+                    logger->warn("Not saving config for FE {} as it is protected!", feCfg->getName());
+                    cfgText = ScanHelper::dumpChipConfig(feCfg);
+                }
+
+                // Save extra config in data folder
+                std::ofstream backupCfgFile(outputDir + feCfg->getConfigFile() + ".after");
+                backupCfgFile << cfgText;
+                backupCfgFile.close();
+
+                // Plots were written by the result writer
+                if (writer) {
+                    std::string name = feCfg->getName();
+                    unsigned count = writer->getCount(name);
+                    if (count == 0) {
+                        logger->warn("There were no results for chip {}, this usually means that the chip did not send any data at all.", name);
+                    } else {
+                        logger->info("-> Wrote {} results of FE {}", count, feCfg->getRxChannel());
                     }
                 }
             }
         }
-    }
-    std::string lsCmd = "ls -1 " + dataDir + "last_scan/*.p*";
-    logger->info("Finishing run: {}", runCounter);
-    if(doPlots && (system(lsCmd.c_str()) < 0)) {
-        logger->info("Find plots in: {}last_scan", dataDir);
-    }
+        std::string lsCmd = "ls -1 " + dataDir + "last_scan/*.p*";
+        logger->info("Finishing run: {}", runCounter);
+        if(doPlots && (system(lsCmd.c_str()) < 0)) {
+            logger->info("Find plots in: {}last_scan", dataDir);
+        }
+
+        // Register test info into database
+        if (dbUse) {
+            database->cleanUp("scan", outputDir);
+        }
 
-    // Register test info into database
-    if (dbUse) {
-        database->cleanUp("scan", outputDir);
     }
+
+    // Call constructor (eg shutdown Emu threads)
+    hwCtrl.reset();
+
     delete database;
 
     return 0;
@@ -673,12 +774,15 @@ void printHelp() {
     std::cout << " -h: Shows this." << std::endl;
     std::cout << " -n <threads> : Set number of processing threads." << std::endl;
     std::cout << " -s <scan_type> : Scan config" << std::endl;
+    std::cout << " -S <sequence.json> : Run a sequence of scans, keeping hardware and chip configs in memory between them." << std::endl;
     //std::cout << " -n: Provide SPECboard number." << std::endl;
     //std::cout << " -g <cfg_list.txt>: Provide list of chip configurations." << std::endl;
     std::cout << " -c <connectivity.json> [<cfg2.json> ...]: Provide connectivity configuration, can take multiple arguments." << std::endl;
     std::cout << " -r <ctrl.json> Provide controller configuration." << std::endl;
     std::cout << " -t <target_charge> [<tot_target>] : Set target values for threshold/charge (and tot)." << std::endl;
     std::cout << " -p: Enable plotting of results." << std::endl;
+    std::cout << " -R: Record the raw data stream for replay." << std::endl;
+    std::cout << " -F: Write the full chip configuration, not only what changed since the last scan." << std::endl;
     std::cout << " -o <dir> : Output directory. (Default ./data/)" << std::endl;
     std::cout << " -m <int> : 0 = pixel masking disabled, 1 = start with fresh pixel mask, default = pixel masking enabled" << std::endl;
     std::cout << " -k: Report known items (Scans, Hardware etc.)\n";
@@ -739,6 +843,31 @@ void listKnown() {
     logging::listLoggers();
 }
 
+std::vector<ScanStep> loadSequence(const std::string &path, const ScanStep &defaults) {
+    json j = ScanHelper::openJsonFile(path);
+    if (j["scans"].empty()) {
+        throw std::runtime_error("No \"scans\" in " + path);
+    }
+    std::vector<ScanStep> steps;
+    for (auto &entry : j["scans"]) {
+        // Settings not given for a scan are the ones of the command line
+        ScanStep step = defaults;
+        if (entry.is_string()) {
+            step.scanType = static_cast<std::string>(entry);
+        } else {
+            if (entry["scan"].empty()) {
+                throw std::runtime_error("Scan without \"scan\" in " + path);
+            }
+            step.scanType = static_cast<std::string>(entry["scan"]);
+            if (!entry["target_charge"].empty()) step.target_charge = entry["target_charge"];
+            if (!entry["target_tot"].empty()) step.target_tot = entry["target_tot"];
+            if (!entry["mask"].empty()) step.mask_opt = entry["mask"];
+        }
+        steps.push_back(step);
+    }
+    return steps;
+}
+
 std::unique_ptr<ScanBase> buildScan( const std::string& scanType, Bookkeeper& bookie ) {
 
     logger->info("Found Scan config, constructing scan ...");